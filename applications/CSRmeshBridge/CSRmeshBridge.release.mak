@@ -51,6 +51,12 @@ INPUTS=\
       mesh_control_service.c\
       nvm_access.c\
       app_fw_event_handler.c\
+      app_dup_filter.c\
+      app_trace.c\
+      mtl_framing.c\
+      app_neighbour.c\
+      app_user_adv.c\
+      app_adv_parse.c\
       $(DBS)
 
 KEYR=\
@@ -0,0 +1,119 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_adv_parse.c
+ *
+ *  DESCRIPTION
+ *      This file implements the walk over the AD structures of a received
+ *      advert. The advert data is supplied packed two octets to a word, and
+ *      only the length, type and UUID octets are read from it while looking
+ *      for a structure of interest. Adv packets are of the form:
+ *       |L|T|D....|L|T|D....|...
+ *       L - Length  1 octet. Includes length of T(Type) + D(data)
+ *       T - AD type 1 octet
+ *       D - Data    L minus 1 octets
+ *
+ *      The parser does not depend on the radio, so it is also built in the
+ *      host benchmark, host_tests/bench_adv_parse.c.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_adv_parse.h"
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppAdvReadOctet
+ *
+ *  DESCRIPTION
+ *      This function reads a single octet from the packed advert data
+ *      without unpacking the rest of the report.
+ *
+ *  RETURNS
+ *      The octet at the given offset.
+ *
+ *---------------------------------------------------------------------------*/
+extern uint8 AppAdvReadOctet(const uint16 *p_packed, uint16 offset)
+{
+    uint16 word = p_packed[offset >> 1];
+
+    return (offset & 1) ? (uint8)(word >> 8) : (uint8)(word & 0x00FF);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppAdvNextAd
+ *
+ *  DESCRIPTION
+ *      This function steps from the AD structure at *p_index to the next one
+ *      that is long enough to carry a type, a 16 bit UUID and a payload,
+ *      using the length octets. Shorter structures are stepped over. The
+ *      walk ends at a zero length octet or at a structure that runs past
+ *      the end of the advert. The caller moves *p_index past the structure
+ *      found to continue the walk.
+ *
+ *  RETURNS
+ *      TRUE if a structure was found, with its offset in *p_index and its
+ *      length octet in *p_length.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool AppAdvNextAd(const uint16 *p_packed, uint16 length_data,
+                         uint16 *p_index, uint8 *p_length)
+{
+    uint16 index = *p_index;
+    uint8 length;
+
+    while(index + AD_PAYLOAD_OFFSET < length_data)
+    {
+        length = AppAdvReadOctet(p_packed, index + AD_LENGTH_OFFSET);
+
+        if(length == 0 || index + length >= length_data)
+        {
+            /* Early termination or malformed AD structure */
+            break;
+        }
+
+        if(length >= AD_MIN_MATCH_LENGTH)
+        {
+            *p_index = index;
+            *p_length = length;
+            return TRUE;
+        }
+
+        /* Move to the next AD structure */
+        index += length + 1;
+    }
+
+    return FALSE;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppAdvMatchAd
+ *
+ *  DESCRIPTION
+ *      This function compares the AD type and 16 bit UUID of the AD structure
+ *      starting at index against the 3 octet header supplied.
+ *
+ *  RETURNS
+ *      TRUE if the header matches.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool AppAdvMatchAd(const uint16 *p_packed, uint16 index,
+                          const uint8 *p_header)
+{
+    return (AppAdvReadOctet(p_packed, index + AD_TYPE_OFFSET) ==
+                                                            p_header[0] &&
+            AppAdvReadOctet(p_packed, index + AD_UUID_LSB_OFFSET) ==
+                                                            p_header[1] &&
+            AppAdvReadOctet(p_packed, index + AD_UUID_MSB_OFFSET) ==
+                                                            p_header[2]);
+}
@@ -0,0 +1,50 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_adv_parse.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for walking the AD structures of a received
+ *      advert in its packed form
+ *
+ *****************************************************************************/
+
+#ifndef __APP_ADV_PARSE_H__
+#define __APP_ADV_PARSE_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Offsets within an AD structure |L|T|UUID LSB|UUID MSB|Data...| */
+#define AD_LENGTH_OFFSET               (0)
+#define AD_TYPE_OFFSET                 (1)
+#define AD_UUID_LSB_OFFSET             (2)
+#define AD_UUID_MSB_OFFSET             (3)
+#define AD_PAYLOAD_OFFSET              (4)
+
+/* Smallest AD length (type + 16 bit UUID + 1 payload octet) worth matching */
+#define AD_MIN_MATCH_LENGTH            (AD_PAYLOAD_OFFSET)
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Reads a single octet of the packed advert data */
+extern uint8 AppAdvReadOctet(const uint16 *p_packed, uint16 offset);
+
+/* Finds the next AD structure from *p_index long enough to be matched */
+extern bool AppAdvNextAd(const uint16 *p_packed, uint16 length_data,
+                         uint16 *p_index, uint8 *p_length);
+
+/* Compares the AD type and 16 bit UUID of an AD structure with a header */
+extern bool AppAdvMatchAd(const uint16 *p_packed, uint16 index,
+                          const uint8 *p_header);
+
+#endif /* __APP_ADV_PARSE_H__ */
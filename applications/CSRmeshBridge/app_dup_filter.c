@@ -0,0 +1,192 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_dup_filter.c
+ *
+ *  DESCRIPTION
+ *      This file implements a small cache of digests of the MTL payloads
+ *      received in mesh adverts. Relays repeat every message several times,
+ *      so most received adverts are exact copies of a message that has
+ *      already been handed to the scheduler. Dropping these here saves the
+ *      MAC and decrypt work the CSRmesh library does before its own seen
+ *      packet cache rejects them.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <time.h>
+#include <mem.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_dup_filter.h"
+
+#ifdef ENABLE_DUPLICATE_FILTER
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Number of recently received payload digests remembered */
+#define DUP_FILTER_CACHE_SIZE           (16)
+
+/* Time for which a digest filters repeats. This covers the relay repeats of
+ * one message but lets protocol level retransmissions, which are sent with
+ * the same content, reach the library.
+ */
+#define DUP_FILTER_LIFETIME             (1 * SECOND)
+
+/* FNV-1a 32 bit hash parameters */
+#define FNV_OFFSET_BASIS                (0x811C9DC5UL)
+#define FNV_PRIME                       (0x01000193UL)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint32 digest;      /* Digest of the MTL payload */
+    uint32 rx_time;     /* Time the payload was first received */
+}DUP_FILTER_ENTRY_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Cache of recently received payload digests */
+static DUP_FILTER_ENTRY_T dup_cache[DUP_FILTER_CACHE_SIZE];
+
+/* Number of valid entries in the cache */
+static uint16 dup_cache_used;
+
+/* Index of the entry to be replaced next */
+static uint16 dup_cache_next;
+
+/* Filter counters */
+static APP_DUP_FILTER_STATS_T dup_stats;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static uint32 computeDigest(const uint8 *p_mtl, uint16 length);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      computeDigest
+ *
+ *  DESCRIPTION
+ *      Computes the digest of an MTL payload. The last octet holds the TTL,
+ *      which is decremented on every hop, so it is left out to match copies
+ *      relayed by different devices.
+ *
+ *  RETURNS
+ *      32 bit digest of the payload.
+ *
+ *---------------------------------------------------------------------------*/
+static uint32 computeDigest(const uint8 *p_mtl, uint16 length)
+{
+    uint32 digest = FNV_OFFSET_BASIS;
+    uint16 index;
+
+    for(index = 0; index + 1 < length; index++)
+    {
+        digest ^= (p_mtl[index] & 0xFF);
+        digest *= FNV_PRIME;
+    }
+
+    /* Mix in the length so that truncated copies do not match */
+    digest ^= length;
+    digest *= FNV_PRIME;
+
+    return digest;
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppDupFilterInit
+ *
+ *  DESCRIPTION
+ *      This function clears the duplicate cache and the counters.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppDupFilterInit(void)
+{
+    MemSet(dup_cache, 0, sizeof(dup_cache));
+    MemSet(&dup_stats, 0, sizeof(dup_stats));
+    dup_cache_used = 0;
+    dup_cache_next = 0;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppDupFilterIsDuplicate
+ *
+ *  DESCRIPTION
+ *      This function checks whether the MTL payload of a received mesh advert
+ *      is a repeat of one received within DUP_FILTER_LIFETIME. New payloads
+ *      are added to the cache, replacing the oldest entry.
+ *
+ *  RETURNS
+ *      TRUE if the payload is a repeat and should be dropped.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool AppDupFilterIsDuplicate(const uint8 *p_mtl, uint16 length)
+{
+    uint32 digest = computeDigest(p_mtl, length);
+    uint32 now = TimeGet32();
+    uint16 index;
+
+    for(index = 0; index < dup_cache_used; index++)
+    {
+        if(dup_cache[index].digest == digest &&
+           TimeSub(now, dup_cache[index].rx_time) < DUP_FILTER_LIFETIME)
+        {
+            dup_stats.hits++;
+            return TRUE;
+        }
+    }
+
+    /* Remember the new payload in place of the oldest one */
+    dup_cache[dup_cache_next].digest = digest;
+    dup_cache[dup_cache_next].rx_time = now;
+    dup_cache_next = (dup_cache_next + 1) % DUP_FILTER_CACHE_SIZE;
+    if(dup_cache_used < DUP_FILTER_CACHE_SIZE)
+    {
+        dup_cache_used++;
+    }
+
+    dup_stats.misses++;
+    return FALSE;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppDupFilterGetStats
+ *
+ *  DESCRIPTION
+ *      This function returns the duplicate filter counters.
+ *
+ *  RETURNS
+ *      Pointer to the counters.
+ *
+ *---------------------------------------------------------------------------*/
+extern const APP_DUP_FILTER_STATS_T *AppDupFilterGetStats(void)
+{
+    return &dup_stats;
+}
+
+#endif /* ENABLE_DUPLICATE_FILTER */
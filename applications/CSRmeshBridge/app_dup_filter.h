@@ -0,0 +1,54 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_dup_filter.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the duplicate filter applied to received mesh
+ *      adverts before they are passed to the CSRmesh scheduler
+ *
+ *****************************************************************************/
+
+#ifndef __APP_DUP_FILTER_H__
+#define __APP_DUP_FILTER_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+#ifdef ENABLE_DUPLICATE_FILTER
+/*============================================================================*
+ *  Public Data Types
+ *============================================================================*/
+/* Duplicate filter counters */
+typedef struct
+{
+    uint32 hits;    /* Repeats dropped before reaching the scheduler */
+    uint32 misses;  /* Messages passed on to the scheduler */
+}APP_DUP_FILTER_STATS_T;
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Clears the duplicate cache and the counters */
+extern void AppDupFilterInit(void);
+
+/* Checks the MTL payload against the recently received payloads and records
+ * it if it is new
+ */
+extern bool AppDupFilterIsDuplicate(const uint8 *p_mtl, uint16 length);
+
+/* Returns the duplicate filter counters */
+extern const APP_DUP_FILTER_STATS_T *AppDupFilterGetStats(void);
+
+#endif /* ENABLE_DUPLICATE_FILTER */
+#endif /* __APP_DUP_FILTER_H__ */
@@ -33,6 +33,12 @@
 #include "csr_ota.h"
 #include "csr_ota_service.h"
 #include "gatt_service.h"
+#include "mesh_control_service.h"
+#include "app_dup_filter.h"
+#include "app_trace.h"
+#include "app_neighbour.h"
+#include "app_user_adv.h"
+#include "app_adv_parse.h"
 
 /*============================================================================*
  *  Private Data
@@ -43,6 +49,16 @@ static uint8  unpackedData[MAX_ADV_DATA_LEN];
 /* TTL of received message */
 static uint8 rx_ttl;
 
+/* User advert AD header: AD type followed by the 16 bit user tag */
+static const uint8 user_ad_data[3] = {(0x00), (0xAB), (0xAB)};
+
+#ifdef ENABLE_USER_ADV_REASSEMBLY
+/* User advert chunk AD header: AD type followed by the company identifier */
+static const uint8 user_chunk_ad_data[3] = {(USER_ADV_AD_TYPE),
+                                            (USER_ADV_COMPANY_ID_LSB),
+                                            (USER_ADV_COMPANY_ID_MSB)};
+#endif /* ENABLE_USER_ADV_REASSEMBLY */
+
 /*============================================================================*
  *  Private Function Prototypes
  *============================================================================*/
@@ -685,6 +701,37 @@ extern void HandleSignalGattAccessInd(GATT_ACCESS_IND_T *p_event_data)
 }
 
 
+#ifdef ENABLE_ATT_MTU_EXCHANGE
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      HandleSignalGattExchangeMtuInd
+ *
+ *  DESCRIPTION
+ *      This function handles GATT_EXCHANGE_MTU_IND message. The client MTU is
+ *      accepted up to ATT_MTU_MAX and the resulting MTU is used for the mesh
+ *      control service transfers on this connection.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void HandleSignalGattExchangeMtuInd(
+                                    GATT_EXCHANGE_MTU_IND_T *p_event_data)
+{
+    uint16 mtu = p_event_data->mtu;
+
+    /* The MTU in use is the smaller of the client and server MTUs */
+    if(mtu > ATT_MTU_MAX)
+    {
+        mtu = ATT_MTU_MAX;
+    }
+
+    GattExchangeMtuRsp(p_event_data->cid, ATT_MTU_MAX);
+
+    MeshControlSetAttMtu(mtu);
+}
+#endif /* ENABLE_ATT_MTU_EXCHANGE */
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      HandleSignalLmDisconnectComplete
@@ -758,105 +805,93 @@ extern bool HandleLEAdvMessage(LM_EV_ADVERTISING_REPORT_T* report)
     bool result = FALSE;
     uint16 *advertData;
     uint8 length;
-    uint8 index = 0;
-	uint8 mydata[3]={(0x00),(0xAB),(0xAB)};
+    uint16 index = 0;
 
     HCI_EV_DATA_ULP_ADVERTISING_REPORT_T *data = &(report->data);
 
     /* handle non connectable adv */
     if( data->event_type == ls_advert_non_connectable )
     {
-        /* The advert data is supplied to us as a packed uint8 so unpack it
-         * locally to allow easier analysis (to find the device name).
-         *
-         * Get a pointer to the actual data, which is after the control
-         * information block and RSSI parameter (the last uint8).
+        /* The advert data is supplied to us as a packed uint8. Get a pointer
+         * to the actual data, which is after the control information block
+         * and RSSI parameter (the last uint8).
          */
         advertData = (uint16*) data +
                      sizeof(HCI_EV_DATA_ULP_ADVERTISING_REPORT_T) +
                      sizeof(uint8);
 
-        MemCopyUnPack(unpackedData, advertData, data->length_data);
-
-        /* Loop until we find a block with manufacturer specific data */
-        do
+        /* Walk the AD structures using their length octets. For mesh
+         * packets, the AD data is the 16 bits UUID followed by the mesh
+         * payload. Mesh payload size = L minus 3. Only the length, type and
+         * UUID octets are read from the packed report until a mesh AD
+         * structure is found.
+         */
+        while(AppAdvNextAd(advertData, data->length_data, &index, &length))
         {
-            if(index + 4 < data->length_data)
+            if(AppAdvMatchAd(advertData, index, mesh_ad_data))
             {
-                /* Search for CSRmesh UUID data 
-                 * Adv packets are of the form:
-                 *  |L|T|D....|L|T|D....|...
-                 *  L - Length  1 octet. Includes length of T(Type) + D(data)
-                 *  T - AD type 1 octet
-                 *  D - Data    L minus 1 octets
-                 *  For mesh packets, data will be 16 bits UUID followed by mesh
-                 *  payload
-                 *  Mesh payload size = L minus 3 .
+                /* Unpack the report only up to the end of this AD
+                 * structure.
                  */
-                if (!MemCmp(&unpackedData[index + 1], mesh_ad_data, 3))
-                {
-                    /* derive length first */
-                    length = unpackedData[index];
-
-                    if(length > MAX_ADV_DATA_LEN || length == 0)
-                    {
-                        /* We don't have enough data to process */
-                        break;
-                    }
+                MemCopyUnPack(unpackedData, advertData, index + length + 1);
 
-                    /* Fill in TTL variables */
-                    rx_ttl  = unpackedData[index + length];
+                /* Fill in TTL variables */
+                rx_ttl  = unpackedData[index + length];
+                result = TRUE;
 
-                    /* Update Bearer Event Data structure with incoming Mesh 
-                     * Data.
-                     */
-                     DEBUG_STR("a mesh data ");
-					BD_ADDR_T *myaddress=&(data->address);
-					DEBUG_U8((myaddress->nap & 0xFF00)>>8);
-					DEBUG_STR(":");
-					DEBUG_U8((myaddress->nap & 0x00FF));
-					DEBUG_STR(":");
-					DEBUG_U8(myaddress->uap);
-					DEBUG_STR(":");
-					DEBUG_U8((myaddress->lap & 0xFF0000) >> 16);
-					DEBUG_STR(":");
-					DEBUG_U8((myaddress->lap & 0x00FF00) >> 8);
-					DEBUG_STR(":");
-					DEBUG_U8((myaddress->lap & 0x0000FF));
-					DEBUG_STR("\n");
-                    CSRSchedHandleIncomingData(
-                                        CSR_SCHED_INCOMING_LE_MESH_DATA_EVENT, 
-                                        &unpackedData[index+4], (length-3), 
-                                        report->rssi);
-                    result = TRUE;
-                    break;
-                }
-                else if (!MemCmp(&unpackedData[index + 1], mydata, 3))
+#ifdef ENABLE_DUPLICATE_FILTER
+                /* Drop exact repeats of a recently received message */
+                if(AppDupFilterIsDuplicate(
+                                &unpackedData[index + AD_PAYLOAD_OFFSET],
+                                (length-3)))
                 {
-                    /* Not a mesh data */
-					DEBUG_STR("Not a mesh data ");
-					BD_ADDR_T *myaddress=&(data->address);
-					DEBUG_U8((myaddress->nap & 0xFF00)>>8);
-					DEBUG_STR(":");
-					DEBUG_U8((myaddress->nap & 0x00FF));
-					DEBUG_STR(":");
-					DEBUG_U8(myaddress->uap);
-					DEBUG_STR(":");
-					DEBUG_U8((myaddress->lap & 0xFF0000) >> 16);
-					DEBUG_STR(":");
-					DEBUG_U8((myaddress->lap & 0x00FF00) >> 8);
-					DEBUG_STR(":");
-					DEBUG_U8((myaddress->lap & 0x0000FF));
-					DEBUG_STR("\n");
+#ifdef ENABLE_NEIGHBOUR_TABLE
+                    AppNeighbourUpdate(&data->address, report->rssi, TRUE);
+#endif /* ENABLE_NEIGHBOUR_TABLE */
+                    APP_TRACE(trace_evt_mesh_dup, &data->address,
+                              report->rssi);
+                    break;
                 }
-                index += 1;
+#endif /* ENABLE_DUPLICATE_FILTER */
+
+#ifdef ENABLE_NEIGHBOUR_TABLE
+                /* Record the neighbour the advert was heard from */
+                AppNeighbourUpdate(&data->address, report->rssi, FALSE);
+#endif /* ENABLE_NEIGHBOUR_TABLE */
+
+                /* Update Bearer Event Data structure with incoming Mesh 
+                 * Data.
+                 */
+                APP_TRACE(trace_evt_mesh_adv, &data->address,
+                          report->rssi);
+                CSRSchedHandleIncomingData(
+                                    CSR_SCHED_INCOMING_LE_MESH_DATA_EVENT, 
+                                    &unpackedData[index + AD_PAYLOAD_OFFSET],
+                                    (length-3), 
+                                    report->rssi);
+                break;
             }
-            else
+            else if(AppAdvMatchAd(advertData, index, user_ad_data))
             {
-                /* We don't have enough data to process */
+                /* Not a mesh data */
+                APP_TRACE(trace_evt_user_adv, &data->address,
+                          report->rssi);
+            }
+#ifdef ENABLE_USER_ADV_REASSEMBLY
+            else if(AppAdvMatchAd(advertData, index, user_chunk_ad_data))
+            {
+                /* Chunk of a report sent by a light in user adverts */
+                MemCopyUnPack(unpackedData, advertData, index + length + 1);
+                AppUserAdvHandleChunk(&data->address,
+                                      &unpackedData[index + AD_PAYLOAD_OFFSET],
+                                      (length-3));
                 break;
             }
-        }while(index < data->length_data);
+#endif /* ENABLE_USER_ADV_REASSEMBLY */
+
+            /* Move to the next AD structure */
+            index += length + 1;
+        }
     }
     else
     {
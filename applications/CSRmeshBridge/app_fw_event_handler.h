@@ -30,6 +30,10 @@ extern void HandleSignalLmConnectionUpdate(
 extern void HandleSignalLsConnParamUpdateInd(
                                 LS_CONNECTION_PARAM_UPDATE_IND_T *p_event_data);
 extern void HandleSignalGattAccessInd(GATT_ACCESS_IND_T *p_event_data);
+#ifdef ENABLE_ATT_MTU_EXCHANGE
+extern void HandleSignalGattExchangeMtuInd(
+                                    GATT_EXCHANGE_MTU_IND_T *p_event_data);
+#endif /* ENABLE_ATT_MTU_EXCHANGE */
 extern void HandleSignalLmDisconnectComplete(
                 HCI_EV_DATA_DISCONNECT_COMPLETE_T *p_event_data);
 extern bool HandleLEAdvMessage(LM_EV_ADVERTISING_REPORT_T* report);
@@ -39,6 +39,12 @@
 
 #define ATT_MTU                              (23)
 
+/* Largest ATT MTU offered in the Exchange MTU procedure when
+ * ENABLE_ATT_MTU_EXCHANGE is defined. At this MTU a whole mesh message fits in
+ * one ATT write or notification.
+ */
+#define ATT_MTU_MAX                          (64)
+
 #define ATT_WRITE_MAX_DATALEN                (ATT_MTU - 3)
 
 /* GATT ERROR codes: 
@@ -0,0 +1,424 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_neighbour.c
+ *
+ *  DESCRIPTION
+ *      This file keeps a table of the devices heard in received mesh
+ *      adverts, with an averaged RSSI, packet counts and the time each was
+ *      last heard. The table is read over the NEIGHBOUR_TABLE characteristic
+ *      to work out the mesh topology and relay placement on a site.
+ *
+ *      Entries are found through a small hash on the BD address and kept in
+ *      a list ordered by the time they were last heard, so an update from
+ *      the scan path does not search the whole table and the least recently
+ *      heard entry is the one replaced.
+ *
+ *      NEIGHBOUR_TABLE value:
+ *          |slot|table size|BD address (6)|RSSI|packets (2)|repeats (2)|
+ *          |age (2)|
+ *      Multi octet fields are little endian. The BD address is sent LAP
+ *      first, then UAP and NAP. RSSI is the average in dBm, packets is the
+ *      number of mesh adverts heard from the neighbour, repeats the number
+ *      of those that were repeats of a message already received and age the
+ *      number of seconds since it was last heard. Only the first two octets
+ *      are sent for an unused slot.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <time.h>
+#include <mem.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_neighbour.h"
+
+#ifdef ENABLE_NEIGHBOUR_TABLE
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Number of hash buckets. Must be a power of 2. */
+#define NEIGHBOUR_HASH_SIZE             (8)
+
+/* Marks the end of a bucket chain or of the recently heard list */
+#define NEIGHBOUR_NONE                  (0xFFFF)
+
+/* RSSI average is kept in 1/16 dBm steps */
+#define NEIGHBOUR_RSSI_SCALE            (16)
+
+/* Weight of a new RSSI sample in the average is 1/NEIGHBOUR_RSSI_WEIGHT */
+#define NEIGHBOUR_RSSI_WEIGHT           (8)
+
+/* Largest value of the 16 bit counters and age */
+#define NEIGHBOUR_COUNT_MAX             (0xFFFF)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    BD_ADDR_T addr;         /* BD address of the neighbour */
+    int16  rssi_avg;        /* Averaged RSSI in 1/16 dBm */
+    uint16 packets;         /* Mesh adverts heard */
+    uint16 repeats;         /* Repeats of messages already received */
+    uint32 last_seen;       /* Time the neighbour was last heard */
+    uint16 hash_next;       /* Next entry in the same hash bucket */
+    uint16 lru_prev;        /* More recently heard entry */
+    uint16 lru_next;        /* Less recently heard entry */
+}NEIGHBOUR_ENTRY_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Neighbour table */
+static NEIGHBOUR_ENTRY_T neighbours[NEIGHBOUR_TABLE_SIZE];
+
+/* First entry in each hash bucket */
+static uint16 neighbour_hash[NEIGHBOUR_HASH_SIZE];
+
+/* Most and least recently heard entries */
+static uint16 neighbour_lru_head;
+static uint16 neighbour_lru_tail;
+
+/* Number of entries in use */
+static uint16 neighbour_used;
+
+/* Slot returned by the next read of NEIGHBOUR_TABLE */
+static uint16 neighbour_cursor;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static uint16 hashAddress(const BD_ADDR_T *p_addr);
+static void unlinkRecent(uint16 entry);
+static void linkRecent(uint16 entry);
+static void unlinkHash(uint16 entry);
+static uint16 allocateEntry(const BD_ADDR_T *p_addr);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      hashAddress
+ *
+ *  DESCRIPTION
+ *      Computes the hash bucket of a BD address.
+ *
+ *  RETURNS
+ *      Hash bucket index.
+ *
+ *---------------------------------------------------------------------------*/
+static uint16 hashAddress(const BD_ADDR_T *p_addr)
+{
+    uint16 hash = (uint16)(p_addr->lap ^ (p_addr->lap >> 16) ^
+                           p_addr->uap ^ p_addr->nap);
+
+    return (hash ^ (hash >> 8)) & (NEIGHBOUR_HASH_SIZE - 1);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      unlinkRecent
+ *
+ *  DESCRIPTION
+ *      Removes an entry from the recently heard list.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void unlinkRecent(uint16 entry)
+{
+    NEIGHBOUR_ENTRY_T *p_entry = &neighbours[entry];
+
+    if(p_entry->lru_prev != NEIGHBOUR_NONE)
+    {
+        neighbours[p_entry->lru_prev].lru_next = p_entry->lru_next;
+    }
+    else
+    {
+        neighbour_lru_head = p_entry->lru_next;
+    }
+
+    if(p_entry->lru_next != NEIGHBOUR_NONE)
+    {
+        neighbours[p_entry->lru_next].lru_prev = p_entry->lru_prev;
+    }
+    else
+    {
+        neighbour_lru_tail = p_entry->lru_prev;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      linkRecent
+ *
+ *  DESCRIPTION
+ *      Puts an entry at the head of the recently heard list.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void linkRecent(uint16 entry)
+{
+    neighbours[entry].lru_prev = NEIGHBOUR_NONE;
+    neighbours[entry].lru_next = neighbour_lru_head;
+
+    if(neighbour_lru_head != NEIGHBOUR_NONE)
+    {
+        neighbours[neighbour_lru_head].lru_prev = entry;
+    }
+    else
+    {
+        neighbour_lru_tail = entry;
+    }
+
+    neighbour_lru_head = entry;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      unlinkHash
+ *
+ *  DESCRIPTION
+ *      Removes an entry from its hash bucket.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void unlinkHash(uint16 entry)
+{
+    uint16 *p_link = &neighbour_hash[hashAddress(&neighbours[entry].addr)];
+
+    while(*p_link != NEIGHBOUR_NONE)
+    {
+        if(*p_link == entry)
+        {
+            *p_link = neighbours[entry].hash_next;
+            return;
+        }
+        p_link = &neighbours[*p_link].hash_next;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      allocateEntry
+ *
+ *  DESCRIPTION
+ *      Takes an unused entry, or the least recently heard one if the table
+ *      is full, for a new neighbour and adds it to its hash bucket.
+ *
+ *  RETURNS
+ *      Index of the entry.
+ *
+ *---------------------------------------------------------------------------*/
+static uint16 allocateEntry(const BD_ADDR_T *p_addr)
+{
+    uint16 entry;
+    uint16 bucket;
+
+    if(neighbour_used < NEIGHBOUR_TABLE_SIZE)
+    {
+        entry = neighbour_used++;
+    }
+    else
+    {
+        /* Replace the neighbour heard least recently */
+        entry = neighbour_lru_tail;
+        unlinkRecent(entry);
+        unlinkHash(entry);
+    }
+
+    MemSet(&neighbours[entry], 0, sizeof(NEIGHBOUR_ENTRY_T));
+    neighbours[entry].addr = *p_addr;
+
+    bucket = hashAddress(p_addr);
+    neighbours[entry].hash_next = neighbour_hash[bucket];
+    neighbour_hash[bucket] = entry;
+
+    return entry;
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppNeighbourInit
+ *
+ *  DESCRIPTION
+ *      This function clears the neighbour table.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppNeighbourInit(void)
+{
+    uint16 bucket;
+
+    for(bucket = 0; bucket < NEIGHBOUR_HASH_SIZE; bucket++)
+    {
+        neighbour_hash[bucket] = NEIGHBOUR_NONE;
+    }
+
+    neighbour_lru_head = NEIGHBOUR_NONE;
+    neighbour_lru_tail = NEIGHBOUR_NONE;
+    neighbour_used = 0;
+    neighbour_cursor = 0;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppNeighbourUpdate
+ *
+ *  DESCRIPTION
+ *      This function records a mesh advert received from a neighbour. The
+ *      RSSI is added to the neighbour's exponential average and the
+ *      neighbour becomes the most recently heard one.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppNeighbourUpdate(const BD_ADDR_T *p_addr, int8 rssi,
+                               bool repeat)
+{
+    NEIGHBOUR_ENTRY_T *p_entry;
+    uint16 entry = neighbour_hash[hashAddress(p_addr)];
+    int16 sample = (int16)rssi * NEIGHBOUR_RSSI_SCALE;
+
+    while(entry != NEIGHBOUR_NONE &&
+          (neighbours[entry].addr.lap != p_addr->lap ||
+           neighbours[entry].addr.uap != p_addr->uap ||
+           neighbours[entry].addr.nap != p_addr->nap))
+    {
+        entry = neighbours[entry].hash_next;
+    }
+
+    if(entry == NEIGHBOUR_NONE)
+    {
+        entry = allocateEntry(p_addr);
+        neighbours[entry].rssi_avg = sample;
+    }
+    else
+    {
+        unlinkRecent(entry);
+        neighbours[entry].rssi_avg += (sample - neighbours[entry].rssi_avg) /
+                                      NEIGHBOUR_RSSI_WEIGHT;
+    }
+    linkRecent(entry);
+
+    p_entry = &neighbours[entry];
+    p_entry->last_seen = TimeGet32();
+
+    if(p_entry->packets < NEIGHBOUR_COUNT_MAX)
+    {
+        p_entry->packets++;
+    }
+
+    if(repeat && p_entry->repeats < NEIGHBOUR_COUNT_MAX)
+    {
+        p_entry->repeats++;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppNeighbourReadRecord
+ *
+ *  DESCRIPTION
+ *      This function fills in the NEIGHBOUR_TABLE value for the table slot
+ *      at the read cursor and moves the cursor to the next slot, so that
+ *      successive reads return the whole table.
+ *
+ *  RETURNS
+ *      Length of the value.
+ *
+ *---------------------------------------------------------------------------*/
+extern uint16 AppNeighbourReadRecord(uint8 *p_value)
+{
+    NEIGHBOUR_ENTRY_T *p_entry = &neighbours[neighbour_cursor];
+    int32 age;
+
+    p_value[0] = neighbour_cursor;
+    p_value[1] = NEIGHBOUR_TABLE_SIZE;
+
+    if(neighbour_cursor >= neighbour_used)
+    {
+        neighbour_cursor = (neighbour_cursor + 1) % NEIGHBOUR_TABLE_SIZE;
+        return 2;
+    }
+
+    p_value[2] = p_entry->addr.lap & 0xFF;
+    p_value[3] = (p_entry->addr.lap >> 8) & 0xFF;
+    p_value[4] = (p_entry->addr.lap >> 16) & 0xFF;
+    p_value[5] = p_entry->addr.uap & 0xFF;
+    p_value[6] = p_entry->addr.nap & 0xFF;
+    p_value[7] = p_entry->addr.nap >> 8;
+
+    /* Round the average to the nearest dBm */
+    p_value[8] = ((p_entry->rssi_avg + (p_entry->rssi_avg < 0 ?
+                                        -(NEIGHBOUR_RSSI_SCALE / 2) :
+                                        (NEIGHBOUR_RSSI_SCALE / 2))) /
+                  NEIGHBOUR_RSSI_SCALE) & 0xFF;
+
+    p_value[9] = p_entry->packets & 0xFF;
+    p_value[10] = p_entry->packets >> 8;
+    p_value[11] = p_entry->repeats & 0xFF;
+    p_value[12] = p_entry->repeats >> 8;
+
+    /* The 32 bit clock wraps after about 71 minutes. Report the largest age
+     * for neighbours not heard for longer than half of that.
+     */
+    age = TimeSub(TimeGet32(), p_entry->last_seen) / SECOND;
+    if(age < 0 || age > NEIGHBOUR_COUNT_MAX)
+    {
+        age = NEIGHBOUR_COUNT_MAX;
+    }
+    p_value[13] = age & 0xFF;
+    p_value[14] = (age >> 8) & 0xFF;
+
+    neighbour_cursor = (neighbour_cursor + 1) % NEIGHBOUR_TABLE_SIZE;
+
+    return NEIGHBOUR_RECORD_LEN;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppNeighbourSetCursor
+ *
+ *  DESCRIPTION
+ *      This function sets the table slot returned by the next read of the
+ *      NEIGHBOUR_TABLE characteristic.
+ *
+ *  RETURNS
+ *      TRUE if the slot is within the table.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool AppNeighbourSetCursor(uint16 slot)
+{
+    if(slot >= NEIGHBOUR_TABLE_SIZE)
+    {
+        return FALSE;
+    }
+
+    neighbour_cursor = slot;
+    return TRUE;
+}
+
+#endif /* ENABLE_NEIGHBOUR_TABLE */
@@ -0,0 +1,58 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_neighbour.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the table of neighbours heard in received mesh
+ *      adverts
+ *
+ *****************************************************************************/
+
+#ifndef __APP_NEIGHBOUR_H__
+#define __APP_NEIGHBOUR_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+#include <bluetooth.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+#ifdef ENABLE_NEIGHBOUR_TABLE
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Number of neighbours remembered. The least recently heard neighbour is
+ * replaced when a new one is heard and the table is full.
+ */
+#define NEIGHBOUR_TABLE_SIZE            (16)
+
+/* Length of the NEIGHBOUR_TABLE characteristic value */
+#define NEIGHBOUR_RECORD_LEN            (15)
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Clears the neighbour table */
+extern void AppNeighbourInit(void);
+
+/* Records a mesh advert received from a neighbour */
+extern void AppNeighbourUpdate(const BD_ADDR_T *p_addr, int8 rssi,
+                               bool repeat);
+
+/* Fills in the NEIGHBOUR_TABLE value for the next table slot */
+extern uint16 AppNeighbourReadRecord(uint8 *p_value);
+
+/* Sets the table slot returned by the next read of NEIGHBOUR_TABLE */
+extern bool AppNeighbourSetCursor(uint16 slot);
+
+#endif /* ENABLE_NEIGHBOUR_TABLE */
+#endif /* __APP_NEIGHBOUR_H__ */
@@ -0,0 +1,207 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_trace.c
+ *
+ *  DESCRIPTION
+ *      This file implements a fixed size ring of binary trace entries for
+ *      the advert receive path. Recording an entry only stores a few words;
+ *      the entries are formatted and written to the UART from a timer once
+ *      the pending radio events have been handled, a few at a time.
+ *
+ *      Each entry is written as:
+ *          T <event> <timestamp ms> <address hash> <rssi>
+ *      and entries lost because the ring was full are reported as:
+ *          T DROP <count>
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <timer.h>
+#include <time.h>
+#include <mem.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_debug.h"
+#include "app_trace.h"
+
+#ifdef DEBUG_ENABLE
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Number of entries in the trace ring */
+#define TRACE_RING_SIZE                 (32)
+
+/* Maximum number of entries written to the UART per drain timer expiry */
+#define TRACE_DRAIN_BATCH               (4)
+
+/* Delay before the next batch of entries is written to the UART */
+#define TRACE_DRAIN_INTERVAL            (20 * MILLISECOND)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint16 event;       /* app_trace_event */
+    uint32 timestamp;   /* Receive time in milliseconds */
+    uint16 addr_hash;   /* Hash of the sender BD address */
+    int8   rssi;        /* Received signal strength */
+}TRACE_ENTRY_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Trace ring */
+static TRACE_ENTRY_T trace_ring[TRACE_RING_SIZE];
+
+/* Index of the oldest entry not yet written out */
+static uint16 trace_tail;
+
+/* Number of entries not yet written out */
+static uint16 trace_count;
+
+/* Number of entries lost since the last drop report */
+static uint16 trace_dropped;
+
+/* Drain timer */
+static timer_id trace_drain_tid = TIMER_INVALID;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static void traceDrainTimerHandler(timer_id tid);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      traceDrainTimerHandler
+ *
+ *  DESCRIPTION
+ *      Writes up to TRACE_DRAIN_BATCH entries to the UART and restarts the
+ *      timer if more entries are pending.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void traceDrainTimerHandler(timer_id tid)
+{
+    TRACE_ENTRY_T *p_entry;
+    uint16 batch = 0;
+
+    if(tid != trace_drain_tid)
+    {
+        return;
+    }
+    trace_drain_tid = TIMER_INVALID;
+
+    if(trace_dropped)
+    {
+        DEBUG_STR("T DROP ");
+        DEBUG_U16(trace_dropped);
+        DEBUG_STR("\r\n");
+        trace_dropped = 0;
+    }
+
+    while(trace_count && batch < TRACE_DRAIN_BATCH)
+    {
+        p_entry = &trace_ring[trace_tail];
+
+        DEBUG_STR("T ");
+        DEBUG_U8(p_entry->event);
+        DEBUG_STR(" ");
+        DEBUG_U32(p_entry->timestamp);
+        DEBUG_STR(" ");
+        DEBUG_U16(p_entry->addr_hash);
+        DEBUG_STR(" ");
+        DEBUG_U8(p_entry->rssi & 0xFF);
+        DEBUG_STR("\r\n");
+
+        trace_tail = (trace_tail + 1) % TRACE_RING_SIZE;
+        trace_count--;
+        batch++;
+    }
+
+    if(trace_count || trace_dropped)
+    {
+        trace_drain_tid = TimerCreate(TRACE_DRAIN_INTERVAL, TRUE,
+                                      traceDrainTimerHandler);
+    }
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppTraceInit
+ *
+ *  DESCRIPTION
+ *      This function clears the trace ring.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppTraceInit(void)
+{
+    TimerDelete(trace_drain_tid);
+    trace_drain_tid = TIMER_INVALID;
+    trace_tail = 0;
+    trace_count = 0;
+    trace_dropped = 0;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppTraceRecord
+ *
+ *  DESCRIPTION
+ *      This function stores a trace entry in the ring and starts the drain
+ *      timer if it is not already running. If the ring is full the entry is
+ *      counted as dropped.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppTraceRecord(app_trace_event event, const BD_ADDR_T *p_addr,
+                           int8 rssi)
+{
+    TRACE_ENTRY_T *p_entry;
+
+    if(trace_count == TRACE_RING_SIZE)
+    {
+        trace_dropped++;
+    }
+    else
+    {
+        p_entry = &trace_ring[(trace_tail + trace_count) % TRACE_RING_SIZE];
+        p_entry->event = event;
+        p_entry->timestamp = TimeGet32() / MILLISECOND;
+        p_entry->addr_hash = (uint16)(p_addr->lap ^ (p_addr->lap >> 16) ^
+                                      ((uint16)p_addr->uap << 8) ^ p_addr->nap);
+        p_entry->rssi = rssi;
+        trace_count++;
+    }
+
+    if(trace_drain_tid == TIMER_INVALID)
+    {
+        trace_drain_tid = TimerCreate(TRACE_DRAIN_INTERVAL, TRUE,
+                                      traceDrainTimerHandler);
+    }
+}
+
+#endif /* DEBUG_ENABLE */
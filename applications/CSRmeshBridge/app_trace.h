@@ -0,0 +1,56 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_trace.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the deferred binary trace of received adverts
+ *
+ *****************************************************************************/
+
+#ifndef __APP_TRACE_H__
+#define __APP_TRACE_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+#include <bluetooth.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Trace event identifiers */
+typedef enum
+{
+    trace_evt_mesh_adv = 1,     /* Mesh advert passed to the scheduler */
+    trace_evt_mesh_dup,         /* Mesh advert dropped as a repeat */
+    trace_evt_user_adv          /* User (0x00ABAB) advert received */
+}app_trace_event;
+
+#ifdef DEBUG_ENABLE
+/* Records a trace entry. Entries are written to the UART later. */
+#define APP_TRACE(e, p_addr, rssi)  AppTraceRecord((e), (p_addr), (rssi))
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Clears the trace ring */
+extern void AppTraceInit(void);
+
+/* Adds an entry to the trace ring and schedules it to be written out */
+extern void AppTraceRecord(app_trace_event event, const BD_ADDR_T *p_addr,
+                           int8 rssi);
+#else
+#define APP_TRACE(e, p_addr, rssi)
+#endif /* DEBUG_ENABLE */
+
+#endif /* __APP_TRACE_H__ */
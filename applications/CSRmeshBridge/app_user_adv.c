@@ -0,0 +1,367 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_user_adv.c
+ *
+ *  DESCRIPTION
+ *      This file puts back together the reports that lights send in user
+ *      adverts. A report longer than one advert is sent in chunks of
+ *      manufacturer specific data:
+ *          |L|0xFF|0x0A|0x00|total << 4 | index|report octets...|
+ *      Every chunk but the last carries USER_ADV_CHUNK_LEN octets. The chunks
+ *      are sent in turn and repeated for as long as the report is current.
+ *
+ *      Chunks are collected per sending device. When all the chunks of a
+ *      report have been received it is notified once to the client on the
+ *      USER_ADV_REPORT characteristic. The same report is not notified again
+ *      until its content changes.
+ *
+ *      Many lights may be sending at once. A report being reassembled keeps
+ *      its slot until it is complete or its chunks stop, and the chunks of
+ *      other devices are dropped meanwhile. Their reports are repeated, so
+ *      they are picked up once a slot is free. The digests of the reports
+ *      notified are kept apart from the slots for more devices, so that a
+ *      device getting a slot again does not notify the same report twice.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <time.h>
+#include <mem.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_user_adv.h"
+#include "mesh_control_service.h"
+
+#ifdef ENABLE_USER_ADV_REASSEMBLY
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Number of devices whose reports can be reassembled at the same time */
+#define USER_ADV_SOURCES                (4)
+
+/* Number of devices whose last notified report is remembered */
+#define USER_ADV_FORWARDED              (16)
+
+/* A partly reassembled report is discarded if no chunk of it is received
+ * for this long. Lights send the chunks of a report 200ms apart, however
+ * long they wait between repeats of the whole report.
+ */
+#define USER_ADV_REASSEMBLY_TIMEOUT     (5 * SECOND)
+
+/* FNV-1a 32 bit hash parameters */
+#define FNV_OFFSET_BASIS                (0x811C9DC5UL)
+#define FNV_PRIME                       (0x01000193UL)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    BD_ADDR_T addr;             /* Device sending the report */
+    bool   in_use;              /* Slot holds a device */
+    uint16 total;               /* Number of chunks in the report */
+    uint16 received;            /* Bit mask of the chunks received */
+    uint16 length;              /* Report length, once the last chunk is in */
+    uint32 last_rx;             /* Time the last chunk was received */
+    uint8  data[USER_ADV_MAX_REPORT_LEN];
+}USER_ADV_SLOT_T;
+
+typedef struct
+{
+    BD_ADDR_T addr;             /* Device the report was received from */
+    bool   in_use;              /* Entry holds a device */
+    uint32 digest;              /* Digest of the report last notified */
+}USER_ADV_FORWARDED_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Reports being reassembled */
+static USER_ADV_SLOT_T user_adv_slots[USER_ADV_SOURCES];
+
+/* Reports last notified and the entry to be replaced next */
+static USER_ADV_FORWARDED_T user_adv_forwarded[USER_ADV_FORWARDED];
+static uint16 user_adv_forwarded_next;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static bool isSameAddr(const BD_ADDR_T *p_a, const BD_ADDR_T *p_b);
+static bool isReassembling(const USER_ADV_SLOT_T *p_slot, uint32 now);
+static USER_ADV_SLOT_T *getSlot(const BD_ADDR_T *p_addr, uint32 now);
+static USER_ADV_FORWARDED_T *getForwarded(const BD_ADDR_T *p_addr);
+static uint32 computeDigest(const uint8 *p_data, uint16 length);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      isSameAddr
+ *
+ *  DESCRIPTION
+ *      Compares two Bluetooth addresses.
+ *
+ *  RETURNS
+ *      TRUE if the addresses are the same.
+ *
+ *---------------------------------------------------------------------------*/
+static bool isSameAddr(const BD_ADDR_T *p_a, const BD_ADDR_T *p_b)
+{
+    return (p_a->lap == p_b->lap && p_a->uap == p_b->uap &&
+            p_a->nap == p_b->nap);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      isReassembling
+ *
+ *  DESCRIPTION
+ *      Checks whether a slot holds a report that has some of its chunks but
+ *      not all of them, and whose chunks are still arriving.
+ *
+ *  RETURNS
+ *      TRUE if the slot must not be given to another device.
+ *
+ *---------------------------------------------------------------------------*/
+static bool isReassembling(const USER_ADV_SLOT_T *p_slot, uint32 now)
+{
+    return (p_slot->in_use && p_slot->received != 0 &&
+            p_slot->received != (1 << p_slot->total) - 1 &&
+            TimeSub(now, p_slot->last_rx) <=
+                                        (int32)USER_ADV_REASSEMBLY_TIMEOUT);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      getSlot
+ *
+ *  DESCRIPTION
+ *      Finds the slot of a device. If the device has no slot, the slot of
+ *      the device heard least recently is given to it, unless that device
+ *      is in the middle of a report.
+ *
+ *  RETURNS
+ *      Pointer to the slot, or NULL if every slot is in the middle of a
+ *      report.
+ *
+ *---------------------------------------------------------------------------*/
+static USER_ADV_SLOT_T *getSlot(const BD_ADDR_T *p_addr, uint32 now)
+{
+    USER_ADV_SLOT_T *p_slot = NULL;
+    uint16 index;
+
+    for(index = 0; index < USER_ADV_SOURCES; index++)
+    {
+        USER_ADV_SLOT_T *p_entry = &user_adv_slots[index];
+
+        if(p_entry->in_use && isSameAddr(&p_entry->addr, p_addr))
+        {
+            return p_entry;
+        }
+
+        if(isReassembling(p_entry, now))
+        {
+            continue;
+        }
+
+        if(p_slot == NULL || !p_entry->in_use ||
+           (p_slot->in_use &&
+            TimeSub(now, p_entry->last_rx) > TimeSub(now, p_slot->last_rx)))
+        {
+            p_slot = p_entry;
+        }
+    }
+
+    if(p_slot != NULL)
+    {
+        MemSet(p_slot, 0, sizeof(USER_ADV_SLOT_T));
+        p_slot->addr = *p_addr;
+        p_slot->in_use = TRUE;
+    }
+
+    return p_slot;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      getForwarded
+ *
+ *  DESCRIPTION
+ *      Finds the report last notified for a device.
+ *
+ *  RETURNS
+ *      Pointer to the entry, or NULL if none is held for the device.
+ *
+ *---------------------------------------------------------------------------*/
+static USER_ADV_FORWARDED_T *getForwarded(const BD_ADDR_T *p_addr)
+{
+    uint16 index;
+
+    for(index = 0; index < USER_ADV_FORWARDED; index++)
+    {
+        if(user_adv_forwarded[index].in_use &&
+           isSameAddr(&user_adv_forwarded[index].addr, p_addr))
+        {
+            return &user_adv_forwarded[index];
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      computeDigest
+ *
+ *  DESCRIPTION
+ *      Computes the digest of a reassembled report.
+ *
+ *  RETURNS
+ *      32 bit digest of the report.
+ *
+ *---------------------------------------------------------------------------*/
+static uint32 computeDigest(const uint8 *p_data, uint16 length)
+{
+    uint32 digest = FNV_OFFSET_BASIS;
+    uint16 index;
+
+    for(index = 0; index < length; index++)
+    {
+        digest ^= (p_data[index] & 0xFF);
+        digest *= FNV_PRIME;
+    }
+
+    digest ^= length;
+    digest *= FNV_PRIME;
+
+    return digest;
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppUserAdvInit
+ *
+ *  DESCRIPTION
+ *      This function discards all partly reassembled reports.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppUserAdvInit(void)
+{
+    MemSet(user_adv_slots, 0, sizeof(user_adv_slots));
+    MemSet(user_adv_forwarded, 0, sizeof(user_adv_forwarded));
+    user_adv_forwarded_next = 0;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppUserAdvHandleChunk
+ *
+ *  DESCRIPTION
+ *      This function adds a chunk received from a device to the report being
+ *      reassembled for it. p_chunk points to the index octet which follows
+ *      the company identifier. A report whose chunks stop arriving, or whose
+ *      number of chunks changes, is started again. The chunks are sent in
+ *      turn, so the first chunk always starts a new copy of the report and
+ *      the chunks of an older copy are not mixed in. Once the chunks have
+ *      all been received the next chunk starts a new copy as well, so that
+ *      a change of content is picked up. Chunks from a device that cannot
+ *      be given a slot are dropped.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppUserAdvHandleChunk(const BD_ADDR_T *p_addr,
+                                  const uint8 *p_chunk, uint16 length)
+{
+    USER_ADV_SLOT_T *p_slot;
+    USER_ADV_FORWARDED_T *p_forwarded;
+    uint32 now = TimeGet32();
+    uint16 chunk_index = p_chunk[0] & 0x0F;
+    uint16 total = (p_chunk[0] >> 4) & 0x0F;
+    uint16 all_chunks;
+    uint32 digest;
+
+    /* Drop the index octet */
+    length--;
+
+    /* Ignore chunks that are malformed or from reports too long to hold */
+    if(total == 0 || total > USER_ADV_MAX_CHUNKS || chunk_index >= total ||
+       length == 0 || length > USER_ADV_CHUNK_LEN ||
+       (chunk_index + 1 < total && length != USER_ADV_CHUNK_LEN))
+    {
+        return;
+    }
+
+    p_slot = getSlot(p_addr, now);
+    if(p_slot == NULL)
+    {
+        return;
+    }
+
+    all_chunks = (1 << total) - 1;
+
+    if(chunk_index == 0 || p_slot->total != total ||
+       p_slot->received == all_chunks ||
+       TimeSub(now, p_slot->last_rx) > (int32)USER_ADV_REASSEMBLY_TIMEOUT)
+    {
+        p_slot->total = total;
+        p_slot->received = 0;
+        p_slot->length = 0;
+    }
+
+    p_slot->last_rx = now;
+
+    MemCopy(&p_slot->data[chunk_index * USER_ADV_CHUNK_LEN], &p_chunk[1],
+            length);
+    p_slot->received |= (1 << chunk_index);
+
+    if(chunk_index + 1 == total)
+    {
+        p_slot->length = chunk_index * USER_ADV_CHUNK_LEN + length;
+    }
+
+    if(p_slot->received == all_chunks)
+    {
+        digest = computeDigest(p_slot->data, p_slot->length);
+        p_forwarded = getForwarded(&p_slot->addr);
+
+        if(p_forwarded == NULL || digest != p_forwarded->digest)
+        {
+            /* Keep the report for the next copy if no client takes it */
+            if(MeshControlNotifyUserAdvReport(&p_slot->addr, p_slot->data,
+                                              p_slot->length))
+            {
+                if(p_forwarded == NULL)
+                {
+                    p_forwarded =
+                            &user_adv_forwarded[user_adv_forwarded_next];
+                    user_adv_forwarded_next = (user_adv_forwarded_next + 1) %
+                                              USER_ADV_FORWARDED;
+                    p_forwarded->addr = p_slot->addr;
+                    p_forwarded->in_use = TRUE;
+                }
+                p_forwarded->digest = digest;
+            }
+        }
+    }
+}
+
+#endif /* ENABLE_USER_ADV_REASSEMBLY */
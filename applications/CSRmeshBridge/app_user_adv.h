@@ -0,0 +1,61 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_user_adv.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the reassembly of reports sent in chunks in
+ *      user adverts
+ *
+ *****************************************************************************/
+
+#ifndef __APP_USER_ADV_H__
+#define __APP_USER_ADV_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+#include <bluetooth.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+#ifdef ENABLE_USER_ADV_REASSEMBLY
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Manufacturer specific AD header of a user advert chunk: AD type followed
+ * by the company identifier
+ */
+#define USER_ADV_AD_TYPE                (0xFF)
+#define USER_ADV_COMPANY_ID_LSB         (0x0A)
+#define USER_ADV_COMPANY_ID_MSB         (0x00)
+
+/* Largest number of report octets carried in one chunk */
+#define USER_ADV_CHUNK_LEN              (23)
+
+/* Largest number of chunks in a report that is reassembled */
+#define USER_ADV_MAX_CHUNKS             (8)
+
+/* Largest report that is reassembled */
+#define USER_ADV_MAX_REPORT_LEN         (USER_ADV_MAX_CHUNKS * \
+                                         USER_ADV_CHUNK_LEN)
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Discards all partly reassembled reports */
+extern void AppUserAdvInit(void);
+
+/* Adds a chunk received from a device to its report */
+extern void AppUserAdvHandleChunk(const BD_ADDR_T *p_addr,
+                                  const uint8 *p_chunk, uint16 length);
+
+#endif /* ENABLE_USER_ADV_REASSEMBLY */
+#endif /* __APP_USER_ADV_H__ */
@@ -44,6 +44,10 @@
 #include "csr_ota.h"
 #include "csr_ota_service.h"
 #include "gatt_service.h"
+#include "app_dup_filter.h"
+#include "app_trace.h"
+#include "app_neighbour.h"
+#include "app_user_adv.h"
 
 /*============================================================================*
  *  Public Data
@@ -267,6 +271,13 @@ void AppInit(sleep_state last_sleep_state)
     */
     GattInstallServerWriteLongReliable();
 
+#ifdef ENABLE_ATT_MTU_EXCHANGE
+    /* Install GATT Server support for the Exchange MTU procedure so that
+     * mesh messages can be transferred in a single ATT operation.
+     */
+    GattInstallServerExchangeMtu();
+#endif /* ENABLE_ATT_MTU_EXCHANGE */
+
 #ifdef USE_STATIC_RANDOM_ADDRESS
     /* Generate random address for the CSRmesh Device. */
     generateStaticRandomAddress(&g_bridgeapp_data.random_bd_addr);
@@ -285,6 +296,9 @@ void AppInit(sleep_state last_sleep_state)
      * so that every byte received will trigger the rx callback.
      */
     UartRead(1, 0);
+
+    /* Clear the received advert trace */
+    AppTraceInit();
 #endif /* DEBUG_ENABLE */
 
     /* Tell Security Manager module about the value it needs to initialize it's
@@ -294,6 +308,21 @@ void AppInit(sleep_state last_sleep_state)
 
     /* Intialise application data */
     AppDataInit();
+
+#ifdef ENABLE_DUPLICATE_FILTER
+    /* Clear the received advert duplicate cache */
+    AppDupFilterInit();
+#endif /* ENABLE_DUPLICATE_FILTER */
+
+#ifdef ENABLE_NEIGHBOUR_TABLE
+    /* Clear the neighbour table */
+    AppNeighbourInit();
+#endif /* ENABLE_NEIGHBOUR_TABLE */
+
+#ifdef ENABLE_USER_ADV_REASSEMBLY
+    /* Discard partly reassembled user advert reports */
+    AppUserAdvInit();
+#endif /* ENABLE_USER_ADV_REASSEMBLY */
     
     /* Initialise CSRmesh bridge application State */
     AppSetState(app_state_init);
@@ -574,6 +603,14 @@ bool AppProcessLmEvent(lm_event_code event_code,
             HandleSignalGattAccessInd((GATT_ACCESS_IND_T*)p_event_data);
         break;
 
+#ifdef ENABLE_ATT_MTU_EXCHANGE
+        case GATT_EXCHANGE_MTU_IND:
+            /* Client has started the Exchange MTU procedure */
+            HandleSignalGattExchangeMtuInd(
+                                    (GATT_EXCHANGE_MTU_IND_T*)p_event_data);
+        break;
+#endif /* ENABLE_ATT_MTU_EXCHANGE */
+
         case GATT_DISCONNECT_IND:
             /* Disconnect procedure triggered by remote host or due to
              * link loss is considered complete on reception of
@@ -40,8 +40,15 @@
 /*! \brief Bluetooth SIG Organization identifier for CSRmesh device appearance */
 #define APPEARANCE_ORG_BLUETOOTH_SIG   (0)
 
-/* Maximum number of timers */
-#define MAX_APP_TIMERS                 (1 + CSR_MESH_MAX_NO_TIMERS)
+/* Maximum number of timers: one for the application, one each for the MTL
+ * batch flush and inbound MTL queue drain and one more for the debug trace
+ * drain timer.
+ */
+#ifdef DEBUG_ENABLE
+#define MAX_APP_TIMERS                 (4 + CSR_MESH_MAX_NO_TIMERS)
+#else
+#define MAX_APP_TIMERS                 (3 + CSR_MESH_MAX_NO_TIMERS)
+#endif /* DEBUG_ENABLE */
 
 /* TGAP(conn_pause_peripheral) defined in Core Specification Addendum 3 Revision
  * 2. A Peripheral device should not perform a Connection Parameter Update proc-
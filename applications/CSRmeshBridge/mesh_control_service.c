@@ -19,6 +19,7 @@
 #include <gatt_prim.h>
 #include <mem.h>
 #include <buf_utils.h>
+#include <timer.h>
 
 /*============================================================================*
  *  Local Header Files
@@ -27,6 +28,8 @@
 #include "app_gatt_db.h"
 #include "app_gatt.h"
 #include "mesh_control_service.h"
+#include "mtl_framing.h"
+#include "app_neighbour.h"
 #include "csr_mesh_bridge.h"
 
 /*============================================================================*
@@ -34,6 +37,15 @@
  *============================================================================*/
 #include "csr_mesh.h"
 
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Size of the batch buffer. A batch is limited to one notification at the
+ * negotiated MTU. Each message in a batch is prefixed with a one octet
+ * length: |L|MTL msg|L|MTL msg|...
+ */
+#define MTL_BATCH_BUF_LEN               (ATT_MTU_MAX - 3)
+
 /*============================================================================*
  *  Private Data Types
  *============================================================================*/
@@ -45,13 +57,82 @@ typedef struct
     uint8 mesh_data[MESH_LONGEST_MSG_LEN];
 }MESH_MSG_T;
 
+/* Batched MTL notification state */
+typedef struct
+{
+    /* MTL_BATCH_CP value written by the client */
+    uint8               mode;
+
+    /* Client configuration for MTL_BATCH_CP characteristic */
+    gatt_client_config  ccd;
+
+    /* Connection on which the pending batch is to be notified */
+    uint16              ucid;
+
+    /* Pending batch and its length */
+    uint8               data[MTL_BATCH_BUF_LEN];
+    uint16              length;
+
+    /* Batch flush timer */
+    timer_id            flush_tid;
+}MTL_BATCH_T;
+
+/* Queue of messages written by the client. The slot after the last queued
+ * message is used to reassemble the message being written.
+ */
+typedef struct
+{
+    MESH_MSG_T          slot[MTL_RX_QUEUE_SIZE];
+
+    /* Index of the oldest queued message and number of queued messages */
+    uint16              head;
+    uint16              count;
+
+    /* Attempts made to pass the oldest message to the scheduler */
+    uint16              attempts;
+
+    /* Messages dropped because the queue was full or the scheduler did not
+     * accept them in MTL_RX_MAX_ATTEMPTS attempts
+     */
+    uint16              dropped;
+
+    /* Set when the first part of the message being written was dropped */
+    bool                discard;
+
+    /* Client configuration for MTL_RX_STATUS characteristic */
+    gatt_client_config  ccd;
+
+    /* Connection on which MTL_RX_STATUS is notified */
+    uint16              ucid;
+
+    /* Queue drain timer */
+    timer_id            drain_tid;
+}MTL_RX_QUEUE_T;
+
+/* Reassembled user advert report notification state */
+typedef struct
+{
+    /* Client configuration for USER_ADV_REPORT characteristic */
+    gatt_client_config  ccd;
+
+    /* Connection on which USER_ADV_REPORT is notified */
+    uint16              ucid;
+}USER_ADV_REPORT_T;
+
 /* Structure for the Lock Unlock service */
 typedef struct
 {
     /* Client configuration for Mesh Control characteristic */
     gatt_client_config  mtl_cp_ccd;
 
-    MESH_MSG_T mesh_data;
+    /* Largest ATT write or notification payload on this connection */
+    uint16              att_data_len;
+
+    MTL_RX_QUEUE_T rx_queue;
+
+    MTL_BATCH_T batch;
+
+    USER_ADV_REPORT_T user_adv;
 
 }MESH_SERVICE_DATA_T;
 
@@ -60,6 +141,311 @@ typedef struct
  *============================================================================*/
 MESH_SERVICE_DATA_T        g_mesh_svc_data;
 
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static void flushMtlBatch(void);
+static void mtlBatchFlushTimerHandler(timer_id tid);
+static bool isMtlBatchActive(void);
+static MESH_MSG_T *getMtlRxWriteSlot(void);
+static void readMtlRxStatus(uint8 *p_status);
+static void notifyMtlRxStatus(void);
+static void drainMtlRxQueue(void);
+static void mtlRxDrainTimerHandler(timer_id tid);
+static void notifyMtlSegment(uint16 ucid, mtl_segment segment, uint16 length,
+                             uint8 *p_data);
+static bool reassembleMtlSegment(MESH_MSG_T *p_msg, mtl_segment segment,
+                                 GATT_ACCESS_IND_T *p_ind);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      flushMtlBatch
+ *
+ *  DESCRIPTION
+ *      This function notifies the pending batch of MTL messages, if any, on
+ *      MTL_BATCH_CP.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void flushMtlBatch(void)
+{
+    TimerDelete(g_mesh_svc_data.batch.flush_tid);
+    g_mesh_svc_data.batch.flush_tid = TIMER_INVALID;
+
+    if(g_mesh_svc_data.batch.length)
+    {
+        GattCharValueNotification(g_mesh_svc_data.batch.ucid,
+                                  HANDLE_MTL_BATCH_CP,
+                                  g_mesh_svc_data.batch.length,
+                                  g_mesh_svc_data.batch.data);
+        g_mesh_svc_data.batch.length = 0;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      mtlBatchFlushTimerHandler
+ *
+ *  DESCRIPTION
+ *      This function handles the expiry of the batch flush timer.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void mtlBatchFlushTimerHandler(timer_id tid)
+{
+    if(tid == g_mesh_svc_data.batch.flush_tid)
+    {
+        g_mesh_svc_data.batch.flush_tid = TIMER_INVALID;
+        flushMtlBatch();
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      isMtlBatchActive
+ *
+ *  DESCRIPTION
+ *      This function checks whether the client has enabled batching and
+ *      notifications on MTL_BATCH_CP. Batching also needs an MTU larger
+ *      than the default ATT_MTU. At the default MTU a response plus its
+ *      length prefix takes most of the 20 octet payload, so two responses
+ *      never fit in one batch and each batch would only add the prefix and
+ *      the flush delay.
+ *
+ *  RETURNS
+ *      TRUE if MTL responses are to be batched.
+ *
+ *---------------------------------------------------------------------------*/
+static bool isMtlBatchActive(void)
+{
+    return (g_mesh_svc_data.batch.mode == MTL_BATCH_MODE_ON &&
+            g_mesh_svc_data.batch.ccd == gatt_client_config_notification &&
+            g_mesh_svc_data.att_data_len > ATT_WRITE_MAX_DATALEN);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      getMtlRxWriteSlot
+ *
+ *  DESCRIPTION
+ *      This function returns the slot in which the message being written by
+ *      the client is reassembled.
+ *
+ *  RETURNS
+ *      Pointer to the slot, or NULL if the queue is full.
+ *
+ *---------------------------------------------------------------------------*/
+static MESH_MSG_T *getMtlRxWriteSlot(void)
+{
+    MTL_RX_QUEUE_T *p_queue = &g_mesh_svc_data.rx_queue;
+
+    if(p_queue->count == MTL_RX_QUEUE_SIZE)
+    {
+        return NULL;
+    }
+
+    return &p_queue->slot[(p_queue->head + p_queue->count) % MTL_RX_QUEUE_SIZE];
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      readMtlRxStatus
+ *
+ *  DESCRIPTION
+ *      This function fills in the MTL_RX_STATUS value: number of free slots
+ *      followed by the number of dropped messages (little endian).
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void readMtlRxStatus(uint8 *p_status)
+{
+    MTL_RX_QUEUE_T *p_queue = &g_mesh_svc_data.rx_queue;
+
+    p_status[0] = MTL_RX_QUEUE_SIZE - p_queue->count;
+    p_status[1] = p_queue->dropped & 0xFF;
+    p_status[2] = p_queue->dropped >> 8;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      notifyMtlRxStatus
+ *
+ *  DESCRIPTION
+ *      This function notifies MTL_RX_STATUS if the client has enabled it.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void notifyMtlRxStatus(void)
+{
+    uint8 status[3];
+
+    if(g_mesh_svc_data.rx_queue.ucid != GATT_INVALID_UCID &&
+       g_mesh_svc_data.rx_queue.ccd == gatt_client_config_notification)
+    {
+        readMtlRxStatus(status);
+        GattCharValueNotification(g_mesh_svc_data.rx_queue.ucid,
+                                  HANDLE_MTL_RX_STATUS, sizeof(status),
+                                  status);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      drainMtlRxQueue
+ *
+ *  DESCRIPTION
+ *      This function passes the oldest queued message to the scheduler. If
+ *      the scheduler does not accept it, it is offered again on the next
+ *      drain, up to MTL_RX_MAX_ATTEMPTS times, after which it is dropped and
+ *      reported in MTL_RX_STATUS. The drain timer is restarted
+ *      while messages remain so that they are fed to the scheduler at the
+ *      rate its transmit queue accepts them.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void drainMtlRxQueue(void)
+{
+    MTL_RX_QUEUE_T *p_queue = &g_mesh_svc_data.rx_queue;
+    MESH_MSG_T *p_msg;
+    bool was_full = (p_queue->count == MTL_RX_QUEUE_SIZE);
+    bool sent = FALSE;
+
+    TimerDelete(p_queue->drain_tid);
+    p_queue->drain_tid = TIMER_INVALID;
+
+    if(p_queue->count == 0)
+    {
+        return;
+    }
+
+    p_msg = &p_queue->slot[p_queue->head];
+
+    /* Send the MTL data as it is on the mesh */
+    DEBUG_STR("Send GATT Msg\r\n");
+
+    p_queue->attempts++;
+    if(CSRSchedHandleIncomingData(CSR_SCHED_INCOMING_GATT_MESH_DATA_EVENT,
+                                  p_msg->mesh_data, p_msg->length, 0x00)
+                                                == CSR_MESH_RESULT_SUCCESS)
+    {
+        sent = TRUE;
+    }
+
+    if(sent || p_queue->attempts >= MTL_RX_MAX_ATTEMPTS)
+    {
+        /* Release the slot */
+        p_msg->length = 0;
+        p_queue->head = (p_queue->head + 1) % MTL_RX_QUEUE_SIZE;
+        p_queue->count--;
+        p_queue->attempts = 0;
+
+        if(!sent)
+        {
+            /* Given up on the message. Count it with the overflow drops. */
+            p_queue->dropped++;
+        }
+
+        if(was_full || !sent)
+        {
+            /* Tell the client there is room again or that a message was
+             * dropped
+             */
+            notifyMtlRxStatus();
+        }
+    }
+
+    if(p_queue->count)
+    {
+        p_queue->drain_tid = TimerCreate(MTL_RX_DRAIN_INTERVAL, TRUE,
+                                         mtlRxDrainTimerHandler);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      mtlRxDrainTimerHandler
+ *
+ *  DESCRIPTION
+ *      This function handles the expiry of the inbound queue drain timer.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void mtlRxDrainTimerHandler(timer_id tid)
+{
+    if(tid == g_mesh_svc_data.rx_queue.drain_tid)
+    {
+        g_mesh_svc_data.rx_queue.drain_tid = TIMER_INVALID;
+        drainMtlRxQueue();
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      notifyMtlSegment
+ *
+ *  DESCRIPTION
+ *      This function is the transport used to frame responses to the client.
+ *      It notifies a segment of an MTL message on the characteristic that
+ *      carries it.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void notifyMtlSegment(uint16 ucid, mtl_segment segment, uint16 length,
+                             uint8 *p_data)
+{
+    GattCharValueNotification(ucid,
+                              (segment == mtl_segment_continuation) ?
+                                HANDLE_MTL_CONTINUATION_CP :
+                                HANDLE_MTL_COMPLETE_CP,
+                              length, p_data);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      reassembleMtlSegment
+ *
+ *  DESCRIPTION
+ *      This function adds a segment written by the client to the message
+ *      reassembled in the slot.
+ *
+ *  RETURNS
+ *      TRUE if the slot now holds a complete message.
+ *
+ *---------------------------------------------------------------------------*/
+static bool reassembleMtlSegment(MESH_MSG_T *p_msg, mtl_segment segment,
+                                 GATT_ACCESS_IND_T *p_ind)
+{
+    MTL_REASSEMBLY_T rx;
+    bool complete;
+
+    rx.p_data = p_msg->mesh_data;
+    rx.size = MESH_LONGEST_MSG_LEN;
+    rx.length = p_msg->length;
+
+    complete = MtlFramingReassemble(&rx, segment, p_ind->offset,
+                                    p_ind->value, p_ind->size_value);
+    p_msg->length = rx.length;
+
+    return complete;
+}
+
 /*============================================================================*
  *  Public Function Implementations
  *============================================================================*/
@@ -81,6 +467,33 @@ extern void MeshControlServiceDataInit(void)
      * descriptor value to none.
      */
     g_mesh_svc_data.mtl_cp_ccd = gatt_client_config_none;
+
+    /* Use the default MTU until the client exchanges a larger one */
+    g_mesh_svc_data.att_data_len = ATT_WRITE_MAX_DATALEN;
+
+    /* Old clients do not know about batching, so it stays off until the
+     * client enables it.
+     */
+    TimerDelete(g_mesh_svc_data.batch.flush_tid);
+    g_mesh_svc_data.batch.flush_tid = TIMER_INVALID;
+    g_mesh_svc_data.batch.mode = MTL_BATCH_MODE_OFF;
+    g_mesh_svc_data.batch.ccd = gatt_client_config_none;
+    g_mesh_svc_data.batch.length = 0;
+
+    /* Discard messages queued on the previous connection */
+    TimerDelete(g_mesh_svc_data.rx_queue.drain_tid);
+    g_mesh_svc_data.rx_queue.drain_tid = TIMER_INVALID;
+    g_mesh_svc_data.rx_queue.head = 0;
+    g_mesh_svc_data.rx_queue.count = 0;
+    g_mesh_svc_data.rx_queue.attempts = 0;
+    g_mesh_svc_data.rx_queue.dropped = 0;
+    g_mesh_svc_data.rx_queue.discard = FALSE;
+    g_mesh_svc_data.rx_queue.slot[0].length = 0;
+    g_mesh_svc_data.rx_queue.ccd = gatt_client_config_none;
+    g_mesh_svc_data.rx_queue.ucid = GATT_INVALID_UCID;
+
+    g_mesh_svc_data.user_adv.ccd = gatt_client_config_none;
+    g_mesh_svc_data.user_adv.ucid = GATT_INVALID_UCID;
 }
 
 /*----------------------------------------------------------------------------*
@@ -102,7 +515,7 @@ extern void MeshControlHandleAccessRead(GATT_ACCESS_IND_T *p_ind)
     uint8  *p_value = NULL;
     sys_status rc = sys_status_success;
     CSR_MESH_UUID_T devUUID;
-    uint8 val[16];
+    uint8 val[20];
 
     switch(p_ind->handle)
     {
@@ -133,6 +546,59 @@ extern void MeshControlHandleAccessRead(GATT_ACCESS_IND_T *p_ind)
             p_value = val;
             length = 2;
         }
+        break;
+
+        case HANDLE_MTL_BATCH_CP:
+        {
+            p_value = val;
+            val[0] = g_mesh_svc_data.batch.mode;
+            length = 1;
+        }
+        break;
+
+        case HANDLE_MTL_BATCH_CLIENT_CONFIG:
+        {
+            p_value = val;
+            BufWriteUint16(&p_value, g_mesh_svc_data.batch.ccd);
+            p_value = val;
+            length = 2;
+        }
+        break;
+
+        case HANDLE_MTL_RX_STATUS:
+        {
+            p_value = val;
+            readMtlRxStatus(val);
+            length = 3;
+        }
+        break;
+
+        case HANDLE_MTL_RX_STATUS_CLIENT_CONFIG:
+        {
+            p_value = val;
+            BufWriteUint16(&p_value, g_mesh_svc_data.rx_queue.ccd);
+            p_value = val;
+            length = 2;
+        }
+        break;
+
+        case HANDLE_USER_ADV_REPORT_CLIENT_CONFIG:
+        {
+            p_value = val;
+            BufWriteUint16(&p_value, g_mesh_svc_data.user_adv.ccd);
+            p_value = val;
+            length = 2;
+        }
+        break;
+
+#ifdef ENABLE_NEIGHBOUR_TABLE
+        case HANDLE_NEIGHBOUR_TABLE:
+        {
+            p_value = val;
+            length = AppNeighbourReadRecord(val);
+        }
+        break;
+#endif /* ENABLE_NEIGHBOUR_TABLE */
 
         default:
             /* No more IRQ characteristics */
@@ -160,32 +626,119 @@ extern void MeshControlHandleAccessRead(GATT_ACCESS_IND_T *p_ind)
  *---------------------------------------------------------------------------*/
 extern void MeshControlNotifyResponse(uint16 ucid, uint8 *mtl_msg, uint8 length)
 {
+    uint16 data_len = g_mesh_svc_data.att_data_len;
+
     /* Update the connected host if notifications are configured */
     if((ucid != GATT_INVALID_UCID) &&
        (g_mesh_svc_data.mtl_cp_ccd == gatt_client_config_notification))
     {
-        /* If message is less than or equal to ATT_WRITE_MAX_DATA_LEN,
-         * notify it using MTL_COMPLETE_CP. If it is greater than
-         * ATT_WRITE_MAX_DATA_LEN notify first ATT_WRITE_MAX_DATA_LEN bytes
-         * with MTL_CONTINUATION_CP and rest with MTL_COMPLETE_CP.
+        if(isMtlBatchActive() && length < g_mesh_svc_data.att_data_len)
+        {
+            /* Notify the pending batch first if the message does not fit */
+            if(g_mesh_svc_data.batch.length + 1 + length >
+                                                g_mesh_svc_data.att_data_len)
+            {
+                flushMtlBatch();
+            }
+
+            /* Append the message with its length prefix */
+            g_mesh_svc_data.batch.ucid = ucid;
+            g_mesh_svc_data.batch.data[g_mesh_svc_data.batch.length++] =
+                                                                        length;
+            MemCopy(&g_mesh_svc_data.batch.data[g_mesh_svc_data.batch.length],
+                    mtl_msg, length);
+            g_mesh_svc_data.batch.length += length;
+
+            if(g_mesh_svc_data.batch.length == g_mesh_svc_data.att_data_len)
+            {
+                flushMtlBatch();
+            }
+            else if(g_mesh_svc_data.batch.flush_tid == TIMER_INVALID)
+            {
+                g_mesh_svc_data.batch.flush_tid =
+                                        TimerCreate(MTL_BATCH_FLUSH_TIME, TRUE,
+                                                    mtlBatchFlushTimerHandler);
+            }
+            return;
+        }
+
+        /* Keep the notifications in order with any pending batch */
+        flushMtlBatch();
+
+        /* Split the message to fit the notifications at the negotiated
+         * MTU
          */
-        if (length <= ATT_WRITE_MAX_DATALEN)
+        MtlFramingSegment(ucid, mtl_msg, length, data_len, notifyMtlSegment);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MeshControlNotifyUserAdvReport
+ *
+ *  DESCRIPTION
+ *      This function notifies a report reassembled from user adverts on the
+ *      USER_ADV_REPORT characteristic. The report is split into as many
+ *      notifications as the negotiated MTU needs.
+ *
+ *  RETURNS
+ *      TRUE if the report was notified.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool MeshControlNotifyUserAdvReport(const BD_ADDR_T *p_addr,
+                                           const uint8 *p_data,
+                                           uint16 length)
+{
+    /* Kept off the stack, which is small on this target */
+    static uint8 segment[MTL_BATCH_BUF_LEN];
+    uint16 seg_index = 0;
+    uint16 seg_len;
+    uint16 copy_len;
+
+    if(g_mesh_svc_data.user_adv.ucid == GATT_INVALID_UCID ||
+       g_mesh_svc_data.user_adv.ccd != gatt_client_config_notification)
+    {
+        return FALSE;
+    }
+
+    /* The first segment carries the address of the light and the length */
+    segment[1] = p_addr->lap & 0xFF;
+    segment[2] = (p_addr->lap >> 8) & 0xFF;
+    segment[3] = (p_addr->lap >> 16) & 0xFF;
+    segment[4] = p_addr->uap & 0xFF;
+    segment[5] = p_addr->nap & 0xFF;
+    segment[6] = p_addr->nap >> 8;
+    segment[7] = length & 0xFF;
+    seg_len = 8;
+
+    do
+    {
+        copy_len = g_mesh_svc_data.att_data_len - seg_len;
+        if(copy_len > length)
         {
-            GattCharValueNotification(ucid, HANDLE_MTL_COMPLETE_CP,
-                                      length, mtl_msg);
+            copy_len = length;
         }
-        else
+
+        MemCopy(&segment[seg_len], p_data, copy_len);
+        p_data += copy_len;
+        length -= copy_len;
+        seg_len += copy_len;
+
+        segment[0] = seg_index & USER_ADV_REPORT_SEGMENT_MASK;
+        if(length == 0)
         {
-            /* Send first ATT_WRITE_MAX_DATALEN with MTL_CONTINUATION_CP */
-            GattCharValueNotification(ucid, HANDLE_MTL_CONTINUATION_CP,
-                                      ATT_WRITE_MAX_DATALEN, mtl_msg);
-
-            /* Send rest of the message with MTL_COMPLETE_CP */
-            GattCharValueNotification(ucid, HANDLE_MTL_COMPLETE_CP,
-                                      length - ATT_WRITE_MAX_DATALEN,
-                                      &mtl_msg[ATT_WRITE_MAX_DATALEN]);
+            segment[0] |= USER_ADV_REPORT_LAST_SEGMENT;
         }
+
+        GattCharValueNotification(g_mesh_svc_data.user_adv.ucid,
+                                  HANDLE_USER_ADV_REPORT, seg_len, segment);
+
+        seg_index++;
+        seg_len = 1;
     }
+    while(length);
+
+    return TRUE;
 }
 
 /*----------------------------------------------------------------------------*
@@ -206,6 +759,7 @@ extern void MeshControlHandleAccessWrite(GATT_ACCESS_IND_T *p_ind)
     sys_status rc = sys_status_success;
     uint8  *pValue;
     bool csr_mesh_send_msg = FALSE;
+    MESH_MSG_T *p_msg;
 
     switch(p_ind->handle)
     {
@@ -242,42 +796,142 @@ extern void MeshControlHandleAccessWrite(GATT_ACCESS_IND_T *p_ind)
         case HANDLE_MTL_CONTINUATION_CP:
         {
             pValue = p_ind->value;
+            p_msg = getMtlRxWriteSlot();
+            g_mesh_svc_data.rx_queue.ucid = p_ind->cid;
 
-            /* Reset the length of the mesh message */
-            g_mesh_svc_data.mesh_data.length = 0;
-
-            if(p_ind->size_value)
+            if(p_msg == NULL)
             {
-                MemCopy(g_mesh_svc_data.mesh_data.mesh_data + p_ind->offset,
-                        p_ind->value, p_ind->size_value);
-                g_mesh_svc_data.mesh_data.length = p_ind->size_value;
+                /* No free slot. Write commands cannot be refused, so drop
+                 * the message and report it.
+                 */
+                g_mesh_svc_data.rx_queue.dropped++;
+                g_mesh_svc_data.rx_queue.discard = TRUE;
+                notifyMtlRxStatus();
+                break;
             }
+
+            g_mesh_svc_data.rx_queue.discard = FALSE;
+            reassembleMtlSegment(p_msg, mtl_segment_continuation, p_ind);
         }
         break;
 
         case HANDLE_MTL_COMPLETE_CP:
         {
             pValue = p_ind->value;
+            p_msg = getMtlRxWriteSlot();
+            g_mesh_svc_data.rx_queue.ucid = p_ind->cid;
 
-            if(p_ind->size_value && ((p_ind->size_value + 
-                     g_mesh_svc_data.mesh_data.length) <= MESH_LONGEST_MSG_LEN))
+            if(p_msg == NULL || g_mesh_svc_data.rx_queue.discard)
             {
-                MemCopy(g_mesh_svc_data.mesh_data.mesh_data + \
-                        g_mesh_svc_data.mesh_data.length,
-                        p_ind->value, p_ind->size_value);
-                g_mesh_svc_data.mesh_data.length += p_ind->size_value;
+                /* Drop the message, or the rest of one already dropped */
+                if(!g_mesh_svc_data.rx_queue.discard)
+                {
+                    g_mesh_svc_data.rx_queue.dropped++;
+                    notifyMtlRxStatus();
+                }
+                g_mesh_svc_data.rx_queue.discard = FALSE;
+                break;
+            }
 
-                /* Send message to CSRmesh Library. */
+            if(reassembleMtlSegment(p_msg, mtl_segment_complete, p_ind))
+            {
+                /* Queue the message for the CSRmesh Library. */
+                g_mesh_svc_data.rx_queue.count++;
                 csr_mesh_send_msg = TRUE;
+
+                /* Start the next message in the following slot */
+                p_msg = getMtlRxWriteSlot();
+                if(p_msg != NULL)
+                {
+                    p_msg->length = 0;
+                }
+                else
+                {
+                    /* Tell the client to hold off */
+                    notifyMtlRxStatus();
+                }
+            }
+
+        }
+        break;
+
+        case HANDLE_MTL_BATCH_CP:
+        {
+            pValue = p_ind->value;
+
+            /* Batching is only accepted at an MTU that can carry a batch,
+             * see isMtlBatchActive
+             */
+            if(p_ind->size_value == 1 &&
+               (*pValue == MTL_BATCH_MODE_OFF ||
+                (*pValue == MTL_BATCH_MODE_ON &&
+                 g_mesh_svc_data.att_data_len > ATT_WRITE_MAX_DATALEN)))
+            {
+                /* Notify anything pending before switching mode */
+                flushMtlBatch();
+                g_mesh_svc_data.batch.mode = BufReadUint8(&pValue);
             }
             else
             {
-                g_mesh_svc_data.mesh_data.length = 0;
+                rc = gatt_status_att_val_oor;
+            }
+        }
+        break;
+
+        case HANDLE_MTL_BATCH_CLIENT_CONFIG:
+        {
+            pValue = p_ind->value;
+            g_mesh_svc_data.batch.ccd = BufReadUint16(&pValue);
+
+            /* Reset the reserved bits in any case */
+            g_mesh_svc_data.batch.ccd &= ~gatt_client_config_reserved;
+
+            if(g_mesh_svc_data.batch.ccd != gatt_client_config_notification)
+            {
+                /* Batched notifications can no longer be sent */
+                TimerDelete(g_mesh_svc_data.batch.flush_tid);
+                g_mesh_svc_data.batch.flush_tid = TIMER_INVALID;
+                g_mesh_svc_data.batch.length = 0;
             }
+        }
+        break;
+
+        case HANDLE_MTL_RX_STATUS_CLIENT_CONFIG:
+        {
+            pValue = p_ind->value;
+            g_mesh_svc_data.rx_queue.ccd = BufReadUint16(&pValue);
 
+            /* Reset the reserved bits in any case */
+            g_mesh_svc_data.rx_queue.ccd &= ~gatt_client_config_reserved;
+            g_mesh_svc_data.rx_queue.ucid = p_ind->cid;
         }
         break;
 
+        case HANDLE_USER_ADV_REPORT_CLIENT_CONFIG:
+        {
+            pValue = p_ind->value;
+            g_mesh_svc_data.user_adv.ccd = BufReadUint16(&pValue);
+
+            /* Reset the reserved bits in any case */
+            g_mesh_svc_data.user_adv.ccd &= ~gatt_client_config_reserved;
+            g_mesh_svc_data.user_adv.ucid = p_ind->cid;
+        }
+        break;
+
+#ifdef ENABLE_NEIGHBOUR_TABLE
+        case HANDLE_NEIGHBOUR_TABLE:
+        {
+            pValue = p_ind->value;
+
+            if(p_ind->size_value != 1 ||
+               !AppNeighbourSetCursor(BufReadUint8(&pValue)))
+            {
+                rc = gatt_status_att_val_oor;
+            }
+        }
+        break;
+#endif /* ENABLE_NEIGHBOUR_TABLE */
+
         case HANDLE_MTL_TTL:
         {
             uint8 ttl = 0x00;
@@ -296,25 +950,42 @@ extern void MeshControlHandleAccessWrite(GATT_ACCESS_IND_T *p_ind)
 
     GattAccessRsp(p_ind->cid, p_ind->handle, rc, 0, NULL);
 
-    if(csr_mesh_send_msg)
+    /* Pass the message straight on if nothing is waiting for the drain
+     * timer. Otherwise it is sent after the messages queued before it.
+     */
+    if(csr_mesh_send_msg &&
+       g_mesh_svc_data.rx_queue.drain_tid == TIMER_INVALID)
     {
-        /* Send the MTL data as it is on the mesh */
-        DEBUG_STR("Send GATT Msg\r\n");
-
-        /* Update Bearer Event Data structure with incoming Mesh Data */
-        if(g_mesh_svc_data.mesh_data.length 
-                                <= sizeof(g_mesh_svc_data.mesh_data.mesh_data))
-        {
-
-            CSRSchedHandleIncomingData(CSR_SCHED_INCOMING_GATT_MESH_DATA_EVENT,
-                                       g_mesh_svc_data.mesh_data.mesh_data,
-                                       g_mesh_svc_data.mesh_data.length,
-                                       0x00);
+        drainMtlRxQueue();
+    }
+}
 
-            /* Reset the length of the mesh message */
-            g_mesh_svc_data.mesh_data.length = 0;
-        }
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MeshControlSetAttMtu
+ *
+ *  DESCRIPTION
+ *      This function sets the ATT MTU negotiated with the client. Responses
+ *      are split into MTL_CONTINUATION_CP and MTL_COMPLETE_CP notifications
+ *      only when they do not fit in one notification at this MTU. Writes
+ *      from the client are reassembled whatever their size.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void MeshControlSetAttMtu(uint16 mtu)
+{
+    if(mtu < ATT_MTU)
+    {
+        mtu = ATT_MTU;
     }
+    else if(mtu > ATT_MTU_MAX)
+    {
+        mtu = ATT_MTU_MAX;
+    }
+
+    g_mesh_svc_data.att_data_len = mtu - 3;
 }
 
 /*----------------------------------------------------------------------------*
@@ -19,7 +19,9 @@
  *============================================================================*/
 
 #include <types.h>
+#include <bluetooth.h>
 #include <bt_event_types.h>
+#include <timer.h>
 
 /*============================================================================*
  *  Public Definitions
@@ -27,6 +29,30 @@
 
 #define MESH_LONGEST_MSG_LEN                              (27)
 
+/* MTL_BATCH_CP values */
+#define MTL_BATCH_MODE_OFF                                (0x00)
+#define MTL_BATCH_MODE_ON                                 (0x01)
+
+/* Time after the first queued message at which a partly filled batch is
+ * notified
+ */
+#define MTL_BATCH_FLUSH_TIME                              (20 * MILLISECOND)
+
+/* Number of complete messages from the client that can wait for the
+ * scheduler
+ */
+#define MTL_RX_QUEUE_SIZE                                 (4)
+
+/* Interval at which queued messages are passed to the scheduler */
+#define MTL_RX_DRAIN_INTERVAL                             (50 * MILLISECOND)
+
+/* Number of times the scheduler is offered a message before it is dropped */
+#define MTL_RX_MAX_ATTEMPTS                               (3)
+
+/* USER_ADV_REPORT segment header: segment index and last segment flag */
+#define USER_ADV_REPORT_SEGMENT_MASK                      (0x7F)
+#define USER_ADV_REPORT_LAST_SEGMENT                      (0x80)
+
 /*============================================================================*
  *  Public Function Prototypes
  *============================================================================*/
@@ -44,6 +70,9 @@ extern void MeshControlHandleAccessRead(GATT_ACCESS_IND_T *p_ind);
 extern void MeshControlHandleAccessWrite(GATT_ACCESS_IND_T *p_ind);
 
 
+/* This function sets the ATT MTU negotiated with the client */
+extern void MeshControlSetAttMtu(uint16 mtu);
+
 /* This function is used to check if the handle belongs to the Mesh Control
  * service
  */
@@ -54,6 +83,13 @@ extern bool MeshControlCheckHandleRange(uint16 handle);
  */
 extern void MeshControlNotifyResponse(uint16 ucid, uint8 *mtl_msg, uint8 length);
 
+/* This function notifies a report reassembled from user adverts to the
+ * bridge client
+ */
+extern bool MeshControlNotifyUserAdvReport(const BD_ADDR_T *p_addr,
+                                           const uint8 *p_data,
+                                           uint16 length);
+
 
 #endif /* __MESH_CONTROL_SERVICE_H__ */
 
@@ -48,5 +48,17 @@
 /* Mesh Appearance characteristic UUID */
 #define MESH_APPEARANCE_UUID                  0xC4EDC0009DAF11E3800600025B000B00
 
+/* Batched MTL notification characteristic UUID */
+#define MTL_BATCH_CP_UUID                     0xC4EDC0009DAF11E3800700025B000B00
+
+/* Inbound MTL queue status characteristic UUID */
+#define MTL_RX_STATUS_UUID                    0xC4EDC0009DAF11E3800800025B000B00
+
+/* Neighbour table characteristic UUID */
+#define NEIGHBOUR_TABLE_UUID                  0xC4EDC0009DAF11E3800900025B000B00
+
+/* Reassembled user advert report characteristic UUID */
+#define USER_ADV_REPORT_UUID                  0xC4EDC0009DAF11E3800A00025B000B00
+
 #endif /* __MESH_CONTROL_SERIVCE_UUIDS_H__ */
 
@@ -0,0 +1,110 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      mtl_framing.c
+ *
+ *  DESCRIPTION
+ *      This file implements the framing of MTL messages over the Mesh
+ *      Control Service. A message that does not fit in one ATT payload is
+ *      sent as its first part on MTL_CONTINUATION_CP followed by the rest on
+ *      MTL_COMPLETE_CP. A message that fits is sent on MTL_COMPLETE_CP alone.
+ *
+ *      The framing does not use GATT directly, the transport is passed in by
+ *      the caller. The host side of the protocol, for gateways talking to
+ *      the bridge, is gateway/mtl_gateway.c.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <mem.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "mtl_framing.h"
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MtlFramingSegment
+ *
+ *  DESCRIPTION
+ *      This function sends an MTL message using the transport function
+ *      passed. The message is sent in one MTL_COMPLETE_CP segment if it fits
+ *      in data_len octets. Otherwise the first data_len octets are sent in an
+ *      MTL_CONTINUATION_CP segment and the rest in an MTL_COMPLETE_CP
+ *      segment, so the message must not be longer than twice data_len.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void MtlFramingSegment(uint16 ucid, uint8 *p_msg, uint16 length,
+                              uint16 data_len, MTL_SEGMENT_SEND_T send)
+{
+    if(length <= data_len)
+    {
+        send(ucid, mtl_segment_complete, length, p_msg);
+    }
+    else
+    {
+        /* Send first data_len octets with MTL_CONTINUATION_CP */
+        send(ucid, mtl_segment_continuation, data_len, p_msg);
+
+        /* Send rest of the message with MTL_COMPLETE_CP */
+        send(ucid, mtl_segment_complete, length - data_len, &p_msg[data_len]);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MtlFramingReassemble
+ *
+ *  DESCRIPTION
+ *      This function adds a received segment to the message being
+ *      reassembled. An MTL_CONTINUATION_CP segment starts a new message and
+ *      is stored at the ATT offset it was written at. An MTL_COMPLETE_CP
+ *      segment is appended to the message. Segments that do not fit in the
+ *      buffer discard the message.
+ *
+ *  RETURNS
+ *      TRUE if a complete message is now held in the buffer.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool MtlFramingReassemble(MTL_REASSEMBLY_T *p_rx, mtl_segment segment,
+                                 uint16 offset, const uint8 *p_value,
+                                 uint16 size)
+{
+    if(segment == mtl_segment_continuation)
+    {
+        /* Reset the length of the mesh message */
+        p_rx->length = 0;
+
+        if(size && (offset + size) <= p_rx->size)
+        {
+            MemCopy(p_rx->p_data + offset, p_value, size);
+            p_rx->length = offset + size;
+        }
+
+        return FALSE;
+    }
+
+    if(size && (p_rx->length + size) <= p_rx->size)
+    {
+        MemCopy(p_rx->p_data + p_rx->length, p_value, size);
+        p_rx->length += size;
+
+        return TRUE;
+    }
+
+    p_rx->length = 0;
+
+    return FALSE;
+}
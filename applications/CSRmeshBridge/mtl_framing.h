@@ -0,0 +1,61 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      mtl_framing.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the framing of MTL messages carried over the
+ *      MTL_CONTINUATION_CP and MTL_COMPLETE_CP characteristics
+ *
+ *****************************************************************************/
+
+#ifndef __MTL_FRAMING_H__
+#define __MTL_FRAMING_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+
+/*============================================================================*
+ *  Public Data Types
+ *============================================================================*/
+/* Part of an MTL message carried by one ATT write or notification */
+typedef enum
+{
+    mtl_segment_continuation,   /* Carried on MTL_CONTINUATION_CP */
+    mtl_segment_complete        /* Carried on MTL_COMPLETE_CP */
+}mtl_segment;
+
+/* Transport function used to send one segment of an MTL message. On the
+ * bridge it notifies the matching characteristic.
+ */
+typedef void (*MTL_SEGMENT_SEND_T)(uint16 ucid, mtl_segment segment,
+                                   uint16 length, uint8 *p_data);
+
+/* Reassembly state of a message received in segments */
+typedef struct
+{
+    uint8  *p_data;     /* Buffer the message is reassembled in */
+    uint16 size;        /* Size of the buffer */
+    uint16 length;      /* Length of the message reassembled so far */
+}MTL_REASSEMBLY_T;
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Splits an MTL message into segments of at most data_len octets and passes
+ * them to the transport
+ */
+extern void MtlFramingSegment(uint16 ucid, uint8 *p_msg, uint16 length,
+                              uint16 data_len, MTL_SEGMENT_SEND_T send);
+
+/* Adds a received segment to the message being reassembled */
+extern bool MtlFramingReassemble(MTL_REASSEMBLY_T *p_rx, mtl_segment segment,
+                                 uint16 offset, const uint8 *p_value,
+                                 uint16 size);
+
+#endif /* __MTL_FRAMING_H__ */
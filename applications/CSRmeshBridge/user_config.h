@@ -39,5 +39,26 @@
 
 /* Enable application debug logging on UART */
 #define DEBUG_ENABLE
+
+/* Enable the Exchange MTU procedure with an MTU of up to ATT_MTU_MAX. Only
+ * enable this once GattInstallServerExchangeMtu, GattExchangeMtuRsp and the
+ * ATT_MTU_MAX MTU are confirmed to be supported by the CSR101x firmware the
+ * application is built for. Without it the default 23 octet MTU is used, and
+ * MTL_BATCH_CP rejects batching as no batch fits in one notification.
+ */
+/* #define ENABLE_ATT_MTU_EXCHANGE */
+
+/* Enable dropping of repeated mesh adverts before they reach the scheduler */
+#define ENABLE_DUPLICATE_FILTER
+
+/* Enable the table of neighbours heard in mesh adverts, read over the
+ * NEIGHBOUR_TABLE characteristic
+ */
+#define ENABLE_NEIGHBOUR_TABLE
+
+/* Enable reassembly of the reports lights send in chunks in user adverts,
+ * notified on the USER_ADV_REPORT characteristic
+ */
+#define ENABLE_USER_ADV_REASSEMBLY
 #endif /* __USER_CONFIG_H__ */
 
@@ -0,0 +1,382 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_ack_table.c
+ *
+ *  DESCRIPTION
+ *      This file keeps the table of sensors to which sensor value
+ *      acknowledgements are sent. Each device has its own transaction id and
+ *      number of acknowledgements still to be sent, and leaves the table once
+ *      they have all been sent.
+ *
+ *      Devices are looked up through a hash of the device id. When the table
+ *      is full the device added or refreshed least recently is replaced, as
+ *      it has already been sent the most acknowledgements.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <mem.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_ack_table.h"
+
+#ifdef ENABLE_ACK_MODE
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Number of hash buckets. Must be a power of 2. */
+#define ACK_HASH_SIZE                   (8)
+
+/* Marks the end of a bucket chain, of the free list or of the recent list */
+#define ACK_NONE                        (0xFFFF)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint16 dev_id;              /* Device to acknowledge */
+    uint16 tid;                 /* Transaction id of the last value written */
+    uint16 retransmit_count;    /* Acknowledgements still to be sent */
+    uint16 hash_next;           /* Next entry in the bucket or free list */
+    uint16 lru_prev;            /* More recently added entry */
+    uint16 lru_next;            /* Less recently added entry */
+}ACK_ENTRY_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Acknowledgement table */
+static ACK_ENTRY_T ack_entries[ACK_TABLE_SIZE];
+
+/* First entry in each hash bucket */
+static uint16 ack_hash[ACK_HASH_SIZE];
+
+/* First unused entry */
+static uint16 ack_free;
+
+/* Most and least recently added entries */
+static uint16 ack_lru_head;
+static uint16 ack_lru_tail;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static uint16 hashDevice(uint16 dev_id);
+static void unlinkRecent(uint16 entry);
+static void linkRecent(uint16 entry);
+static void unlinkHash(uint16 entry);
+static void freeEntry(uint16 entry);
+static uint16 allocateEntry(uint16 dev_id);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      hashDevice
+ *
+ *  DESCRIPTION
+ *      Computes the hash bucket of a device id.
+ *
+ *  RETURNS
+ *      Hash bucket index.
+ *
+ *---------------------------------------------------------------------------*/
+static uint16 hashDevice(uint16 dev_id)
+{
+    return (dev_id ^ (dev_id >> 3) ^ (dev_id >> 8)) & (ACK_HASH_SIZE - 1);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      unlinkRecent
+ *
+ *  DESCRIPTION
+ *      Removes an entry from the recently added list.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void unlinkRecent(uint16 entry)
+{
+    ACK_ENTRY_T *p_entry = &ack_entries[entry];
+
+    if(p_entry->lru_prev != ACK_NONE)
+    {
+        ack_entries[p_entry->lru_prev].lru_next = p_entry->lru_next;
+    }
+    else
+    {
+        ack_lru_head = p_entry->lru_next;
+    }
+
+    if(p_entry->lru_next != ACK_NONE)
+    {
+        ack_entries[p_entry->lru_next].lru_prev = p_entry->lru_prev;
+    }
+    else
+    {
+        ack_lru_tail = p_entry->lru_prev;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      linkRecent
+ *
+ *  DESCRIPTION
+ *      Puts an entry at the head of the recently added list.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void linkRecent(uint16 entry)
+{
+    ack_entries[entry].lru_prev = ACK_NONE;
+    ack_entries[entry].lru_next = ack_lru_head;
+
+    if(ack_lru_head != ACK_NONE)
+    {
+        ack_entries[ack_lru_head].lru_prev = entry;
+    }
+    else
+    {
+        ack_lru_tail = entry;
+    }
+
+    ack_lru_head = entry;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      unlinkHash
+ *
+ *  DESCRIPTION
+ *      Removes an entry from its hash bucket.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void unlinkHash(uint16 entry)
+{
+    uint16 *p_link = &ack_hash[hashDevice(ack_entries[entry].dev_id)];
+
+    while(*p_link != ACK_NONE)
+    {
+        if(*p_link == entry)
+        {
+            *p_link = ack_entries[entry].hash_next;
+            return;
+        }
+        p_link = &ack_entries[*p_link].hash_next;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      freeEntry
+ *
+ *  DESCRIPTION
+ *      Removes an entry from the table and returns it to the free list.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void freeEntry(uint16 entry)
+{
+    unlinkRecent(entry);
+    unlinkHash(entry);
+
+    ack_entries[entry].hash_next = ack_free;
+    ack_free = entry;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      allocateEntry
+ *
+ *  DESCRIPTION
+ *      Takes an unused entry, or the least recently added one if the table
+ *      is full, for a new device and adds it to its hash bucket.
+ *
+ *  RETURNS
+ *      Index of the entry.
+ *
+ *---------------------------------------------------------------------------*/
+static uint16 allocateEntry(uint16 dev_id)
+{
+    uint16 entry;
+    uint16 bucket;
+
+    if(ack_free == ACK_NONE)
+    {
+        /* Replace the device added least recently */
+        freeEntry(ack_lru_tail);
+    }
+
+    entry = ack_free;
+    ack_free = ack_entries[entry].hash_next;
+
+    MemSet(&ack_entries[entry], 0, sizeof(ACK_ENTRY_T));
+    ack_entries[entry].dev_id = dev_id;
+
+    bucket = hashDevice(dev_id);
+    ack_entries[entry].hash_next = ack_hash[bucket];
+    ack_hash[bucket] = entry;
+
+    return entry;
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppAckTableInit
+ *
+ *  DESCRIPTION
+ *      This function removes all the devices from the table.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppAckTableInit(void)
+{
+    uint16 index;
+
+    for(index = 0; index < ACK_HASH_SIZE; index++)
+    {
+        ack_hash[index] = ACK_NONE;
+    }
+
+    for(index = 0; index < ACK_TABLE_SIZE; index++)
+    {
+        ack_entries[index].hash_next = index + 1;
+    }
+    ack_entries[ACK_TABLE_SIZE - 1].hash_next = ACK_NONE;
+    ack_free = 0;
+
+    ack_lru_head = ACK_NONE;
+    ack_lru_tail = ACK_NONE;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppAckTableAdd
+ *
+ *  DESCRIPTION
+ *      This function adds a device to the table, or refreshes the transaction
+ *      id of a device already in it, and sets the number of acknowledgements
+ *      to be sent to it. The device becomes the most recently added one.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppAckTableAdd(uint16 dev_id, uint16 tid, uint16 retransmit_count)
+{
+    uint16 entry = ack_hash[hashDevice(dev_id)];
+
+    while(entry != ACK_NONE && ack_entries[entry].dev_id != dev_id)
+    {
+        entry = ack_entries[entry].hash_next;
+    }
+
+    if(entry == ACK_NONE)
+    {
+        entry = allocateEntry(dev_id);
+    }
+    else
+    {
+        unlinkRecent(entry);
+    }
+    linkRecent(entry);
+
+    ack_entries[entry].tid = tid;
+    ack_entries[entry].retransmit_count = retransmit_count;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppAckTableSend
+ *
+ *  DESCRIPTION
+ *      This function calls send for each device in the table, most recently
+ *      added first. A device is removed from the table once all its
+ *      acknowledgements have been sent.
+ *
+ *  RETURNS
+ *      Number of devices with acknowledgements still to be sent.
+ *
+ *---------------------------------------------------------------------------*/
+extern uint16 AppAckTableSend(ACK_SEND_T send)
+{
+    uint16 entry = ack_lru_head;
+    uint16 pending = 0;
+
+    while(entry != ACK_NONE)
+    {
+        ACK_ENTRY_T *p_entry = &ack_entries[entry];
+        uint16 next = p_entry->lru_next;
+
+        send(p_entry->dev_id, p_entry->tid);
+
+        if(p_entry->retransmit_count > 1)
+        {
+            p_entry->retransmit_count--;
+            pending++;
+        }
+        else
+        {
+            freeEntry(entry);
+        }
+
+        entry = next;
+    }
+
+    return pending;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppAckTableCount
+ *
+ *  DESCRIPTION
+ *      This function counts the devices with acknowledgements still to be
+ *      sent.
+ *
+ *  RETURNS
+ *      Number of devices in the table.
+ *
+ *---------------------------------------------------------------------------*/
+extern uint16 AppAckTableCount(void)
+{
+    uint16 entry = ack_lru_head;
+    uint16 count = 0;
+
+    while(entry != ACK_NONE)
+    {
+        count++;
+        entry = ack_entries[entry].lru_next;
+    }
+
+    return count;
+}
+
+#endif /* ENABLE_ACK_MODE */
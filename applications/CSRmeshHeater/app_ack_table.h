@@ -0,0 +1,57 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_ack_table.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the table of sensors to which sensor value
+ *      acknowledgements are sent
+ *
+ *****************************************************************************/
+
+#ifndef __APP_ACK_TABLE_H__
+#define __APP_ACK_TABLE_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+#ifdef ENABLE_ACK_MODE
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Maximum devices for which acknowledgements could be sent */
+#define ACK_TABLE_SIZE                  (8)
+
+/*============================================================================*
+ *  Public Data Types
+ *============================================================================*/
+/* Function called to send the acknowledgement to a device */
+typedef void (*ACK_SEND_T)(uint16 dev_id, uint16 tid);
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Removes all the devices from the table */
+extern void AppAckTableInit(void);
+
+/* Adds a device to the table or refreshes its transaction id */
+extern void AppAckTableAdd(uint16 dev_id, uint16 tid, uint16 retransmit_count);
+
+/* Sends one acknowledgement to each device in the table */
+extern uint16 AppAckTableSend(ACK_SEND_T send);
+
+/* Returns the number of devices in the table */
+extern uint16 AppAckTableCount(void);
+
+#endif /* ENABLE_ACK_MODE */
+#endif /* __APP_ACK_TABLE_H__ */
@@ -12,6 +12,7 @@
  *  SDK Header Files
  *============================================================================*/
 #include <timer.h>
+#include <time.h>
 #include <mem.h>
 #include <buf_utils.h>
 #include <config_store.h>
@@ -37,25 +38,33 @@
 #include "csr_ota.h"
 #include "csr_ota_service.h"
 #include "gatt_service.h"
+#include "app_ack_table.h"
 /*============================================================================*
  *  Private Definitions
  *============================================================================*/
 
 #ifdef ENABLE_ACK_MODE
-typedef struct 
-{
-    uint16 dev_id;
-    uint16 tid;
-}DEVICE_INFO_T;
-
-/* Maximum devices for which ackowledgements could be sent */
-#define MAX_ACK_DEVICES                     (5)
-
 /* Maximum retransmit count */
 #define MAX_RETRANSMIT_COUNT                (MAX_RETRANSMISSION_TIME / \
                                              RETRANSMIT_INTERVAL)
 #endif /* ENABLE_ACK_MODE */
 
+#ifdef ENABLE_AGGREGATED_ACK
+#if !defined(ENABLE_ACK_MODE) || !defined(ENABLE_DATA_MODEL)
+#error "Aggregated acknowledgement needs ack mode and the data model"
+#endif
+
+/* Length of a (device id, tid) entry in the aggregated acknowledgement */
+#define AGGREGATED_ACK_ENTRY_LEN            (3)
+
+/* Largest aggregated acknowledgement: code followed by the entries */
+#define AGGREGATED_ACK_MAX_LEN              (10)
+
+/* Entries in one aggregated acknowledgement */
+#define AGGREGATED_ACK_ENTRIES              ((AGGREGATED_ACK_MAX_LEN - 1) / \
+                                             AGGREGATED_ACK_ENTRY_LEN)
+#endif /* ENABLE_AGGREGATED_ACK */
+
 typedef struct
 {
     sensor_type_t type;
@@ -74,6 +83,46 @@ typedef struct
 /* Desired Air temperature sensor Index */
 #define DESIRED_AIR_TEMP_IDX             (1)
 
+/* Number of times the temperature is read from the group */
+#define READ_VALUE_TRANSMIT_COUNT        (60)
+
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+/* Number of times a subscription is sent to the group. The sensors keep the
+ * repeat interval, so unlike a read it does not have to be repeated until a
+ * value is heard. A subscription which is lost is sent again when the lease
+ * expires.
+ */
+#define SUBSCRIBE_TRANSMIT_COUNT         (5)
+
+/* Time after the last value heard when the cached temperature is stale */
+#define SUBSCRIPTION_LEASE_TIME          ((uint32)SUBSCRIPTION_LEASE_REPEATS * \
+                                          subscription_interval * SECOND)
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+
+#ifdef ENABLE_PREDICTIVE_CONTROL
+/* Shortest time between the values the rate of change is taken over. The
+ * retransmissions of one value arrive within this time.
+ */
+#define TEMP_RATE_MIN_SAMPLE_TIME        (20 * SECOND)
+
+/* Longest time between the values the rate of change is taken over */
+#define TEMP_RATE_MAX_SAMPLE_TIME        (30 * 60 * SECOND)
+
+/* Largest rate of change taken in 1/32 kelvin per hour (20 kelvin/hour) */
+#define TEMP_RATE_MAX                    (640)
+
+/* Seconds in an hour, the unit time of the rate of change */
+#define SECONDS_PER_HOUR                 (3600L)
+
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+/* Time for which the repeat interval another heater subscribed with is kept
+ * to. A heater which still needs it subscribes again when it hears a longer
+ * one. Kept within the range of TimeSub.
+ */
+#define SHARED_SUBSCRIPTION_TIME         (30 * 60 * SECOND)
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+#endif /* ENABLE_PREDICTIVE_CONTROL */
+
 /*============================================================================*
  *  Private Data
  *============================================================================*/
@@ -103,15 +152,49 @@ static uint16 read_value_transmit_count = 0;
 /* Read Value Timer ID. */
 static timer_id read_val_tid = TIMER_INVALID;
 
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+/* Subscription lease Timer ID. */
+static timer_id lease_tid = TIMER_INVALID;
+
+/* Time the cached temperature was last heard from the group */
+static uint32 temp_last_heard;
+
+/* Repeat interval in seconds asked of the sensors */
+static uint8 subscription_interval = SUBSCRIPTION_REPEAT_INTERVAL;
+
+/* Time the sensors were last subscribed to */
+static uint32 subscribe_time;
+
+#ifdef ENABLE_PREDICTIVE_CONTROL
+/* Shortest repeat interval another heater subscribed to the group with, the
+ * heater and the time it was heard. 0 if none.
+ */
+static uint8 shared_interval;
+static uint16 shared_dev_id;
+static uint32 shared_time;
+
+/* Another heater has asked the sensors for a longer interval than this one */
+static bool subscription_overridden;
+#endif /* ENABLE_PREDICTIVE_CONTROL */
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+
+#ifdef ENABLE_PREDICTIVE_CONTROL
+/* Previous value the rate of change was taken from and its time */
+static SENSOR_FORMAT_TEMPERATURE_T prev_air_temp;
+static uint32 prev_air_temp_time;
+
+/* Smoothed rate of change of the temperature in 1/32 kelvin per hour */
+static int16 air_temp_rate;
+#endif /* ENABLE_PREDICTIVE_CONTROL */
+
 #ifdef ENABLE_ACK_MODE
 /* Retransmit Timer ID. */
 static timer_id retransmit_tid = TIMER_INVALID;
 
-/* Write Value Msg Retransmit counter */
-static uint16   ack_retransmit_count = 0;
-
-/* Array of structure holding the device id and the transaction id to be sent*/
-static DEVICE_INFO_T sensor_dev_ack[MAX_ACK_DEVICES];
+#ifdef ENABLE_AGGREGATED_ACK
+/* Aggregated acknowledgement being filled in */
+static CSRMESH_DATA_BLOCK_SEND_T aggregated_ack;
+#endif /* ENABLE_AGGREGATED_ACK */
 #endif /* ENABLE_ACK_MODE */
 
 /* Attention timer id */
@@ -121,9 +204,21 @@ static timer_id attn_tid = TIMER_INVALID;
  *  Private Function Prototypes
  *============================================================================*/
 static void updateHeaterStatus(void);
+#ifdef ENABLE_PREDICTIVE_CONTROL
+static bool updateTempRate(SENSOR_FORMAT_TEMPERATURE_T temp);
+static void resetTempRate(void);
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+static void updateSubscriptionInterval(int32 predicted);
+static void sharedSubscriptionHeard(uint16 dev_id, uint8 interval);
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+#endif /* ENABLE_PREDICTIVE_CONTROL */
 static void startReadValueTimer(void);
 static void readValTimerHandler(timer_id tid);
 static void readCurrentTempFromGroup(void);
+static void startTempRead(void);
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+static void leaseTimerHandler(timer_id tid);
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
 
 #ifdef DEBUG_ENABLE
 /* Print a number in decimal. */
@@ -133,11 +228,15 @@ static void printInDecimal(uint32 val);
 #endif /* DEBUG_ENABLE */
 
 #ifdef ENABLE_ACK_MODE
+#ifdef ENABLE_AGGREGATED_ACK
+static void addToAggregatedAck(uint16 dev_id, uint16 tid);
+static void sendAggregatedAck(void);
+static bool aggregatedAckSavesMessages(void);
+#endif /* ENABLE_AGGREGATED_ACK */
+static void sendValueAckToDevice(uint16 dev_id, uint16 tid);
 static void sendValueAck(void);
 static void retransmitIntervalTimerHandler(timer_id tid);
-static void startRetransmitTimer(void);
 static void addDeviceToSensorList(uint16 dev_id, uint8 tid);
-static void resetDeviceList(void);
 #endif /* ENABLE_ACK_MODE */
 
 /*============================================================================*
@@ -168,44 +267,173 @@ static void printInDecimal(uint32 val)
 #endif /* DEBUG_ENABLE */
 
 #ifdef ENABLE_ACK_MODE
+#ifdef ENABLE_AGGREGATED_ACK
 /*----------------------------------------------------------------------------*
  *  NAME
- *      sendValueAck
+ *      sendAggregatedAck
  *
  *  DESCRIPTION
- *      This function sends the sensor value acknowledgement message back to the
- *      device.
+ *      This function sends the aggregated acknowledgement filled in so far to
+ *      the sensor groups and starts a new one.
+ *          |USER_SENSOR_ACK_LIST|dev id LSB|dev id MSB|tid|...
  *
  *  RETURNS
  *      Nothing.
  *
  *----------------------------------------------------------------------------*/
-static void sendValueAck(void)
+static void sendAggregatedAck(void)
 {
     uint16 index;
 
-    for(index = 0; index < MAX_ACK_DEVICES; index++)
+    if(aggregated_ack.datagramoctets_len > 1)
     {
-        if(sensor_dev_ack[index].dev_id != MESH_BROADCAST_ID)
+        for(index = 0; index < NUM_SENSOR_MODEL_GROUPS; index++)
         {
-            /* Retransmitting the same message on every transmission interval 
-             * can be configured to increase the possibility of the msg to reach 
-             * to the scanning devices with more robustness as they are scanning 
-             * at low duty cycles.
-             */
-            CSRMESH_SENSOR_VALUE_T value;
-            value.type = sensor_type_internal_air_temperature;
-            value.value[0] = WORD_LSB(current_air_temp);
-            value.value[1] = WORD_MSB(current_air_temp);
-            value.value_len = 2;
-            value.type2 = sensor_type_desired_air_temperature;
-            value.value2[0] = WORD_LSB(current_desired_air_temp);
-            value.value2[1] = WORD_MSB(current_desired_air_temp);
-            value.value2_len = 2;
-            value.tid = sensor_dev_ack[index].tid;
-            SensorValue(0, sensor_dev_ack[index].dev_id, &value);
+            if(sensor_model_groups[index] != 0)
+            {
+                DataBlockSend(0, sensor_model_groups[index], &aggregated_ack);
+            }
         }
     }
+
+    aggregated_ack.datagramoctets[0] = USER_SENSOR_ACK_LIST;
+    aggregated_ack.datagramoctets_len = 1;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      addToAggregatedAck
+ *
+ *  DESCRIPTION
+ *      This function adds the device id and tid of a sensor to the aggregated
+ *      acknowledgement, sending it first if it is full.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void addToAggregatedAck(uint16 dev_id, uint16 tid)
+{
+    uint8 *p_entry;
+
+    if(aggregated_ack.datagramoctets_len + AGGREGATED_ACK_ENTRY_LEN > 
+                                                        AGGREGATED_ACK_MAX_LEN)
+    {
+        sendAggregatedAck();
+    }
+
+    p_entry = &aggregated_ack.datagramoctets[aggregated_ack.datagramoctets_len];
+    p_entry[0] = WORD_LSB(dev_id);
+    p_entry[1] = WORD_MSB(dev_id);
+    p_entry[2] = tid & 0xFF;
+    aggregated_ack.datagramoctets_len += AGGREGATED_ACK_ENTRY_LEN;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      aggregatedAckSavesMessages
+ *
+ *  DESCRIPTION
+ *      This function checks whether the aggregated acknowledgement takes
+ *      fewer messages than a sensor value message to each sensor in the
+ *      acknowledgement table. Each block of the aggregated acknowledgement
+ *      is sent to every sensor group, so a single sensor, or a few sensors
+ *      on several groups, are acknowledged one by one.
+ *
+ *  RETURNS
+ *      TRUE if the aggregated acknowledgement is to be sent.
+ *
+ *----------------------------------------------------------------------------*/
+static bool aggregatedAckSavesMessages(void)
+{
+    uint16 sensors = AppAckTableCount();
+    uint16 blocks = (sensors + AGGREGATED_ACK_ENTRIES - 1) /
+                                                        AGGREGATED_ACK_ENTRIES;
+    uint16 groups = 0;
+    uint16 index;
+
+    for(index = 0; index < NUM_SENSOR_MODEL_GROUPS; index++)
+    {
+        if(sensor_model_groups[index] != 0)
+        {
+            groups++;
+        }
+    }
+
+    return (groups != 0 && blocks * groups < sensors);
+}
+#endif /* ENABLE_AGGREGATED_ACK */
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendValueAckToDevice
+ *
+ *  DESCRIPTION
+ *      This function sends the sensor value acknowledgement message back to a
+ *      device.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void sendValueAckToDevice(uint16 dev_id, uint16 tid)
+{
+    /* Retransmitting the same message on every transmission interval 
+     * can be configured to increase the possibility of the msg to reach 
+     * to the scanning devices with more robustness as they are scanning 
+     * at low duty cycles.
+     */
+    CSRMESH_SENSOR_VALUE_T value;
+    value.type = sensor_type_internal_air_temperature;
+    value.value[0] = WORD_LSB(current_air_temp);
+    value.value[1] = WORD_MSB(current_air_temp);
+    value.value_len = 2;
+    value.type2 = sensor_type_desired_air_temperature;
+    value.value2[0] = WORD_LSB(current_desired_air_temp);
+    value.value2[1] = WORD_MSB(current_desired_air_temp);
+    value.value2_len = 2;
+    value.tid = tid;
+    SensorValue(0, dev_id, &value);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendValueAck
+ *
+ *  DESCRIPTION
+ *      This function sends the sensor value acknowledgement message back to 
+ *      the devices in the acknowledgement table and starts the timer for the
+ *      next one while any are left to be sent.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void sendValueAck(void)
+{
+    uint16 pending;
+
+#ifdef ENABLE_AGGREGATED_ACK
+    /* All the sensors are acknowledged in as few messages as possible */
+    if(aggregatedAckSavesMessages())
+    {
+        aggregated_ack.datagramoctets[0] = USER_SENSOR_ACK_LIST;
+        aggregated_ack.datagramoctets_len = 1;
+        pending = AppAckTableSend(addToAggregatedAck);
+        sendAggregatedAck();
+    }
+    else
+#endif /* ENABLE_AGGREGATED_ACK */
+    {
+        pending = AppAckTableSend(sendValueAckToDevice);
+    }
+
+    if(pending > 0)
+    {
+        retransmit_tid = TimerCreate(RETRANSMIT_INTERVAL, TRUE,
+                                     retransmitIntervalTimerHandler);
+    }
+
     DEBUG_STR(" Acknowledge DESIRED TEMP : ");
     printInDecimal(current_desired_air_temp/32);
     DEBUG_STR(" kelvin\r\n");
@@ -232,133 +460,243 @@ static void retransmitIntervalTimerHandler(timer_id tid)
     {
         retransmit_tid = TIMER_INVALID;
 
-        /* transmit the pending message to all the groups*/
+        /* transmit the pending acknowledgements */
         sendValueAck();
-
-        ack_retransmit_count --;
-
-        /* start a timer to send the broadcast ack data */
-        startRetransmitTimer();
     }
 }
 
 /*----------------------------------------------------------------------------*
  *  NAME
- *      startRetransmitTimer
+ *      addDeviceToSensorList
  *
  *  DESCRIPTION
- *      This function starts the broadcast timer for retransmission.
+ *      This function adds the device id and the transaction id onto the 
+ *      acknowledgement table. A device already in the table has its tid
+ *      refreshed and its acknowledgements sent again from the start.
  *
  *  RETURNS
  *      None
  *
  *----------------------------------------------------------------------------*/
-static void startRetransmitTimer(void)
+static void addDeviceToSensorList(uint16 dev_id, uint8 tid)
 {
-    if(retransmit_tid == TIMER_INVALID && ack_retransmit_count > 0)
-    {
-        retransmit_tid = TimerCreate(RETRANSMIT_INTERVAL, TRUE,
-                                     retransmitIntervalTimerHandler);
-    }
+    AppAckTableAdd(dev_id, tid, MAX_RETRANSMIT_COUNT);
 
-    /* reset the device id and the tid in the device list as we have sent all
-     * the ack to the devices
+    /* start a timer to send the ack data unless one is already running for
+     * the other devices in the table.
      */
-    if(ack_retransmit_count == 0)
+    if(retransmit_tid == TIMER_INVALID)
     {
-        resetDeviceList();
+        retransmit_tid = TimerCreate(RETRANSMIT_INTERVAL, TRUE,
+                                     retransmitIntervalTimerHandler);
     }
 }
+#endif /* ENABLE_ACK_MODE */
 
+#ifdef ENABLE_PREDICTIVE_CONTROL
 /*----------------------------------------------------------------------------*
  *  NAME
- *      addDeviceToSensorList
+ *      updateTempRate
  *
  *  DESCRIPTION
- *      This function adds the device id and the transaction id onto the 
- *      list.
+ *      This function takes the rate of change of the temperature between the
+ *      previous value and a value received from the group, and smooths it
+ *      into the rate used for the prediction. Values received sooner than
+ *      TEMP_RATE_MIN_SAMPLE_TIME after the previous one are ignored. After a
+ *      gap longer than TEMP_RATE_MAX_SAMPLE_TIME the rate is started again.
  *
  *  RETURNS
- *      None
+ *      TRUE if the rate was updated.
  *
  *----------------------------------------------------------------------------*/
-static void addDeviceToSensorList(uint16 dev_id, uint8 tid)
+static bool updateTempRate(SENSOR_FORMAT_TEMPERATURE_T temp)
 {
-    uint8 index;
-    bool dev_found = FALSE;
+    uint32 now = TimeGet32();
+    int32 elapsed = TimeSub(now, prev_air_temp_time);
+    int32 rate;
 
-    /* Check whether the device is already present in the list as we are 
-     * sending the acknowledgements in which case we can refresh the latest
-     * tid for that device.
-     */
-    for(index = 0; index < MAX_ACK_DEVICES; index++)
+    if(prev_air_temp != 0 && elapsed >= 0 &&
+       elapsed < (int32)TEMP_RATE_MIN_SAMPLE_TIME)
     {
-        if(sensor_dev_ack[index].dev_id == dev_id)
-        {
-            dev_found = TRUE;
-            sensor_dev_ack[index].tid = tid;
-            break;
-        }
+        return FALSE;
     }
-    /* If the device is not found then add the device onto the device list db */
-    if(!dev_found)
+
+    if(prev_air_temp != 0 && elapsed >= 0 &&
+       elapsed <= (int32)TEMP_RATE_MAX_SAMPLE_TIME)
     {
-        for(index = 0; index < MAX_ACK_DEVICES; index++)
+        rate = (((int32)temp - (int32)prev_air_temp) * SECONDS_PER_HOUR) /
+               (elapsed / SECOND);
+
+        if(rate > TEMP_RATE_MAX)
         {
-            if(sensor_dev_ack[index].dev_id == MESH_BROADCAST_ID)
-            {
-                sensor_dev_ack[index].dev_id = dev_id;
-                sensor_dev_ack[index].tid = tid;
-                break;
-            }
+            rate = TEMP_RATE_MAX;
         }
-        /* If the device list is full then just replace the oldest device id as
-         * we would have sent the maximum acknowledgements to the first dev
-         * added in the list.
-         */
-        if(index == MAX_ACK_DEVICES - 1)
+        else if(rate < -TEMP_RATE_MAX)
         {
-            sensor_dev_ack[0].dev_id = dev_id;
-            sensor_dev_ack[0].tid = tid;
+            rate = -TEMP_RATE_MAX;
         }
+
+        air_temp_rate = (int16)((air_temp_rate + rate) / 2);
+    }
+    else
+    {
+        air_temp_rate = 0;
     }
-    ack_retransmit_count = MAX_RETRANSMIT_COUNT;
 
-    /* start a timer to send the broadcast ack data */
-    TimerDelete(retransmit_tid);
-    retransmit_tid = TIMER_INVALID;
-    startRetransmitTimer();
+    prev_air_temp = temp;
+    prev_air_temp_time = now;
+
+    return TRUE;
 }
 
 /*----------------------------------------------------------------------------*
  *  NAME
- *      resetDeviceList
+ *      resetTempRate
  *
  *  DESCRIPTION
- *      The function resets the device id and the ack flag of complete db
+ *      This function forgets the values the rate of change is taken from.
  *
  *  RETURNS
  *      Nothing.
  *
- *---------------------------------------------------------------------------*/
-static void resetDeviceList(void)
+ *----------------------------------------------------------------------------*/
+static void resetTempRate(void)
 {
-    uint16 idx;
+    prev_air_temp = 0;
+    air_temp_rate = 0;
+}
+
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      updateSubscriptionInterval
+ *
+ *  DESCRIPTION
+ *      This function works out how soon the temperature is predicted to
+ *      reach the edge of the band at which the heater switches next, and
+ *      asks the sensors to repeat their value twice in that time. The
+ *      sensors are only asked again when the interval needed has halved or
+ *      doubled, or another heater has asked for a longer one, and not within
+ *      SUBSCRIPTION_MIN_CHANGE_TIME of the last subscription, so that the
+ *      requests do not add traffic of their own.
+ *
+ *      The sensors repeat at the interval last asked for. While another
+ *      heater needs a shorter interval than this one, this heater takes it
+ *      as its own rather than asking for a longer one.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void updateSubscriptionInterval(int32 predicted)
+{
+    int32 margin, interval = SUBSCRIPTION_MAX_REPEAT_INTERVAL;
+    uint32 now = TimeGet32();
+    int32 elapsed;
+
+    /* Distance to the edge the temperature is moving towards */
+    if(g_heater_app_data.status == heater_on && air_temp_rate > 0)
+    {
+        margin = (int32)current_desired_air_temp +
+                 HEATER_HYSTERESIS_BAND / 2 - predicted;
+        interval = (margin * SECONDS_PER_HOUR) / air_temp_rate / 2;
+    }
+    else if(g_heater_app_data.status == heater_off && air_temp_rate < 0)
+    {
+        margin = predicted - (int32)current_desired_air_temp +
+                 HEATER_HYSTERESIS_BAND / 2;
+        interval = (margin * SECONDS_PER_HOUR) / (-air_temp_rate) / 2;
+    }
 
-    for(idx=0; idx < MAX_ACK_DEVICES; idx++)
+    if(interval < SUBSCRIPTION_MIN_REPEAT_INTERVAL)
+    {
+        interval = SUBSCRIPTION_MIN_REPEAT_INTERVAL;
+    }
+    else if(interval > SUBSCRIPTION_MAX_REPEAT_INTERVAL)
     {
-        sensor_dev_ack[idx].dev_id = MESH_BROADCAST_ID;
-        sensor_dev_ack[idx].tid = 0;
+        interval = SUBSCRIPTION_MAX_REPEAT_INTERVAL;
+    }
+
+    /* The values are heard far more often than the time kept to, so a
+     * time which has wrapped round is long past.
+     */
+    elapsed = TimeSub(now, shared_time);
+    if(shared_interval != 0 &&
+       (elapsed < 0 || elapsed >= (int32)SHARED_SUBSCRIPTION_TIME))
+    {
+        shared_interval = 0;
+    }
+
+    if(shared_interval != 0 && interval >= shared_interval)
+    {
+        subscription_interval = shared_interval;
+        subscription_overridden = FALSE;
+        return;
+    }
+
+    elapsed = TimeSub(now, subscribe_time);
+    if((interval * 2 <= subscription_interval ||
+        interval >= subscription_interval * 2 ||
+        subscription_overridden) &&
+       (elapsed < 0 ||
+        elapsed >= (int32)(SUBSCRIPTION_MIN_CHANGE_TIME * SECOND)))
+    {
+        DEBUG_STR(" SUBSCRIPTION INTERVAL : ");
+        printInDecimal(interval);
+        DEBUG_STR(" seconds\r\n");
+
+        subscription_interval = interval & 0xFF;
+        subscription_overridden = FALSE;
+        readCurrentTempFromGroup();
     }
 }
-#endif /* ENABLE_ACK_MODE */
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sharedSubscriptionHeard
+ *
+ *  DESCRIPTION
+ *      This function is called when another heater subscribes to the
+ *      sensors of the group. It keeps the shortest interval heard, or the
+ *      latest one of the heater that asked for it, for
+ *      SHARED_SUBSCRIPTION_TIME. An interval longer than the one this heater
+ *      asked for has replaced it at the sensors, so it is asked for again.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void sharedSubscriptionHeard(uint16 dev_id, uint8 interval)
+{
+    uint32 now = TimeGet32();
+    int32 elapsed = TimeSub(now, shared_time);
+
+    if(shared_interval == 0 || dev_id == shared_dev_id ||
+       interval <= shared_interval ||
+       elapsed < 0 || elapsed >= (int32)SHARED_SUBSCRIPTION_TIME)
+    {
+        shared_interval = interval;
+        shared_dev_id = dev_id;
+        shared_time = now;
+    }
+
+    if(interval > subscription_interval)
+    {
+        subscription_overridden = TRUE;
+    }
+}
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+#endif /* ENABLE_PREDICTIVE_CONTROL */
 
 /*----------------------------------------------------------------------------*
  *  NAME
  *      updateHeaterStatus
  *
  *  DESCRIPTION
- *      This function updates the Heater Status from ON or OFF
+ *      This function updates the Heater Status from ON or OFF. Under
+ *      predictive control the heater switches on when the predicted
+ *      temperature is below the band around the desired temperature, off
+ *      when it is above the band, and otherwise keeps its state.
  *
  *  RETURNS
  *      Nothing.
@@ -366,7 +704,27 @@ static void resetDeviceList(void)
  *----------------------------------------------------------------------------*/
 static void updateHeaterStatus(void)
 {
-    if( current_desired_air_temp > current_air_temp )
+#ifdef ENABLE_PREDICTIVE_CONTROL
+    int32 predicted = (int32)current_air_temp +
+                      ((int32)air_temp_rate * HEATER_PREDICTION_HORIZON) /
+                      SECONDS_PER_HOUR;
+    bool heat = (g_heater_app_data.status == heater_on);
+
+    if(predicted + HEATER_HYSTERESIS_BAND / 2 < 
+       (int32)current_desired_air_temp)
+    {
+        heat = TRUE;
+    }
+    else if(predicted > 
+            (int32)current_desired_air_temp + HEATER_HYSTERESIS_BAND / 2)
+    {
+        heat = FALSE;
+    }
+#else
+    bool heat = (current_desired_air_temp > current_air_temp);
+#endif /* ENABLE_PREDICTIVE_CONTROL */
+
+    if( heat )
     {
         if( g_heater_app_data.status == heater_off )
         {
@@ -388,6 +746,13 @@ static void updateHeaterStatus(void)
         /* Turn off the red LED to indicate Heating status */
         IOTLightControlDevicePower(FALSE);
     }
+
+#if defined(ENABLE_PREDICTIVE_CONTROL) && defined(ENABLE_SENSOR_SUBSCRIPTION)
+    if(current_air_temp != 0 && current_desired_air_temp != 0)
+    {
+        updateSubscriptionInterval(predicted);
+    }
+#endif /* ENABLE_PREDICTIVE_CONTROL && ENABLE_SENSOR_SUBSCRIPTION */
 }
 
 /*----------------------------------------------------------------------------*
@@ -404,22 +769,115 @@ static void updateHeaterStatus(void)
 static void readCurrentTempFromGroup(void)
 {
     uint16 index;
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+    CSRMESH_SENSOR_SET_STATE_T sensor_state;
+#else
     CSRMESH_SENSOR_READ_VALUE_T sensor_read;
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
 
     for(index = 0; index < NUM_SENSOR_MODEL_GROUPS; index++)
     {
         if(sensor_model_groups[index] != 0)
         {
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+            /* Setting the repeat interval subscribes to the sensors. They
+             * write their value onto the group straight away and then on
+             * every change and every repeat interval.
+             */
+            sensor_state.type = sensor_type_internal_air_temperature;
+            sensor_state.repeatinterval = subscription_interval;
+            sensor_state.tid = 0;
+            SensorSetState(0,
+                           sensor_model_groups[index],
+                           &sensor_state);
+            subscribe_time = TimeGet32();
+#else
             sensor_read.type = sensor_type_internal_air_temperature;
             sensor_read.type2 = sensor_type_desired_air_temperature;
             sensor_read.tid = 0;
             SensorReadValue(0,
                             sensor_model_groups[index], 
                             &sensor_read);
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
         }
     }
 }
 
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      startTempRead
+ *
+ *  DESCRIPTION
+ *      This function starts reading the temperature from the group, or
+ *      subscribing to it when subscriptions are enabled. Reads are repeated
+ *      until a value is received from the group, subscriptions only
+ *      SUBSCRIBE_TRANSMIT_COUNT times.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void startTempRead(void)
+{
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+    read_value_transmit_count = SUBSCRIBE_TRANSMIT_COUNT;
+#else
+    read_value_transmit_count = READ_VALUE_TRANSMIT_COUNT;
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+
+    /* start a timer to read the temp from the group */
+    TimerDelete(read_val_tid);
+    read_val_tid = TIMER_INVALID;
+    startReadValueTimer();
+
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+    /* The lease runs from now so that a group which does not answer is
+     * subscribed to again when it expires.
+     */
+    temp_last_heard = TimeGet32();
+    TimerDelete(lease_tid);
+    lease_tid = TimerCreate(SUBSCRIPTION_LEASE_TIME, TRUE, leaseTimerHandler);
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+}
+
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      leaseTimerHandler
+ *
+ *  DESCRIPTION
+ *      This function expires SUBSCRIPTION_LEASE_TIME after the cached
+ *      temperature could last have been refreshed. If a value has been heard
+ *      since, the timer is started again for the rest of the lease.
+ *      Otherwise the cached temperature is stale and the heater subscribes
+ *      to the group again.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void leaseTimerHandler(timer_id tid)
+{
+    if(tid == lease_tid)
+    {
+        int32 elapsed = TimeSub(TimeGet32(), temp_last_heard);
+
+        lease_tid = TIMER_INVALID;
+
+        if(elapsed >= 0 && elapsed < (int32)SUBSCRIPTION_LEASE_TIME)
+        {
+            lease_tid = TimerCreate(SUBSCRIPTION_LEASE_TIME - elapsed, TRUE,
+                                    leaseTimerHandler);
+        }
+        else
+        {
+            DEBUG_STR(" TEMP STALE, SUBSCRIBING AGAIN\r\n");
+            startTempRead();
+        }
+    }
+}
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      startReadValueTimer
@@ -541,6 +999,10 @@ extern void InitialiseSensorData(void)
                                         sensor_type_desired_air_temperature;
     sensor_data[DESIRED_AIR_TEMP_IDX].value       = 
                                         (uint16 *)&current_desired_air_temp;
+
+#ifdef ENABLE_ACK_MODE
+    AppAckTableInit();
+#endif /* ENABLE_ACK_MODE */
 }
 
 /*----------------------------------------------------------------------------*
@@ -640,6 +1102,20 @@ extern void ConfigureHeater(bool old_config)
         /* Stop the reading of the temp */
         TimerDelete(read_val_tid);
         read_val_tid = TIMER_INVALID;
+
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+        /* Stop the subscription lease */
+        TimerDelete(lease_tid);
+        lease_tid = TIMER_INVALID;
+        subscription_interval = SUBSCRIPTION_REPEAT_INTERVAL;
+#ifdef ENABLE_PREDICTIVE_CONTROL
+        shared_interval = 0;
+        subscription_overridden = FALSE;
+#endif /* ENABLE_PREDICTIVE_CONTROL */
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+#ifdef ENABLE_PREDICTIVE_CONTROL
+        resetTempRate();
+#endif /* ENABLE_PREDICTIVE_CONTROL */
     }
 
     /* Grouping has been modified but sensor is still configured. Hence 
@@ -648,12 +1124,7 @@ extern void ConfigureHeater(bool old_config)
     if(IsHeaterConfigured())
     {
         /* read the current temperature of the group */
-        read_value_transmit_count = 60;
-
-        /* start a timer to read the temp from the group */
-        TimerDelete(read_val_tid);
-        read_val_tid = TIMER_INVALID;
-        startReadValueTimer();
+        startTempRead();
     }
 }
 
@@ -718,15 +1189,16 @@ extern void InitialiseHeater(void)
         EnableHighDutyScanMode(FALSE);
         DEBUG_STR("Heater Configured Moving to Low Power Mode \r\n\r\n");
 
-        /* read the current temperature of the group */
-        read_value_transmit_count = 60;
-
 #ifdef ENABLE_ACK_MODE
         retransmit_tid = TIMER_INVALID;
 #endif
-        /* start a timer to read the temp from the group */
         read_val_tid = TIMER_INVALID;
-        startReadValueTimer();
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+        lease_tid = TIMER_INVALID;
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+
+        /* read the current temperature of the group */
+        startTempRead();
     }
 }
 
@@ -867,6 +1339,16 @@ void CSRmeshAppProcessMeshEvent(CSR_MESH_APP_EVENT_DATA_T eventDataCallback)
 
                     current_air_temp = 0;
                     current_desired_air_temp = 0;
+#ifdef ENABLE_PREDICTIVE_CONTROL
+                    resetTempRate();
+#endif /* ENABLE_PREDICTIVE_CONTROL */
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+                    subscription_interval = SUBSCRIPTION_REPEAT_INTERVAL;
+#ifdef ENABLE_PREDICTIVE_CONTROL
+                    shared_interval = 0;
+                    subscription_overridden = FALSE;
+#endif /* ENABLE_PREDICTIVE_CONTROL */
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
 
                     /* Start Mesh association again */
                     InitiateAssociation();
@@ -1101,6 +1583,9 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
             SENSOR_FORMAT_TEMPERATURE_T recvd_air_temp = 0;
             uint8 *value, *value2;
             bool send_ack = FALSE;
+#ifdef ENABLE_PREDICTIVE_CONTROL
+            bool rate_updated = FALSE;
+#endif /* ENABLE_PREDICTIVE_CONTROL */
             MemSet(&model_rsp_data.sensor_value,
                    0x0000,
                    sizeof(model_rsp_data.sensor_value));
@@ -1148,6 +1633,18 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
             read_val_tid = TIMER_INVALID;
             read_value_transmit_count = 0;
 
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+            /* The cached temperature is fresh again */
+            temp_last_heard = TimeGet32();
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+
+#ifdef ENABLE_PREDICTIVE_CONTROL
+            if(recvd_air_temp != 0 && recvd_desired_temp != 0)
+            {
+                rate_updated = updateTempRate(recvd_air_temp);
+            }
+#endif /* ENABLE_PREDICTIVE_CONTROL */
+
             if((current_desired_air_temp != recvd_desired_temp ||
                 current_air_temp != recvd_air_temp) &&
                 (recvd_air_temp != 0 && recvd_desired_temp != 0))
@@ -1193,9 +1690,40 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
                     }
                 }
             }
+#ifdef ENABLE_PREDICTIVE_CONTROL
+            else if(rate_updated)
+            {
+                /* A repeated value still changes the rate of change and so
+                 * the predicted temperature.
+                 */
+                updateHeaterStatus();
+            }
+#endif /* ENABLE_PREDICTIVE_CONTROL */
         }
         break;
 
+#if defined(ENABLE_PREDICTIVE_CONTROL) && defined(ENABLE_SENSOR_SUBSCRIPTION)
+        case CSRMESH_SENSOR_SET_STATE:
+        {
+            /* Another heater is subscribing to the sensors of the group */
+            CSRMESH_SENSOR_SET_STATE_T *p_event = 
+                                    (CSRMESH_SENSOR_SET_STATE_T *)data->data;
+
+            if(p_event->type == sensor_type_internal_air_temperature &&
+               p_event->repeatinterval != 0)
+            {
+                sharedSubscriptionHeard(data->src_id,
+                                        p_event->repeatinterval & 0xFF);
+            }
+
+            /* The heater has no repeat interval of its own to respond with */
+            if (state_data != NULL)
+            {
+                *state_data = NULL;
+            }
+        }
+        break;
+#endif /* ENABLE_PREDICTIVE_CONTROL && ENABLE_SENSOR_SUBSCRIPTION */
 
         default:
         break;
@@ -45,12 +45,21 @@
 /*! \brief Bluetooth SIG Organization identifier for CSRmesh device appearance */
 #define APPEARANCE_ORG_BLUETOOTH_SIG        (0)
 
+#ifdef ENABLE_SENSOR_SUBSCRIPTION
+/* Subscription lease timer */
+#define SUBSCRIPTION_TIMERS                 (1)
+#else
+#define SUBSCRIPTION_TIMERS                 (0)
+#endif /* ENABLE_SENSOR_SUBSCRIPTION */
+
 #ifdef ENABLE_DEVICE_UUID_ADVERTS
 /* Maximum number of timers */
-#define MAX_APP_TIMERS                      (7 + CSR_MESH_MAX_NO_TIMERS)
+#define MAX_APP_TIMERS                      (7 + SUBSCRIPTION_TIMERS + \
+                                             CSR_MESH_MAX_NO_TIMERS)
 #else
 /* Maximum number of timers */
-#define MAX_APP_TIMERS                      (6 + CSR_MESH_MAX_NO_TIMERS)
+#define MAX_APP_TIMERS                      (6 + SUBSCRIPTION_TIMERS + \
+                                             CSR_MESH_MAX_NO_TIMERS)
 #endif /* ENABLE_DEVICE_UUID_ADVERTS */
 
 /* TGAP(conn_pause_peripheral) defined in Core Specification Addendum 3 Revision
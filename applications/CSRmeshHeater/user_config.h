@@ -80,6 +80,61 @@
 /* Enable the Acknowledge mode */
 /* #define ENABLE_ACK_MODE */
 
+/* Enable acknowledging the sensors in ack mode with one data model message
+ * to the sensor groups, listing the device id and tid of each sensor heard,
+ * instead of a sensor value message to each sensor. The list is sent only
+ * when it takes fewer messages than acknowledging each sensor.
+ */
+/* #define ENABLE_AGGREGATED_ACK */
+
+/* Enable subscribing to the temperature sensors of the group. Instead of
+ * reading the temperature, the heater asks the sensors to repeat their value
+ * every SUBSCRIPTION_REPEAT_INTERVAL and only subscribes again when no value
+ * has been heard for SUBSCRIPTION_LEASE_TIME.
+ */
+#define ENABLE_SENSOR_SUBSCRIPTION
+
+/* Repeat interval in seconds requested from the sensors. Value range 30-255 */
+#define SUBSCRIPTION_REPEAT_INTERVAL   (60)
+
+/* Number of repeat intervals after the last value heard when the cached
+ * temperature is stale
+ */
+#define SUBSCRIPTION_LEASE_REPEATS     (3)
+
+/* Enable predictive control of the heater. The heater keeps its state while
+ * the temperature is within a band around the desired temperature, and
+ * compares the temperature predicted from its rate of change against the
+ * band, so that it needs fewer temperature updates. With sensor subscription
+ * the repeat interval asked of the sensors follows how soon the temperature
+ * is predicted to reach the edge of the band.
+ */
+#define ENABLE_PREDICTIVE_CONTROL
+
+/* Width of the band around the desired temperature in 1/32 kelvin. A narrow
+ * band makes up for the heater acting on older values
+ */
+#define HEATER_HYSTERESIS_BAND         (8)
+
+/* Time in seconds ahead of the last value for which the temperature is
+ * predicted. It should cover the time the heater element takes to warm up
+ * and cool down
+ */
+#define HEATER_PREDICTION_HORIZON      (600)
+
+/* Range of the repeat intervals in seconds asked of the sensors under
+ * predictive control. Value range 30-255
+ */
+#define SUBSCRIPTION_MIN_REPEAT_INTERVAL (30)
+#define SUBSCRIPTION_MAX_REPEAT_INTERVAL (120)
+
+/* Shortest time in seconds between two subscriptions under predictive
+ * control. Every sensor writes a new repeat interval to its NVM and sends its
+ * value straight away, so the interval is not changed more often. Value range
+ * up to 1800
+ */
+#define SUBSCRIPTION_MIN_CHANGE_TIME   (600)
+
 /* Enable Static Random Address. */
 /* #define USE_STATIC_RANDOM_ADDRESS */
 
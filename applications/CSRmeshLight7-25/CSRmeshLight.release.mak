@@ -32,7 +32,7 @@ OTAU_VERSION=7
 OTAU_SLOT_1=0x4300
 OTAU_SLOT_END=0x10000
 
-LIBS=csrmesh light_server power_server attention_server data_server data_client battery_server 
+LIBS=csrmesh light_server power_server attention_server data_server data_client battery_server sensor_server 
 DBS=\
 \
       app_gatt_db.db\
@@ -57,6 +57,9 @@ INPUTS=\
       battery_hw.c\
       app_fw_event_handler.c\
       app_mesh_event_handler.c\
+      app_dup_filter.c\
+      app_location.c\
+      app_sensor_proxy.c\
       pio_ctrlr_code.asm\
       $(DBS)
 
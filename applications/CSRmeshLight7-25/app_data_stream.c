@@ -22,6 +22,7 @@
  *============================================================================*/
 #include <gatt.h>
 #include <timer.h>
+#include <time.h>
 #include <mem.h>
 
 /*============================================================================*
@@ -35,6 +36,7 @@
  *  Local Header Files
 *============================================================================*/
 #include "app_data_stream.h"
+#include "csr_mesh_light_gatt.h"
 
 #ifdef ENABLE_DATA_MODEL
 /*=============================================================================*
@@ -61,6 +63,9 @@
 /* Max data per per stream send */
 #define MAX_DATA_STREAM_PACKET_SIZE       (8)
 
+/* Length of the CSR_STREAM_STATS_RSP data block */
+#define STREAM_STATS_RSP_LEN              (9)
+
 /*============================================================================*
  *  Private Data Type
  *===========================================================================*/
@@ -117,6 +122,16 @@ static APP_STREAM_STATE_DATA_T app_stream_state;
 /* Stream bytes sent tracker */
 static uint16 tx_stream_offset = 0;
 
+/* Data sent in the current stream and its length */
+static const uint8 *tx_stream_data = device_info;
+static uint16 tx_stream_length = 0;
+
+/* Device which asked for the device info while another stream was being
+ * sent. The device info is sent to it once that stream ends.
+ */
+static bool device_info_pending = FALSE;
+static uint16 device_info_dest_id;
+
 /* Stream send retry timer */
 static timer_id stream_send_retry_tid = TIMER_INVALID;
 
@@ -134,11 +149,21 @@ static timer_id rx_stream_timeout_tid;
 
 static APP_DATA_STREAM_CODE_T current_stream_code;
 
+#ifdef ENABLE_DATA_STREAM_STATS
+/* Data stream transfer statistics */
+static APP_DATA_STREAM_STATS_T stream_stats;
+
+/* Time at which the current tx stream was started */
+static uint32 stream_start_time;
+#endif /* ENABLE_DATA_STREAM_STATS */
 
 /*=============================================================================*
  *  Private Function Prototypes
  *============================================================================*/
 static void streamSendRetryTimer(timer_id tid);
+static void sendFlush(void);
+static void streamEnded(void);
+static void sendDeviceInfo(uint16 dest_id);
 static void sendNextPacket(void);
 static void resetRxStreamState(void);
 static void rxStreamTimeoutHandler(timer_id tid);
@@ -150,8 +175,12 @@ static void handleCSRmeshDataStreamDataInd(uint16 src_id,
                                            CSRMESH_DATA_STREAM_SEND_T *p_event);
 static void handleCSRmeshDataStreamSendCfm(
                                        CSRMESH_DATA_STREAM_RECEIVED_T *p_event);
-static void startStream(uint16 dest_id);
+static void startStream(uint16 dest_id, const uint8 *p_data,
+                        uint16 length);
 static void endStream(void);
+#ifdef ENABLE_DATA_STREAM_STATS
+static void sendStreamStats(uint16 dest_id);
+#endif /* ENABLE_DATA_STREAM_STATS */
 
 /*=============================================================================*
  *  Private Function Implementations
@@ -162,7 +191,9 @@ static void endStream(void);
  *      streamSendRetryTimer
  *
  *  DESCRIPTION
- *      Timer handler to retry sending next packet
+ *      Timer handler to retry sending the flush or packet which has not been
+ *      acknowledged. After MAX_SEND_RETRIES the stream is ended without
+ *      waiting any longer for the receiver.
  *
  *  RETURNS
  *      Nothing.
@@ -175,9 +206,25 @@ static void streamSendRetryTimer(timer_id tid)
     {
         stream_send_retry_tid = TIMER_INVALID;
         stream_send_retry_count++;
-        if( stream_send_retry_count < MAX_SEND_RETRIES )
+        if( stream_send_retry_count >= MAX_SEND_RETRIES )
+        {
+#ifdef ENABLE_DATA_STREAM_STATS
+            stream_stats.streams_aborted++;
+#endif /* ENABLE_DATA_STREAM_STATS */
+            if(app_stream_state.tx.status == stream_send_in_progress)
+            {
+                /* Tell the receiver the stream has ended in case it can
+                 * still hear us
+                 */
+                sendFlush();
+            }
+
+            /* The receiver is not responding */
+            streamEnded();
+        }
+        else if(app_stream_state.tx.status == stream_send_in_progress)
         {
-            MemCopy(send_param.streamoctets, &device_info[tx_stream_offset],
+            MemCopy(send_param.streamoctets, &tx_stream_data[tx_stream_offset],
                                              app_stream_state.tx.last_data_len);
             send_param.streamoctets_len = app_stream_state.tx.last_data_len;
             send_param.streamsn = app_stream_state.tx.sn;
@@ -186,16 +233,106 @@ static void streamSendRetryTimer(timer_id tid)
             /* Send the next packet */
             DataStreamSend(CSR_MESH_DEFAULT_NETID, 
                                       app_stream_state.tx.dest_id, &send_param);
+#ifdef ENABLE_DATA_STREAM_STATS
+            stream_stats.packets_sent++;
+            stream_stats.retransmissions++;
+#endif /* ENABLE_DATA_STREAM_STATS */
 
             stream_send_retry_tid =  TimerCreate(STREAM_SEND_RETRY_TIME, TRUE,
                                                           streamSendRetryTimer);
         }
         else
         {
-            stream_send_retry_count = 0;
-            endStream();
+            /* The flush starting or ending the stream is not acknowledged */
+            sendFlush();
+
+            stream_send_retry_tid =  TimerCreate(STREAM_SEND_RETRY_TIME, TRUE,
+                                                          streamSendRetryTimer);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendFlush
+ *
+ *  DESCRIPTION
+ *      Sends a flush with the current sequence number to the stream receiver
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendFlush(void)
+{
+    CSRMESH_DATA_STREAM_FLUSH_T flush_param;
+
+    flush_param.streamsn = app_stream_state.tx.sn;
+    DataStreamFlush(CSR_MESH_DEFAULT_NETID, app_stream_state.tx.dest_id,
+                                                                  &flush_param);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      streamEnded
+ *
+ *  DESCRIPTION
+ *      Returns the stream transmit state to idle, then answers a device info
+ *      request which arrived during the stream.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void streamEnded(void)
+{
+    TimerDelete(stream_send_retry_tid);
+    stream_send_retry_tid = TIMER_INVALID;
+    stream_send_retry_count = 0;
+
+    app_stream_state.tx.status = stream_send_idle;
+    app_stream_state.tx.sn = 0;
+
+    if(device_info_pending)
+    {
+        device_info_pending = FALSE;
+        sendDeviceInfo(device_info_dest_id);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendDeviceInfo
+ *
+ *  DESCRIPTION
+ *      Sends the device info to a device in a data stream. If another stream,
+ *      such as a location report, is being sent it is not cut short, the
+ *      device info is sent once it ends instead.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendDeviceInfo(uint16 dest_id)
+{
+    if(AppDataStreamIsSending())
+    {
+        if(tx_stream_data != device_info ||
+           app_stream_state.tx.dest_id != dest_id)
+        {
+            device_info_pending = TRUE;
+            device_info_dest_id = dest_id;
         }
+        return;
     }
+
+    /* Set the source device ID as the stream target device */
+    tx_stream_offset = 0;
+    /* Set the opcode to CSR_DEVICE_INFO_RSP */
+    device_info[0] = CSR_DEVICE_INFO_RSP;
+
+    /* start sending the data */
+    startStream(dest_id, device_info, device_info_length + 2);
 }
 
 /*----------------------------------------------------------------------------*
@@ -242,14 +379,15 @@ static void sendNextPacket(void)
     TimerDelete(stream_send_retry_tid);
     stream_send_retry_tid = TIMER_INVALID;
 
-    data_pending = device_info_length+2 - tx_stream_offset;
+    data_pending = tx_stream_length - tx_stream_offset;
 
     if( data_pending )
     {
         len = (data_pending > MAX_DATA_STREAM_PACKET_SIZE)? 
                                 MAX_DATA_STREAM_PACKET_SIZE : data_pending;
 
-        MemCopy(send_param.streamoctets, &device_info[tx_stream_offset],len);
+        MemCopy(send_param.streamoctets, &tx_stream_data[tx_stream_offset],
+                                                                        len);
         send_param.streamoctets_len = len;
         send_param.streamsn = app_stream_state.tx.sn;
                 
@@ -257,6 +395,9 @@ static void sendNextPacket(void)
         DataStreamSend(CSR_MESH_DEFAULT_NETID, app_stream_state.tx.dest_id, 
                                                                   &send_param);
         app_stream_state.tx.last_data_len = len;
+#ifdef ENABLE_DATA_STREAM_STATS
+        stream_stats.packets_sent++;
+#endif /* ENABLE_DATA_STREAM_STATS */
 
         stream_send_retry_tid = TimerCreate(STREAM_SEND_RETRY_TIME, TRUE,
                                                        streamSendRetryTimer);
@@ -315,6 +456,13 @@ static void handleCSRmeshDataStreamFlushInd(
         rx_stream_in_progress = FALSE;
         TimerDelete(rx_stream_timeout_tid);
         rx_stream_timeout_tid = TIMER_INVALID;
+
+        if(current_stream_code == CSR_DEVICE_INFO_SET)
+        {
+            /* Advertise the new device info */
+            current_stream_code = 0;
+            UserAdvertsUpdate();
+        }
     }
 }
 
@@ -336,13 +484,7 @@ static void handleCSRmeshDataBlockInd(uint16 src_id,
     {
         case CSR_DEVICE_INFO_REQ:
         {
-            /* Set the source device ID as the stream target device */
-            tx_stream_offset = 0;
-            /* Set the opcode to CSR_DEVICE_INFO_RSP */
-            device_info[0] = CSR_DEVICE_INFO_RSP;
-
-            /* start sending the data */
-            startStream(src_id);
+            sendDeviceInfo(src_id);
         }
         break;
 
@@ -354,8 +496,18 @@ static void handleCSRmeshDataBlockInd(uint16 src_id,
             device_info[1] = device_info_length;
             MemCopy(&device_info[2], DEVICE_INFO_STRING,
                                                    sizeof(DEVICE_INFO_STRING));
+            UserAdvertsUpdate();
+        }
+        break;
+
+#ifdef ENABLE_DATA_STREAM_STATS
+        case CSR_STREAM_STATS_REQ:
+        {
+            /* Report the statistics to the requesting device */
+            sendStreamStats(src_id);
         }
         break;
+#endif /* ENABLE_DATA_STREAM_STATS */
 
         default:
         break;
@@ -391,12 +543,7 @@ static void handleCSRmeshDataStreamDataInd(uint16 src_id,
         {
             case CSR_DEVICE_INFO_REQ:
             {
-                /* Set the source device ID as the stream target device */
-                tx_stream_offset = 0;
-                /* Set the stream code to CSR_DEVICE_INFO_RSP */
-                device_info[0] = CSR_DEVICE_INFO_RSP;
-                /* Start the stream */
-                startStream(src_id);
+                sendDeviceInfo(src_id);
             }
             break;
 
@@ -408,6 +555,7 @@ static void handleCSRmeshDataStreamDataInd(uint16 src_id,
                 device_info[1] = device_info_length;
                 MemCopy(&device_info[2], DEVICE_INFO_STRING,
                                                     sizeof(DEVICE_INFO_STRING));
+                UserAdvertsUpdate();
             }
             break;
 
@@ -420,12 +568,14 @@ static void handleCSRmeshDataStreamDataInd(uint16 src_id,
                 device_info_length = p_event->streamoctets[1];
                 MemCopy(device_info, p_event->streamoctets,
                                                     p_event->streamoctets_len);
-                rx_stream_offset = p_event->streamoctets_len;
             }
             break;
             default:
             break;
         }
+
+        /* Only the first packet of a stream carries the CODE */
+        rx_stream_offset = p_event->streamoctets_len;
     }
     else
     {
@@ -434,8 +584,8 @@ static void handleCSRmeshDataStreamDataInd(uint16 src_id,
         {
             MemCopy(&device_info[rx_stream_offset], p_event->streamoctets,
                                                     p_event->streamoctets_len);
-            rx_stream_offset += p_event->streamoctets_len;
         }
+        rx_stream_offset += p_event->streamoctets_len;
 
         /* No other CODE is handled currently */
     }
@@ -457,6 +607,9 @@ static void handleCSRmeshDataStreamSendCfm(
 {
     
     tx_stream_offset += app_stream_state.tx.last_data_len;
+#ifdef ENABLE_DATA_STREAM_STATS
+    stream_stats.bytes_acked += app_stream_state.tx.last_data_len;
+#endif /* ENABLE_DATA_STREAM_STATS */
     /* Send next block if it is not end of string */
     sendNextPacket();
 }
@@ -468,16 +621,19 @@ static void handleCSRmeshDataStreamSendCfm(
  *  DESCRIPTION
  *      Initialises the stream model to start sending a data stream. 
  *      This function sets the receiver device ID to which the data is to be
- *      sent using the StreamSendData
+ *      sent using the StreamSendData and the data to be sent. The data must
+ *      stay unchanged until the stream ends. The start flush is retried
+ *      until it is acknowledged, or the stream ends after MAX_SEND_RETRIES.
  *
  *  RETURNS/MODIFIES
  *      Nothing
  *
  *----------------------------------------------------------------------------*/
-static void startStream(uint16 dest_id)
+static void startStream(uint16 dest_id, const uint8 *p_data, uint16 length)
 {
-    CSRMESH_DATA_STREAM_FLUSH_T flush_param;
     app_stream_state.tx.dest_id = dest_id;
+    tx_stream_data = p_data;
+    tx_stream_length = length;
 
     /* Initialise the next expected sequence number to 0 */
     app_stream_state.tx.sn = 0;
@@ -485,9 +641,23 @@ static void startStream(uint16 dest_id)
     app_stream_state.tx.status = stream_start_flush_sent;
     app_stream_state.tx.last_data_len = 0;
 
+#ifdef ENABLE_DATA_STREAM_STATS
+    /* Restart the per stream counters */
+    stream_stats.streams_started++;
+    stream_stats.packets_sent = 0;
+    stream_stats.retransmissions = 0;
+    stream_stats.bytes_acked = 0;
+    stream_stats.duration = 0;
+    stream_start_time = TimeGet32();
+#endif /* ENABLE_DATA_STREAM_STATS */
+
     /* Send flush to indicate start of stream */
-    flush_param.streamsn = app_stream_state.tx.sn;
-    DataStreamFlush(CSR_MESH_DEFAULT_NETID, dest_id, &flush_param);
+    sendFlush();
+
+    stream_send_retry_count = 0;
+    TimerDelete(stream_send_retry_tid);
+    stream_send_retry_tid = TimerCreate(STREAM_SEND_RETRY_TIME, TRUE,
+                                                       streamSendRetryTimer);
 }
 
 /*----------------------------------------------------------------------------*
@@ -495,7 +665,9 @@ static void startStream(uint16 dest_id)
  *      endStream
  *
  *  DESCRIPTION
- *      Sends flush to end stream and updates the stream transmit state
+ *      Sends flush to end stream and updates the stream transmit state. The
+ *      end flush is retried until it is acknowledged, or the stream ends
+ *      after MAX_SEND_RETRIES.
  *
  *  RETURNS/MODIFIES
  *      Nothing
@@ -503,17 +675,53 @@ static void startStream(uint16 dest_id)
  *----------------------------------------------------------------------------*/
 static void endStream(void)
 {
-    CSRMESH_DATA_STREAM_FLUSH_T flush_param;
-    if(app_stream_state.tx.status == stream_send_in_progress)
-    {
-        app_stream_state.tx.status = stream_finish_flush_sent;
-        app_stream_state.tx.last_data_len = 0;
-    }
+    app_stream_state.tx.status = stream_finish_flush_sent;
+    app_stream_state.tx.last_data_len = 0;
+
     /* Send flush to end stream */
-    flush_param.streamsn = app_stream_state.tx.sn;
-    DataStreamFlush(CSR_MESH_DEFAULT_NETID, app_stream_state.tx.dest_id, 
-                                                                  &flush_param);
+    sendFlush();
+
+    stream_send_retry_count = 0;
+    TimerDelete(stream_send_retry_tid);
+    stream_send_retry_tid = TimerCreate(STREAM_SEND_RETRY_TIME, TRUE,
+                                                       streamSendRetryTimer);
+}
+
+#ifdef ENABLE_DATA_STREAM_STATS
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendStreamStats
+ *
+ *  DESCRIPTION
+ *      Sends the statistics of the last stream in a CSR_STREAM_STATS_RSP
+ *      data block. The fields are sent little endian in the order: packets
+ *      sent, retransmissions, bytes acknowledged and duration in
+ *      milliseconds.
+ *
+ *  RETURNS/MODIFIES
+ *      Nothing
+ *
+ *----------------------------------------------------------------------------*/
+static void sendStreamStats(uint16 dest_id)
+{
+    CSRMESH_DATA_BLOCK_SEND_T block_param;
+    uint16 duration = (stream_stats.duration > 0xFFFF) ?
+                                0xFFFF : (uint16)stream_stats.duration;
+
+    block_param.datagramoctets[0] = CSR_STREAM_STATS_RSP;
+    block_param.datagramoctets[1] = stream_stats.packets_sent & 0xFF;
+    block_param.datagramoctets[2] = stream_stats.packets_sent >> 8;
+    block_param.datagramoctets[3] = stream_stats.retransmissions & 0xFF;
+    block_param.datagramoctets[4] = stream_stats.retransmissions >> 8;
+    block_param.datagramoctets[5] = stream_stats.bytes_acked & 0xFF;
+    block_param.datagramoctets[6] = stream_stats.bytes_acked >> 8;
+    block_param.datagramoctets[7] = duration & 0xFF;
+    block_param.datagramoctets[8] = duration >> 8;
+    block_param.datagramoctets_len = STREAM_STATS_RSP_LEN;
+
+    DataBlockSend(CSR_MESH_DEFAULT_NETID, dest_id, &block_param);
 }
+#endif /* ENABLE_DATA_STREAM_STATS */
 
 
 /*=============================================================================*
@@ -557,9 +765,92 @@ extern void AppDataStreamInit(uint16 *group_id_list, uint16 num_groups)
     app_stream_state.tx.dest_id = 0;
     app_stream_state.tx.status = stream_send_idle;
     app_stream_state.tx.last_data_len = 0;
+    device_info_pending = FALSE;
 
     MemCopy(&device_info[2], DEVICE_INFO_STRING, sizeof(DEVICE_INFO_STRING));
+
+#ifdef ENABLE_DATA_STREAM_STATS
+    AppDataStreamResetStats();
+#endif /* ENABLE_DATA_STREAM_STATS */
+}
+
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      AppDataStreamIsSending
+ *
+ *  DESCRIPTION
+ *      This function checks whether a data stream is being sent.
+ *
+ *  RETURNS
+ *      TRUE if a stream is being sent.
+ *
+ *----------------------------------------------------------------------------*/
+extern bool AppDataStreamIsSending(void)
+{
+    return (app_stream_state.tx.status != stream_send_idle);
+}
+
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      AppDataStreamSendReport
+ *
+ *  DESCRIPTION
+ *      This function sends a report to a device in a data stream. The report
+ *      must stay unchanged until the stream ends.
+ *
+ *  RETURNS
+ *      TRUE if the stream was started, FALSE if a stream is already being
+ *      sent.
+ *
+ *----------------------------------------------------------------------------*/
+extern bool AppDataStreamSendReport(uint16 dest_id, const uint8 *p_data,
+                                    uint16 length)
+{
+    if(AppDataStreamIsSending())
+    {
+        return FALSE;
+    }
+
+    tx_stream_offset = 0;
+    startStream(dest_id, p_data, length);
+
+    return TRUE;
+}
+
+#ifdef ENABLE_DATA_STREAM_STATS
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppDataStreamGetStats
+ *
+ *  DESCRIPTION
+ *      This function returns the data stream transfer statistics.
+ *
+ *  RETURNS
+ *      Pointer to the statistics.
+ *
+ *---------------------------------------------------------------------------*/
+extern const APP_DATA_STREAM_STATS_T *AppDataStreamGetStats(void)
+{
+    return &stream_stats;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppDataStreamResetStats
+ *
+ *  DESCRIPTION
+ *      This function clears the data stream transfer statistics.
+ *
+ *  RETURNS
+ *      Nothing
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppDataStreamResetStats(void)
+{
+    MemSet(&stream_stats, 0, sizeof(stream_stats));
+    stream_start_time = 0;
 }
+#endif /* ENABLE_DATA_STREAM_STATS */
 
 
 /*----------------------------------------------------------------------------*
@@ -748,8 +1039,12 @@ CSRmeshResult AppDataClientHandler(CSRMESH_MODEL_EVENT_T event_code,
                 /* Received the acknowledgement for the stream flush sent
                  * to finish the stream
                  */
-                app_stream_state.tx.status = stream_send_idle;
-                app_stream_state.tx.sn = 0;
+#ifdef ENABLE_DATA_STREAM_STATS
+                stream_stats.streams_completed++;
+                stream_stats.duration = (uint32)TimeSub(TimeGet32(),
+                                              stream_start_time) / MILLISECOND;
+#endif /* ENABLE_DATA_STREAM_STATS */
+                streamEnded();
             }
             
             /* nesn must be tx.sn + tx.last_data_len */
@@ -48,9 +48,28 @@ typedef enum
     CSR_DEVICE_INFO_SET = 0x03,
     CSR_DEVICE_INFO_RESET = 0x04,
     USER_LOCATION_REPORT = 0x05,
-    USER_ADV_DATA = 0x06
+    USER_ADV_DATA = 0x06,
+    CSR_STREAM_STATS_REQ = 0x07,
+    CSR_STREAM_STATS_RSP = 0x08
 }APP_DATA_STREAM_CODE_T;
 
+#ifdef ENABLE_DATA_STREAM_STATS
+/* Transfer statistics of the data streams sent by this device. The per stream
+ * fields describe the last stream started, the totals cover all streams since
+ * the last reset.
+ */
+typedef struct
+{
+    uint16 streams_started;   /* Streams started */
+    uint16 streams_completed; /* Streams acknowledged up to the end flush */
+    uint16 streams_aborted;   /* Streams ended after MAX_SEND_RETRIES */
+    uint16 packets_sent;      /* Stream packets sent in the last stream */
+    uint16 retransmissions;   /* Retransmitted packets in the last stream */
+    uint16 bytes_acked;       /* Stream octets acknowledged in last stream */
+    uint32 duration;          /* Start to end flush ack of last stream (ms) */
+}APP_DATA_STREAM_STATS_T;
+#endif /* ENABLE_DATA_STREAM_STATS */
+
 extern uint8 device_info[];
 
 /*============================================================================*
@@ -66,5 +85,20 @@ CSRmeshResult AppDataServerHandler(CSRMESH_MODEL_EVENT_T event_code,
                                    CSRMESH_EVENT_DATA_T* data,
                                    CsrUint16 length,
                                    void **state_data);
+
+/* Checks whether a data stream is being sent */
+bool AppDataStreamIsSending(void);
+
+/* Sends a report to a device in a data stream */
+bool AppDataStreamSendReport(uint16 dest_id, const uint8 *p_data,
+                             uint16 length);
+
+#ifdef ENABLE_DATA_STREAM_STATS
+/* Returns the data stream transfer statistics */
+const APP_DATA_STREAM_STATS_T *AppDataStreamGetStats(void);
+
+/* Clears the data stream transfer statistics */
+void AppDataStreamResetStats(void);
+#endif /* ENABLE_DATA_STREAM_STATS */
 #endif /* __APP_DATA_STREAM_H__ */
 
@@ -34,6 +34,9 @@
 #include "csr_ota.h"
 #include "csr_ota_service.h"
 #include "gatt_service.h"
+#include "mesh_control_service.h"
+#include "app_dup_filter.h"
+#include "app_location.h"
 
 /*============================================================================*
  *  Private Data
@@ -700,6 +703,37 @@ extern void HandleSignalGattAccessInd(GATT_ACCESS_IND_T *p_event_data)
 }
 
 
+#ifdef ENABLE_ATT_MTU_EXCHANGE
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      HandleSignalGattExchangeMtuInd
+ *
+ *  DESCRIPTION
+ *      This function handles GATT_EXCHANGE_MTU_IND message. The client MTU is
+ *      accepted up to ATT_MTU_MAX and the resulting MTU is used for the mesh
+ *      control service transfers on this connection.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void HandleSignalGattExchangeMtuInd(
+                                    GATT_EXCHANGE_MTU_IND_T *p_event_data)
+{
+    uint16 mtu = p_event_data->mtu;
+
+    /* The MTU in use is the smaller of the client and server MTUs */
+    if(mtu > ATT_MTU_MAX)
+    {
+        mtu = ATT_MTU_MAX;
+    }
+
+    GattExchangeMtuRsp(p_event_data->cid, ATT_MTU_MAX);
+
+    MeshControlSetAttMtu(mtu);
+}
+#endif /* ENABLE_ATT_MTU_EXCHANGE */
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      HandleSignalLmDisconnectComplete
@@ -823,6 +857,16 @@ extern bool HandleLEAdvMessage(LM_EV_ADVERTISING_REPORT_T* report)
 
                     /* Fill in TTL variables */
                     rx_ttl  = unpackedData[index + length];
+                    result = TRUE;
+
+#ifdef ENABLE_DUPLICATE_FILTER
+                    /* Drop exact repeats of a recently received message */
+                    if(AppDupFilterIsDuplicate(&unpackedData[index+4],
+                                               (length-3)))
+                    {
+                        break;
+                    }
+#endif /* ENABLE_DUPLICATE_FILTER */
 
                     /* Update Bearer Event Data structure with incoming Mesh 
                      * Data.
@@ -832,15 +876,18 @@ extern bool HandleLEAdvMessage(LM_EV_ADVERTISING_REPORT_T* report)
                                         CSR_SCHED_INCOMING_LE_MESH_DATA_EVENT,
                                         &unpackedData[index+4], (length-3), 
                                         report->rssi);
-                    result = TRUE;
                     break;
                 }
                 else if (!MemCmp(&unpackedData[index + 1], mydata, 3))
                 {
                     /* Not a mesh data */
-					/*DEBUG_STR(" a phone address data ");*/
-					
-					
+#ifdef ENABLE_LOCATION_REPORT
+                    /* Add the sighting to the window of the tag. The windows
+                     * are reported to the collector together.
+                     */
+                    AppLocationRecordSighting(&(data->address), report->rssi);
+                    break;
+#else
 					CSRMESH_DATA_BLOCK_SEND_T p_send;
 					BD_ADDR_T *myaddress=&(data->address);
 					
@@ -852,30 +899,11 @@ extern bool HandleLEAdvMessage(LM_EV_ADVERTISING_REPORT_T* report)
 					p_send.datagramoctets[5]=(myaddress->lap & 0x00FF00) >> 8;
 					p_send.datagramoctets[6]=(myaddress->lap & 0x0000FF);
                     p_send.datagramoctets[7]=(CsrUint8)report->rssi;
-                    
 
 					p_send.datagramoctets_len=10;
 					
-					/*DEBUG_U8((myaddress->nap & 0xFF00)>>8);*/
-					/*DEBUG_STR(":");*/
-    				/*DEBUG_U8((myaddress->nap & 0x00FF));*/
-					/*DEBUG_STR(":");*/
-    				/*DEBUG_U8(myaddress->uap);*/
-					/*DEBUG_STR(":");*/
-    				/*DEBUG_U8((myaddress->lap & 0xFF0000) >> 16);*/
-					/*DEBUG_STR(":");*/
-    				/*DEBUG_U8((myaddress->lap & 0x00FF00) >> 8);*/
-					/*DEBUG_STR(":");*/
-    				/*DEBUG_U8((myaddress->lap & 0x0000FF));*/
-					/*DEBUG_STR("\n")*/
-                    
-					/*DEBUG_U8(report->rssi);*/
-                    
-
-					
 					DataBlockSend(g_lightapp_data.netId,0x8ffe,&p_send);
-
-					
+#endif /* ENABLE_LOCATION_REPORT */
                 }
 				else
 					{
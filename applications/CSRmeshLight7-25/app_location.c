@@ -0,0 +1,236 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_location.c
+ *
+ *  DESCRIPTION
+ *      This file aggregates the adverts heard from location tags. The RSSI
+ *      of each sighting is added to the window of its tag, and every
+ *      LOCATION_REPORT_INTERVAL the windows are sent to the collector in one
+ *      USER_LOCATION_REPORT data stream:
+ *          |USER_LOCATION_REPORT|number of tags|tag record|tag record|...
+ *      Each tag record holds the BD address of the tag (NAP, UAP then LAP,
+ *      most significant octet first), the mean RSSI of the sightings and the
+ *      number of sightings.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <timer.h>
+#include <mem.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_location.h"
+#include "app_data_stream.h"
+
+#ifdef ENABLE_LOCATION_REPORT
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Largest number of sightings counted for a tag in one window. This keeps
+ * the RSSI sum within 16 bits.
+ */
+#define LOCATION_MAX_SIGHTINGS          (0xFF)
+
+/* Length of the report header: code and number of tags */
+#define LOCATION_REPORT_HDR_LEN         (2)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    BD_ADDR_T addr;     /* BD address of the tag */
+    int16  rssi_sum;    /* Sum of the RSSI of the sightings in the window */
+    uint16 count;       /* Number of sightings in the window */
+}LOCATION_TAG_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Tags heard in the current window */
+static LOCATION_TAG_T location_tags[LOCATION_MAX_TAGS];
+
+/* Number of tags heard in the current window */
+static uint16 location_tag_count;
+
+/* Report being sent to the collector */
+static uint8 location_report[LOCATION_REPORT_HDR_LEN +
+                             LOCATION_MAX_TAGS * LOCATION_TAG_RECORD_LEN];
+
+/* Report timer, running while there are sightings to report */
+static timer_id location_report_tid = TIMER_INVALID;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static void locationReportTimerHandler(timer_id tid);
+static uint16 buildLocationReport(void);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      buildLocationReport
+ *
+ *  DESCRIPTION
+ *      Fills in the report from the windows of the tags heard.
+ *
+ *  RETURNS
+ *      Length of the report.
+ *
+ *---------------------------------------------------------------------------*/
+static uint16 buildLocationReport(void)
+{
+    uint8 *p_record = &location_report[LOCATION_REPORT_HDR_LEN];
+    uint16 index;
+
+    location_report[0] = USER_LOCATION_REPORT;
+    location_report[1] = location_tag_count;
+
+    for(index = 0; index < location_tag_count; index++)
+    {
+        LOCATION_TAG_T *p_tag = &location_tags[index];
+
+        p_record[0] = (p_tag->addr.nap >> 8) & 0xFF;
+        p_record[1] = p_tag->addr.nap & 0xFF;
+        p_record[2] = p_tag->addr.uap & 0xFF;
+        p_record[3] = (p_tag->addr.lap >> 16) & 0xFF;
+        p_record[4] = (p_tag->addr.lap >> 8) & 0xFF;
+        p_record[5] = p_tag->addr.lap & 0xFF;
+        p_record[6] = (p_tag->rssi_sum / (int16)p_tag->count) & 0xFF;
+        p_record[7] = p_tag->count & 0xFF;
+
+        p_record += LOCATION_TAG_RECORD_LEN;
+    }
+
+    return LOCATION_REPORT_HDR_LEN +
+           location_tag_count * LOCATION_TAG_RECORD_LEN;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      locationReportTimerHandler
+ *
+ *  DESCRIPTION
+ *      Sends the windows of the tags heard to the collector and starts new
+ *      windows. If another stream is being sent the sightings are kept and
+ *      reported at the end of the next interval.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void locationReportTimerHandler(timer_id tid)
+{
+    if(tid == location_report_tid)
+    {
+        location_report_tid = TIMER_INVALID;
+
+        /* The previous report may still be being sent from the buffer */
+        if(AppDataStreamIsSending())
+        {
+            location_report_tid = TimerCreate(LOCATION_REPORT_INTERVAL, TRUE,
+                                              locationReportTimerHandler);
+            return;
+        }
+
+        if(location_tag_count)
+        {
+            AppDataStreamSendReport(LOCATION_COLLECTOR_ID, location_report,
+                                    buildLocationReport());
+            location_tag_count = 0;
+        }
+    }
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppLocationInit
+ *
+ *  DESCRIPTION
+ *      This function clears the sightings and stops the report timer.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppLocationInit(void)
+{
+    TimerDelete(location_report_tid);
+    location_report_tid = TIMER_INVALID;
+    location_tag_count = 0;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppLocationRecordSighting
+ *
+ *  DESCRIPTION
+ *      This function adds the RSSI of an advert received from a tag to the
+ *      window of the tag. Sightings of a tag heard after LOCATION_MAX_TAGS
+ *      others in the same window are dropped; the tag is counted in a later
+ *      window from the next advert it sends after the report. The report
+ *      timer is started by the first sighting, so that no timer runs while
+ *      no tags are heard.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppLocationRecordSighting(const BD_ADDR_T *p_addr, int8 rssi)
+{
+    LOCATION_TAG_T *p_tag = NULL;
+    uint16 index;
+
+    for(index = 0; index < location_tag_count; index++)
+    {
+        if(location_tags[index].addr.lap == p_addr->lap &&
+           location_tags[index].addr.uap == p_addr->uap &&
+           location_tags[index].addr.nap == p_addr->nap)
+        {
+            p_tag = &location_tags[index];
+            break;
+        }
+    }
+
+    if(p_tag == NULL)
+    {
+        if(location_tag_count == LOCATION_MAX_TAGS)
+        {
+            return;
+        }
+
+        p_tag = &location_tags[location_tag_count++];
+        p_tag->addr = *p_addr;
+        p_tag->rssi_sum = 0;
+        p_tag->count = 0;
+    }
+
+    if(p_tag->count < LOCATION_MAX_SIGHTINGS)
+    {
+        p_tag->rssi_sum += rssi;
+        p_tag->count++;
+    }
+
+    if(location_report_tid == TIMER_INVALID)
+    {
+        location_report_tid = TimerCreate(LOCATION_REPORT_INTERVAL, TRUE,
+                                          locationReportTimerHandler);
+    }
+}
+
+#endif /* ENABLE_LOCATION_REPORT */
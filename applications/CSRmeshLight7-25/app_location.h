@@ -0,0 +1,56 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_location.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the aggregation of tag sightings into
+ *      USER_LOCATION_REPORT streams
+ *
+ *****************************************************************************/
+
+#ifndef __APP_LOCATION_H__
+#define __APP_LOCATION_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+#include <bluetooth.h>
+#include <time.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+#ifdef ENABLE_LOCATION_REPORT
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Device that collects the location reports */
+#define LOCATION_COLLECTOR_ID           (0x8FFE)
+
+/* Time over which sightings are aggregated into one report */
+#define LOCATION_REPORT_INTERVAL        (5 * SECOND)
+
+/* Number of tags reported in one report */
+#define LOCATION_MAX_TAGS               (8)
+
+/* Length of a tag record: BD address, mean RSSI and number of sightings */
+#define LOCATION_TAG_RECORD_LEN         (8)
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Clears the sightings and stops the report timer */
+extern void AppLocationInit(void);
+
+/* Records the RSSI of an advert received from a tag */
+extern void AppLocationRecordSighting(const BD_ADDR_T *p_addr, int8 rssi);
+
+#endif /* ENABLE_LOCATION_REPORT */
+#endif /* __APP_LOCATION_H__ */
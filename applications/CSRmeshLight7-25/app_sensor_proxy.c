@@ -0,0 +1,354 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_sensor_proxy.c
+ *
+ *  DESCRIPTION
+ *      This file implements the proxy behaviour of the sensor model. The
+ *      light keeps the latest value written by each sensor for each sensor
+ *      type onto each group in a small cache, and answers SENSOR_READ_VALUE
+ *      and SENSOR_MISSING messages sent to a group from the values written
+ *      to that group. A sensor which sleeps most of the
+ *      time then does not have to hear the reads itself, and the reads are
+ *      answered by a light within one hop.
+ *
+ *      The light only hears the values written onto the groups set on its
+ *      sensor model, so those have to include the groups of the sensors.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <mem.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_sensor_proxy.h"
+#include "sensor_server.h"
+
+#ifdef ENABLE_SENSOR_PROXY
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Longest sensor value in octets */
+#define SENSOR_PROXY_MAX_VALUE_LEN      (4)
+
+/* Number of sensor types in a SENSOR_MISSING message */
+#define SENSOR_MISSING_MAX_TYPES        (4)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint16 src_id;              /* Sensor which wrote the value, 0 if unused */
+    uint16 dst_id;              /* Group the value was written to */
+    sensor_type_t type;         /* Sensor type of the value */
+    uint8  value[SENSOR_PROXY_MAX_VALUE_LEN];
+    uint16 value_len;           /* Length of the value in octets */
+    uint32 last_heard;          /* Time the value was last written */
+}SENSOR_PROXY_ENTRY_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Cached sensor values */
+static SENSOR_PROXY_ENTRY_T proxy_cache[SENSOR_PROXY_CACHE_SIZE];
+
+/* Response to the sensor reads */
+static CSRMESH_SENSOR_VALUE_T proxy_rsp;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static void expireValues(uint32 now);
+static void storeValue(uint16 src_id, uint16 dst_id, sensor_type_t type,
+                       const CsrUint8 *p_value, uint16 value_len,
+                       uint32 now);
+static bool packValue(uint16 dst_id, sensor_type_t type, sensor_type_t *p_type,
+                      CsrUint8 *p_value, CsrUint8 *p_value_len);
+static CSRmeshResult sensorProxyHandler(CSRMESH_MODEL_EVENT_T event_code,
+                                        CSRMESH_EVENT_DATA_T* data,
+                                        CsrUint16 length,
+                                        void **state_data);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      expireValues
+ *
+ *  DESCRIPTION
+ *      Drops the values older than SENSOR_PROXY_MAX_AGE. This is done on
+ *      every sensor message, which keeps the ages well within the range of
+ *      the 32 bit time.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void expireValues(uint32 now)
+{
+    uint16 index;
+
+    for(index = 0; index < SENSOR_PROXY_CACHE_SIZE; index++)
+    {
+        int32 age = TimeSub(now, proxy_cache[index].last_heard);
+
+        if(proxy_cache[index].src_id != 0 &&
+           (age < 0 || age > (int32)SENSOR_PROXY_MAX_AGE))
+        {
+            proxy_cache[index].src_id = 0;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      storeValue
+ *
+ *  DESCRIPTION
+ *      Keeps a value written by a sensor to a group. The value replaces the
+ *      previous value of the same sensor, group and type. Otherwise it takes
+ *      a free entry, or the entry heard least recently.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void storeValue(uint16 src_id, uint16 dst_id, sensor_type_t type,
+                       const CsrUint8 *p_value, uint16 value_len,
+                       uint32 now)
+{
+    SENSOR_PROXY_ENTRY_T *p_entry = NULL;
+    uint16 index;
+
+    if(type == sensor_type_invalid || value_len == 0 ||
+       value_len > SENSOR_PROXY_MAX_VALUE_LEN)
+    {
+        return;
+    }
+
+    for(index = 0; index < SENSOR_PROXY_CACHE_SIZE; index++)
+    {
+        SENSOR_PROXY_ENTRY_T *p_cached = &proxy_cache[index];
+
+        if(p_cached->src_id == src_id && p_cached->dst_id == dst_id &&
+           p_cached->type == type)
+        {
+            p_entry = p_cached;
+            break;
+        }
+
+        if(p_entry == NULL || p_cached->src_id == 0 ||
+           (p_entry->src_id != 0 &&
+            TimeSub(now, p_cached->last_heard) > 
+            TimeSub(now, p_entry->last_heard)))
+        {
+            p_entry = p_cached;
+        }
+    }
+
+    p_entry->src_id = src_id;
+    p_entry->dst_id = dst_id;
+    p_entry->type = type;
+    p_entry->value_len = value_len;
+    p_entry->last_heard = now;
+    for(index = 0; index < value_len; index++)
+    {
+        p_entry->value[index] = p_value[index] & 0xFF;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      packValue
+ *
+ *  DESCRIPTION
+ *      Fills in the type and the value most recently written to a group for
+ *      a sensor type in the response. Values written to other groups are not
+ *      used, as they may come from sensors elsewhere.
+ *
+ *  RETURNS
+ *      TRUE if a value of the type is cached.
+ *
+ *---------------------------------------------------------------------------*/
+static bool packValue(uint16 dst_id, sensor_type_t type, sensor_type_t *p_type,
+                      CsrUint8 *p_value, CsrUint8 *p_value_len)
+{
+    SENSOR_PROXY_ENTRY_T *p_entry = NULL;
+    uint32 now = TimeGet32();
+    uint16 index;
+
+    if(type == sensor_type_invalid)
+    {
+        return FALSE;
+    }
+
+    for(index = 0; index < SENSOR_PROXY_CACHE_SIZE; index++)
+    {
+        SENSOR_PROXY_ENTRY_T *p_cached = &proxy_cache[index];
+
+        if(p_cached->src_id != 0 && p_cached->dst_id == dst_id &&
+           p_cached->type == type &&
+           (p_entry == NULL ||
+            TimeSub(now, p_cached->last_heard) <
+            TimeSub(now, p_entry->last_heard)))
+        {
+            p_entry = p_cached;
+        }
+    }
+
+    if(p_entry == NULL)
+    {
+        return FALSE;
+    }
+
+    *p_type = p_entry->type;
+    MemCopy(p_value, p_entry->value, p_entry->value_len);
+    *p_value_len = p_entry->value_len;
+
+    return TRUE;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sensorProxyHandler
+ *
+ *  DESCRIPTION
+ *      Handles the sensor model messages. Values written by the sensors are
+ *      cached, and reads and missing value messages are answered with the
+ *      cached values of up to two of the types asked for. The light is not a
+ *      sensor itself, so no other messages are answered.
+ *
+ *  RETURNS
+ *      CSR_MESH_RESULT_SUCCESS.
+ *
+ *---------------------------------------------------------------------------*/
+static CSRmeshResult sensorProxyHandler(CSRMESH_MODEL_EVENT_T event_code,
+                                        CSRMESH_EVENT_DATA_T* data,
+                                        CsrUint16 length,
+                                        void **state_data)
+{
+    uint32 now = TimeGet32();
+    bool send_rsp = FALSE;
+
+    expireValues(now);
+
+    MemSet(&proxy_rsp, 0x0000, sizeof(proxy_rsp));
+
+    switch(event_code)
+    {
+        case CSRMESH_SENSOR_WRITE_VALUE:
+        case CSRMESH_SENSOR_WRITE_VALUE_NO_ACK:
+        {
+            CSRMESH_SENSOR_WRITE_VALUE_T *p_event = 
+                                    (CSRMESH_SENSOR_WRITE_VALUE_T *)data->data;
+
+            storeValue(data->src_id, data->dst_id, p_event->type,
+                       p_event->value, p_event->value_len, now);
+            storeValue(data->src_id, data->dst_id, p_event->type2,
+                       p_event->value2, p_event->value2_len, now);
+        }
+        break;
+
+        case CSRMESH_SENSOR_VALUE:
+        {
+            CSRMESH_SENSOR_VALUE_T *p_event = 
+                                    (CSRMESH_SENSOR_VALUE_T *)data->data;
+
+            storeValue(data->src_id, data->dst_id, p_event->type,
+                       p_event->value, p_event->value_len, now);
+            storeValue(data->src_id, data->dst_id, p_event->type2,
+                       p_event->value2, p_event->value2_len, now);
+        }
+        break;
+
+        case CSRMESH_SENSOR_READ_VALUE:
+        {
+            CSRMESH_SENSOR_READ_VALUE_T *p_event = 
+                                    (CSRMESH_SENSOR_READ_VALUE_T *)data->data;
+
+            if(packValue(data->dst_id, p_event->type, &proxy_rsp.type,
+                         proxy_rsp.value, &proxy_rsp.value_len))
+            {
+                send_rsp = TRUE;
+            }
+
+            if(packValue(data->dst_id, p_event->type2, &proxy_rsp.type2,
+                         proxy_rsp.value2, &proxy_rsp.value2_len))
+            {
+                send_rsp = TRUE;
+            }
+
+            proxy_rsp.tid = p_event->tid;
+        }
+        break;
+
+        case CSRMESH_SENSOR_MISSING:
+        {
+            CSRMESH_SENSOR_MISSING_T *p_event = 
+                                    (CSRMESH_SENSOR_MISSING_T *)data->data;
+            uint16 index;
+
+            for(index = 0; index < SENSOR_MISSING_MAX_TYPES; index++)
+            {
+                if(!send_rsp)
+                {
+                    send_rsp = packValue(data->dst_id, p_event->types[index],
+                                         &proxy_rsp.type, proxy_rsp.value,
+                                         &proxy_rsp.value_len);
+                }
+                else if(packValue(data->dst_id, p_event->types[index],
+                                  &proxy_rsp.type2, proxy_rsp.value2,
+                                  &proxy_rsp.value2_len))
+                {
+                    break;
+                }
+            }
+        }
+        break;
+
+        default:
+        break;
+    }
+
+    if(state_data != NULL)
+    {
+        *state_data = send_rsp ? (void *)&proxy_rsp : NULL;
+    }
+
+    return CSR_MESH_RESULT_SUCCESS;
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppSensorProxyInit
+ *
+ *  DESCRIPTION
+ *      This function initialises the sensor model on the groups given and
+ *      empties the cache.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppSensorProxyInit(uint16 *group_id_list, uint16 num_groups)
+{
+    MemSet(proxy_cache, 0x0000, sizeof(proxy_cache));
+
+    SensorModelInit(0, group_id_list, num_groups, sensorProxyHandler);
+}
+
+#endif /* ENABLE_SENSOR_PROXY */
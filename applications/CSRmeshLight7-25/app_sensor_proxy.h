@@ -0,0 +1,46 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_sensor_proxy.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the cache of sensor values which the light
+ *      answers sensor reads from
+ *
+ *****************************************************************************/
+
+#ifndef __APP_SENSOR_PROXY_H__
+#define __APP_SENSOR_PROXY_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+#include <time.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+#ifdef ENABLE_SENSOR_PROXY
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Number of (device, sensor type) values cached */
+#define SENSOR_PROXY_CACHE_SIZE         (8)
+
+/* A cached value is not used to answer once it is older than this */
+#define SENSOR_PROXY_MAX_AGE            (10 * 60 * SECOND)
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Initialises the sensor model and empties the cache */
+extern void AppSensorProxyInit(uint16 *group_id_list, uint16 num_groups);
+
+#endif /* ENABLE_SENSOR_PROXY */
+#endif /* __APP_SENSOR_PROXY_H__ */
@@ -51,6 +51,9 @@
 #include "csr_ota.h"
 #include "csr_ota_service.h"
 #include "gatt_service.h"
+#include "app_dup_filter.h"
+#include "app_location.h"
+#include "app_sensor_proxy.h"
 
 /*============================================================================*
  *  Private Definitions
@@ -84,6 +87,9 @@ uint16 light_model_groups[MAX_MODEL_GROUPS];
 uint16 power_model_groups[MAX_MODEL_GROUPS];
 uint16 attention_model_groups[MAX_MODEL_GROUPS];
 uint16 data_model_groups[MAX_MODEL_GROUPS];
+#ifdef ENABLE_SENSOR_PROXY
+uint16 sensor_model_groups[MAX_MODEL_GROUPS];
+#endif /* ENABLE_SENSOR_PROXY */
 
 /*============================================================================*
  *  Private Function Prototypes
@@ -263,6 +269,13 @@ void AppInit(sleep_state last_sleep_state)
     */
     GattInstallServerWriteLongReliable();
 
+#ifdef ENABLE_ATT_MTU_EXCHANGE
+    /* Install GATT Server support for the Exchange MTU procedure so that
+     * mesh messages can be transferred in a single ATT operation.
+     */
+    GattInstallServerExchangeMtu();
+#endif /* ENABLE_ATT_MTU_EXCHANGE */
+
 #ifdef USE_STATIC_RANDOM_ADDRESS
     /* Generate random address for the CSRmesh Device. */
     GenerateStaticRandomAddress(&g_lightapp_data.random_bd_addr);
@@ -293,6 +306,11 @@ void AppInit(sleep_state last_sleep_state)
 
     /* Intialise application data */
     AppDataInit();
+
+#ifdef ENABLE_DUPLICATE_FILTER
+    /* Clear the received advert duplicate cache */
+    AppDupFilterInit();
+#endif /* ENABLE_DUPLICATE_FILTER */
     
     /* Initialise CSRmesh light application State */
     AppSetState(app_state_init);
@@ -354,6 +372,16 @@ void AppInit(sleep_state last_sleep_state)
         AppDataStreamInit(data_model_groups, MAX_MODEL_GROUPS);
 #endif /* ENABLE_DATA_MODEL */
 
+#ifdef ENABLE_LOCATION_REPORT
+        /* Start with no tag sightings */
+        AppLocationInit();
+#endif /* ENABLE_LOCATION_REPORT */
+
+#ifdef ENABLE_SENSOR_PROXY
+        /* Initialize the sensor model to proxy the sensor values */
+        AppSensorProxyInit(sensor_model_groups, MAX_MODEL_GROUPS);
+#endif /* ENABLE_SENSOR_PROXY */
+
         /* Start CSRmesh */
         result = CSRmeshStart();
 
@@ -639,6 +667,14 @@ bool AppProcessLmEvent(lm_event_code event_code,
             HandleSignalGattAccessInd((GATT_ACCESS_IND_T*)p_event_data);
         break;
 
+#ifdef ENABLE_ATT_MTU_EXCHANGE
+        case GATT_EXCHANGE_MTU_IND:
+            /* Client has started the Exchange MTU procedure */
+            HandleSignalGattExchangeMtuInd(
+                                    (GATT_EXCHANGE_MTU_IND_T*)p_event_data);
+        break;
+#endif /* ENABLE_ATT_MTU_EXCHANGE */
+
         case GATT_DISCONNECT_IND:
             /* Disconnect procedure triggered by remote host or due to
              * link loss is considered complete on reception of
@@ -45,12 +45,21 @@
 /*! \brief Bluetooth SIG Organization identifier for CSRmesh device appearance */
 #define APPEARANCE_ORG_BLUETOOTH_SIG   (0)
 
+#ifdef ENABLE_LOCATION_REPORT
+/* Location report timer */
+#define LOCATION_REPORT_TIMERS         (1)
+#else
+#define LOCATION_REPORT_TIMERS         (0)
+#endif /* ENABLE_LOCATION_REPORT */
+
  #ifdef ENABLE_DEVICE_UUID_ADVERTS
 /* Maximum number of timers */
-#define MAX_APP_TIMERS                 (9 + CSR_MESH_MAX_NO_TIMERS)
+#define MAX_APP_TIMERS                 (9 + LOCATION_REPORT_TIMERS + \
+                                        CSR_MESH_MAX_NO_TIMERS)
 #else
 /* Maximum number of timers */
-#define MAX_APP_TIMERS                 (8 + CSR_MESH_MAX_NO_TIMERS)
+#define MAX_APP_TIMERS                 (8 + LOCATION_REPORT_TIMERS + \
+                                        CSR_MESH_MAX_NO_TIMERS)
 #endif /* ENABLE_DEVICE_UUID_ADVERTS */
 
 /* TGAP(conn_pause_peripheral) defined in Core Specification Addendum 3 Revision
@@ -132,10 +141,19 @@
 #define SIZEOF_DATA_MODEL_GROUPS       (0)
 #endif /* ENABLE_DATA_MODEL */
 
-/* NVM Offset for Application data */
-#define NVM_MAX_APP_MEMORY_WORDS       (NVM_OFFSET_DATA_MODEL_GROUPS + \
+#define NVM_OFFSET_SENSOR_MODEL_GROUPS (NVM_OFFSET_DATA_MODEL_GROUPS + \
                                         SIZEOF_DATA_MODEL_GROUPS)
 
+#ifdef ENABLE_SENSOR_PROXY
+#define SIZEOF_SENSOR_MODEL_GROUPS     (sizeof(uint16)*MAX_MODEL_GROUPS)
+#else
+#define SIZEOF_SENSOR_MODEL_GROUPS     (0)
+#endif /* ENABLE_SENSOR_PROXY */
+
+/* NVM Offset for Application data */
+#define NVM_MAX_APP_MEMORY_WORDS       (NVM_OFFSET_SENSOR_MODEL_GROUPS + \
+                                        SIZEOF_SENSOR_MODEL_GROUPS)
+
 /* The User key index where the application config flags are stored */
 #define CSKEY_INDEX_USER_FLAGS         (0)
 
@@ -288,6 +306,9 @@ extern uint16 light_model_groups[MAX_MODEL_GROUPS];
 extern uint16 power_model_groups[MAX_MODEL_GROUPS];
 extern uint16 attention_model_groups[MAX_MODEL_GROUPS];
 extern uint16 data_model_groups[MAX_MODEL_GROUPS];
+#ifdef ENABLE_SENSOR_PROXY
+extern uint16 sensor_model_groups[MAX_MODEL_GROUPS];
+#endif /* ENABLE_SENSOR_PROXY */
 
 /* CSR mesh test application specific data */
 extern CSRMESH_LIGHT_APP_DATA_T g_lightapp_data;
@@ -55,19 +55,35 @@
 CsrUint8 ad_data[MAX_USER_ADV_DATA_LEN];
 CsrUint8 scan_rsp_data[MAX_USER_ADV_DATA_LEN];
 
-CsrUint8 user_ad_data[MAX_USER_ADV_DATA_LEN];
+/* User advert with the advertising parameters filled in */
+static CSR_SCHED_ADV_DATA_T user_adv;
 
-static CsrUint8 user_ad_index=0;
+/* Set once the advertising parameters of user_adv are filled in */
+static bool user_adv_params_valid = FALSE;
 
-static CsrUint8 user_ad_total=0;
+/* Length of the device_info octets sent in the user adverts, taken when
+ * device_info changes. The payload of each advert is copied from device_info
+ * when it is sent rather than kept in a frame of its own.
+ */
+static uint16 user_ad_length = 0;
 
-static CsrUint8 user_ad_offset=0;
+/* Number of user adverts in a round, 0 until they are built */
+static uint16 user_ad_frame_count = 0;
 
-static CsrUint8 user_ad_offset2=0;
+/* User advert sent next */
+static uint16 user_ad_frame_next = 0;
 
-static CsrUint8 user_ad_length=0;
+/* Interval between rounds of user adverts when connected */
+static uint32 user_ad_interval = USER_AD_FAST_INTERVAL;
 
-static CsrUint8 user_ad_length2=0;
+/* Rounds of user adverts left at USER_AD_FAST_INTERVAL */
+static uint16 user_ad_fast_cycles = USER_AD_FAST_CYCLES;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static void buildUserAdverts(void);
+static void fillUserAdvert(uint16 frame);
 
 /*============================================================================*
  *  Private Function Implementations
@@ -84,6 +100,91 @@ static CsrUint8 user_ad_length2=0;
         UserAdverts(FALSE);
     }
 }
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      buildUserAdverts
+ *
+ *  DESCRIPTION
+ *      This function works out how device_info is split into the user
+ *      adverts. The advertising parameters and the part of the AD header
+ *      that is the same in every advert, which do not change, are filled in
+ *      the first time.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void buildUserAdverts(void)
+{
+    BD_ADDR_T addr;
+
+    if(!user_adv_params_valid)
+    {
+        CSReadBdaddr(&addr);
+        MemCopy(&user_adv.adv_params.bd_addr.addr, &addr, sizeof(BD_ADDR_T));
+        user_adv.adv_params.bd_addr.type = L2CA_RANDOM_ADDR_TYPE;
+
+        user_adv.adv_params.adv_type = ls_advert_non_connectable;
+        user_adv.adv_params.role = gap_role_broadcaster;
+        user_adv.adv_params.bond = gap_mode_bond_no;
+        user_adv.adv_params.connect_mode = gap_mode_connect_no;
+        user_adv.adv_params.discover_mode = gap_mode_discover_no;
+        user_adv.adv_params.security_mode = gap_mode_security_none;
+        user_adv.ad_data_length = MAX_USER_ADV_DATA_LEN;
+        user_adv.ad_data[1] = AD_TYPE_MANUF;
+        user_adv.ad_data[2] = 0x0A;
+        user_adv.ad_data[3] = 0x00;
+
+        user_adv_params_valid = TRUE;
+    }
+
+    user_ad_length = 0;
+    user_ad_frame_count = 0;
+    user_ad_frame_next = 0;
+
+    /* device_info[1] holds the length, the octets sent start at [2] */
+    if(device_info[1] <= 2)
+    {
+        return;
+    }
+    user_ad_length = device_info[1] - 2;
+    user_ad_frame_count = (user_ad_length + USER_AD_CHUNK_LEN - 1) /
+                                                          USER_AD_CHUNK_LEN;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      fillUserAdvert
+ *
+ *  DESCRIPTION
+ *      This function fills the AD data of user_adv with a user advert: the
+ *      length octet, the frame octet (frame index in the low nibble, number
+ *      of frames in the high nibble) and the chunk of device_info it
+ *      carries.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void fillUserAdvert(uint16 frame)
+{
+    uint16 offset = frame * USER_AD_CHUNK_LEN;
+    uint16 chunk_len = user_ad_length - offset;
+
+    if(chunk_len > USER_AD_CHUNK_LEN)
+    {
+        chunk_len = USER_AD_CHUNK_LEN;
+    }
+
+    user_adv.ad_data[0] = chunk_len + 4;
+    user_adv.ad_data[4] = frame + (user_ad_frame_count << 4);
+    MemCopy(&user_adv.ad_data[5], &device_info[2 + offset], chunk_len);
+
+    /* Pad with zeros so that nothing follows the chunk AD structure */
+    MemSet(&user_adv.ad_data[5 + chunk_len], 0,
+           MAX_USER_ADV_DATA_LEN - 5 - chunk_len);
+}
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      getSupported16BitUUIDServiceList
@@ -617,63 +718,38 @@ extern void UserStopAdverts(void)
 
 extern void UserAdverts(bool is_gatt_adv)
 {
-	if((g_lightapp_data.bearer_tx_state.bearerEnabled &
-                                                     GATT_SERVER_BEARER_ACTIVE))
-	{CSRSchedResult result = CSR_SCHED_RESULT_FAILURE;
-    CSR_SCHED_ADV_DATA_T user_adv;
-	
-	
-	BD_ADDR_T addr;
-	CSReadBdaddr(&addr);
-	MemCopy(&user_adv.adv_params.bd_addr.addr, 
-            &addr, 
-            sizeof(BD_ADDR_T));
-	user_adv.adv_params.bd_addr.type = L2CA_RANDOM_ADDR_TYPE;
-
-	user_adv.adv_params.adv_type = ls_advert_non_connectable;
-	user_adv.adv_params.role = gap_role_broadcaster;
-    user_adv.adv_params.bond = gap_mode_bond_no;
-    user_adv.adv_params.connect_mode = gap_mode_connect_no;
-    user_adv.adv_params.discover_mode = gap_mode_discover_no;
-    user_adv.adv_params.security_mode = gap_mode_security_none;
-
-	if (user_ad_length != device_info[1]-2)
+	if(user_ad_frame_count == 0)
 	{
-		user_ad_index = 0;
-		user_ad_offset = 0;
-		user_ad_length = device_info[1]-2;
-		user_ad_total = (user_ad_length + 22) / 23;
-	}
-	
-	if ((user_ad_length - user_ad_offset)<=23)
-	{
-		user_ad_data[4] = user_ad_index + (user_ad_total << 4);
-		user_ad_length2 = user_ad_length - user_ad_offset;
-		user_ad_index = 0;
-		user_ad_offset = 0;
-		user_ad_offset2 = user_ad_offset;
-	}
-	else
-	{
-		user_ad_length2 = 23;
-		user_ad_data[4] = user_ad_index + (user_ad_total << 4);
-		user_ad_offset2 = user_ad_offset;
-		user_ad_offset += 23;
-		++user_ad_index;
+		buildUserAdverts();
 	}
 
-	user_ad_data[0] = user_ad_length2 + 4;
-	user_ad_data[1] = AD_TYPE_MANUF;
-	user_ad_data[2] = 0x0A;
-	user_ad_data[3] = 0x00;	
+	if((g_lightapp_data.bearer_tx_state.bearerEnabled &
+                                                     GATT_SERVER_BEARER_ACTIVE)
+	   && user_ad_frame_count)
+	{
+	fillUserAdvert(user_ad_frame_next);
+	CSRSchedSendUserAdv(&user_adv, NULL);
 
-	MemCopy(&user_ad_data[5],&device_info[2 + user_ad_offset2],user_ad_length2);
-	
+	user_ad_frame_next = (user_ad_frame_next + 1) % user_ad_frame_count;
 
-	MemCopy(user_adv.ad_data, user_ad_data, MAX_USER_ADV_DATA_LEN);
-    user_adv.ad_data_length = MAX_USER_ADV_DATA_LEN;
-	
-	result = CSRSchedSendUserAdv(&user_adv, NULL);
+	/* Slow down after every round of chunks once the fast rounds are
+	 * done
+	 */
+	if(user_ad_frame_next == 0)
+	{
+		if(user_ad_fast_cycles)
+		{
+			user_ad_fast_cycles--;
+		}
+		else if(user_ad_interval < USER_AD_SLOW_INTERVAL)
+		{
+			user_ad_interval *= 2;
+			if(user_ad_interval > USER_AD_SLOW_INTERVAL)
+			{
+				user_ad_interval = USER_AD_SLOW_INTERVAL;
+			}
+		}
+	}
 	}
 
 	if(is_gatt_adv)
@@ -684,9 +760,43 @@ extern void UserAdverts(bool is_gatt_adv)
                                                 TRUE, gattAdvertTimerHandler2);
 	}
 	else
+	{
+		/* Finish the round at the fast rate so that its chunks are
+		 * reassembled together
+		 */
+		TimerDelete(g_lightapp_data.user_advert_tid);
+    	g_lightapp_data.user_advert_tid = TimerCreate(
+                                  (user_ad_frame_next != 0) ?
+                                  USER_AD_FAST_INTERVAL : user_ad_interval,
+                                  TRUE, userAdvertTimerHandler);
+	}
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      UserAdvertsUpdate
+ *
+ *  DESCRIPTION
+ *      This function rebuilds the user adverts after device_info has been
+ *      changed and sends them at the fast rate again.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void UserAdvertsUpdate(void)
+{
+	buildUserAdverts();
+
+	user_ad_interval = USER_AD_FAST_INTERVAL;
+	user_ad_fast_cycles = USER_AD_FAST_CYCLES;
+
+	/* Bring forward a user advert waiting for the slow interval */
+	if(g_lightapp_data.user_advert_tid != TIMER_INVALID)
 	{
 		TimerDelete(g_lightapp_data.user_advert_tid);
-    	g_lightapp_data.user_advert_tid = TimerCreate(800 * MILLISECOND, TRUE, userAdvertTimerHandler);
+		g_lightapp_data.user_advert_tid = TimerCreate(user_ad_interval, TRUE,
+                                                      userAdvertTimerHandler);
 	}
 }
 
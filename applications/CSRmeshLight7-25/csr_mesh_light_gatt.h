@@ -55,6 +55,25 @@
 #define GATT_ADVERT_GROSS_INTERVAL  (620 * MILLISECOND)
 #define GATT_ADVERT_RANDOM          (10 * MILLISECOND)
 
+/* User adverts carry device_info in chunks of manufacturer specific data:
+ *  |L|AD_TYPE_MANUF|0x0A|0x00|total << 4 | index|device_info octets...|
+ */
+#define USER_AD_CHUNK_LEN              (23)
+
+/* Largest number of chunks needed for device_info */
+#define USER_AD_MAX_FRAMES             ((255 - 2 + USER_AD_CHUNK_LEN - 1) / \
+                                        USER_AD_CHUNK_LEN)
+
+/* The chunks of a round are always sent USER_AD_FAST_INTERVAL apart, so a
+ * receiver gets the whole of device_info within a few seconds. After
+ * device_info changes USER_AD_FAST_CYCLES rounds are sent back to back. The
+ * gap between rounds then doubles after every round up to
+ * USER_AD_SLOW_INTERVAL, at which the rounds are repeated as a keep-alive.
+ */
+#define USER_AD_FAST_INTERVAL          (200 * MILLISECOND)
+#define USER_AD_SLOW_INTERVAL          (6400 * MILLISECOND)
+#define USER_AD_FAST_CYCLES            (3)
+
 #define ADVERT_INTERVAL                (GATT_ADVERT_GROSS_INTERVAL \
                                      - (GATT_ADVERT_RANDOM/2))
 
@@ -83,6 +102,9 @@ extern void GattStopAdverts(void);
 
 extern void UserAdverts(bool is_gatt_adv);
 
+/* This function rebuilds the user adverts after device_info has changed */
+extern void UserAdvertsUpdate(void);
+
 extern void UserStopAdverts(void);
 
 #endif /* __CSR_MESH_LIGHT_GATT_H__ */
@@ -290,6 +290,12 @@ void ReadPersistentStore(void)
             sizeof(uint16)*MAX_MODEL_GROUPS, NVM_OFFSET_DATA_MODEL_GROUPS);
 #endif /* ENABLE_DATA_MODEL */
 
+#ifdef ENABLE_SENSOR_PROXY
+        MemSet(sensor_model_groups, 0x0000, sizeof(uint16)*MAX_MODEL_GROUPS);
+        Nvm_Write((uint16 *)sensor_model_groups, 
+            sizeof(uint16)*MAX_MODEL_GROUPS, NVM_OFFSET_SENSOR_MODEL_GROUPS);
+#endif /* ENABLE_SENSOR_PROXY */
+
         /* Write device name and length to NVM for the first time */
         GapInitWriteDataToNVM(&nvm_offset);
 
@@ -320,6 +326,12 @@ void ReadPersistentStore(void)
                                              NVM_OFFSET_DATA_MODEL_GROUPS);
 #endif /* ENABLE_DATA_MODEL */
 
+#ifdef ENABLE_SENSOR_PROXY
+    /* Read assigned Groups IDs for Sensor model from NVM */
+    Nvm_Read((uint16 *)sensor_model_groups, sizeof(uint16)*MAX_MODEL_GROUPS,
+                                             NVM_OFFSET_SENSOR_MODEL_GROUPS);
+#endif /* ENABLE_SENSOR_PROXY */
+
     /* Read association state from NVM */
     Nvm_Read((uint16 *)&g_lightapp_data.assoc_state,
             sizeof(g_lightapp_data.assoc_state), NVM_OFFSET_ASSOCIATION_STATE);
@@ -420,6 +432,15 @@ extern void RemoveAssociation(void)
                                 NVM_OFFSET_DATA_MODEL_GROUPS);
 #endif /* ENABLE_DATA_MODEL */
 
+#ifdef ENABLE_SENSOR_PROXY
+    /* sensor model */
+    MemSet(sensor_model_groups, 0x0000, 
+                                sizeof(sensor_model_groups));
+    Nvm_Write((uint16 *)sensor_model_groups, 
+                                sizeof(sensor_model_groups),
+                                NVM_OFFSET_SENSOR_MODEL_GROUPS);
+#endif /* ENABLE_SENSOR_PROXY */
+
     /* Reset Light State */
     g_lightapp_data.light_model.red   = 0xFF;
     g_lightapp_data.light_model.green = 0xFF;
@@ -553,6 +574,25 @@ extern bool HandleGroupSetMsg(CSR_MESH_GROUP_ID_RELATED_DATA_T msg)
     }
 #endif /* ENABLE_DATA_MODEL */
 
+#ifdef ENABLE_SENSOR_PROXY
+    if(model == CSRMESH_SENSOR_MODEL || model == CSRMESH_ALL_MODELS)
+    {
+        if(index < MAX_MODEL_GROUPS)
+        {
+            sensor_model_groups[index] = group_id;
+
+            /* Save to NVM */
+            Nvm_Write(&sensor_model_groups[index],
+                      sizeof(uint16),
+                      NVM_OFFSET_SENSOR_MODEL_GROUPS + index);
+        }
+        else
+        {
+            update_lastetag = FALSE;
+        }
+    }
+#endif /* ENABLE_SENSOR_PROXY */
+
     return update_lastetag;
 }
 
@@ -696,6 +736,12 @@ extern void WriteApplicationAndServiceDataToNVM(void)
                   sizeof(uint16),
                   NVM_OFFSET_DATA_MODEL_GROUPS + index);
 #endif /* ENABLE_DATA_MODEL */
+
+#ifdef ENABLE_SENSOR_PROXY
+        Nvm_Write(&sensor_model_groups[index],
+                  sizeof(uint16),
+                  NVM_OFFSET_SENSOR_MODEL_GROUPS + index);
+#endif /* ENABLE_SENSOR_PROXY */
     }
 
     /* Write GAP service data into NVM */
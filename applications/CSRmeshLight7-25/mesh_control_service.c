@@ -52,6 +52,9 @@ typedef struct
     /* Client configuration for Mesh Control characteristic */
     gatt_client_config  mtl_cp_ccd;
 
+    /* Largest ATT write or notification payload on this connection */
+    uint16              att_data_len;
+
     MESH_MSG_T mesh_data;
 
 }MESH_SERVICE_DATA_T;
@@ -82,6 +85,9 @@ extern void MeshControlServiceDataInit(void)
      * descriptor value to none.
      */
     g_mesh_svc_data.mtl_cp_ccd = gatt_client_config_none;
+
+    /* Use the default MTU until the client exchanges a larger one */
+    g_mesh_svc_data.att_data_len = ATT_WRITE_MAX_DATALEN;
 }
 
 /*----------------------------------------------------------------------------*
@@ -161,30 +167,32 @@ extern void MeshControlHandleAccessRead(GATT_ACCESS_IND_T *p_ind)
  *---------------------------------------------------------------------------*/
 extern void MeshControlNotifyResponse(uint16 ucid, uint8 *mtl_msg, uint8 length)
 {
+    uint16 data_len = g_mesh_svc_data.att_data_len;
+
     /* Update the connected host if notifications are configured */
     if((ucid != GATT_INVALID_UCID) &&
        (g_mesh_svc_data.mtl_cp_ccd == gatt_client_config_notification))
     {
-        /* If message is less than or equal to ATT_WRITE_MAX_DATA_LEN,
-         * notify it using MTL_COMPLETE_CP. If it is greater than
-         * ATT_WRITE_MAX_DATA_LEN notify first ATT_WRITE_MAX_DATA_LEN bytes
-         * with MTL_CONTINUATION_CP and rest with MTL_COMPLETE_CP.
+        /* If message fits in one notification at the negotiated MTU,
+         * notify it using MTL_COMPLETE_CP. Otherwise notify the first
+         * data_len bytes with MTL_CONTINUATION_CP and rest with
+         * MTL_COMPLETE_CP.
          */
-        if (length <= ATT_WRITE_MAX_DATALEN)
+        if (length <= data_len)
         {
             GattCharValueNotification(ucid, HANDLE_MTL_COMPLETE_CP,
                                       length, mtl_msg);
         }
         else
         {
-            /* Send first ATT_WRITE_MAX_DATALEN with MTL_CONTINUATION_CP */
+            /* Send first data_len octets with MTL_CONTINUATION_CP */
             GattCharValueNotification(ucid, HANDLE_MTL_CONTINUATION_CP,
-                                      ATT_WRITE_MAX_DATALEN, mtl_msg);
+                                      data_len, mtl_msg);
 
             /* Send rest of the message with MTL_COMPLETE_CP */
             GattCharValueNotification(ucid, HANDLE_MTL_COMPLETE_CP,
-                                      length - ATT_WRITE_MAX_DATALEN,
-                                      &mtl_msg[ATT_WRITE_MAX_DATALEN]);
+                                      length - data_len,
+                                      &mtl_msg[data_len]);
         }
     }
 }
@@ -247,7 +255,11 @@ extern void MeshControlHandleAccessWrite(GATT_ACCESS_IND_T *p_ind)
             /* Reset the length of the mesh message */
             g_mesh_svc_data.mesh_data.length = 0;
 
-            if(p_ind->size_value)
+            /* Writes can be longer than the message buffer once a larger
+             * MTU has been exchanged
+             */
+            if(p_ind->size_value && ((p_ind->offset + p_ind->size_value)
+                                                <= MESH_LONGEST_MSG_LEN))
             {
                 MemCopy(g_mesh_svc_data.mesh_data.mesh_data + p_ind->offset,
                         p_ind->value, p_ind->size_value);
@@ -317,6 +329,34 @@ extern void MeshControlHandleAccessWrite(GATT_ACCESS_IND_T *p_ind)
     }
 }
 
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MeshControlSetAttMtu
+ *
+ *  DESCRIPTION
+ *      This function sets the ATT MTU negotiated with the client. Responses
+ *      are split into MTL_CONTINUATION_CP and MTL_COMPLETE_CP notifications
+ *      only when they do not fit in one notification at this MTU. Writes
+ *      from the client are reassembled whatever their size.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void MeshControlSetAttMtu(uint16 mtu)
+{
+    if(mtu < ATT_MTU)
+    {
+        mtu = ATT_MTU;
+    }
+    else if(mtu > ATT_MTU_MAX)
+    {
+        mtu = ATT_MTU_MAX;
+    }
+
+    g_mesh_svc_data.att_data_len = mtu - 3;
+}
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      MeshControlCheckHandleRange
@@ -44,6 +44,9 @@ extern void MeshControlHandleAccessRead(GATT_ACCESS_IND_T *p_ind);
 extern void MeshControlHandleAccessWrite(GATT_ACCESS_IND_T *p_ind);
 
 
+/* This function sets the ATT MTU negotiated with the client */
+extern void MeshControlSetAttMtu(uint16 mtu);
+
 /* This function is used to check if the handle belongs to the Mesh Control
  * service
  */
@@ -32,7 +32,7 @@
  * This application currently erases all the NVM values if the NVM version has
  * changed.
  */
-#define APP_NVM_VERSION         (1)
+#define APP_NVM_VERSION         (2)
 
 #define CSR_MESH_LIGHT_PID      (0x1060)
 
@@ -75,11 +75,39 @@
  */
 #define ENABLE_DATA_MODEL
 
+#ifdef ENABLE_DATA_MODEL
+/* Enable collection of data stream transfer statistics. The statistics can be
+ * read over the mesh with the CSR_STREAM_STATS_REQ data block.
+ */
+#define ENABLE_DATA_STREAM_STATS
+
+/* Enable aggregation of location tag sightings into USER_LOCATION_REPORT
+ * streams sent to the collector
+ */
+#define ENABLE_LOCATION_REPORT
+#endif /* ENABLE_DATA_MODEL */
+
+/* Enable the sensor model proxy. The light caches the latest value each
+ * sensor writes for each sensor type on the groups of its sensor model, and
+ * answers sensor reads and missing value messages from the cache.
+ */
+#define ENABLE_SENSOR_PROXY
+
 /* Enable the this definition to use an authorisation code for association */
 /*#define USE_AUTHORISATION_CODE */
 
 /* Enable Device UUID Advertisements */
 #define ENABLE_DEVICE_UUID_ADVERTS
 
+/* Enable the Exchange MTU procedure with an MTU of up to ATT_MTU_MAX. Only
+ * enable this once GattInstallServerExchangeMtu, GattExchangeMtuRsp and the
+ * ATT_MTU_MAX MTU are confirmed to be supported by the CSR101x firmware the
+ * application is built for. Without it the default 23 octet MTU is used.
+ */
+/* #define ENABLE_ATT_MTU_EXCHANGE */
+
+/* Enable dropping of repeated mesh adverts before they reach the scheduler */
+#define ENABLE_DUPLICATE_FILTER
+
 #endif /* __USER_CONFIG_H__ */
 
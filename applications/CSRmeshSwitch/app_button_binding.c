@@ -0,0 +1,208 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_button_binding.c
+ *
+ *  DESCRIPTION
+ *      This file keeps the bindings of the switch buttons to the switch
+ *      model groups. Each button is bound to a mask of switch model group
+ *      indexes, and optionally to a shared group which holds every device
+ *      in those groups. A button with a shared group sends one command to
+ *      it. Otherwise it sends a command to each group assigned in its mask,
+ *      and the command queue spreads them over time.
+ *
+ *      Bindings are set with the USER_BUTTON_BINDING_SET data block:
+ *          |USER_BUTTON_BINDING_SET|button|group mask|shared group (LE 16)|
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_button_binding.h"
+#include "csr_mesh_switch.h"
+#include "nvm_access.h"
+
+#ifdef ENABLE_BUTTON_BINDINGS
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint16 group_mask;          /* Switch model group indexes bound */
+    uint16 shared_group;        /* Group holding all of them, or 0 if none */
+}BUTTON_BINDING_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Bindings of the buttons */
+static BUTTON_BINDING_T button_bindings[NUM_BUTTON_BINDINGS];
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppButtonBindingReset
+ *
+ *  DESCRIPTION
+ *      This function binds every button to the first switch model group,
+ *      which is how the switch behaves without bindings, and saves the
+ *      bindings to NVM.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppButtonBindingReset(void)
+{
+    uint16 index;
+
+    for(index = 0; index < NUM_BUTTON_BINDINGS; index++)
+    {
+        button_bindings[index].group_mask = 0x0001;
+        button_bindings[index].shared_group = 0;
+    }
+
+    AppButtonBindingWriteNVM();
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppButtonBindingReadNVM
+ *
+ *  DESCRIPTION
+ *      This function reads the bindings from NVM.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppButtonBindingReadNVM(void)
+{
+    uint16 index;
+
+    for(index = 0; index < NUM_BUTTON_BINDINGS; index++)
+    {
+        Nvm_Read(&button_bindings[index].group_mask, 1,
+                 NVM_OFFSET_BUTTON_BINDINGS +
+                 index * BUTTON_BINDING_NVM_SIZE);
+        Nvm_Read(&button_bindings[index].shared_group, 1,
+                 NVM_OFFSET_BUTTON_BINDINGS +
+                 index * BUTTON_BINDING_NVM_SIZE + 1);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppButtonBindingWriteNVM
+ *
+ *  DESCRIPTION
+ *      This function writes the bindings to NVM.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppButtonBindingWriteNVM(void)
+{
+    uint16 index;
+
+    for(index = 0; index < NUM_BUTTON_BINDINGS; index++)
+    {
+        Nvm_Write(&button_bindings[index].group_mask, 1,
+                  NVM_OFFSET_BUTTON_BINDINGS +
+                  index * BUTTON_BINDING_NVM_SIZE);
+        Nvm_Write(&button_bindings[index].shared_group, 1,
+                  NVM_OFFSET_BUTTON_BINDINGS +
+                  index * BUTTON_BINDING_NVM_SIZE + 1);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppButtonBindingSet
+ *
+ *  DESCRIPTION
+ *      This function binds a button to the switch model groups whose indexes
+ *      are set in group_mask. shared_group is a group holding every device
+ *      in those groups, or 0 if there is none. The binding is saved to NVM.
+ *
+ *  RETURNS
+ *      TRUE if the binding was set, FALSE if it is not valid.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool AppButtonBindingSet(uint16 button, uint16 group_mask,
+                                uint16 shared_group)
+{
+    if(button >= NUM_BUTTON_BINDINGS ||
+       (group_mask & ~((1 << SWITCH_MODEL_GROUPS) - 1)) != 0)
+    {
+        return FALSE;
+    }
+
+    button_bindings[button].group_mask = group_mask;
+    button_bindings[button].shared_group = shared_group;
+
+    Nvm_Write(&button_bindings[button].group_mask, 1,
+              NVM_OFFSET_BUTTON_BINDINGS + button * BUTTON_BINDING_NVM_SIZE);
+    Nvm_Write(&button_bindings[button].shared_group, 1,
+              NVM_OFFSET_BUTTON_BINDINGS +
+              button * BUTTON_BINDING_NVM_SIZE + 1);
+
+    return TRUE;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppButtonBindingGetDestinations
+ *
+ *  DESCRIPTION
+ *      This function gets the destinations of the commands sent by a button.
+ *      This is the shared group of the button if it has one, or else each
+ *      group bound to it that has been assigned. A button bound to the first
+ *      group while none of its groups is assigned sends to the first group
+ *      anyway, which is 0 and so reaches every device, as the switch does
+ *      without bindings. p_dest_ids must have room for SWITCH_MODEL_GROUPS
+ *      destinations.
+ *
+ *  RETURNS
+ *      Number of destinations.
+ *
+ *---------------------------------------------------------------------------*/
+extern uint16 AppButtonBindingGetDestinations(uint16 button,
+                                              uint16 *p_dest_ids)
+{
+    BUTTON_BINDING_T *p_binding = &button_bindings[button];
+    uint16 num_dest = 0;
+    uint16 index;
+
+    if(p_binding->shared_group != 0)
+    {
+        p_dest_ids[0] = p_binding->shared_group;
+        return 1;
+    }
+
+    for(index = 0; index < SWITCH_MODEL_GROUPS; index++)
+    {
+        if((p_binding->group_mask & (1 << index)) &&
+           switch_model_groups[index] != 0)
+        {
+            p_dest_ids[num_dest++] = switch_model_groups[index];
+        }
+    }
+
+    if(num_dest == 0 && (p_binding->group_mask & 1))
+    {
+        p_dest_ids[num_dest++] = switch_model_groups[0];
+    }
+
+    return num_dest;
+}
+
+#endif /* ENABLE_BUTTON_BINDINGS */
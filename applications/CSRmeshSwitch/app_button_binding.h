@@ -0,0 +1,69 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_button_binding.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the bindings of the switch buttons to the
+ *      switch model groups
+ *
+ *****************************************************************************/
+
+#ifndef __APP_BUTTON_BINDING_H__
+#define __APP_BUTTON_BINDING_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+#ifdef ENABLE_BUTTON_BINDINGS
+#ifndef ENABLE_COMMAND_COALESCING
+#error "Button bindings need command coalescing"
+#endif /* ENABLE_COMMAND_COALESCING */
+
+#ifndef ENABLE_DATA_MODEL
+#error "Button bindings need the data model"
+#endif /* ENABLE_DATA_MODEL */
+
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Buttons that can be bound to groups */
+#define BUTTON_BINDING_POWER            (0)     /* SW4 */
+#define BUTTON_BINDING_LEVEL            (1)     /* SW2 and SW3 */
+#define NUM_BUTTON_BINDINGS             (2)
+
+/* Words of NVM used by a binding: group mask and shared group */
+#define BUTTON_BINDING_NVM_SIZE         (2)
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Binds every button to the first switch model group and saves it to NVM */
+extern void AppButtonBindingReset(void);
+
+/* Reads the bindings from NVM */
+extern void AppButtonBindingReadNVM(void);
+
+/* Writes the bindings to NVM */
+extern void AppButtonBindingWriteNVM(void);
+
+/* Binds a button to a set of switch model groups */
+extern bool AppButtonBindingSet(uint16 button, uint16 group_mask,
+                                uint16 shared_group);
+
+/* Gets the destinations of the commands sent by a button */
+extern uint16 AppButtonBindingGetDestinations(uint16 button,
+                                              uint16 *p_dest_ids);
+
+#endif /* ENABLE_BUTTON_BINDINGS */
+#endif /* __APP_BUTTON_BINDING_H__ */
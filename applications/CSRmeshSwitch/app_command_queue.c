@@ -0,0 +1,367 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_command_queue.c
+ *
+ *  DESCRIPTION
+ *      This file coalesces the commands sent by the switch. Each model and
+ *      destination pair has one slot holding the command waiting to be sent
+ *      to it, and a new command for the same pair overwrites the one waiting
+ *      and moves the slot behind the other slots. Commands are sent no more
+ *      often than COMMAND_SEND_INTERVAL, in the order they were last
+ *      written, so that the transmit queue does not fill with values that
+ *      are already out of date and the lights end up in the state of the
+ *      last command.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <timer.h>
+#include <mem.h>
+
+/*============================================================================*
+ *  CSRmesh Header Files
+ *============================================================================*/
+#include <csr_mesh.h>
+#include <light_client.h>
+#include <power_client.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_command_queue.h"
+#include "csr_mesh_switch.h"
+
+#ifdef ENABLE_COMMAND_COALESCING
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+/* Model a command is sent to */
+typedef enum
+{
+    command_model_power,
+    command_model_light
+}COMMAND_MODEL_T;
+
+/* Command held in a slot */
+typedef enum
+{
+    command_power_state,
+    command_light_level,
+    command_light_power_level
+}COMMAND_TYPE_T;
+
+typedef struct
+{
+    bool   pending;             /* Slot holds a command waiting to be sent */
+    uint16 order;               /* Order in which the slot was written */
+    COMMAND_MODEL_T model;      /* Model the command is sent to */
+    uint16 dest_id;             /* Destination of the command */
+    COMMAND_TYPE_T type;        /* Command */
+    uint8  value;               /* Power state or light level */
+    uint16 duration;            /* Level duration of a light power level */
+}COMMAND_SLOT_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Commands waiting to be sent */
+static COMMAND_SLOT_T command_slots[COMMAND_QUEUE_SLOTS];
+
+/* Order given to the next slot filled */
+static uint16 command_order;
+
+/* Transaction identifier of the next command sent */
+static uint8 command_tid = 1;
+
+/* Timer running for COMMAND_SEND_INTERVAL after each command is sent */
+static timer_id command_timer_tid = TIMER_INVALID;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static void commandTimerHandler(timer_id tid);
+static void sendCommand(COMMAND_SLOT_T *p_slot);
+static void sendOldestCommand(void);
+static void queueCommand(COMMAND_MODEL_T model, uint16 dest_id,
+                         COMMAND_TYPE_T type, uint8 value, uint16 duration);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendCommand
+ *
+ *  DESCRIPTION
+ *      Sends the command held in a slot and frees the slot.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendCommand(COMMAND_SLOT_T *p_slot)
+{
+    switch(p_slot->type)
+    {
+        case command_power_state:
+        {
+            CSRMESH_POWER_SET_STATE_T power_state;
+
+            power_state.state = p_slot->value;
+            power_state.tid = command_tid;
+            PowerSetState(DEFAULT_NW_ID, p_slot->dest_id, &power_state, FALSE);
+        }
+        break;
+
+        case command_light_level:
+        {
+            CSRMESH_LIGHT_SET_LEVEL_T light_level;
+
+            light_level.level = p_slot->value;
+            light_level.tid = command_tid;
+            LightSetLevel(DEFAULT_NW_ID, p_slot->dest_id, &light_level, FALSE);
+        }
+        break;
+
+        case command_light_power_level:
+        {
+            CSRMESH_LIGHT_SET_POWER_LEVEL_T power_level;
+
+            power_level.power = csr_mesh_power_state_on;
+            power_level.level = p_slot->value;
+            power_level.levelduration = p_slot->duration;
+            power_level.sustain = 0;
+            power_level.decay = 0;
+            power_level.tid = command_tid;
+            LightSetPowerLevel(DEFAULT_NW_ID, p_slot->dest_id, &power_level,
+                               FALSE);
+        }
+        break;
+
+        default:
+        break;
+    }
+
+    command_tid = (command_tid + 1) & 0xFF;
+    p_slot->pending = FALSE;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendOldestCommand
+ *
+ *  DESCRIPTION
+ *      Sends the command that has been waiting longest, and starts the timer
+ *      which holds back the next command.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendOldestCommand(void)
+{
+    COMMAND_SLOT_T *p_oldest = NULL;
+    uint16 index;
+
+    for(index = 0; index < COMMAND_QUEUE_SLOTS; index++)
+    {
+        COMMAND_SLOT_T *p_slot = &command_slots[index];
+
+        if(p_slot->pending &&
+           (p_oldest == NULL ||
+            (uint16)(command_order - p_slot->order) >
+            (uint16)(command_order - p_oldest->order)))
+        {
+            p_oldest = p_slot;
+        }
+    }
+
+    if(p_oldest != NULL)
+    {
+        sendCommand(p_oldest);
+
+        TimerDelete(command_timer_tid);
+        command_timer_tid = TimerCreate(COMMAND_SEND_INTERVAL, TRUE,
+                                        commandTimerHandler);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      commandTimerHandler
+ *
+ *  DESCRIPTION
+ *      Sends the next command waiting once COMMAND_SEND_INTERVAL has passed
+ *      since the last one. The timer stops when no command is waiting.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void commandTimerHandler(timer_id tid)
+{
+    if(tid == command_timer_tid)
+    {
+        command_timer_tid = TIMER_INVALID;
+        sendOldestCommand();
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      queueCommand
+ *
+ *  DESCRIPTION
+ *      Puts a command in the slot of its model and destination, replacing
+ *      the command waiting there. The slot then goes behind the others, so a
+ *      power command and a light command to the same destination are sent
+ *      in the order they were last given. The command is sent at once if no
+ *      command has been sent in the last COMMAND_SEND_INTERVAL.
+ *
+ *      If every slot holds a command for another destination, the oldest is
+ *      sent straight away to make room, ahead of COMMAND_SEND_INTERVAL. The
+ *      alternative is dropping a command, which loses a button press. The
+ *      slots cover both models of every switch model group, so this only
+ *      happens when commands go to more destinations than the groups within
+ *      one interval, and then one msg is sent per command given.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void queueCommand(COMMAND_MODEL_T model, uint16 dest_id,
+                         COMMAND_TYPE_T type, uint8 value, uint16 duration)
+{
+    COMMAND_SLOT_T *p_slot = NULL;
+    COMMAND_SLOT_T *p_free = NULL;
+    uint16 index;
+
+    for(index = 0; index < COMMAND_QUEUE_SLOTS; index++)
+    {
+        COMMAND_SLOT_T *p_entry = &command_slots[index];
+
+        if(!p_entry->pending)
+        {
+            if(p_free == NULL)
+            {
+                p_free = p_entry;
+            }
+        }
+        else if(p_entry->model == model && p_entry->dest_id == dest_id)
+        {
+            p_slot = p_entry;
+            break;
+        }
+    }
+
+    if(p_slot == NULL)
+    {
+        if(p_free == NULL)
+        {
+            sendOldestCommand();
+            queueCommand(model, dest_id, type, value, duration);
+            return;
+        }
+
+        p_slot = p_free;
+        p_slot->pending = TRUE;
+        p_slot->model = model;
+        p_slot->dest_id = dest_id;
+    }
+
+    p_slot->order = command_order++;
+    p_slot->type = type;
+    p_slot->value = value;
+    p_slot->duration = duration;
+
+    if(command_timer_tid == TIMER_INVALID)
+    {
+        sendOldestCommand();
+    }
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppCommandQueueInit
+ *
+ *  DESCRIPTION
+ *      This function discards the commands waiting to be sent.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppCommandQueueInit(void)
+{
+    TimerDelete(command_timer_tid);
+    command_timer_tid = TIMER_INVALID;
+    MemSet(command_slots, 0, sizeof(command_slots));
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppCommandSetPowerState
+ *
+ *  DESCRIPTION
+ *      This function queues a power state command to a destination.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppCommandSetPowerState(uint16 dest_id,
+                                    csr_mesh_power_state_t state)
+{
+    queueCommand(command_model_power, dest_id, command_power_state, state, 0);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppCommandSetLevel
+ *
+ *  DESCRIPTION
+ *      This function queues a light level command to a destination. It
+ *      replaces a light power level command waiting for the destination, as
+ *      both set the level of the lights.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppCommandSetLevel(uint16 dest_id, uint8 level)
+{
+    queueCommand(command_model_light, dest_id, command_light_level, level, 0);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppCommandSetPowerLevel
+ *
+ *  DESCRIPTION
+ *      This function queues a light power level command to a destination,
+ *      which turns the lights on and fades them to the level over the
+ *      duration in seconds.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppCommandSetPowerLevel(uint16 dest_id, uint8 level,
+                                    uint16 duration)
+{
+    queueCommand(command_model_light, dest_id, command_light_power_level,
+                 level, duration);
+}
+
+#endif /* ENABLE_COMMAND_COALESCING */
@@ -0,0 +1,66 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_command_queue.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the queue which coalesces the commands sent by
+ *      the switch
+ *
+ *****************************************************************************/
+
+#ifndef __APP_COMMAND_QUEUE_H__
+#define __APP_COMMAND_QUEUE_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+#include <time.h>
+
+/*============================================================================*
+ *  CSRmesh Header Files
+ *============================================================================*/
+#include <csr_mesh_model_common.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+#ifdef ENABLE_COMMAND_COALESCING
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Number of model and destination pairs that can have a command waiting:
+ * the power and light models for each switch model group
+ */
+#define COMMAND_QUEUE_SLOTS             (2 * SWITCH_MODEL_GROUPS)
+
+/* Shortest time between two commands. The mesh repeats each message for
+ * 600ms, so at this rate no more than three of them are being sent at once.
+ */
+#define COMMAND_SEND_INTERVAL           (250 * MILLISECOND)
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Discards the commands waiting to be sent */
+extern void AppCommandQueueInit(void);
+
+/* Queues a power state command */
+extern void AppCommandSetPowerState(uint16 dest_id,
+                                    csr_mesh_power_state_t state);
+
+/* Queues a light level command */
+extern void AppCommandSetLevel(uint16 dest_id, uint8 level);
+
+/* Queues a light power level command */
+extern void AppCommandSetPowerLevel(uint16 dest_id, uint8 level,
+                                    uint16 duration);
+
+#endif /* ENABLE_COMMAND_COALESCING */
+#endif /* __APP_COMMAND_QUEUE_H__ */
@@ -36,6 +36,7 @@
 *============================================================================*/
 #include "app_data_stream.h"
 #include "app_watchdog_model.h"
+#include "app_button_binding.h"
 
 #ifdef ENABLE_DATA_MODEL
 /*=============================================================================*
@@ -376,6 +377,21 @@ static void handleCSRmeshDataBlockInd(uint16 src_id,
         }
         break;
 
+#ifdef ENABLE_BUTTON_BINDINGS
+        case USER_BUTTON_BINDING_SET:
+        {
+            /* |code|button|group mask|shared group LSB|shared group MSB| */
+            if(p_event->datagramoctets_len >= 5)
+            {
+                AppButtonBindingSet(p_event->datagramoctets[1],
+                                    p_event->datagramoctets[2],
+                                    p_event->datagramoctets[3] |
+                                    (p_event->datagramoctets[4] << 8));
+            }
+        }
+        break;
+#endif /* ENABLE_BUTTON_BINDINGS */
+
         default:
         break;
     }
@@ -46,7 +46,8 @@ typedef enum
     CSR_DEVICE_INFO_REQ = 0x01,
     CSR_DEVICE_INFO_RSP = 0x02,
     CSR_DEVICE_INFO_SET = 0x03,
-    CSR_DEVICE_INFO_RESET = 0x04
+    CSR_DEVICE_INFO_RESET = 0x04,
+    USER_BUTTON_BINDING_SET = 0x0C
 }APP_DATA_STREAM_CODE_T;
 
 /*============================================================================*
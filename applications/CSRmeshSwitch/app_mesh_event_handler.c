@@ -224,6 +224,11 @@ void CSRmeshAppProcessMeshEvent(CSR_MESH_APP_EVENT_DATA_T eventDataCallback)
                 {
                     g_switchapp_data.assoc_state = app_state_not_associated;
 
+#ifdef ENABLE_COMMAND_COALESCING
+                    /* Discard the commands waiting for the old groups */
+                    AppCommandQueueInit();
+#endif /* ENABLE_COMMAND_COALESCING */
+
                     /* Enable promiscuous mode */
                     g_switchapp_data.bearer_tx_state.bearerPromiscuous = 
                                 LE_BEARER_ACTIVE | GATT_SERVER_BEARER_ACTIVE;
@@ -247,6 +252,11 @@ void CSRmeshAppProcessMeshEvent(CSR_MESH_APP_EVENT_DATA_T eventDataCallback)
                                             sizeof(switch_model_groups),
                                             NVM_OFFSET_SWITCH_MODEL_GROUPS);
 
+#ifdef ENABLE_BUTTON_BINDINGS
+                    /* Bind the buttons to the first group again */
+                    AppButtonBindingReset();
+#endif /* ENABLE_BUTTON_BINDINGS */
+
                     /* Attention model */
                     MemSet(attention_model_groups, 0x0000,
                                             sizeof(attention_model_groups));
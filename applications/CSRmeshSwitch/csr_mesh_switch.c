@@ -59,7 +59,7 @@
 /* CSRmesh switch application specific data */
 CSRMESH_SWITCH_APP_DATA_T g_switchapp_data;
 /* Declare space for Model Groups */
-uint16 switch_model_groups[MAX_MODEL_GROUPS];
+uint16 switch_model_groups[SWITCH_MODEL_GROUPS];
 uint16 attention_model_groups[MAX_MODEL_GROUPS];
 #ifdef ENABLE_DATA_MODEL
 uint16 data_model_groups[MAX_MODEL_GROUPS];
@@ -367,7 +367,7 @@ void AppInit(sleep_state last_sleep_state)
         /* Initialize the attention model */
         SwitchModelInit(0, 
                         switch_model_groups,
-                        MAX_MODEL_GROUPS,
+                        SWITCH_MODEL_GROUPS,
                         NULL);
 
         /* Initialize the attention model */
@@ -40,6 +40,8 @@
 #include "battery_server.h"
 #include "app_data_stream.h"
 #include "app_watchdog_model.h"
+#include "app_command_queue.h"
+#include "app_button_binding.h"
 
  /*============================================================================*
  *  Public Definitions
@@ -47,12 +49,21 @@
 /*! \brief Bluetooth SIG Organization identifier for CSRmesh device appearance */
 #define APPEARANCE_ORG_BLUETOOTH_SIG   (0)
 
+#ifdef ENABLE_COMMAND_COALESCING
+/* Command send interval timer */
+#define COMMAND_QUEUE_TIMERS                (1)
+#else
+#define COMMAND_QUEUE_TIMERS                (0)
+#endif /* ENABLE_COMMAND_COALESCING */
+
 #ifdef ENABLE_DEVICE_UUID_ADVERTS
 /* Maximum number of timers */
-#define MAX_APP_TIMERS                      (7 + CSR_MESH_MAX_NO_TIMERS)
+#define MAX_APP_TIMERS                      (7 + COMMAND_QUEUE_TIMERS + \
+                                             CSR_MESH_MAX_NO_TIMERS)
 #else
 /* Maximum number of timers */
-#define MAX_APP_TIMERS                      (6 + CSR_MESH_MAX_NO_TIMERS)
+#define MAX_APP_TIMERS                      (6 + COMMAND_QUEUE_TIMERS + \
+                                             CSR_MESH_MAX_NO_TIMERS)
 #endif /* ENABLE_DEVICE_UUID_ADVERTS */
 
 /* TGAP(conn_pause_peripheral) defined in Core Specification Addendum 3 Revision
@@ -120,7 +131,7 @@
 #define NVM_OFFSET_SWITCH_MODEL_GROUPS (NVM_OFFSET_SWITCH_STATE + 1)
 
 #define NVM_OFFSET_ATTN_MODEL_GROUPS   (NVM_OFFSET_SWITCH_MODEL_GROUPS + \
-                                        sizeof(uint16)*MAX_MODEL_GROUPS)
+                                        sizeof(uint16)*SWITCH_MODEL_GROUPS)
 
 #define NVM_OFFSET_DATA_MODEL_GROUPS   (NVM_OFFSET_ATTN_MODEL_GROUPS + \
                                         sizeof(uint16)*MAX_MODEL_GROUPS)
@@ -137,9 +148,18 @@
 #define SIZEOF_WDOG_MODEL_GROUPS       (0)
 #endif
 
-/* NVM Offset for Application data */
-#define NVM_MAX_APP_MEMORY_WORDS       (NVM_OFFSET_WDOG_MODEL_GROUPS + \
+#define NVM_OFFSET_BUTTON_BINDINGS     (NVM_OFFSET_WDOG_MODEL_GROUPS + \
                                         SIZEOF_WDOG_MODEL_GROUPS)
+#ifdef ENABLE_BUTTON_BINDINGS
+#define SIZEOF_BUTTON_BINDINGS         (NUM_BUTTON_BINDINGS * \
+                                        BUTTON_BINDING_NVM_SIZE)
+#else
+#define SIZEOF_BUTTON_BINDINGS         (0)
+#endif
+
+/* NVM Offset for Application data */
+#define NVM_MAX_APP_MEMORY_WORDS       (NVM_OFFSET_BUTTON_BINDINGS + \
+                                        SIZEOF_BUTTON_BINDINGS)
 
 
 /* The User key index where the application config flags are stored */
@@ -279,7 +299,7 @@ typedef struct
  *  Public Data
  *============================================================================*/
 /* Supported Model group ID lists */
-extern uint16 switch_model_groups[MAX_MODEL_GROUPS];
+extern uint16 switch_model_groups[SWITCH_MODEL_GROUPS];
 extern uint16 attention_model_groups[MAX_MODEL_GROUPS];
 #ifdef ENABLE_DATA_MODEL
 extern uint16 data_model_groups[MAX_MODEL_GROUPS];
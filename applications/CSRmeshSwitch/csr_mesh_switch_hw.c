@@ -19,6 +19,7 @@
  *============================================================================*/
 #include <types.h>
 #include <pio.h>
+#include <time.h>
 
 /*============================================================================*
  *  Local Header Files
@@ -27,6 +28,7 @@
 #include "iot_hw.h"
 #include "csr_mesh_switch_hw.h"
 #include "nvm_access.h"
+#include "app_command_queue.h"
 
 /*============================================================================*
  *  Private Definitions
@@ -58,19 +60,268 @@ static bool     incButtonState = KEY_RELEASED;
 static bool     decButtonState = KEY_RELEASED;
 static timer_id oneSecTimerId  = TIMER_INVALID;
 
+#ifndef ENABLE_COMMAND_COALESCING
 static uint8    switch_cmd_tid = 1;
+#endif /* ENABLE_COMMAND_COALESCING */
+
+#ifdef ENABLE_LEVEL_RAMP
+/* Level ramp started by the last press of SW2 or SW3 */
+static uint32   rampStartTime;
+static uint8    rampStartLevel;
+static uint8    rampTargetLevel;
+
+/* Ramp duration in seconds, zero when no ramp is running */
+static uint16   rampDuration = 0;
+#endif /* ENABLE_LEVEL_RAMP */
 #endif /* DEBUG_ENABLE */
 
 
 /*============================================================================*
  *  Private Function Prototypes
  *============================================================================*/
+#ifndef DEBUG_ENABLE
+static void sendPowerState(csr_mesh_power_state_t state);
+static void sendLightLevel(uint8 level);
+#ifdef ENABLE_LEVEL_RAMP
+static void sendLightPowerLevel(uint8 level, uint16 duration);
+#endif /* ENABLE_LEVEL_RAMP */
+#endif /* DEBUG_ENABLE */
+
+#if !defined(DEBUG_ENABLE) && defined(ENABLE_LEVEL_RAMP)
+static uint8 getRampLevel(void);
+static void startLevelRamp(uint8 target);
+static void stopLevelRamp(void);
+#endif /* !DEBUG_ENABLE && ENABLE_LEVEL_RAMP */
 
 
 /*============================================================================*
  *  Private Function Implementations
  *============================================================================*/
 #ifndef DEBUG_ENABLE
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendPowerState
+ *
+ *  DESCRIPTION
+ *      This function sends a power state command to the groups bound to
+ *      the power button.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendPowerState(csr_mesh_power_state_t state)
+{
+#if defined(ENABLE_BUTTON_BINDINGS)
+    uint16 dest_ids[SWITCH_MODEL_GROUPS];
+    uint16 num_dest;
+    uint16 index;
+
+    num_dest = AppButtonBindingGetDestinations(BUTTON_BINDING_POWER, dest_ids);
+
+    for(index = 0; index < num_dest; index++)
+    {
+        AppCommandSetPowerState(dest_ids[index], state);
+    }
+#elif defined(ENABLE_COMMAND_COALESCING)
+    AppCommandSetPowerState(switch_model_groups[0], state);
+#else
+    CSRMESH_POWER_SET_STATE_T power_state;
+
+    power_state.state = state;
+    power_state.tid = switch_cmd_tid++;
+    PowerSetState(DEFAULT_NW_ID, switch_model_groups[0], &power_state, FALSE);
+#endif /* ENABLE_COMMAND_COALESCING */
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendLightLevel
+ *
+ *  DESCRIPTION
+ *      This function sends a light level command to the groups bound to
+ *      the level buttons.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendLightLevel(uint8 level)
+{
+#if defined(ENABLE_BUTTON_BINDINGS)
+    uint16 dest_ids[SWITCH_MODEL_GROUPS];
+    uint16 num_dest;
+    uint16 index;
+
+    num_dest = AppButtonBindingGetDestinations(BUTTON_BINDING_LEVEL, dest_ids);
+
+    for(index = 0; index < num_dest; index++)
+    {
+        AppCommandSetLevel(dest_ids[index], level);
+    }
+#elif defined(ENABLE_COMMAND_COALESCING)
+    AppCommandSetLevel(switch_model_groups[0], level);
+#else
+    CSRMESH_LIGHT_SET_LEVEL_T light_level;
+
+    light_level.level = level;
+    light_level.tid = switch_cmd_tid++;
+    LightSetLevel(DEFAULT_NW_ID, switch_model_groups[0], &light_level, FALSE);
+#endif /* ENABLE_COMMAND_COALESCING */
+}
+
+#ifdef ENABLE_LEVEL_RAMP
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendLightPowerLevel
+ *
+ *  DESCRIPTION
+ *      This function sends a light power level command to the groups bound
+ *      to the level buttons, which turns the lights on and fades them to the
+ *      level over the duration in seconds.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendLightPowerLevel(uint8 level, uint16 duration)
+{
+#if defined(ENABLE_BUTTON_BINDINGS)
+    uint16 dest_ids[SWITCH_MODEL_GROUPS];
+    uint16 num_dest;
+    uint16 index;
+
+    num_dest = AppButtonBindingGetDestinations(BUTTON_BINDING_LEVEL, dest_ids);
+
+    for(index = 0; index < num_dest; index++)
+    {
+        AppCommandSetPowerLevel(dest_ids[index], level, duration);
+    }
+#elif defined(ENABLE_COMMAND_COALESCING)
+    AppCommandSetPowerLevel(switch_model_groups[0], level, duration);
+#else
+    CSRMESH_LIGHT_SET_POWER_LEVEL_T power_level;
+
+    power_level.power = csr_mesh_power_state_on;
+    power_level.level = level;
+    power_level.levelduration = duration;
+    power_level.sustain = 0;
+    power_level.decay = 0;
+    power_level.tid = switch_cmd_tid++;
+    LightSetPowerLevel(DEFAULT_NW_ID, switch_model_groups[0], &power_level,
+                                                                         FALSE);
+#endif /* ENABLE_COMMAND_COALESCING */
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      getRampLevel
+ *
+ *  DESCRIPTION
+ *      This function works out the level the lights have reached on the
+ *      running ramp. A ramp stopped early still changes the level by at
+ *      least LEVEL_STEP_SIZE, so that a short press steps the level.
+ *
+ *  RETURNS
+ *      Level reached.
+ *
+ *---------------------------------------------------------------------------*/
+static uint8 getRampLevel(void)
+{
+    int32 elapsed = TimeSub(TimeGet32(), rampStartTime) / MILLISECOND;
+    int32 duration = (int32)rampDuration * (SECOND / MILLISECOND);
+    int16 distance = (int16)rampTargetLevel - (int16)rampStartLevel;
+    int16 change;
+
+    if (elapsed >= duration)
+    {
+        return rampTargetLevel;
+    }
+
+    change = (int16)(((int32)distance * elapsed) / duration);
+
+    if (distance > 0 && change < LEVEL_STEP_SIZE)
+    {
+        change = distance < LEVEL_STEP_SIZE ? distance : LEVEL_STEP_SIZE;
+    }
+    else if (distance < 0 && change > -LEVEL_STEP_SIZE)
+    {
+        change = distance > -LEVEL_STEP_SIZE ? distance : -LEVEL_STEP_SIZE;
+    }
+
+    return (uint8)(rampStartLevel + change);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      startLevelRamp
+ *
+ *  DESCRIPTION
+ *      This function sends one light power level message which fades the
+ *      lights from the current level to the target level. The duration is
+ *      scaled to the distance, so that the level changes at the same rate
+ *      whatever the starting level.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void startLevelRamp(uint8 target)
+{
+    uint16 distance;
+
+    /* Start from the level reached if the other button is ramping */
+    if (rampDuration != 0)
+    {
+        g_switchapp_data.brightness_level = getRampLevel();
+        rampDuration = 0;
+    }
+
+    distance = (target > g_switchapp_data.brightness_level) ?
+                        (target - g_switchapp_data.brightness_level) :
+                        (g_switchapp_data.brightness_level - target);
+
+    /* Nothing to do if the lights are already at the limit */
+    if (distance == 0)
+    {
+        return;
+    }
+
+    rampStartTime = TimeGet32();
+    rampStartLevel = g_switchapp_data.brightness_level;
+    rampTargetLevel = target;
+    rampDuration = (distance * LEVEL_RAMP_TIME + MAX_LEVEL - 1) / MAX_LEVEL;
+
+    sendLightPowerLevel(target, rampDuration);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      stopLevelRamp
+ *
+ *  DESCRIPTION
+ *      This function stops the running ramp by sending one light level
+ *      message with the level reached, which also ends the transition on
+ *      the lights.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void stopLevelRamp(void)
+{
+    if (rampDuration == 0)
+    {
+        return;
+    }
+
+    g_switchapp_data.brightness_level = getRampLevel();
+    rampDuration = 0;
+
+    sendLightLevel(g_switchapp_data.brightness_level);
+}
+#endif /* ENABLE_LEVEL_RAMP */
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      handleButtonDebounce
@@ -86,8 +337,6 @@ static void handleButtonDebounce(timer_id tid)
 {
     bool startOneSecTimer = FALSE;
     bool update_nvm = FALSE;
-    CSRMESH_POWER_SET_STATE_T power_state;
-    CSRMESH_LIGHT_SET_LEVEL_T light_level;
 
     if( tid == g_switchapp_data.debounce_tid)
     {
@@ -103,6 +352,9 @@ static void handleButtonDebounce(timer_id tid)
         {
             /* Set State and increment level */
             incButtonState = KEY_PRESSED;
+#ifdef ENABLE_LEVEL_RAMP
+            startLevelRamp(MAX_LEVEL);
+#else
             if (g_switchapp_data.brightness_level 
                                             < (MAX_LEVEL - LEVEL_STEP_SIZE))
             {
@@ -115,11 +367,15 @@ static void handleButtonDebounce(timer_id tid)
 
             /* Start 1 second timer */
             startOneSecTimer = TRUE;
+#endif /* ENABLE_LEVEL_RAMP */
         }
         else if ((PioGet(SW3_PIO) == TRUE) && (incButtonState == KEY_PRESSED))
         {
             /* Set state to KEY RELEASE */
             incButtonState = KEY_RELEASED;
+#ifdef ENABLE_LEVEL_RAMP
+            stopLevelRamp();
+#endif /* ENABLE_LEVEL_RAMP */
             update_nvm = TRUE;
         }
 
@@ -127,6 +383,9 @@ static void handleButtonDebounce(timer_id tid)
         {
             /* Set State and decrement level */
             decButtonState = KEY_PRESSED;
+#ifdef ENABLE_LEVEL_RAMP
+            startLevelRamp(MIN_LEVEL);
+#else
             if (g_switchapp_data.brightness_level > LEVEL_STEP_SIZE)
             {
                 g_switchapp_data.brightness_level -= LEVEL_STEP_SIZE;
@@ -138,11 +397,15 @@ static void handleButtonDebounce(timer_id tid)
 
             /* Start 1 second timer */
             startOneSecTimer = TRUE;
+#endif /* ENABLE_LEVEL_RAMP */
         }
         else if ((PioGet(SW2_PIO) == TRUE) && (decButtonState == KEY_PRESSED))
         {
             /* Set state to KEY RELEASE */
             decButtonState = KEY_RELEASED;
+#ifdef ENABLE_LEVEL_RAMP
+            stopLevelRamp();
+#endif /* ENABLE_LEVEL_RAMP */
             update_nvm = TRUE;
         }
 
@@ -150,26 +413,19 @@ static void handleButtonDebounce(timer_id tid)
         {
             /* Set Button State */
             onButtonState = KEY_PRESSED;
-            power_state.state = csr_mesh_power_state_on;
-            power_state.tid = switch_cmd_tid++;
-            PowerSetState(0, switch_model_groups[0], &power_state, FALSE);
+            sendPowerState(csr_mesh_power_state_on);
         }
         else if ((PioGet(SW4_PIO) == TRUE) && (onButtonState == KEY_PRESSED))
         {
             /* Set state to KEY RELEASE */
             onButtonState = KEY_RELEASED;
-            power_state.state = csr_mesh_power_state_off;
-            power_state.tid = switch_cmd_tid++;
-            PowerSetState(0, switch_model_groups[0], &power_state, FALSE);
+            sendPowerState(csr_mesh_power_state_off);
         }
 
         /* Send Light Command and Create One Second Timer when flag is set */
         if (startOneSecTimer)
         {
-            light_level.level = g_switchapp_data.brightness_level;
-            light_level.tid = switch_cmd_tid++;
-            LightSetLevel(DEFAULT_NW_ID, switch_model_groups[0], &light_level, 
-                                                                         FALSE);
+            sendLightLevel(g_switchapp_data.brightness_level);
 
             /* Start 1 second timer */
             oneSecTimerId = TimerCreate(BUTTON_ONE_SEC_PRESS_TIME, TRUE,
@@ -193,10 +449,7 @@ static void handleButtonDebounce(timer_id tid)
                 g_switchapp_data.brightness_level = MAX_LEVEL;
             }
 
-            light_level.level = g_switchapp_data.brightness_level;
-            light_level.tid = switch_cmd_tid++;
-            LightSetLevel(DEFAULT_NW_ID, switch_model_groups[0], &light_level, 
-                                                                         FALSE);
+            sendLightLevel(g_switchapp_data.brightness_level);
 
             oneSecTimerId = TimerCreate(BUTTON_ONE_SEC_PRESS_TIME, TRUE,
                                                     handleButtonDebounce);
@@ -214,18 +467,17 @@ static void handleButtonDebounce(timer_id tid)
                 g_switchapp_data.brightness_level = MIN_LEVEL;
             }
 
-            light_level.level = g_switchapp_data.brightness_level;
-            light_level.tid = switch_cmd_tid++;
-            LightSetLevel(DEFAULT_NW_ID, switch_model_groups[0], &light_level, 
-                                                                         FALSE);
+            sendLightLevel(g_switchapp_data.brightness_level);
 
             oneSecTimerId = TimerCreate(BUTTON_ONE_SEC_PRESS_TIME, TRUE,
                                                     handleButtonDebounce);
         }
     }
 
+#ifndef ENABLE_COMMAND_COALESCING
     /* Restart the tid */
     switch_cmd_tid  = switch_cmd_tid > 255? 0: switch_cmd_tid;
+#endif /* ENABLE_COMMAND_COALESCING */
 
     /* Update NVM if required */
     if (update_nvm)
@@ -237,9 +237,10 @@ extern void ReadPersistentStore(void)
                   NVM_OFFSET_BEARER_STATE);
 
         /* Initialize model groups */
-        MemSet(switch_model_groups, 0x0000, sizeof(uint16)*MAX_MODEL_GROUPS);
+        MemSet(switch_model_groups, 0x0000,
+                                        sizeof(uint16)*SWITCH_MODEL_GROUPS);
         Nvm_Write((uint16 *)switch_model_groups, 
-                  sizeof(uint16)*MAX_MODEL_GROUPS,
+                  sizeof(uint16)*SWITCH_MODEL_GROUPS,
                   NVM_OFFSET_SWITCH_MODEL_GROUPS);
 
         MemSet(attention_model_groups, 0x0000, sizeof(uint16)*MAX_MODEL_GROUPS);
@@ -260,6 +261,11 @@ extern void ReadPersistentStore(void)
                   sizeof(uint16)*MAX_MODEL_GROUPS,
                   NVM_OFFSET_WDOG_MODEL_GROUPS);
 #endif
+
+#ifdef ENABLE_BUTTON_BINDINGS
+        AppButtonBindingReset();
+#endif /* ENABLE_BUTTON_BINDINGS */
+
         /* Write device name and length to NVM for the first time */
         GapInitWriteDataToNVM(&nvm_offset);
 
@@ -277,9 +283,14 @@ extern void ReadPersistentStore(void)
     }
 
     /* Read assigned Groups IDs for Switch model from NVM */
-    Nvm_Read((uint16 *)switch_model_groups, sizeof(uint16)*MAX_MODEL_GROUPS,
+    Nvm_Read((uint16 *)switch_model_groups, sizeof(uint16)*SWITCH_MODEL_GROUPS,
                                              NVM_OFFSET_SWITCH_MODEL_GROUPS);
 
+#ifdef ENABLE_BUTTON_BINDINGS
+    /* Read the bindings of the buttons to the switch model groups */
+    AppButtonBindingReadNVM();
+#endif /* ENABLE_BUTTON_BINDINGS */
+
 
     /* Read assigned Groups IDs for Attention model from NVM */
     Nvm_Read((uint16 *)attention_model_groups, sizeof(uint16)*MAX_MODEL_GROUPS,
@@ -375,7 +386,7 @@ extern bool HandleGroupSetMsg(CSR_MESH_GROUP_ID_RELATED_DATA_T msg)
 
     if(model == CSRMESH_SWITCH_MODEL || model == CSRMESH_ALL_MODELS)
     {
-        if(index < MAX_MODEL_GROUPS)
+        if(index < SWITCH_MODEL_GROUPS)
         {
             /* Store Group ID */
             switch_model_groups[index] = group_id;
@@ -564,16 +575,23 @@ extern void WriteApplicationAndServiceDataToNVM(void)
                NVM_OFFSET_SWITCH_STATE);
 
 
-    for(index = 0; index < MAX_MODEL_GROUPS; index++)
+    for(index = 0; index < SWITCH_MODEL_GROUPS; index++)
     {
         /* Save to NVM */
         Nvm_Write(&switch_model_groups[index],
                   sizeof(uint16),
                   NVM_OFFSET_SWITCH_MODEL_GROUPS + index);
+    }
+
+#ifdef ENABLE_BUTTON_BINDINGS
+    AppButtonBindingWriteNVM();
+#endif /* ENABLE_BUTTON_BINDINGS */
 
+    for(index = 0; index < MAX_MODEL_GROUPS; index++)
+    {
         Nvm_Write(&attention_model_groups[index],
                   sizeof(uint16),
-                  NVM_OFFSET_ATT_MODEL_GROUPS + index);
+                  NVM_OFFSET_ATTN_MODEL_GROUPS + index);
 
 #ifdef ENABLE_DATA_MODEL
         Nvm_Write(&data_model_groups[index],
@@ -32,7 +32,7 @@
  * This application currently erases all the NVM values if the NVM version has
  * changed.
  */
-#define APP_NVM_VERSION     (1)
+#define APP_NVM_VERSION     (2)
 
 #define CSR_MESH_SWITCH_PID (0x1061)
 
@@ -84,5 +84,34 @@
 /* Enable Device UUID Advertisements 
 #define ENABLE_DEVICE_UUID_ADVERTS */
 
+/* Enable level ramps. Pressing SW2 or SW3 sends one light power level message
+ * which fades the lights towards the minimum or maximum level, and releasing
+ * it sends one light level message which stops them at the level reached.
+ */
+#define ENABLE_LEVEL_RAMP
+
+/* Time in seconds taken to ramp the level across its full range */
+#define LEVEL_RAMP_TIME                (5)
+
+/* Enable command coalescing. A command waiting to be sent to a model and
+ * destination is replaced by the next command to the same pair, and commands
+ * are sent no faster than the mesh can transmit them while they go to no
+ * more destinations than the switch model groups.
+ */
+#define ENABLE_COMMAND_COALESCING
+
+/* Enable button bindings. Each button is bound to a set of the switch model
+ * groups and sends its commands to each of them, or to one group shared by
+ * all of them where one is configured. The bindings are stored in NVM.
+ */
+#define ENABLE_BUTTON_BINDINGS
+
+#ifdef ENABLE_BUTTON_BINDINGS
+/* Number of groups supported by the switch model */
+#define SWITCH_MODEL_GROUPS  (4)
+#else
+#define SWITCH_MODEL_GROUPS  (MAX_MODEL_GROUPS)
+#endif /* ENABLE_BUTTON_BINDINGS */
+
 #endif /* __USER_CONFIG_H__ */
 
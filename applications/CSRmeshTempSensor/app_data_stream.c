@@ -36,6 +36,7 @@
 *============================================================================*/
 #include "app_data_stream.h"
 #include "app_mesh_event_handler.h"
+#include "app_sensor_history.h"
 
 #ifdef ENABLE_DATA_MODEL
 /*=============================================================================*
@@ -62,6 +63,11 @@
 /* Max data per per stream send */
 #define MAX_DATA_STREAM_PACKET_SIZE       (8)
 
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+/* Length of the USER_SENSOR_UPDATE_STATS_RSP data block */
+#define UPDATE_STATS_RSP_LEN              (9)
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+
 /*============================================================================*
  *  Private Data Type
  *===========================================================================*/
@@ -118,6 +124,19 @@ static APP_STREAM_STATE_DATA_T app_stream_state;
 /* Stream bytes sent tracker */
 static uint16 tx_stream_offset = 0;
 
+/* Data sent in the current stream and its length */
+static const uint8 *tx_stream_data = device_info;
+static uint16 tx_stream_length = 0;
+
+/* Called when the report being sent ends */
+static APP_DATA_STREAM_DONE_T tx_stream_done = NULL;
+
+/* Device which asked for the device info while another stream was being
+ * sent. The device info is sent to it once that stream ends.
+ */
+static bool device_info_pending = FALSE;
+static uint16 device_info_dest_id;
+
 /* Stream send retry timer */
 static timer_id stream_send_retry_tid = TIMER_INVALID;
 
@@ -140,6 +159,12 @@ static APP_DATA_STREAM_CODE_T current_stream_code;
  *  Private Function Prototypes
  *============================================================================*/
 static void streamSendRetryTimer(timer_id tid);
+static void sendFlush(void);
+static void streamEnded(bool delivered);
+static void sendDeviceInfo(uint16 dest_id);
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+static void sendUpdateStats(uint16 dest_id);
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
 static void sendNextPacket(void);
 static void resetRxStreamState(void);
 static void rxStreamTimeoutHandler(timer_id tid);
@@ -151,7 +176,8 @@ static void handleCSRmeshDataStreamDataInd(uint16 src_id,
                                            CSRMESH_DATA_STREAM_SEND_T *p_event);
 static void handleCSRmeshDataStreamSendCfm(
                                        CSRMESH_DATA_STREAM_RECEIVED_T *p_event);
-static void startStream(uint16 dest_id);
+static void startStream(uint16 dest_id, const uint8 *p_data,
+                        uint16 length);
 static void endStream(void);
 
 /*=============================================================================*
@@ -163,7 +189,9 @@ static void endStream(void);
  *      streamSendRetryTimer
  *
  *  DESCRIPTION
- *      Timer handler to retry sending next packet
+ *      Timer handler to retry sending the flush or packet which has not been
+ *      acknowledged. After MAX_SEND_RETRIES the stream is ended without
+ *      waiting any longer for the receiver.
  *
  *  RETURNS
  *      Nothing.
@@ -176,9 +204,22 @@ static void streamSendRetryTimer(timer_id tid)
     {
         stream_send_retry_tid = TIMER_INVALID;
         stream_send_retry_count++;
-        if( stream_send_retry_count < MAX_SEND_RETRIES )
+        if( stream_send_retry_count >= MAX_SEND_RETRIES )
+        {
+            if(app_stream_state.tx.status == stream_send_in_progress)
+            {
+                /* Tell the receiver the stream has ended in case it can
+                 * still hear us
+                 */
+                sendFlush();
+            }
+
+            /* The receiver is not responding */
+            streamEnded(FALSE);
+        }
+        else if(app_stream_state.tx.status == stream_send_in_progress)
         {
-            MemCopy(send_param.streamoctets, &device_info[tx_stream_offset],
+            MemCopy(send_param.streamoctets, &tx_stream_data[tx_stream_offset],
                                              app_stream_state.tx.last_data_len);
             send_param.streamoctets_len = app_stream_state.tx.last_data_len;
             send_param.streamsn = app_stream_state.tx.sn;
@@ -191,16 +232,150 @@ static void streamSendRetryTimer(timer_id tid)
         }
         else
         {
-            stream_send_retry_count = 0;
-            endStream();
-            /* Set the mesh scan back to low duty cycle if the device is already 
-             * configured.
-             */
-            EnableHighDutyScanMode(FALSE);
+            /* The flush starting or ending the stream is not acknowledged */
+            sendFlush();
+
+            stream_send_retry_tid =  TimerCreate(STREAM_SEND_RETRY_TIME, TRUE,
+                                                          streamSendRetryTimer);
         }
     }
 }
 
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendFlush
+ *
+ *  DESCRIPTION
+ *      Sends a flush with the current sequence number to the stream receiver
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendFlush(void)
+{
+    CSRMESH_DATA_STREAM_FLUSH_T flush_param;
+
+    flush_param.streamsn = app_stream_state.tx.sn;
+    DataStreamFlush(CSR_MESH_DEFAULT_NETID, app_stream_state.tx.dest_id,
+                                                                  &flush_param);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      streamEnded
+ *
+ *  DESCRIPTION
+ *      Returns the stream transmit state to idle and tells the sender of the
+ *      report whether the receiver acknowledged all of it. A device info
+ *      request which arrived during the stream is then answered.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void streamEnded(bool delivered)
+{
+    APP_DATA_STREAM_DONE_T done = tx_stream_done;
+
+    TimerDelete(stream_send_retry_tid);
+    stream_send_retry_tid = TIMER_INVALID;
+    stream_send_retry_count = 0;
+
+    app_stream_state.tx.status = stream_send_idle;
+    app_stream_state.tx.sn = 0;
+    tx_stream_done = NULL;
+
+    /* Set the mesh scan back to low duty cycle if the device is already 
+     * configured.
+     */
+    EnableHighDutyScanMode(FALSE);
+
+    if(done != NULL)
+    {
+        done(delivered);
+    }
+
+    if(device_info_pending)
+    {
+        device_info_pending = FALSE;
+        sendDeviceInfo(device_info_dest_id);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendDeviceInfo
+ *
+ *  DESCRIPTION
+ *      Sends the device info to a device in a data stream. If another stream
+ *      is being sent it is not cut short, the device info is sent once it
+ *      ends instead.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendDeviceInfo(uint16 dest_id)
+{
+    if(AppDataStreamIsSending())
+    {
+        if(tx_stream_data != device_info ||
+           app_stream_state.tx.dest_id != dest_id)
+        {
+            device_info_pending = TRUE;
+            device_info_dest_id = dest_id;
+        }
+        return;
+    }
+
+    /* Change the Rx scan duty cycle to active at the start of stream */
+    EnableHighDutyScanMode(TRUE);
+    /* Set the source device ID as the stream target device */
+    tx_stream_offset = 0;
+    /* Set the opcode to CSR_DEVICE_INFO_RSP */
+    device_info[0] = CSR_DEVICE_INFO_RSP;
+
+    /* start sending the data */
+    startStream(dest_id, device_info, device_info_length + 2);
+}
+
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      sendUpdateStats
+ *
+ *  DESCRIPTION
+ *      Sends the statistics of the write value msgs sent for the temperature
+ *      updates in a USER_SENSOR_UPDATE_STATS_RSP data block. The fields are
+ *      sent little endian in the order: updates, msgs sent in the last
+ *      update, msgs sent in all updates and the retransmission level of the
+ *      next update.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void sendUpdateStats(uint16 dest_id)
+{
+    CSRMESH_DATA_BLOCK_SEND_T block_param;
+    const APP_TEMP_UPDATE_STATS_T *p_stats = AppTempUpdateGetStats();
+
+    block_param.datagramoctets[0] = USER_SENSOR_UPDATE_STATS_RSP;
+    block_param.datagramoctets[1] = p_stats->updates & 0xFF;
+    block_param.datagramoctets[2] = p_stats->updates >> 8;
+    block_param.datagramoctets[3] = p_stats->last_msgs_sent & 0xFF;
+    block_param.datagramoctets[4] = p_stats->last_msgs_sent >> 8;
+    block_param.datagramoctets[5] = p_stats->total_msgs_sent & 0xFF;
+    block_param.datagramoctets[6] = p_stats->total_msgs_sent >> 8;
+    block_param.datagramoctets[7] = p_stats->retransmit_level & 0xFF;
+    block_param.datagramoctets[8] = p_stats->retransmit_level >> 8;
+    block_param.datagramoctets_len = UPDATE_STATS_RSP_LEN;
+
+    DataBlockSend(CSR_MESH_DEFAULT_NETID, dest_id, &block_param);
+}
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      rxStreamTimeoutHandler
@@ -249,14 +424,15 @@ static void sendNextPacket(void)
     TimerDelete(stream_send_retry_tid);
     stream_send_retry_tid = TIMER_INVALID;
 
-    data_pending = device_info_length+2 - tx_stream_offset;
+    data_pending = tx_stream_length - tx_stream_offset;
 
     if( data_pending )
     {
         len = (data_pending > MAX_DATA_STREAM_PACKET_SIZE)? 
                                 MAX_DATA_STREAM_PACKET_SIZE : data_pending;
 
-        MemCopy(send_param.streamoctets, &device_info[tx_stream_offset],len);
+        MemCopy(send_param.streamoctets, &tx_stream_data[tx_stream_offset],
+                                                                        len);
         send_param.streamoctets_len = len;
         send_param.streamsn = app_stream_state.tx.sn;
         /* Send the next packet */
@@ -271,10 +447,6 @@ static void sendNextPacket(void)
     {
         /* Send flush to indicate end of stream */
         endStream();
-        /* Set the mesh scan back to low duty cycle if the device is already 
-         * configured.
-         */
-        EnableHighDutyScanMode(FALSE);
     }
 }
 
@@ -352,15 +524,7 @@ static void handleCSRmeshDataBlockInd(uint16 src_id,
     {
         case CSR_DEVICE_INFO_REQ:
         {
-            /* Change the Rx scan duty cycle to active at the start of stream */
-            EnableHighDutyScanMode(TRUE);
-            /* Set the source device ID as the stream target device */
-            tx_stream_offset = 0;
-            /* Set the opcode to CSR_DEVICE_INFO_RSP */
-            device_info[0] = CSR_DEVICE_INFO_RSP;
-
-            /* start sending the data */
-            startStream(src_id);
+            sendDeviceInfo(src_id);
         }
         break;
 
@@ -375,6 +539,35 @@ static void handleCSRmeshDataBlockInd(uint16 src_id,
         }
         break;
 
+#ifdef ENABLE_AGGREGATED_ACK
+        case USER_SENSOR_ACK_LIST:
+        {
+            HandleAggregatedAck(src_id, &p_event->datagramoctets[1],
+                                p_event->datagramoctets_len - 1);
+        }
+        break;
+#endif /* ENABLE_AGGREGATED_ACK */
+
+#ifdef ENABLE_SENSOR_HISTORY
+        case USER_SENSOR_HISTORY_REQ:
+        {
+            /* Upload the history to the requester, who also takes the
+             * uploads made when the history is nearly full.
+             */
+            AppSensorHistoryUpload(src_id);
+        }
+        break;
+#endif /* ENABLE_SENSOR_HISTORY */
+
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+        case USER_SENSOR_UPDATE_STATS_REQ:
+        {
+            /* Report the msgs sent for the temperature updates */
+            sendUpdateStats(src_id);
+        }
+        break;
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+
         default:
         break;
     }
@@ -409,14 +602,7 @@ static void handleCSRmeshDataStreamDataInd(uint16 src_id,
         {
             case CSR_DEVICE_INFO_REQ:
             {
-                /* Change the Rx scan duty cycle to active at start of stream */
-                EnableHighDutyScanMode(TRUE);
-                /* Set the source device ID as the stream target device */
-                tx_stream_offset = 0;
-                /* Set the stream code to CSR_DEVICE_INFO_RSP */
-                device_info[0] = CSR_DEVICE_INFO_RSP;
-                /* Start the stream */
-                startStream(src_id);
+                sendDeviceInfo(src_id);
             }
             break;
 
@@ -490,16 +676,19 @@ static void handleCSRmeshDataStreamSendCfm(
  *  DESCRIPTION
  *      Initialises the stream model to start sending a data stream. 
  *      This function sets the receiver device ID to which the data is to be
- *      sent using the StreamSendData
+ *      sent using the StreamSendData and the data to be sent. The data must
+ *      stay unchanged until the stream ends. The start flush is retried
+ *      until it is acknowledged, or the stream ends after MAX_SEND_RETRIES.
  *
  *  RETURNS/MODIFIES
  *      Nothing
  *
  *----------------------------------------------------------------------------*/
-static void startStream(uint16 dest_id)
+static void startStream(uint16 dest_id, const uint8 *p_data, uint16 length)
 {
-    CSRMESH_DATA_STREAM_FLUSH_T flush_param;
     app_stream_state.tx.dest_id = dest_id;
+    tx_stream_data = p_data;
+    tx_stream_length = length;
 
     /* Initialise the next expected sequence number to 0 */
     app_stream_state.tx.sn = 0;
@@ -508,8 +697,12 @@ static void startStream(uint16 dest_id)
     app_stream_state.tx.last_data_len = 0;
 
     /* Send flush to indicate start of stream */
-    flush_param.streamsn = app_stream_state.tx.sn;
-    DataStreamFlush(CSR_MESH_DEFAULT_NETID, dest_id, &flush_param);
+    sendFlush();
+
+    stream_send_retry_count = 0;
+    TimerDelete(stream_send_retry_tid);
+    stream_send_retry_tid = TimerCreate(STREAM_SEND_RETRY_TIME, TRUE,
+                                                       streamSendRetryTimer);
 }
 
 /*----------------------------------------------------------------------------*
@@ -517,7 +710,9 @@ static void startStream(uint16 dest_id)
  *      endStream
  *
  *  DESCRIPTION
- *      Sends flush to end stream and updates the stream transmit state
+ *      Sends flush to end stream and updates the stream transmit state. The
+ *      end flush is retried until it is acknowledged, or the stream ends
+ *      after MAX_SEND_RETRIES.
  *
  *  RETURNS/MODIFIES
  *      Nothing
@@ -525,16 +720,16 @@ static void startStream(uint16 dest_id)
  *----------------------------------------------------------------------------*/
 static void endStream(void)
 {
-    CSRMESH_DATA_STREAM_FLUSH_T flush_param;
-    if(app_stream_state.tx.status == stream_send_in_progress)
-    {
-        app_stream_state.tx.status = stream_finish_flush_sent;
-        app_stream_state.tx.last_data_len = 0;
-    }
+    app_stream_state.tx.status = stream_finish_flush_sent;
+    app_stream_state.tx.last_data_len = 0;
+
     /* Send flush to end stream */
-    flush_param.streamsn = app_stream_state.tx.sn;
-    DataStreamFlush(CSR_MESH_DEFAULT_NETID, app_stream_state.tx.dest_id, 
-                                                                  &flush_param);
+    sendFlush();
+
+    stream_send_retry_count = 0;
+    TimerDelete(stream_send_retry_tid);
+    stream_send_retry_tid = TimerCreate(STREAM_SEND_RETRY_TIME, TRUE,
+                                                       streamSendRetryTimer);
 }
 
 
@@ -579,10 +774,62 @@ extern void AppDataStreamInit(uint16 *group_id_list, uint16 num_groups)
     app_stream_state.tx.dest_id = 0;
     app_stream_state.tx.status = stream_send_idle;
     app_stream_state.tx.last_data_len = 0;
+    tx_stream_done = NULL;
+    device_info_pending = FALSE;
 
     MemCopy(&device_info[2], DEVICE_INFO_STRING, sizeof(DEVICE_INFO_STRING));
 }
 
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      AppDataStreamIsSending
+ *
+ *  DESCRIPTION
+ *      This function checks whether a data stream is being sent.
+ *
+ *  RETURNS
+ *      TRUE if a stream is being sent.
+ *
+ *----------------------------------------------------------------------------*/
+extern bool AppDataStreamIsSending(void)
+{
+    return (app_stream_state.tx.status != stream_send_idle);
+}
+
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      AppDataStreamSendReport
+ *
+ *  DESCRIPTION
+ *      This function sends a report to a device in a data stream. The report
+ *      must stay unchanged until the stream ends. The done handler, if any,
+ *      is then called with TRUE if the receiver acknowledged the whole
+ *      stream, including the flush ending it.
+ *
+ *  RETURNS
+ *      TRUE if the stream was started, FALSE if a stream is already being
+ *      sent.
+ *
+ *----------------------------------------------------------------------------*/
+extern bool AppDataStreamSendReport(uint16 dest_id, const uint8 *p_data,
+                                    uint16 length,
+                                    APP_DATA_STREAM_DONE_T done)
+{
+    if(AppDataStreamIsSending())
+    {
+        return FALSE;
+    }
+
+    /* Change the Rx scan duty cycle to active at the start of stream */
+    EnableHighDutyScanMode(TRUE);
+
+    tx_stream_offset = 0;
+    tx_stream_done = done;
+    startStream(dest_id, p_data, length);
+
+    return TRUE;
+}
+
 
 /*----------------------------------------------------------------------------*
  *  NAME
@@ -770,8 +1017,7 @@ CSRmeshResult AppDataClientHandler(CSRMESH_MODEL_EVENT_T event_code,
                 /* Received the acknowledgement for the stream flush sent
                  * to finish the stream
                  */
-                app_stream_state.tx.status = stream_send_idle;
-                app_stream_state.tx.sn = 0;
+                streamEnded(TRUE);
             }
             
             /* nesn must be tx.sn + tx.last_data_len */
@@ -46,9 +46,19 @@ typedef enum
     CSR_DEVICE_INFO_REQ = 0x01,
     CSR_DEVICE_INFO_RSP = 0x02,
     CSR_DEVICE_INFO_SET = 0x03,
-    CSR_DEVICE_INFO_RESET = 0x04
+    CSR_DEVICE_INFO_RESET = 0x04,
+    USER_SENSOR_ACK_LIST = 0x09,
+    USER_SENSOR_HISTORY_REQ = 0x0A,
+    USER_SENSOR_HISTORY_RSP = 0x0B,
+    USER_SENSOR_UPDATE_STATS_REQ = 0x0C,
+    USER_SENSOR_UPDATE_STATS_RSP = 0x0D
 }APP_DATA_STREAM_CODE_T;
 
+/* Called when a report stream ends, with TRUE if the receiver acknowledged
+ * all of it
+ */
+typedef void (*APP_DATA_STREAM_DONE_T)(bool delivered);
+
 /*============================================================================*
  *  Public Function Prototypes
  *============================================================================*/
@@ -62,5 +72,12 @@ CSRmeshResult AppDataServerHandler(CSRMESH_MODEL_EVENT_T event_code,
                                    CSRMESH_EVENT_DATA_T* data,
                                    CsrUint16 length,
                                    void **state_data);
+
+/* Checks whether a data stream is being sent */
+bool AppDataStreamIsSending(void);
+
+/* Sends a report to a device in a data stream */
+bool AppDataStreamSendReport(uint16 dest_id, const uint8 *p_data,
+                             uint16 length, APP_DATA_STREAM_DONE_T done);
 #endif /* __APP_DATA_STREAM_H__ */
 
@@ -827,6 +827,9 @@ extern bool HandleLEAdvMessage(LM_EV_ADVERTISING_REPORT_T* report)
                                         CSR_SCHED_INCOMING_LE_MESH_DATA_EVENT,
                                         &unpackedData[index+4], (length-3), 
                                         report->rssi);
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+                    NoteMeshMsgHeard();
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
                     result = TRUE;
                     break;
                 }
@@ -38,6 +38,7 @@
 #include "csr_ota.h"
 #include "csr_ota_service.h"
 #include "gatt_service.h"
+#include "app_sensor_history.h"
 
 /*============================================================================*
  *  Private Definitions
@@ -55,11 +56,29 @@
 /* Max sensor type supp in this app sensor_type_desired_air_temperature = 3*/
 #define SENSOR_TYPE_SUPPORTED_MAX          (sensor_type_desired_air_temperature)
 
+/* Number of sensor values carried in one sensor write value msg */
+#define SENSOR_VALUES_PER_MSG               (2)
+
+/* Number of sensor types carried in one sensor types msg */
+#define MAX_SENSOR_TYPES_IN_RSP             (4)
+
 /* Max transmit msg density */
 #define MAX_TRANSMIT_MSG_DENSITY            (6)
 
+/* Interval at which the temperature is sampled. The EVENT pin of the sensor
+ * reports changes, so sampling is only kept as a fallback when it is used.
+ */
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+#define TEMP_SAMPLE_INTERVAL ((uint32)TEMPERATURE_FALLBACK_SAMPLING_INTERVAL)
+#else
+#define TEMP_SAMPLE_INTERVAL ((uint32)TEMPERATURE_SAMPLING_INTERVAL)
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
 #ifdef ENABLE_ACK_MODE
 
+/* Length of a (device id, tid) entry in the aggregated acknowledgement */
+#define AGGREGATED_ACK_ENTRY_LEN            (3)
+
 /* The maximum number of heater devices that in grp */
 #define MAX_HEATERS_IN_GROUP                (5)
 
@@ -69,11 +88,52 @@
 #define MAX_NO_RESPONSE_COUNT               (5)
 #endif /* ENABLE_ACK_MODE */
 
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+/* Number of retransmission levels. The top level sends TRANSMIT_MSG_DENSITY
+ * msgs NUM_OF_RETRANSMISSIONS times, each level below it a quarter fewer.
+ */
+#define RETRANSMIT_LEVELS                   (4)
+
+/* Lowest retransmission level used. Only early acks take the level below
+ * RETRANSMIT_NO_ACK_MIN_LEVEL: without acks there is no evidence that fewer
+ * msgs get through, and at DEFAULT_RX_DUTY_CYCLE the sensor hears so little
+ * of the mesh traffic that the neighbourhood nearly always looks quiet.
+ */
+#define RETRANSMIT_MIN_LEVEL                (1)
+#define RETRANSMIT_NO_ACK_MIN_LEVEL         (RETRANSMIT_LEVELS - 1)
+
+/* Mesh msgs heard per retransmission below which the neighbourhood is taken
+ * to be quiet and above which it is taken to be busy.
+ */
+#define RETRANSMIT_QUIET_MSGS               (1)
+#define RETRANSMIT_BUSY_MSGS                (4)
+
+/* Outcome of a temperature update */
+typedef enum
+{
+    retransmit_no_acks,         /* No heaters are known to ack the writes */
+    retransmit_acked_early,     /* All acks within half the retransmissions */
+    retransmit_acked,           /* All acks received */
+    retransmit_acks_missing     /* One or more heaters did not ack */
+} RETRANSMIT_OUTCOME_T;
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+
+/* Function pointer which starts a read of a sensor. The value read is
+ * reported to updateSensorValue.
+ */
+typedef bool (*SENSOR_READ_T)(void);
+
+/* Sensor registry entry */
 typedef struct
 {
-    sensor_type_t type;
-    uint16        *value;
+    sensor_type_t type;         /* Sensor type */
+    SENSOR_READ_T read;         /* Starts a read, NULL if set by the app */
+    uint16        *value;       /* Current value, 0 until it is known */
+    uint16        *last_bcast;  /* Value last written onto the groups */
+    uint16        tolerance;    /* Change from last_bcast which is written */
+    uint16        nvm_slot;     /* Slot of the sensor state in NVM */
     uint8         repeat_interval;
+    uint16        sent_value;   /* Value sent in the previous update */
 } SENSOR_DATA_T;
 
 #ifdef ENABLE_ACK_MODE
@@ -104,8 +164,36 @@ CSR_MESH_VID_PID_VERSION_T vid_pid_info =
     .version    = APP_VERSION,
 };
 
-/* Sensor Model Data */
-static SENSOR_DATA_T sensor_data[NUM_SENSORS_SUPPORTED];
+/* Sensor Model Data. Entries are in ascending order of sensor type and are
+ * indexed by the *_IDX definitions. Another sensor type is supported by
+ * adding its entry here and raising NUM_SENSORS_SUPPORTED.
+ */
+static SENSOR_DATA_T sensor_data[NUM_SENSORS_SUPPORTED] =
+{
+    {
+        sensor_type_internal_air_temperature,
+        TempSensorRead,
+        (uint16 *)&current_air_temp,
+        (uint16 *)&last_bcast_air_temp,
+        TEMPERATURE_CHANGE_TOLERANCE,
+        CURRENT_AIR_TEMP_IDX,
+        0,
+        0
+    },
+    {
+        sensor_type_desired_air_temperature,
+        NULL,
+        (uint16 *)&current_desired_air_temp,
+        (uint16 *)&last_bcast_desired_air_temp,
+        1,
+        DESIRED_AIR_TEMP_IDX,
+        0,
+        0
+    }
+};
+
+/* Bit mask of the sensors whose change is being written onto the groups */
+static uint16 write_val_changed = 0;
 
 /* Temperature Sensor Sample Timer ID. */
 static timer_id tempsensor_sample_tid = TIMER_INVALID;
@@ -119,6 +207,23 @@ static timer_id repeat_interval_tid = TIMER_INVALID;
 /* Write Value Msg Retransmit counter */
 static uint16 write_val_retransmit_count = 0;
 
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+/* Current retransmission level */
+static uint16 retransmit_level = RETRANSMIT_LEVELS;
+
+/* Number of retransmissions the current temperature update started with */
+static uint16 write_val_retransmit_total = 0;
+
+/* Number of write value msgs sent for the current temperature update */
+static uint16 write_val_msg_count = 0;
+
+/* Write value msgs sent for the temperature updates completed */
+static APP_TEMP_UPDATE_STATS_T temp_update_stats;
+
+/* Number of mesh msgs heard during the current temperature update */
+static uint16 mesh_msgs_heard = 0;
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+
 /* Temperature Value in 1/32 kelvin units. */
 SENSOR_FORMAT_TEMPERATURE_T current_air_temp;
 
@@ -155,6 +260,9 @@ static uint8 transmit_msg_density = TRANSMIT_MSG_DENSITY;
 #ifdef ENABLE_ACK_MODE
 /* Stores the device info of the heaters participating in the group.*/
 static HEATER_INFO_T heater_list[MAX_HEATERS_IN_GROUP];
+
+/* Transaction id of the temperature update being sent */
+static uint8 write_val_tid = 0;
 #endif /* ENABLE_ACK_MODE */
 
 /* Attention timer id */
@@ -166,8 +274,18 @@ static MODEL_RSP_DATA_T model_rsp_data;
 /*============================================================================*
  *  Private Function Prototypes
  *============================================================================*/
+static uint16 getSensorIndex(sensor_type_t type);
+static uint8 getRepeatInterval(void);
+static void readSensors(void);
+static bool updateSensorValue(uint16 idx, uint16 value);
+static void packSensorValue(uint16 idx, sensor_type_t *p_type,
+                            CsrUint8 *p_value, CsrUint8 *p_value_len);
 static void writeTempValue(void);
 static void startRetransmitTimer(void);
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+static void adaptRetransmitLevel(RETRANSMIT_OUTCOME_T outcome);
+static void endTempUpdate(void);
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
 static void repeatIntervalTimerHandler(timer_id tid);
 
 /*============================================================================*
@@ -259,6 +377,71 @@ static void resetAckInHeaterList(void)
         }
     }
 }
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      recordHeaterAck
+ *
+ *  DESCRIPTION
+ *      The function records the ack received from a heater. If the heater is
+ *      not present in the list it is added onto it.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void recordHeaterAck(uint16 src_id)
+{
+    uint16 index;
+
+    for(index = 0; index < MAX_HEATERS_IN_GROUP; index++)
+    {
+        if(heater_list[index].dev_id == src_id)
+        {
+            heater_list[index].ack_recvd = TRUE;
+            heater_list[index].no_response_count = 0;
+            return;
+        }
+    }
+
+    for(index = 0; index < MAX_HEATERS_IN_GROUP; index++)
+    {
+        if(heater_list[index].dev_id == MESH_BROADCAST_ID)
+        {
+            heater_list[index].dev_id = src_id;
+            heater_list[index].ack_recvd = TRUE;
+            heater_list[index].no_response_count = 0;
+            return;
+        }
+    }
+}
+
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      heaterListHasDevices
+ *
+ *  DESCRIPTION
+ *      The function checks whether any heater has been added to the list
+ *
+ *  RETURNS
+ *      TRUE if a heater is present in the list.
+ *
+ *---------------------------------------------------------------------------*/
+static bool heaterListHasDevices(void)
+{
+    uint16 idx;
+
+    for(idx=0; idx < MAX_HEATERS_IN_GROUP; idx++)
+    {
+        if(heater_list[idx].dev_id != MESH_BROADCAST_ID)
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
 #endif /* ENABLE_ACK_MODE */
 
 /*-----------------------------------------------------------------------------*
@@ -287,13 +470,146 @@ static uint8 getSensorGroupCount(void)
     return num_groups;
 }
 
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      getSensorIndex
+ *
+ *  DESCRIPTION
+ *      This function finds the registry entry of a sensor type.
+ *
+ *  RETURNS
+ *      Index of the entry, NUM_SENSORS_SUPPORTED if the type is not supported.
+ *
+ *----------------------------------------------------------------------------*/
+static uint16 getSensorIndex(sensor_type_t type)
+{
+    uint16 idx;
+
+    for(idx = 0; idx < NUM_SENSORS_SUPPORTED; idx++)
+    {
+        if(sensor_data[idx].type == type)
+        {
+            break;
+        }
+    }
+    return idx;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      getRepeatInterval
+ *
+ *  DESCRIPTION
+ *      This function finds the smallest repeat interval set on the sensors.
+ *
+ *  RETURNS
+ *      Repeat interval in seconds, 0 if none of the sensors repeat.
+ *
+ *----------------------------------------------------------------------------*/
+static uint8 getRepeatInterval(void)
+{
+    uint8 interval = 0;
+    uint16 idx;
+
+    for(idx = 0; idx < NUM_SENSORS_SUPPORTED; idx++)
+    {
+        if(sensor_data[idx].repeat_interval != 0 &&
+           (interval == 0 || sensor_data[idx].repeat_interval < interval))
+        {
+            interval = sensor_data[idx].repeat_interval;
+        }
+    }
+    return interval;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      readSensors
+ *
+ *  DESCRIPTION
+ *      This function starts a read of the sensors which are read from the
+ *      hardware.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void readSensors(void)
+{
+    uint16 idx;
+
+    for(idx = 0; idx < NUM_SENSORS_SUPPORTED; idx++)
+    {
+        if(sensor_data[idx].read != NULL)
+        {
+            sensor_data[idx].read();
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      updateSensorValue
+ *
+ *  DESCRIPTION
+ *      This function takes a value read from a sensor as its current value if
+ *      it has moved by the tolerance of the sensor from the last broadcast
+ *      value.
+ *
+ *  RETURNS
+ *      TRUE if the value has to be written onto the groups.
+ *
+ *----------------------------------------------------------------------------*/
+static bool updateSensorValue(uint16 idx, uint16 value)
+{
+    SENSOR_DATA_T *p_sensor = &sensor_data[idx];
+
+    if(ABS_DIFF(*p_sensor->last_bcast, value) < p_sensor->tolerance)
+    {
+        return FALSE;
+    }
+
+    *p_sensor->value = value;
+
+    /* Set last Broadcast value to the current value. */
+    *p_sensor->last_bcast = value;
+
+    return TRUE;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      packSensorValue
+ *
+ *  DESCRIPTION
+ *      This function fills in the type and the current value of a sensor in
+ *      a sensor msg.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void packSensorValue(uint16 idx, sensor_type_t *p_type,
+                            CsrUint8 *p_value, CsrUint8 *p_value_len)
+{
+    uint16 value = *sensor_data[idx].value;
+
+    *p_type = sensor_data[idx].type;
+    p_value[0] = value & 0xFF;
+    p_value[1] = (value >> 8) & 0xFF;
+    *p_value_len = 2;
+}
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      writeTempValue
  *
  *  DESCRIPTION
- *      This function writes the current and the desired temp values onto the 
- *      groups.
+ *      This function writes the sensor values onto the groups. The sensors
+ *      which changed are packed first, SENSOR_VALUES_PER_MSG to a msg, and
+ *      the space left in the last msg is filled with the other sensors. When
+ *      no sensor changed, as on a repeat interval, all of them are written.
+ *      Sensors whose value is not yet known are left out.
  *
  *  RETURNS
  *      Nothing.
@@ -302,7 +618,9 @@ static uint8 getSensorGroupCount(void)
 *----------------------------------------------------------------------------*/
 static void writeTempValue(void)
 {
-    uint16 index, index1;
+    uint16 index, index1, msg;
+    uint16 order[NUM_SENSORS_SUPPORTED];
+    uint16 num_changed = 0, num_values = 0;
     bool ack_reqd = FALSE;
     CSRMESH_SENSOR_WRITE_VALUE_T sensor_values;
 
@@ -310,34 +628,77 @@ static void writeTempValue(void)
     ack_reqd = TRUE;
 #endif /* ENABLE_ACK_MODE */
 
+    /* Changed sensors first, then the others */
+    for(index = 0; index < NUM_SENSORS_SUPPORTED; index++)
+    {
+        if(*sensor_data[index].value != 0 &&
+           (write_val_changed & (1 << index)))
+        {
+            order[num_changed++] = index;
+        }
+    }
+    num_values = num_changed;
+    for(index = 0; index < NUM_SENSORS_SUPPORTED; index++)
+    {
+        if(*sensor_data[index].value != 0 &&
+           !(write_val_changed & (1 << index)))
+        {
+            order[num_values++] = index;
+        }
+    }
+
+    /* Only send the msgs needed for the changed sensors */
+    if(num_changed != 0)
+    {
+        num_changed = ((num_changed + SENSOR_VALUES_PER_MSG - 1) /
+                       SENSOR_VALUES_PER_MSG) * SENSOR_VALUES_PER_MSG;
+        if(num_values > num_changed)
+        {
+            num_values = num_changed;
+        }
+    }
+
+    sensor_values.tid = 0;
+#ifdef ENABLE_ACK_MODE
+    sensor_values.tid = write_val_tid;
+#endif /* ENABLE_ACK_MODE */
+
     for(index1 = 0; index1 < transmit_msg_density; index1 ++)
     {
         for(index = 0; index < NUM_SENSOR_MODEL_GROUPS; index++)
         {
-            if(sensor_model_groups[index] != 0 && 
-               current_air_temp != 0 &&
-               current_desired_air_temp != 0)
+            if(sensor_model_groups[index] == 0)
             {
-                /* Retransmitting same messages back to back multiple times 
-                 * increases the probability of the message being received by 
-                 * devices running on low duty cycle scan. 
-                 * This can be tuned by setting the TRANSMIT_MESSAGE_DENSITY 
-                 */
-                /* transmit the pending message to all the groups */
-                sensor_values.type = sensor_type_internal_air_temperature;
-                sensor_values.value[0] = current_air_temp & 0xFF;
-                sensor_values.value[1] = ((current_air_temp >> 8) & 0xFF);
-                sensor_values.value_len = 2;
-                sensor_values.type2 = sensor_type_desired_air_temperature;
-                sensor_values.value2[0] = current_desired_air_temp & 0xFF;
-                sensor_values.value2[1] = ((current_desired_air_temp >> 8) & 0xFF);
-                sensor_values.value2_len= 2;
-                sensor_values.tid = 0;
+                continue;
+            }
+
+            /* Retransmitting same messages back to back multiple times 
+             * increases the probability of the message being received by 
+             * devices running on low duty cycle scan. 
+             * This can be tuned by setting the TRANSMIT_MESSAGE_DENSITY 
+             */
+            /* transmit the pending message to all the groups */
+            for(msg = 0; msg < num_values; msg += SENSOR_VALUES_PER_MSG)
+            {
+                packSensorValue(order[msg], &sensor_values.type,
+                                sensor_values.value, &sensor_values.value_len);
+
+                sensor_values.type2 = sensor_type_invalid;
+                sensor_values.value2_len = 0;
+                if(msg + 1 < num_values)
+                {
+                    packSensorValue(order[msg + 1], &sensor_values.type2,
+                                    sensor_values.value2,
+                                    &sensor_values.value2_len);
+                }
 
                 SensorWriteValue(0,
                                  sensor_model_groups[index],
                                  &sensor_values,
                                  ack_reqd);
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+                write_val_msg_count++;
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
             }
         }
     }
@@ -360,6 +721,9 @@ static void retransmitIntervalTimerHandler(timer_id tid)
     if (tid == retransmit_tid)
     {
         bool start_timer = TRUE;
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+        RETRANSMIT_OUTCOME_T outcome = retransmit_no_acks;
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
 
         retransmit_tid = TIMER_INVALID;
 
@@ -389,6 +753,20 @@ static void retransmitIntervalTimerHandler(timer_id tid)
                     DEBUG_STR(" RECVD ALL ACK'S STOP TIMER : ");
                 }
             }
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+            if(start_timer == FALSE && heaterListHasDevices())
+            {
+                if(write_val_retransmit_count >= 
+                                            (write_val_retransmit_total/2))
+                {
+                    outcome = retransmit_acked_early;
+                }
+                else
+                {
+                    outcome = retransmit_acked;
+                }
+            }
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
             /* One or more devices have not acked back increase the no response
              * count. If the no response count reaches the maximum, remove the
              * device from the heater list.
@@ -400,6 +778,9 @@ static void retransmitIntervalTimerHandler(timer_id tid)
                     if(heater_list[idx].dev_id != MESH_BROADCAST_ID &&
                        heater_list[idx].ack_recvd == FALSE)
                     {
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+                        outcome = retransmit_acks_missing;
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
                         heater_list[idx].no_response_count++;
                         if(heater_list[idx].no_response_count >= 
                                                         MAX_NO_RESPONSE_COUNT)
@@ -418,8 +799,110 @@ static void retransmitIntervalTimerHandler(timer_id tid)
             /* start a timer to send the broadcast sensor data */
             startRetransmitTimer();
         }
+
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+        /* The temperature update is complete if no more msgs are due */
+        if(retransmit_tid == TIMER_INVALID)
+        {
+            adaptRetransmitLevel(outcome);
+            endTempUpdate();
+        }
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+    }
+}
+
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      adaptRetransmitLevel
+ *
+ *  DESCRIPTION
+ *      This function moves the retransmission level for the next temperature
+ *      update based on the outcome of the one just completed. Acks received
+ *      early lower the level and missing acks raise it. When no acks are
+ *      expected the mesh traffic heard per retransmission is used instead,
+ *      a quiet neighbourhood lowering the level no further than
+ *      RETRANSMIT_NO_ACK_MIN_LEVEL and a busy one raising it.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void adaptRetransmitLevel(RETRANSMIT_OUTCOME_T outcome)
+{
+    uint16 retransmissions = write_val_retransmit_total - 
+                             write_val_retransmit_count;
+
+    switch(outcome)
+    {
+        case retransmit_acked_early:
+            if(retransmit_level > RETRANSMIT_MIN_LEVEL)
+            {
+                retransmit_level--;
+            }
+        break;
+
+        case retransmit_acks_missing:
+            /* Go back to the top level at once so that the heaters which
+             * missed this update get the next one.
+             */
+            retransmit_level = RETRANSMIT_LEVELS;
+        break;
+
+        case retransmit_no_acks:
+            if(mesh_msgs_heard < retransmissions * RETRANSMIT_QUIET_MSGS &&
+               retransmit_level > RETRANSMIT_NO_ACK_MIN_LEVEL)
+            {
+                retransmit_level--;
+            }
+            else if(mesh_msgs_heard > retransmissions * RETRANSMIT_BUSY_MSGS &&
+                    retransmit_level < RETRANSMIT_LEVELS)
+            {
+                retransmit_level++;
+            }
+        break;
+
+        default:
+        break;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      endTempUpdate
+ *
+ *  DESCRIPTION
+ *      This function records the number of write value msgs sent for the
+ *      temperature update in the statistics and clears the counts for the
+ *      next one.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void endTempUpdate(void)
+{
+    temp_update_stats.updates++;
+    temp_update_stats.last_msgs_sent = write_val_msg_count;
+    if(temp_update_stats.total_msgs_sent < 0xFFFF - write_val_msg_count)
+    {
+        temp_update_stats.total_msgs_sent += write_val_msg_count;
+    }
+    else
+    {
+        temp_update_stats.total_msgs_sent = 0xFFFF;
     }
+
+    DEBUG_STR(" MSGS SENT FOR TEMP UPDATE : ");
+    PrintInDecimal(write_val_msg_count);
+    DEBUG_STR(" NEXT RETRANSMIT LEVEL : ");
+    PrintInDecimal(retransmit_level);
+    DEBUG_STR("\r\n");
+
+    write_val_msg_count = 0;
+    mesh_msgs_heard = 0;
 }
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
 
 /*----------------------------------------------------------------------------*
  *  NAME
@@ -465,12 +948,12 @@ static void tempSensorSampleIntervalTimeoutHandler(timer_id tid)
     {
         tempsensor_sample_tid = TIMER_INVALID;
 
-        /* Issue a Temperature Sensor Read. */
-        TempSensorRead();
+        /* Issue a Sensor Read. */
+        readSensors();
 
         /* Start the timer for next sample. */
         tempsensor_sample_tid = TimerCreate(
-                                        (uint32)TEMPERATURE_SAMPLING_INTERVAL, 
+                                        TEMP_SAMPLE_INTERVAL, 
                                         TRUE,
                                         tempSensorSampleIntervalTimeoutHandler);
     }
@@ -481,7 +964,8 @@ static void tempSensorSampleIntervalTimeoutHandler(timer_id tid)
  *      tempSensorEvent
  *
  *  DESCRIPTION
- *      This function Handles the sensor read complete event. Checks if the new 
+ *      This function Handles the sensor read complete event of the
+ *      temperature sensor at index idx of the registry. Checks if the new
  *      temperature is within tolerence from the last broadcast value, otherwise
  *      broadcasts new value.
  *
@@ -489,12 +973,11 @@ static void tempSensorSampleIntervalTimeoutHandler(timer_id tid)
  *      Nothing.
  *
  *----------------------------------------------------------------------------*/
-static void tempSensorEvent(int16 temp)
+static void tempSensorEvent(uint16 idx, int16 temp)
 {
     /* Check if the new value is valid. */
     if (temp > 0)
     {
-        uint16 abs_diff;
         SENSOR_FORMAT_TEMPERATURE_T cur_temp_returned = temp;
 
         /* If Desired air temperature is not Initialised, Initialise it based 
@@ -509,25 +992,24 @@ static void tempSensorEvent(int16 temp)
         PrintInDecimal(cur_temp_returned/32);
         DEBUG_STR(" kelvin\r\n");
 
-        /* Find the absolute difference between current and last broadcast
-         * temperatures.
-         */
-        abs_diff = ABS_DIFF((uint16)last_bcast_air_temp, cur_temp_returned);
+#ifdef ENABLE_SENSOR_HISTORY
+        AppSensorHistoryRecord(cur_temp_returned);
+#endif /* ENABLE_SENSOR_HISTORY */
 
         /* If it changed beyond the tolerance value, then write the current 
-         * temp onto the group.
+         * temp onto the group as well as reset the retransmit count to max
+         * and start the retransmit timer if its not started.
          */
-        if (abs_diff >= TEMPERATURE_CHANGE_TOLERANCE)
+        if (updateSensorValue(idx, cur_temp_returned))
         {
-            /* Set the present temperature as it is more than the temperature
-             * tolerance change. Write the new value to the group as well as
-             * reset the retransmit count to max and start the retransmit timer
-             * if its not started.
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+            /* Wake on the sensor event when the temperature next moves
+             * beyond the tolerance from the broadcast value.
              */
-            current_air_temp = cur_temp_returned;
-
-            /* Set last Broadcast Temperature to current temperature. */
-            last_bcast_air_temp = current_air_temp;
+            TempSensorSetEventBand(
+                    *sensor_data[idx].last_bcast - sensor_data[idx].tolerance,
+                    *sensor_data[idx].last_bcast + sensor_data[idx].tolerance);
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
 
             StartTempTransmission();
         }
@@ -540,7 +1022,7 @@ static void tempSensorEvent(int16 temp)
  *
  *  DESCRIPTION
  *      Start the repeat interval timer  The function should be called only if
- *      the repeat interval on the desired or the current index is non zero.
+ *      the repeat interval of one of the sensors is non zero.
  *
  *  RETURNS/MODIFIES
  *      Nothing
@@ -548,18 +1030,10 @@ static void tempSensorEvent(int16 temp)
  *----------------------------------------------------------------------------*/
 static void startRepeatIntervalTimer (void)
 {
-    /* The app takes the minimum value of the repeat interval from current and
-     * desired repeat intervals.
+    /* The app takes the minimum value of the repeat intervals of the
+     * sensors.
      */
-    uint8 interval = sensor_data[CURRENT_AIR_TEMP_IDX].repeat_interval;
-
-    if(sensor_data[CURRENT_AIR_TEMP_IDX].repeat_interval == 0 || 
-      (sensor_data[DESIRED_AIR_TEMP_IDX].repeat_interval !=0 && 
-        sensor_data[DESIRED_AIR_TEMP_IDX].repeat_interval < 
-        sensor_data[CURRENT_AIR_TEMP_IDX].repeat_interval))
-    {
-        interval = sensor_data[DESIRED_AIR_TEMP_IDX].repeat_interval;
-    }
+    uint8 interval = getRepeatInterval();
 
     /* As the application transmits the same message for a longer period of time
      * we would consider the repeat interval values below 30 seconds to be 
@@ -618,8 +1092,10 @@ static void repeatIntervalTimerHandler(timer_id tid)
  *----------------------------------------------------------------------------*/
 extern void InitiliseSensorData(void)
 {
+    uint16 index;
+
     /* Initialise Temperature Sensor Hardware. */
-    if (!TempSensorHardwareInit(tempSensorEvent))
+    if (!TempSensorHardwareInit(CURRENT_AIR_TEMP_IDX, tempSensorEvent))
     {
         DEBUG_STR("\r\nFailed to Initialise temperature sensor\r\n");
     }
@@ -627,30 +1103,113 @@ extern void InitiliseSensorData(void)
     /* Initialise Application specific Sensor Model Data.
      * This needs to be done before readPersistentStore.
          */
-    sensor_data[CURRENT_AIR_TEMP_IDX].repeat_interval = 
-                                        DEFAULT_REPEAT_INTERVAL & 0xFF;
-    sensor_data[CURRENT_AIR_TEMP_IDX].type        = 
-                                        sensor_type_internal_air_temperature;
-    sensor_data[CURRENT_AIR_TEMP_IDX].value       = 
-                                        (uint16 *)&current_air_temp;
-
-    sensor_data[DESIRED_AIR_TEMP_IDX].repeat_interval = 
-                                                DEFAULT_REPEAT_INTERVAL & 0xFF;
-    sensor_data[DESIRED_AIR_TEMP_IDX].type        = 
-                                        sensor_type_desired_air_temperature;
-    sensor_data[DESIRED_AIR_TEMP_IDX].value       = 
-                                        (uint16 *)&current_desired_air_temp;
+    for(index = 0; index < NUM_SENSORS_SUPPORTED; index++)
+    {
+        sensor_data[index].repeat_interval = DEFAULT_REPEAT_INTERVAL & 0xFF;
+        sensor_data[index].sent_value = 0;
+    }
 
     tempsensor_sample_tid = TIMER_INVALID;
     retransmit_tid  = TIMER_INVALID;
     repeat_interval_tid = TIMER_INVALID;
 
+#ifdef ENABLE_SENSOR_HISTORY
+    AppSensorHistoryInit();
+#endif /* ENABLE_SENSOR_HISTORY */
+
 #ifdef ENABLE_ACK_MODE 
     resetHeaterList();
 #endif /* ENABLE_ACK_MODE */
 }
 
 
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      NoteMeshMsgHeard
+ *
+ *  DESCRIPTION
+ *      This function counts the mesh msgs heard while a temperature update
+ *      is being sent. The count is used to judge how busy the neighbourhood
+ *      is when no acks are expected.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void NoteMeshMsgHeard(void)
+{
+    if(retransmit_tid != TIMER_INVALID && mesh_msgs_heard < 0xFFFF)
+    {
+        mesh_msgs_heard++;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppTempUpdateGetStats
+ *
+ *  DESCRIPTION
+ *      This function returns the statistics of the write value msgs sent
+ *      for the temperature updates.
+ *
+ *  RETURNS
+ *      Pointer to the statistics.
+ *
+ *---------------------------------------------------------------------------*/
+extern const APP_TEMP_UPDATE_STATS_T *AppTempUpdateGetStats(void)
+{
+    temp_update_stats.retransmit_level = retransmit_level;
+    return &temp_update_stats;
+}
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+
+#ifdef ENABLE_AGGREGATED_ACK
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      HandleAggregatedAck
+ *
+ *  DESCRIPTION
+ *      This function handles the aggregated acknowledgement sent by a heater
+ *      to the group. It lists the (device id, tid) of every sensor the heater
+ *      has heard:
+ *          |dev id LSB|dev id MSB|tid|dev id LSB|dev id MSB|tid|...
+ *      If the entry of this sensor is for the update being sent, the heater
+ *      is recorded as having acked, so that the retransmissions stop once
+ *      all the heaters have.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void HandleAggregatedAck(uint16 src_id, const uint8 *p_data,
+                                uint16 length)
+{
+    uint16 self_dev_id = 0;
+    CSR_MESH_APP_EVENT_DATA_T get_dev_id_data;
+    uint16 offset;
+
+    get_dev_id_data.appCallbackDataPtr = &self_dev_id;
+    CSRmeshGetDeviceID(CSR_MESH_DEFAULT_NETID, &get_dev_id_data);
+
+    for(offset = 0; offset + AGGREGATED_ACK_ENTRY_LEN <= length;
+        offset += AGGREGATED_ACK_ENTRY_LEN)
+    {
+        uint16 dev_id = (p_data[offset] & 0xFF) | 
+                        ((p_data[offset + 1] & 0xFF) << 8);
+
+        if(dev_id == self_dev_id)
+        {
+            if((p_data[offset + 2] & 0xFF) == write_val_tid)
+            {
+                recordHeaterAck(src_id);
+            }
+            break;
+        }
+    }
+}
+#endif /* ENABLE_AGGREGATED_ACK */
+
 /*----------------------------------------------------------------------------*
  * NAME
  *      StartTempTransmission
@@ -665,6 +1224,32 @@ extern void InitiliseSensorData(void)
 *----------------------------------------------------------------------------*/
 extern void StartTempTransmission(void)
 {
+    uint16 idx;
+
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+    /* An update still in progress is replaced by this one */
+    if(retransmit_tid != TIMER_INVALID)
+    {
+        endTempUpdate();
+    }
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+
+#ifdef ENABLE_ACK_MODE
+    /* Acks carry the tid of the update they acknowledge */
+    write_val_tid = (write_val_tid + 1) & 0xFF;
+#endif /* ENABLE_ACK_MODE */
+
+    /* Note the sensors which changed since the previous update */
+    write_val_changed = 0;
+    for(idx = 0; idx < NUM_SENSORS_SUPPORTED; idx++)
+    {
+        if(*sensor_data[idx].value != sensor_data[idx].sent_value)
+        {
+            write_val_changed |= (1 << idx);
+            sensor_data[idx].sent_value = *sensor_data[idx].value;
+        }
+    }
+
     transmit_msg_density = TRANSMIT_MSG_DENSITY;
 
     switch(getSensorGroupCount())
@@ -687,7 +1272,22 @@ extern void StartTempTransmission(void)
         break;
     }
 
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+    /* Scale the density and the msgs sent down to the current level */
+    transmit_msg_density = (transmit_msg_density * retransmit_level + 
+                            RETRANSMIT_LEVELS - 1) / RETRANSMIT_LEVELS;
+
+    write_val_retransmit_count = 
+                        ((NUM_OF_RETRANSMISSIONS * retransmit_level) / 
+                         RETRANSMIT_LEVELS) / transmit_msg_density;
+    if(write_val_retransmit_count == 0)
+    {
+        write_val_retransmit_count = 1;
+    }
+    write_val_retransmit_total = write_val_retransmit_count;
+#else
     write_val_retransmit_count = (NUM_OF_RETRANSMISSIONS/transmit_msg_density);
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
 
     DEBUG_STR(" RETRANSMIT_COUNT : ");
     PrintInDecimal(write_val_retransmit_count);
@@ -711,6 +1311,13 @@ extern void StartTempTransmission(void)
     retransmit_tid  = TIMER_INVALID;
     startRetransmitTimer();
 
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+    if(retransmit_tid == TIMER_INVALID)
+    {
+        endTempUpdate();
+    }
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+
     WriteSensorDataToNVM(DESIRED_AIR_TEMP_IDX);
 #ifdef ENABLE_ACK_MODE 
     resetAckInHeaterList();
@@ -731,13 +1338,15 @@ extern void StartTempTransmission(void)
 *----------------------------------------------------------------------------*/
 extern void ReadSensorDataFromNVM(uint16 idx)
 {
+    uint16 offset = GET_SENSOR_NVM_OFFSET(sensor_data[idx].nvm_slot);
+
     Nvm_Read((uint16*)(sensor_data[idx].value), 
              sizeof(uint16),
-             (GET_SENSOR_NVM_OFFSET(idx)));
+             offset);
 
     Nvm_Read((uint16*)&(sensor_data[idx].repeat_interval), 
              sizeof(uint8),
-             (GET_SENSOR_NVM_OFFSET(idx) + sizeof(uint8)));
+             (offset + sizeof(uint8)));
 
 }
 
@@ -755,13 +1364,15 @@ extern void ReadSensorDataFromNVM(uint16 idx)
 *----------------------------------------------------------------------------*/
 extern void WriteSensorDataToNVM(uint16 idx)
 {
+    uint16 offset = GET_SENSOR_NVM_OFFSET(sensor_data[idx].nvm_slot);
+
     Nvm_Write((uint16*)(sensor_data[idx].value), 
               sizeof(uint16),
-              (GET_SENSOR_NVM_OFFSET(idx)));
+              offset);
 
     Nvm_Write((uint16*)&(sensor_data[idx].repeat_interval), 
               sizeof(uint8),
-              (GET_SENSOR_NVM_OFFSET(idx) + sizeof(uint8)));
+              (offset + sizeof(uint8)));
 }
 
 /*-----------------------------------------------------------------------------*
@@ -815,8 +1426,7 @@ extern void ConfigureSensor(bool old_config)
         EnableHighDutyScanMode(FALSE);
         DEBUG_STR("Moving to Low Power Sniff Mode \r\n\r\n");
 
-        if(sensor_data[DESIRED_AIR_TEMP_IDX].repeat_interval !=0 ||
-           sensor_data[CURRENT_AIR_TEMP_IDX].repeat_interval !=0)
+        if(getRepeatInterval() != 0)
         {
             startRepeatIntervalTimer();
         }
@@ -834,6 +1444,11 @@ extern void ConfigureSensor(bool old_config)
         TimerDelete(tempsensor_sample_tid);
         tempsensor_sample_tid = TIMER_INVALID;
 
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+        /* Stop the sensor events */
+        TempSensorClearEventBand();
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
         /* Stop the retransmissions if already in progress */
         TimerDelete(retransmit_tid);
         retransmit_tid = TIMER_INVALID;
@@ -848,7 +1463,7 @@ extern void ConfigureSensor(bool old_config)
         last_bcast_air_temp = 0;
 
         /* Issue a Read to start sampling timer. */
-        TempSensorRead();
+        readSensors();
 
         /* Stop the retransmissions if already in progress */
         TimerDelete(retransmit_tid);
@@ -860,7 +1475,7 @@ extern void ConfigureSensor(bool old_config)
 
         /* Start the timer for next sample. */
         tempsensor_sample_tid = TimerCreate(
-                                (uint32)TEMPERATURE_SAMPLING_INTERVAL, 
+                                TEMP_SAMPLE_INTERVAL, 
                                 TRUE,
                                 tempSensorSampleIntervalTimeoutHandler);
     }
@@ -929,16 +1544,15 @@ extern void EnableTempReading(void)
         EnableHighDutyScanMode(FALSE);
 
         /* Issue a Read to start sampling timer. */
-        TempSensorRead();
+        readSensors();
 
         /* Start the timer for next sample. */
         tempsensor_sample_tid = TimerCreate(
-                                    (uint32)TEMPERATURE_SAMPLING_INTERVAL, 
+                                    TEMP_SAMPLE_INTERVAL, 
                                     TRUE,
                                     tempSensorSampleIntervalTimeoutHandler);
 
-        if(sensor_data[DESIRED_AIR_TEMP_IDX].repeat_interval !=0 ||
-           sensor_data[CURRENT_AIR_TEMP_IDX].repeat_interval !=0)
+        if(getRepeatInterval() != 0)
         {
             startRepeatIntervalTimer();
         }
@@ -1053,6 +1667,10 @@ void CSRmeshAppProcessMeshEvent(CSR_MESH_APP_EVENT_DATA_T eventDataCallback)
                     TimerDelete(tempsensor_sample_tid);
                     tempsensor_sample_tid = TIMER_INVALID;
 
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+                    TempSensorClearEventBand();
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
                     TimerDelete(repeat_interval_tid);
                     repeat_interval_tid = TIMER_INVALID;
 
@@ -1406,30 +2024,22 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
         {
             CSRMESH_SENSOR_GET_TYPES_T *p_event = 
                                     (CSRMESH_SENSOR_GET_TYPES_T *)data->data;
+            uint16 index, num_types = 0;
 
             MemSet(&model_rsp_data.sensor_types, 
                    0x0000,
                    sizeof(model_rsp_data.sensor_types));
 
-            if(p_event->firsttype <= sensor_type_internal_air_temperature)
-            {
-                model_rsp_data.sensor_types.types[0] = 
-                                        sensor_type_internal_air_temperature;
-                model_rsp_data.sensor_types.types[1] = 
-                                        sensor_type_desired_air_temperature;
-                model_rsp_data.sensor_types.types_len = 2;
-            }
-            else if(p_event->firsttype <= sensor_type_desired_air_temperature)
+            for(index = 0; index < NUM_SENSORS_SUPPORTED &&
+                           num_types < MAX_SENSOR_TYPES_IN_RSP; index++)
             {
-                model_rsp_data.sensor_types.types[0] = 
-                                        sensor_type_desired_air_temperature;
-                model_rsp_data.sensor_types.types_len = 1;
-            }
-            else
-            {
-                model_rsp_data.sensor_types.types[0] = sensor_type_invalid;
-                model_rsp_data.sensor_types.types_len = 0;
+                if(sensor_data[index].type >= p_event->firsttype)
+                {
+                    model_rsp_data.sensor_types.types[num_types++] = 
+                                                    sensor_data[index].type;
+                }
             }
+            model_rsp_data.sensor_types.types_len = num_types;
 
             model_rsp_data.sensor_types.tid = p_event->tid;
             /* Send response data to model */
@@ -1448,42 +2058,23 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
                    0x0000,
                    sizeof(model_rsp_data.sensor_value));
             bool send_ack = FALSE;
+            uint16 idx;
 
-            if(p_event->type == sensor_type_internal_air_temperature)
+            idx = getSensorIndex(p_event->type);
+            if(idx < NUM_SENSORS_SUPPORTED)
             {
-                model_rsp_data.sensor_value.type = 
-                                        sensor_type_internal_air_temperature;
-                CsrUint8 *p_temp = model_rsp_data.sensor_value.value;
-                BufWriteUint16(&p_temp, current_air_temp);
-                model_rsp_data.sensor_value.value_len = 2;
-                send_ack = TRUE;
-            }
-            else if(p_event->type == sensor_type_desired_air_temperature)
-            {
-                model_rsp_data.sensor_value.type = 
-                                        sensor_type_desired_air_temperature;
-                CsrUint8 *p_temp = model_rsp_data.sensor_value.value;
-                BufWriteUint16(&p_temp, current_desired_air_temp);
-                model_rsp_data.sensor_value.value_len = 2;
+                packSensorValue(idx, &model_rsp_data.sensor_value.type,
+                                model_rsp_data.sensor_value.value,
+                                &model_rsp_data.sensor_value.value_len);
                 send_ack = TRUE;
             }
 
-            if(p_event->type2 == sensor_type_desired_air_temperature)
-            {
-                model_rsp_data.sensor_value.type2 = 
-                                        sensor_type_desired_air_temperature;
-                CsrUint8 *p_temp = model_rsp_data.sensor_value.value2;
-                BufWriteUint16(&p_temp, current_desired_air_temp);
-                model_rsp_data.sensor_value.value2_len = 2;
-                send_ack = TRUE;
-            }
-            else if(p_event->type2 == sensor_type_internal_air_temperature)
+            idx = getSensorIndex(p_event->type2);
+            if(idx < NUM_SENSORS_SUPPORTED)
             {
-                model_rsp_data.sensor_value.type2 = 
-                                        sensor_type_internal_air_temperature;
-                CsrUint8 *p_temp = model_rsp_data.sensor_value.value2;
-                BufWriteUint16(&p_temp, current_air_temp);
-                model_rsp_data.sensor_value.value2_len = 2;
+                packSensorValue(idx, &model_rsp_data.sensor_value.type2,
+                                model_rsp_data.sensor_value.value2,
+                                &model_rsp_data.sensor_value.value2_len);
                 send_ack = TRUE;
             }
 
@@ -1512,7 +2103,7 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
                                          (CSRMESH_SENSOR_MISSING_T *)data->data;
             uint8 index = 0;
             uint8* types;
-            uint16 type;
+            uint16 idx;
             bool send_ack = FALSE, first_val_inserted = FALSE;
 
             MemSet(&model_rsp_data.sensor_value, 
@@ -1522,51 +2113,30 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
             types =(uint8 *) p_event->types;
             for(index = 0; index < 8; index= index+2)
             {
-                type = (uint16)BufReadUint16(&types);
-                if(type == sensor_type_internal_air_temperature)
+                idx = getSensorIndex((uint16)BufReadUint16(&types));
+                if(idx == NUM_SENSORS_SUPPORTED)
                 {
-                    DEBUG_STR(" MISSING current temp");
-                    if(first_val_inserted == FALSE)
-                    {
-                        model_rsp_data.sensor_value.type = 
-                                        sensor_type_internal_air_temperature;
-                        CsrUint8 *p_temp = model_rsp_data.sensor_value.value;
-                        BufWriteUint16(&p_temp, current_air_temp);
-                        model_rsp_data.sensor_value.value_len = 2;
-                    }
-                    else
-                    {
-                        model_rsp_data.sensor_value.type2 = 
-                                        sensor_type_internal_air_temperature;
-                        CsrUint8 *p_temp = model_rsp_data.sensor_value.value2;
-                        BufWriteUint16(&p_temp, current_air_temp);
-                        model_rsp_data.sensor_value.value2_len = 2;
-                        break;
-                    }
-                    send_ack = TRUE;
+                    continue;
                 }
-                else if(type == sensor_type_desired_air_temperature)
+
+                DEBUG_STR(" MISSING sensor type ");
+                PrintInDecimal(sensor_data[idx].type);
+                if(first_val_inserted == FALSE)
                 {
-                    DEBUG_STR(" MISSING desired air temp");
-                    if(first_val_inserted == FALSE)
-                    {
-                        model_rsp_data.sensor_value.type = 
-                                        sensor_type_desired_air_temperature;
-                        CsrUint8 *p_temp = model_rsp_data.sensor_value.value;
-                        BufWriteUint16(&p_temp, current_desired_air_temp);
-                        model_rsp_data.sensor_value.value_len = 2;
-                    }
-                    else
-                    {
-                        model_rsp_data.sensor_value.type2 = 
-                                        sensor_type_desired_air_temperature;
-                        CsrUint8 *p_temp = model_rsp_data.sensor_value.value2;
-                        BufWriteUint16(&p_temp, current_desired_air_temp);
-                        model_rsp_data.sensor_value.value2_len = 2;
-                        break;
-                    }
+                    packSensorValue(idx, &model_rsp_data.sensor_value.type,
+                                    model_rsp_data.sensor_value.value,
+                                    &model_rsp_data.sensor_value.value_len);
+                    first_val_inserted = TRUE;
+                }
+                else
+                {
+                    packSensorValue(idx, &model_rsp_data.sensor_value.type2,
+                                    model_rsp_data.sensor_value.value2,
+                                    &model_rsp_data.sensor_value.value2_len);
                     send_ack = TRUE;
+                    break;
                 }
+                send_ack = TRUE;
             }
             if(send_ack == TRUE)
             {
@@ -1591,20 +2161,21 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
             CSRMESH_SENSOR_SET_STATE_T *p_event = 
                                     (CSRMESH_SENSOR_SET_STATE_T *)data->data;
             bool send_ack = FALSE;
+            bool interval_changed = FALSE;
+            uint16 idx = getSensorIndex(p_event->type);
 
-            /* repeat interval of desired or current temp has changed */
-            if(p_event->type == sensor_type_desired_air_temperature)
+            /* repeat interval of one of the sensors has changed */
+            if(idx < NUM_SENSORS_SUPPORTED)
             {
-                sensor_data[DESIRED_AIR_TEMP_IDX].repeat_interval = 
-                                                        p_event->repeatinterval;
-                WriteSensorDataToNVM(DESIRED_AIR_TEMP_IDX);
-                send_ack = TRUE;
-            }
-            else if(p_event->type == sensor_type_internal_air_temperature)
-            {
-                sensor_data[CURRENT_AIR_TEMP_IDX].repeat_interval = 
-                                                        p_event->repeatinterval;
-                WriteSensorDataToNVM(CURRENT_AIR_TEMP_IDX); 
+                /* Subscribers repeat the same interval, which needs no NVM
+                 * write
+                 */
+                if(sensor_data[idx].repeat_interval != p_event->repeatinterval)
+                {
+                    sensor_data[idx].repeat_interval = p_event->repeatinterval;
+                    WriteSensorDataToNVM(idx);
+                    interval_changed = TRUE;
+                }
                 send_ack = TRUE;
             }
 
@@ -1621,11 +2192,21 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
                     *state_data = (void *)&g_tsapp_data.sensor_model;
                 }
 
-                /* As repeat interval might have changed restart or stop the 
+                /* As repeat interval has changed restart or stop the 
                  * timer as per the new interval value.
                  */
-                if(sensor_data[CURRENT_AIR_TEMP_IDX].repeat_interval != 0 ||
-                   sensor_data[DESIRED_AIR_TEMP_IDX].repeat_interval != 0)
+                if(!interval_changed)
+                {
+                    /* The timer keeps running. A new subscriber still gets
+                     * the value now, unless it is already being sent.
+                     */
+                    if(getRepeatInterval() != 0 &&
+                       retransmit_tid == TIMER_INVALID)
+                    {
+                        StartTempTransmission();
+                    }
+                }
+                else if(getRepeatInterval() != 0)
                 {
                     startRepeatIntervalTimer();
                 }
@@ -1648,17 +2229,12 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
             CSRMESH_SENSOR_GET_STATE_T *p_event = 
                                     (CSRMESH_SENSOR_GET_STATE_T *)data->data;
             bool send_ack = FALSE;
+            uint16 idx = getSensorIndex(p_event->type);
 
-            if(p_event->type == sensor_type_desired_air_temperature)
+            if(idx < NUM_SENSORS_SUPPORTED)
             {
                 g_tsapp_data.sensor_model.repeatinterval = 
-                            sensor_data[DESIRED_AIR_TEMP_IDX].repeat_interval;
-                send_ack = TRUE;
-            }
-            else if(p_event->type == sensor_type_internal_air_temperature)
-            {
-                g_tsapp_data.sensor_model.repeatinterval = 
-                            sensor_data[CURRENT_AIR_TEMP_IDX].repeat_interval;
+                                            sensor_data[idx].repeat_interval;
                 send_ack = TRUE;
             }
 
@@ -1686,68 +2262,35 @@ CSRmeshResult AppSensorEventHandler(CSRMESH_MODEL_EVENT_T event_code,
             CSRMESH_SENSOR_VALUE_T *p_event = 
                                     (CSRMESH_SENSOR_VALUE_T *)data->data;
 
-            SENSOR_FORMAT_TEMPERATURE_T desired_air_temp_recvd = 0;
-            SENSOR_FORMAT_TEMPERATURE_T current_air_temp_recvd = 0;
-            uint8 *value, *value2;
+            uint8 *value = p_event->value, *value2 = p_event->value2;
+            uint16 idx, idx2;
+            bool acked;
 
-            value = p_event->value;
-            if(p_event->type == sensor_type_desired_air_temperature) 
-            {
-                desired_air_temp_recvd = (uint16)BufReadUint16(&value);
-            }
-            else if(p_event->type == sensor_type_internal_air_temperature)
-            {
-                current_air_temp_recvd = (uint16)BufReadUint16(&value);
-            }
+            /* The ack carries the values of one of the msgs of the update.
+             * Both its values must be the ones last broadcast.
+             */
+            idx = getSensorIndex(p_event->type);
+            idx2 = getSensorIndex(p_event->type2);
+            acked = (idx < NUM_SENSORS_SUPPORTED);
 
-            value2 = p_event->value2;
-            if(p_event->type2 == sensor_type_desired_air_temperature) 
+            if(idx < NUM_SENSORS_SUPPORTED &&
+               (uint16)BufReadUint16(&value) != *sensor_data[idx].last_bcast)
             {
-                desired_air_temp_recvd = (uint16)BufReadUint16(&value2);
+                acked = FALSE;
             }
-            else if(p_event->type2 == sensor_type_internal_air_temperature)
+
+            if(idx2 < NUM_SENSORS_SUPPORTED &&
+               (uint16)BufReadUint16(&value2) != *sensor_data[idx2].last_bcast)
             {
-                current_air_temp_recvd = (uint16)BufReadUint16(&value2);
+                acked = FALSE;
             }
 
             /* We have received acknowledgement for the write_value sent.
              * update the acknowlege heater device list.
              */
-            if(current_air_temp_recvd == last_bcast_air_temp &&
-               desired_air_temp_recvd == last_bcast_desired_air_temp)
+            if(acked)
             {
-                uint16 index;
-                bool dev_found = FALSE;
-                uint16 src_id = data->src_id;
-
-                /* Check whether the heater is present in the list if its 
-                 * present then update the ack recvd from the heater,
-                 * otherwise add the new heater onto the list and increase 
-                 * the count.
-                 */
-                 for(index = 0; index < MAX_HEATERS_IN_GROUP; index++)
-                 {
-                    if(heater_list[index].dev_id == src_id)
-                    {
-                        heater_list[index].ack_recvd = TRUE;
-                        dev_found = TRUE;
-                        heater_list[index].no_response_count = 0;
-                        break;
-                    }
-                 }
-                 if(dev_found == FALSE)
-                 {
-                    for(index = 0; index < MAX_HEATERS_IN_GROUP; index++)
-                    {
-                        if(heater_list[index].dev_id == MESH_BROADCAST_ID)
-                        {
-                            heater_list[index].dev_id = src_id;
-                            heater_list[index].ack_recvd = TRUE;
-                            heater_list[index].no_response_count = 0;
-                            break;
-                        }
-                    }
-                 }
+                recordHeaterAck(data->src_id);
             }
 #endif /* ENABLE_ACK_MODE */
         }
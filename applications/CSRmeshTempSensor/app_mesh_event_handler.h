@@ -14,9 +14,29 @@
 #include <csr_types.h>
 #include <csr_mesh_types.h>
 
-/* Number of Supported Sensors. */
+/* Number of Supported Sensors. Each has an entry in the sensor registry. */
 #define NUM_SENSORS_SUPPORTED               (2)
 
+/* The sensors changed since the previous update are noted in a uint16 bit
+ * mask, one bit per entry of the registry.
+ */
+#if NUM_SENSORS_SUPPORTED > 16
+#error "The sensor registry holds at most 16 sensors"
+#endif
+
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+/* Write value msgs sent for the temperature updates. The total saturates at
+ * 0xFFFF.
+ */
+typedef struct
+{
+    uint16 updates;           /* Temperature updates completed */
+    uint16 last_msgs_sent;    /* Write value msgs sent in the last update */
+    uint16 total_msgs_sent;   /* Write value msgs sent in all updates */
+    uint16 retransmit_level;  /* Retransmission level of the next update */
+} APP_TEMP_UPDATE_STATS_T;
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+
 /*============================================================================*
  *  Public Function Prototypes
  *============================================================================*/
@@ -49,4 +69,15 @@ extern void WriteSensorDataToNVM(uint16 idx);
 extern void ConfigureSensor(bool old_config);
 extern void EnableHighDutyScanMode(bool enable);
 extern void StartTempTransmission(void);
+#ifdef ENABLE_ADAPTIVE_RETRANSMIT
+extern void NoteMeshMsgHeard(void);
+extern const APP_TEMP_UPDATE_STATS_T *AppTempUpdateGetStats(void);
+#endif /* ENABLE_ADAPTIVE_RETRANSMIT */
+#ifdef ENABLE_AGGREGATED_ACK
+#if !defined(ENABLE_ACK_MODE) || !defined(ENABLE_DATA_MODEL)
+#error "Aggregated acknowledgement needs ack mode and the data model"
+#endif
+extern void HandleAggregatedAck(uint16 src_id, const uint8 *p_data,
+                                uint16 length);
+#endif /* ENABLE_AGGREGATED_ACK */
 #endif /* __APP_MESH_EVENT_HANDLER_H__ */
@@ -0,0 +1,468 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  %%appversion
+ *
+ *  FILE
+ *      app_sensor_history.c
+ *
+ *  DESCRIPTION
+ *      This file keeps a history of the temperature samples read. The oldest
+ *      sample is held as it is and every later sample as the change from the
+ *      sample before it:
+ *          |seconds since previous sample|temperature change|
+ *      Both are varints, 7 bits per octet with the top bit set on all but the
+ *      last octet. The temperature change is zigzag encoded, so that small
+ *      falls are as short as small rises. The samples are kept in a ring and
+ *      the oldest are dropped when it is full.
+ *
+ *      The history is uploaded in one data stream on request, or on its own
+ *      once the ring is nearly full:
+ *          |USER_SENSOR_HISTORY_RSP|number of samples (2)|age of the oldest
+ *          sample in seconds (4)|oldest temperature (2)|samples...|
+ *      Multi octet fields are sent least significant octet first and the
+ *      temperatures are in 1/32 kelvin.
+ *
+ ******************************************************************************/
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <time.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "app_sensor_history.h"
+#include "app_data_stream.h"
+
+#ifdef ENABLE_SENSOR_HISTORY
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Length of the upload header */
+#define HISTORY_HDR_LEN                 (9)
+
+/* Varint continuation bit */
+#define VARINT_MORE                     (0x80)
+
+/* Octet of the ring at an offset from its start */
+#define RING(offset)    (history[HISTORY_HDR_LEN + ((offset) % \
+                                                    HISTORY_BUFFER_LEN)])
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint32 time;        /* Time the sample was read */
+    uint16 temp;        /* Temperature in 1/32 kelvin */
+}HISTORY_SAMPLE_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Upload header followed by the ring of encoded samples */
+static uint8 history[HISTORY_HDR_LEN + HISTORY_BUFFER_LEN];
+
+/* Start of the oldest encoded sample and number of octets held */
+static uint16 ring_start;
+static uint16 ring_used;
+
+/* Number of samples held, including the oldest */
+static uint16 sample_count;
+
+/* Oldest sample */
+static uint16 first_temp;
+
+/* Newest sample. Its time is moved on in whole seconds, so that the part
+ * seconds are carried into the next interval.
+ */
+static uint16 last_temp;
+static uint32 last_time;
+
+/* Seconds from the oldest to the newest sample */
+static uint32 history_span;
+
+/* Device the history is uploaded to when it is nearly full */
+static uint16 history_dest_id;
+
+/* Set while the history is being uploaded */
+static bool upload_in_progress;
+
+/* Samples read while the history is being uploaded */
+static HISTORY_SAMPLE_T pending[HISTORY_PENDING_SAMPLES];
+static uint16 pending_count;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static uint16 varintLen(uint32 value);
+static void putVarint(uint32 value);
+static uint32 getVarint(uint16 *p_offset);
+static void dropOldestSample(void);
+static void addSample(uint16 temp, uint32 time);
+static void reverseRing(uint16 from, uint16 to);
+static void clearHistory(void);
+static void uploadDone(bool delivered);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      varintLen
+ *
+ *  DESCRIPTION
+ *      Works out the number of octets a value takes as a varint.
+ *
+ *  RETURNS
+ *      Number of octets.
+ *
+ *---------------------------------------------------------------------------*/
+static uint16 varintLen(uint32 value)
+{
+    uint16 len = 1;
+
+    while(value >= VARINT_MORE)
+    {
+        value >>= 7;
+        len++;
+    }
+
+    return len;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      putVarint
+ *
+ *  DESCRIPTION
+ *      Adds a varint at the end of the ring, which must have room for it.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void putVarint(uint32 value)
+{
+    while(value >= VARINT_MORE)
+    {
+        RING(ring_start + ring_used++) = (value & 0x7F) | VARINT_MORE;
+        value >>= 7;
+    }
+
+    RING(ring_start + ring_used++) = value & 0x7F;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      getVarint
+ *
+ *  DESCRIPTION
+ *      Reads the varint at an offset in the ring and moves the offset past it.
+ *
+ *  RETURNS
+ *      Value read.
+ *
+ *---------------------------------------------------------------------------*/
+static uint32 getVarint(uint16 *p_offset)
+{
+    uint32 value = 0;
+    uint16 shift = 0;
+    uint16 octet;
+
+    do
+    {
+        octet = RING((*p_offset)++) & 0xFF;
+        value |= (uint32)(octet & 0x7F) << shift;
+        shift += 7;
+    }
+    while(octet & VARINT_MORE);
+
+    return value;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      dropOldestSample
+ *
+ *  DESCRIPTION
+ *      Drops the oldest sample. The next sample is decoded to become the
+ *      oldest.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void dropOldestSample(void)
+{
+    uint16 offset = ring_start;
+    uint32 interval = getVarint(&offset);
+    uint16 change = (uint16)getVarint(&offset);
+
+    /* Undo the zigzag encoding */
+    first_temp += (change >> 1) ^ (uint16)(-(int16)(change & 1));
+    history_span -= interval;
+
+    ring_used -= (offset - ring_start);
+    ring_start = offset % HISTORY_BUFFER_LEN;
+    sample_count--;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      addSample
+ *
+ *  DESCRIPTION
+ *      Adds a sample to the history, dropping the oldest samples if the ring
+ *      has no room for it.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void addSample(uint16 temp, uint32 time)
+{
+    int32  elapsed;
+    uint32 interval = 0;
+    int16  change;
+    uint16 zigzag;
+
+    if(sample_count == 0)
+    {
+        first_temp = temp;
+        last_temp = temp;
+        last_time = time;
+        history_span = 0;
+        sample_count = 1;
+        return;
+    }
+
+    elapsed = TimeSub(time, last_time);
+    if(elapsed > 0)
+    {
+        interval = (uint32)elapsed / SECOND;
+    }
+
+    /* Keep the part second for the next interval */
+    last_time += interval * SECOND;
+
+    change = (int16)(temp - last_temp);
+    zigzag = ((uint16)change << 1) ^ (uint16)(change >> 15);
+
+    while(HISTORY_BUFFER_LEN - ring_used <
+          varintLen(interval) + varintLen(zigzag))
+    {
+        dropOldestSample();
+    }
+
+    putVarint(interval);
+    putVarint(zigzag);
+
+    last_temp = temp;
+    history_span += interval;
+    sample_count++;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      reverseRing
+ *
+ *  DESCRIPTION
+ *      Reverses the octets of the ring from one offset up to another.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void reverseRing(uint16 from, uint16 to)
+{
+    uint16 octet;
+
+    while(from < to)
+    {
+        octet = RING(from);
+        RING(from++) = RING(to);
+        RING(to--) = octet;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      clearHistory
+ *
+ *  DESCRIPTION
+ *      Discards all the samples held.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void clearHistory(void)
+{
+    ring_start = 0;
+    ring_used = 0;
+    sample_count = 0;
+    history_span = 0;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      uploadDone
+ *
+ *  DESCRIPTION
+ *      Called when the upload stream ends. The uploaded samples are
+ *      discarded only if the receiver acknowledged the whole upload,
+ *      otherwise they are kept for the next upload. The samples held back
+ *      are then added.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void uploadDone(bool delivered)
+{
+    uint16 index;
+
+    upload_in_progress = FALSE;
+
+    if(delivered)
+    {
+        clearHistory();
+    }
+
+    for(index = 0; index < pending_count; index++)
+    {
+        addSample(pending[index].temp, pending[index].time);
+    }
+    pending_count = 0;
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppSensorHistoryInit
+ *
+ *  DESCRIPTION
+ *      This function discards the history.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppSensorHistoryInit(void)
+{
+    clearHistory();
+    history_dest_id = HISTORY_COLLECTOR_ID;
+    upload_in_progress = FALSE;
+    pending_count = 0;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppSensorHistoryRecord
+ *
+ *  DESCRIPTION
+ *      This function adds a temperature sample to the history. While an
+ *      upload is being sent the samples are held back and added once it has
+ *      ended. The uploaded samples are then discarded if the upload was
+ *      acknowledged. The history is uploaded when it is nearly full.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void AppSensorHistoryRecord(uint16 temp)
+{
+    uint32 now = TimeGet32();
+    uint16 index;
+
+    if(upload_in_progress)
+    {
+        /* Keep the latest samples if too many are read */
+        if(pending_count == HISTORY_PENDING_SAMPLES)
+        {
+            for(index = 1; index < HISTORY_PENDING_SAMPLES; index++)
+            {
+                pending[index - 1] = pending[index];
+            }
+            pending_count--;
+        }
+
+        pending[pending_count].time = now;
+        pending[pending_count].temp = temp;
+        pending_count++;
+        return;
+    }
+
+    addSample(temp, now);
+
+    if(HISTORY_BUFFER_LEN - ring_used < HISTORY_UPLOAD_FREE_LEN)
+    {
+        AppSensorHistoryUpload(history_dest_id);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      AppSensorHistoryUpload
+ *
+ *  DESCRIPTION
+ *      This function uploads the history to a device in one data stream.
+ *      The ring is first turned so that the oldest sample follows the
+ *      header. The device is also used for the uploads made when the
+ *      history is nearly full.
+ *
+ *  RETURNS
+ *      TRUE if the upload was started.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool AppSensorHistoryUpload(uint16 dest_id)
+{
+    int32  elapsed;
+    uint32 age = history_span;
+
+    history_dest_id = dest_id;
+
+    if(upload_in_progress || sample_count == 0 || AppDataStreamIsSending())
+    {
+        return FALSE;
+    }
+
+    elapsed = TimeSub(TimeGet32(), last_time);
+    if(elapsed > 0)
+    {
+        age += (uint32)elapsed / SECOND;
+    }
+
+    if(ring_start != 0)
+    {
+        reverseRing(0, ring_start - 1);
+        reverseRing(ring_start, HISTORY_BUFFER_LEN - 1);
+        reverseRing(0, HISTORY_BUFFER_LEN - 1);
+        ring_start = 0;
+    }
+
+    history[0] = USER_SENSOR_HISTORY_RSP;
+    history[1] = sample_count & 0xFF;
+    history[2] = (sample_count >> 8) & 0xFF;
+    history[3] = age & 0xFF;
+    history[4] = (age >> 8) & 0xFF;
+    history[5] = (age >> 16) & 0xFF;
+    history[6] = (age >> 24) & 0xFF;
+    history[7] = first_temp & 0xFF;
+    history[8] = (first_temp >> 8) & 0xFF;
+
+    upload_in_progress = AppDataStreamSendReport(dest_id, history,
+                                                 HISTORY_HDR_LEN + ring_used,
+                                                 uploadDone);
+
+    return upload_in_progress;
+}
+
+#endif /* ENABLE_SENSOR_HISTORY */
@@ -0,0 +1,61 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  %%appversion
+ *
+ *  FILE
+ *      app_sensor_history.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the history of temperature samples kept on the
+ *      sensor and uploaded in USER_SENSOR_HISTORY_RSP streams
+ *
+ *****************************************************************************/
+
+#ifndef __APP_SENSOR_HISTORY_H__
+#define __APP_SENSOR_HISTORY_H__
+
+/*============================================================================*
+ *  SDK Header Files
+ *============================================================================*/
+#include <types.h>
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+#include "user_config.h"
+
+#ifdef ENABLE_SENSOR_HISTORY
+#ifndef ENABLE_DATA_MODEL
+#error "Sensor history needs the data model"
+#endif /* ENABLE_DATA_MODEL */
+
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Device the history is uploaded to until a device requests it */
+#define HISTORY_COLLECTOR_ID            (0x8FFE)
+
+/* Octets of encoded samples held */
+#define HISTORY_BUFFER_LEN              (192)
+
+/* The history is uploaded once fewer octets than this are free */
+#define HISTORY_UPLOAD_FREE_LEN         (32)
+
+/* Samples kept while the history is being uploaded */
+#define HISTORY_PENDING_SAMPLES         (4)
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Discards the history */
+extern void AppSensorHistoryInit(void);
+
+/* Adds a temperature sample to the history */
+extern void AppSensorHistoryRecord(uint16 temp);
+
+/* Uploads the history to a device */
+extern bool AppSensorHistoryUpload(uint16 dest_id);
+
+#endif /* ENABLE_SENSOR_HISTORY */
+#endif /* __APP_SENSOR_HISTORY_H__ */
@@ -512,6 +512,9 @@ extern void AppProcessSystemEvent(sys_event_id id, void *data)
 #if defined(ENABLE_TEMPERATURE_CONTROLLER) && !defined(DEBUG_ENABLE)
              HandlePIOEvent(((pio_changed_data*)data)->pio_cause);
 #endif /* defined(ENABLE_TEMPERATURE_CONTROLLER) && !defined(DEBUG_ENABLE) */
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+             TempSensorHandlePIOEvent(((pio_changed_data*)data)->pio_cause);
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
         }
         break;
 
@@ -45,12 +45,21 @@
 /*! \brief Bluetooth SIG Organization identifier for CSRmesh device appearance */
 #define APPEARANCE_ORG_BLUETOOTH_SIG        (0)
 
+#ifdef ENABLE_I2C_QUEUE
+/* I2C transaction queue timer */
+#define I2C_QUEUE_TIMERS                    (1)
+#else
+#define I2C_QUEUE_TIMERS                    (0)
+#endif /* ENABLE_I2C_QUEUE */
+
 #ifdef ENABLE_DEVICE_UUID_ADVERTS
 /* Maximum number of timers */
-#define MAX_APP_TIMERS                      (11 + CSR_MESH_MAX_NO_TIMERS)
+#define MAX_APP_TIMERS                      (11 + I2C_QUEUE_TIMERS + \
+                                             CSR_MESH_MAX_NO_TIMERS)
 #else
 /* Maximum number of timers */
-#define MAX_APP_TIMERS                      (10 + CSR_MESH_MAX_NO_TIMERS)
+#define MAX_APP_TIMERS                      (10 + I2C_QUEUE_TIMERS + \
+                                             CSR_MESH_MAX_NO_TIMERS)
 #endif /* ENABLE_DEVICE_UUID_ADVERTS */
 
 /* TGAP(conn_pause_peripheral) defined in Core Specification Addendum 3 Revision
@@ -60,12 +60,22 @@
  *============================================================================*/
 /* Temperature sensor read delay after issuing read command. */
 #ifdef TEMPERATURE_SENSOR_STTS751
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+/* The sensor converts continuously, so no command is issued and the last
+ * conversion is read straight away.
+ */
+#define TEMP_READ_DELAY         (1 * MILLISECOND)
+#else
 #define TEMP_READ_DELAY         (MAX_CONVERSION_TIME * MILLISECOND)
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
 #endif /* TEMPERATURE_SENSOR_STTS751 */
 
 /* Event handler to be called after temperature is read from sensor. */
 static TEMPSENSOR_EVENT_HANDLER_T eventHandler;
 
+/* Sensor index the temperature is reported with */
+static uint16 eventSensor;
+
 /* Timer ID for temperature read delay. */
 static timer_id read_delay_tid = TIMER_INVALID;
 
@@ -86,39 +96,66 @@ static bool     decButtonState = KEY_RELEASED;
 /*============================================================================*
  *  Private Function Implementations
  *============================================================================*/
+#ifdef TEMPERATURE_SENSOR_STTS751
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      tempSensorReport
+ *
+ *  DESCRIPTION
+ *      This function reports the temperature read from the sensor in 1/16
+ *      degree Centigrade units to the registered event handler.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *----------------------------------------------------------------------------*/
+static void tempSensorReport(int16 temp)
+{
+    if (temp != INVALID_TEMPERATURE)
+    {
+        /* Convert temperature in to 1/32 degree Centigrade units */
+        temp = (temp << 1);
+
+        temp += CELSIUS_TO_KELVIN_FACTOR;
+    }
+
+    /* Report the temperature read. */
+    eventHandler(eventSensor, temp);
+}
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      tempSensorReadyToRead
  *
  *  DESCRIPTION
  *      This function is called after a duration of temperature read delay,
- *      once a read is initiated.
+ *      once a read is initiated. With the I2C queue the read is queued and
+ *      reported when it ends.
  *
  *  RETURNS
- *      TRUE if initialization is sucessful.
+ *      Nothing.
  *
  *----------------------------------------------------------------------------*/
-#ifdef TEMPERATURE_SENSOR_STTS751
 static void tempSensorReadyToRead(timer_id tid)
 {
+#ifndef ENABLE_I2C_QUEUE
     int16 temp;
+#endif /* ENABLE_I2C_QUEUE */
 
     if (tid == read_delay_tid)
     {
         read_delay_tid = TIMER_INVALID;
 
-        /* Read the temperature. */
-        STTS751_ReadTemperature(&temp);
-        if (temp != INVALID_TEMPERATURE)
+#ifdef ENABLE_I2C_QUEUE
+        if (!STTS751_QueueReadTemperature(tempSensorReport))
         {
-            /* Convert temperature in to 1/32 degree Centigrade units */
-            temp = (temp << 1);
-
-            temp += CELSIUS_TO_KELVIN_FACTOR;
+            tempSensorReport(INVALID_TEMPERATURE);
         }
-
-        /* Report the temperature read. */
-        eventHandler(temp);
+#else
+        /* Read the temperature. */
+        STTS751_ReadTemperature(&temp);
+        tempSensorReport(temp);
+#endif /* ENABLE_I2C_QUEUE */
     }
 }
 #endif /* TEMPERATURE_SENSOR_STTS751 */
@@ -436,31 +473,109 @@ extern void HandlePIOEvent(uint32 pio_changed)
 #endif /* DEBUG_ENABLE */
 #endif /* ENABLE_TEMPERATURE_CONTROLLER */
 
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      TempSensorHandlePIOEvent
+ *
+ *  DESCRIPTION
+ *      This function handles the PIO Events of the temperature sensor EVENT
+ *      pin. The sensor drives the pin low when the temperature leaves the
+ *      band set, which starts a read of the temperature.
+ *
+ *  RETURNS/MODIFIES
+ *      Nothing
+ *
+ *----------------------------------------------------------------------------*/
+extern void TempSensorHandlePIOEvent(uint32 pio_changed)
+{
+    if ((pio_changed & TEMP_SENSOR_EVENT_MASK) &&
+        (PioGet(TEMP_SENSOR_EVENT_PIO) == FALSE))
+    {
+        /* Release the EVENT pin and read the temperature. */
+        STTS751_InterruptHandler();
+        TempSensorRead();
+    }
+}
+
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      TempSensorSetEventBand
+ *
+ *  DESCRIPTION
+ *      This function sets the band in 1/32 kelvin units outside which the
+ *      sensor raises an event.
+ *
+ *  RETURNS/MODIFIES
+ *      TRUE if the band is set.
+ *
+ *----------------------------------------------------------------------------*/
+extern bool TempSensorSetEventBand(uint16 low, uint16 high)
+{
+    /* Convert the limits to 1/16 degree Centigrade units. */
+    return STTS751_SetEventLimits(
+                    (int16)(low - CELSIUS_TO_KELVIN_FACTOR) >> 1,
+                    (int16)(high - CELSIUS_TO_KELVIN_FACTOR) >> 1);
+}
+
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      TempSensorClearEventBand
+ *
+ *  DESCRIPTION
+ *      This function stops the sensor raising events.
+ *
+ *  RETURNS/MODIFIES
+ *      Nothing
+ *
+ *----------------------------------------------------------------------------*/
+extern void TempSensorClearEventBand(void)
+{
+    STTS751_DisableEvent();
+}
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      TempSensorHardwareInit
  *
  *  DESCRIPTION
- *      This function initialises the temperature sensor hardware.
+ *      This function initialises the temperature sensor hardware. The
+ *      temperatures read are reported to the handler with the sensor index
+ *      given.
  *
  *  RETURNS
  *      TRUE if initialization is sucessful.
  *
  *----------------------------------------------------------------------------*/
-extern bool TempSensorHardwareInit(TEMPSENSOR_EVENT_HANDLER_T handler)
+extern bool TempSensorHardwareInit(uint16 sensor,
+                                   TEMPSENSOR_EVENT_HANDLER_T handler)
 {
     bool status = FALSE;
 
     read_delay_tid = TIMER_INVALID;
 
+#ifdef ENABLE_I2C_QUEUE
+    I2CQueueInit();
+#endif /* ENABLE_I2C_QUEUE */
+
     if (NULL != handler)
     {
         eventHandler = handler;
+        eventSensor = sensor;
 #ifdef TEMPERATURE_SENSOR_STTS751
         status = STTS751_Init();
 #endif /* TEMPERATURE_SENSOR_STTS751 */
     }
 
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+    /* The EVENT pin is open drain and active low. */
+    PioSetDir(TEMP_SENSOR_EVENT_PIO, PIO_DIRECTION_INPUT);
+    PioSetMode(TEMP_SENSOR_EVENT_PIO, pio_mode_user);
+    PioSetPullModes(TEMP_SENSOR_EVENT_MASK, pio_mode_strong_pull_up);
+    PioSetEventMask(TEMP_SENSOR_EVENT_MASK, pio_event_mode_falling);
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
     return status;
 }
 
@@ -483,9 +598,11 @@ extern bool TempSensorRead(void)
     /* Return FALSE if already a read is in progress. */
     if (TIMER_INVALID == read_delay_tid)
     {
-#ifdef TEMPERATURE_SENSOR_STTS751
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+        status = TRUE;
+#elif defined(TEMPERATURE_SENSOR_STTS751)
         status = STTS751_InitiateOneShotRead();
-#endif /* TEMPERATURE_SENSOR_STTS751 */
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
     }
 
     /* Command is issued without failure, start the delay timer. */
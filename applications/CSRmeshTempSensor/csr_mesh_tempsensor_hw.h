@@ -33,11 +33,14 @@
 /* Number of Timers required for temperature sensor. */
 #define NUM_TEMP_SENSOR_TIMERS      (1)
 
-/* Function pointer for Temperature Sensor Event Callback. */
-typedef void (*TEMPSENSOR_EVENT_HANDLER_T)(int16 temp);
+/* Function pointer for Temperature Sensor Event Callback. It is called with
+ * the sensor index given to TempSensorHardwareInit.
+ */
+typedef void (*TEMPSENSOR_EVENT_HANDLER_T)(uint16 sensor, int16 temp);
 
 /* Temperature Sensor Hardware Initialization function. */
-extern bool TempSensorHardwareInit(TEMPSENSOR_EVENT_HANDLER_T handler);
+extern bool TempSensorHardwareInit(uint16 sensor,
+                                   TEMPSENSOR_EVENT_HANDLER_T handler);
 
 /* This function initiates a Read temperature operation.
  * Temperature is reported in the Event Handler registered.
@@ -48,6 +51,23 @@ extern bool TempSensorRead(void);
 extern void HandlePIOEvent(uint32 pio_changed);
 #endif /* defined(ENABLE_TEMPERATURE_CONTROLLER) && !defined(DEBUG_ENABLE) */
 
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+#ifndef TEMPERATURE_SENSOR_STTS751
+#error "ENABLE_TEMP_THRESHOLD_EVENT requires TEMPERATURE_SENSOR_STTS751"
+#endif /* TEMPERATURE_SENSOR_STTS751 */
+
+/* This function handles the PIO Events of the sensor EVENT pin. */
+extern void TempSensorHandlePIOEvent(uint32 pio_changed);
+
+/* This function sets the band in 1/32 kelvin units outside which the sensor
+ * raises an event.
+ */
+extern bool TempSensorSetEventBand(uint16 low, uint16 high);
+
+/* This function stops the sensor raising events. */
+extern void TempSensorClearEventBand(void);
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
 /* UART Receive callback */
 #ifdef DEBUG_ENABLE
 extern uint16 UartDataRxCallback ( void* p_data, uint16 data_count,
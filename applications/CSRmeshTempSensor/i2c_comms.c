@@ -17,6 +17,7 @@
 #include <pio.h>
 #include <types.h>
 #include <i2c.h>
+#include <timer.h>
 
 /*=============================================================================
  *  Local Header Files
@@ -36,6 +37,34 @@ typedef enum
     i2c_bus_acquired = 0x01
 } i2c_bus_status;
 
+#ifdef ENABLE_I2C_QUEUE
+/* A transaction waiting in the queue */
+typedef struct
+{
+    bool               write;           /* Write a register, else read */
+    uint8              base_address;    /* WRITE address of the device */
+    const uint8       *p_regs;          /* Registers read */
+    uint8              num_regs;        /* Number of registers read */
+    uint8             *p_buffer;        /* Values read */
+    uint8              reg;             /* Register written */
+    uint8              register_value;  /* Value written */
+    I2C_DONE_HANDLER_T handler;         /* Called once the transaction ends */
+} I2C_TRANSACTION_T;
+#endif /* ENABLE_I2C_QUEUE */
+
+/*=============================================================================
+ *  Private Definitions
+ *============================================================================*/
+#ifdef ENABLE_I2C_QUEUE
+/* Delay before the next queued transaction is run */
+#define I2C_QUEUE_DELAY                 (1 * MILLISECOND)
+
+/* Times a queued transaction waits for the bus to be released before it is
+ * ended as failed
+ */
+#define I2C_QUEUE_MAX_ATTEMPTS          (20)
+#endif /* ENABLE_I2C_QUEUE */
+
 /*=============================================================================
  *  Private Data
  *============================================================================*/
@@ -44,6 +73,135 @@ i2c_bus_status bus_I2C_status = i2c_bus_released;
 
 bool i2c_initialised = FALSE;
 
+#ifdef ENABLE_I2C_QUEUE
+/* Transactions waiting to be run, oldest at i2c_queue_head */
+static I2C_TRANSACTION_T i2c_queue[I2C_QUEUE_SIZE];
+static uint16 i2c_queue_head;
+static uint16 i2c_queue_count;
+
+/* Times the transaction at the head of the queue found the bus held */
+static uint16 i2c_queue_attempts;
+
+/* Timer which runs the next queued transaction */
+static timer_id i2c_queue_tid = TIMER_INVALID;
+
+/*=============================================================================
+ *  Private Function Prototypes
+ *============================================================================*/
+static I2C_TRANSACTION_T *queueTransaction(I2C_DONE_HANDLER_T handler);
+static void i2cQueueTimerHandler(timer_id tid);
+
+/*=============================================================================
+ *  Private function definitions
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      queueTransaction
+ *
+ *  DESCRIPTION
+ *      This function adds a transaction to the end of the queue and starts
+ *      the queue timer if it is not running.
+ *
+ *  RETURNS
+ *      Pointer to the transaction to be filled in, NULL if the queue is full.
+ *
+ *----------------------------------------------------------------------------*/
+static I2C_TRANSACTION_T *queueTransaction(I2C_DONE_HANDLER_T handler)
+{
+    I2C_TRANSACTION_T *p_trans;
+
+    if(i2c_queue_count == I2C_QUEUE_SIZE)
+    {
+        return NULL;
+    }
+
+    p_trans = &i2c_queue[(i2c_queue_head + i2c_queue_count) % I2C_QUEUE_SIZE];
+    i2c_queue_count++;
+    p_trans->handler = handler;
+
+    if(i2c_queue_tid == TIMER_INVALID)
+    {
+        i2c_queue_tid = TimerCreate(I2C_QUEUE_DELAY, TRUE,
+                                    i2cQueueTimerHandler);
+    }
+
+    return p_trans;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      i2cQueueTimerHandler
+ *
+ *  DESCRIPTION
+ *      This function runs the transaction at the head of the queue and
+ *      reports its result. One transaction is run per timer expiry, so the
+ *      application goes back to the scheduler between transactions. If the
+ *      bus is held the transaction is tried again on the next expiry, up to
+ *      I2C_QUEUE_MAX_ATTEMPTS times, after which it ends as failed.
+ *
+ *  RETURNS
+ *      Nothing
+ *
+ *----------------------------------------------------------------------------*/
+static void i2cQueueTimerHandler(timer_id tid)
+{
+    I2C_TRANSACTION_T trans;
+    bool acquired;
+    bool success = FALSE;
+    bool ended = FALSE;
+
+    if(tid != i2c_queue_tid)
+    {
+        return;
+    }
+
+    i2c_queue_tid = TIMER_INVALID;
+
+    acquired = I2CAcquire();
+    if(acquired || ++i2c_queue_attempts >= I2C_QUEUE_MAX_ATTEMPTS)
+    {
+        /* Take the transaction off the queue before the handler runs, as
+         * it may queue another one.
+         */
+        trans = i2c_queue[i2c_queue_head];
+        i2c_queue_head = (i2c_queue_head + 1) % I2C_QUEUE_SIZE;
+        i2c_queue_count--;
+        i2c_queue_attempts = 0;
+        ended = TRUE;
+    }
+
+    if(acquired)
+    {
+        I2CcommsInit();
+
+        if(trans.write)
+        {
+            success = I2CWriteRegister(trans.base_address, trans.reg,
+                                       trans.register_value);
+        }
+        else
+        {
+            success = I2CReadRegisterList(trans.base_address, trans.p_regs,
+                                          trans.num_regs, trans.p_buffer);
+        }
+
+        I2CRelease();
+    }
+
+    if(ended && trans.handler != NULL)
+    {
+        trans.handler(success);
+    }
+
+    /* The handler may have queued further transactions. */
+    if(i2c_queue_count != 0 && i2c_queue_tid == TIMER_INVALID)
+    {
+        i2c_queue_tid = TimerCreate(I2C_QUEUE_DELAY, TRUE,
+                                    i2cQueueTimerHandler);
+    }
+}
+#endif /* ENABLE_I2C_QUEUE */
+
 /*=============================================================================
  *  Public function definitions
  *============================================================================*/
@@ -196,6 +354,50 @@ extern bool I2CReadRegisters(uint8 base_address, uint8 start_reg,
     return success;
 }
 
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      I2CReadRegisterList
+ *
+ *  DESCRIPTION
+ *      This function reads a list of registers from the specified device in
+ *      one bus transaction. Each register is addressed after a repeated
+ *      start, so the registers need not be contiguous and the device need
+ *      not auto-increment its register pointer. The transaction is stopped
+ *      and waited for once, after the last register.
+ *
+ *  RETURNS
+ *      TRUE if successful
+ *
+ *----------------------------------------------------------------------------*/
+extern bool I2CReadRegisterList(uint8 base_address, const uint8 *p_regs,
+                                uint8 num_regs, uint8 *p_buffer)
+{
+    bool success;
+    uint8 index;
+
+    success = (I2cRawStart(TRUE) == sys_status_success);
+
+    for(index = 0; success && index < num_regs; index++)
+    {
+        success = ((index == 0 ||
+                    I2cRawRestart(TRUE)                == sys_status_success) &&
+                (I2cRawWriteByte(base_address)         == sys_status_success) &&
+                (I2cRawWaitAck(TRUE)                   == sys_status_success) &&
+                (I2cRawWriteByte(p_regs[index])        == sys_status_success) &&
+                (I2cRawWaitAck(TRUE)                   == sys_status_success) &&
+                (I2cRawRestart(TRUE)                   == sys_status_success) &&
+                (I2cRawWriteByte((base_address | 0x1)) == sys_status_success) &&
+                (I2cRawWaitAck(TRUE)                   == sys_status_success) &&
+                (I2cRawReadByte(&p_buffer[index])      == sys_status_success) &&
+                (I2cRawSendNack(TRUE)                  == sys_status_success));
+    }
+
+    success = success && (I2cRawStop(TRUE) == sys_status_success);
+    I2cRawComplete(1 * MILLISECOND);
+    I2cRawTerminate();
+
+    return success;
+}
 
 /*-----------------------------------------------------------------------------*
  *  NAME
@@ -228,3 +430,89 @@ extern bool I2CWriteRegister(uint8 base_address, uint8 reg,
 
     return success;
 }
+
+#ifdef ENABLE_I2C_QUEUE
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      I2CQueueInit
+ *
+ *  DESCRIPTION
+ *      This function empties the transaction queue
+ *
+ *  RETURNS
+ *      Nothing
+ *
+ *----------------------------------------------------------------------------*/
+extern void I2CQueueInit(void)
+{
+    TimerDelete(i2c_queue_tid);
+    i2c_queue_tid = TIMER_INVALID;
+    i2c_queue_head = 0;
+    i2c_queue_count = 0;
+    i2c_queue_attempts = 0;
+}
+
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      I2CQueueReadRegisterList
+ *
+ *  DESCRIPTION
+ *      This function queues a read of a list of registers from the specified
+ *      device. The registers and the buffer must stay valid until the handler
+ *      is called.
+ *
+ *  RETURNS
+ *      TRUE if the read is queued
+ *
+ *----------------------------------------------------------------------------*/
+extern bool I2CQueueReadRegisterList(uint8 base_address, const uint8 *p_regs,
+                                     uint8 num_regs, uint8 *p_buffer,
+                                     I2C_DONE_HANDLER_T handler)
+{
+    I2C_TRANSACTION_T *p_trans = queueTransaction(handler);
+
+    if(p_trans == NULL)
+    {
+        return FALSE;
+    }
+
+    p_trans->write = FALSE;
+    p_trans->base_address = base_address;
+    p_trans->p_regs = p_regs;
+    p_trans->num_regs = num_regs;
+    p_trans->p_buffer = p_buffer;
+
+    return TRUE;
+}
+
+/*-----------------------------------------------------------------------------*
+ *  NAME
+ *      I2CQueueWriteRegister
+ *
+ *  DESCRIPTION
+ *      This function queues a write of one byte of data to a specified
+ *      register on the specified device
+ *
+ *  RETURNS
+ *      TRUE if the write is queued
+ *
+ *----------------------------------------------------------------------------*/
+extern bool I2CQueueWriteRegister(uint8 base_address, uint8 reg,
+                                  uint8 register_value,
+                                  I2C_DONE_HANDLER_T handler)
+{
+    I2C_TRANSACTION_T *p_trans = queueTransaction(handler);
+
+    if(p_trans == NULL)
+    {
+        return FALSE;
+    }
+
+    p_trans->write = TRUE;
+    p_trans->base_address = base_address;
+    p_trans->reg = reg;
+    p_trans->register_value = register_value;
+
+    return TRUE;
+}
+#endif /* ENABLE_I2C_QUEUE */
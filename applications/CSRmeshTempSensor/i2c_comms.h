@@ -25,6 +25,17 @@
  *============================================================================*/
 #include "user_config.h"
 
+#ifdef ENABLE_I2C_QUEUE
+/*=============================================================================
+ *  Public Definitions
+ *============================================================================*/
+/* Number of transactions that can wait in the queue */
+#define I2C_QUEUE_SIZE                  (4)
+
+/* Called when a queued transaction ends, with TRUE if it succeeded */
+typedef void (*I2C_DONE_HANDLER_T)(bool success);
+#endif /* ENABLE_I2C_QUEUE */
+
 /*=============================================================================
  *  Public function prototypes
  *============================================================================*/
@@ -47,7 +58,26 @@ extern bool I2CReadRegister(uint8 base_address, uint8 reg,
 extern bool I2CReadRegisters(uint8 base_address, uint8 start_reg,
                               uint8 num_bytes, uint8 *buffer);
 
+/* Read a list of registers from the specified device in one transaction. */
+extern bool I2CReadRegisterList(uint8 base_address, const uint8 *p_regs,
+                                uint8 num_regs, uint8 *p_buffer);
+
 /* Write one byte of data to the specified register on the specified device. */
 extern bool I2CWriteRegister(uint8 base_address, uint8 reg,
                               uint8 register_value);
+
+#ifdef ENABLE_I2C_QUEUE
+/* Empty the transaction queue. */
+extern void I2CQueueInit(void);
+
+/* Queue a read of a list of registers from the specified device. */
+extern bool I2CQueueReadRegisterList(uint8 base_address, const uint8 *p_regs,
+                                     uint8 num_regs, uint8 *p_buffer,
+                                     I2C_DONE_HANDLER_T handler);
+
+/* Queue a write of one byte of data to the specified register. */
+extern bool I2CQueueWriteRegister(uint8 base_address, uint8 reg,
+                                  uint8 register_value,
+                                  I2C_DONE_HANDLER_T handler);
+#endif /* ENABLE_I2C_QUEUE */
 #endif /* _I2C_COMMS_H */
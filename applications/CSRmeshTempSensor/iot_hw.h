@@ -53,6 +53,13 @@
 /* Bit-mask of all the Temperature Sensor PIOs used by the board. */
 #define BUTTONS_BIT_MASK    (SW2_MASK | SW3_MASK | SW4_MASK)
 
+/* PIO the EVENT output of the STTS751 is wired to when
+ * ENABLE_TEMP_THRESHOLD_EVENT is defined. Change it to match the board. The
+ * pin is pulled up internally, so no external pull-up is needed.
+ */
+#define TEMP_SENSOR_EVENT_PIO   (3)
+#define TEMP_SENSOR_EVENT_MASK  PIO_BIT_MASK(TEMP_SENSOR_EVENT_PIO)
+
 /*============================================================================*
  *  Public Function Prototypes
  *============================================================================*/
@@ -28,6 +28,136 @@
 #include "app_debug.h"
 
 #ifdef TEMPERATURE_SENSOR_STTS751
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Position of the registers in a temperature reading */
+#define READ_STATUS_IDX                 (0)
+#define READ_TEMP_MSB_IDX               (1)
+#define READ_TEMP_LSB_IDX               (2)
+#define READ_LEN                        (3)
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Registers read in one transaction for a temperature reading. The device
+ * does not auto-increment its register pointer, so they are read as a list.
+ */
+static const uint8 read_regs[READ_LEN] =
+{
+    REG_STATUS,
+    REG_TEMP_MSB,
+    REG_TEMP_LSB
+};
+
+#ifdef ENABLE_I2C_QUEUE
+/* Registers of a queued temperature reading */
+static uint8 queued_read[READ_LEN];
+
+/* Handler of the queued temperature reading */
+static STTS751_READ_HANDLER_T read_handler;
+#endif /* ENABLE_I2C_QUEUE */
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static int16 convertTemperature(const uint8 *p_read);
+#ifdef ENABLE_I2C_QUEUE
+static void queuedReadDone(bool success);
+#endif /* ENABLE_I2C_QUEUE */
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+static bool writeLimit(uint8 reg_msb, uint8 reg_lsb, int16 limit);
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      convertTemperature
+ *
+ *  DESCRIPTION
+ *      This function converts the registers of a temperature reading to
+ *      1/16 degree Centigrade units. In continuous conversion mode the
+ *      temperature registers hold the last conversion, so they are used even
+ *      while the next conversion is in progress.
+ *
+ *  RETURNS
+ *      Temperature, INVALID_TEMPERATURE if the conversion is not complete.
+ *
+ *---------------------------------------------------------------------------*/
+static int16 convertTemperature(const uint8 *p_read)
+{
+    uint16 integer = p_read[READ_TEMP_MSB_IDX] & 0xFF;
+    uint16 fraction = p_read[READ_TEMP_LSB_IDX] & 0xFF;
+
+#ifndef ENABLE_TEMP_THRESHOLD_EVENT
+    /* Check if conversion is in progress. */
+    if (p_read[READ_STATUS_IDX] & STATUS_BUSY_BITMASK)
+    {
+        return INVALID_TEMPERATURE;
+    }
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
+    /* Sign extend the temperature value. */
+    if (integer & 0x80) integer |= 0xFF00;
+
+    /* Fill the Integer part into temperature value and Right Shift the
+     * Fractional part as per resolution.
+     */
+    return (int16)((integer << TRES_BITS_SHIFT(12)) |
+                   (fraction >> TRES_BITS_SHIFT(12)));
+}
+
+#ifdef ENABLE_I2C_QUEUE
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      queuedReadDone
+ *
+ *  DESCRIPTION
+ *      This function reports the temperature once a queued reading ends.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void queuedReadDone(bool success)
+{
+    read_handler(success ? convertTemperature(queued_read) :
+                           INVALID_TEMPERATURE);
+}
+#endif /* ENABLE_I2C_QUEUE */
+
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      writeLimit
+ *
+ *  DESCRIPTION
+ *      This function writes a temperature limit in 1/16 degree Centigrade
+ *      units to a pair of limit registers. The I2C bus has to be acquired.
+ *
+ *  RETURNS
+ *      TRUE if write succeeds.
+ *
+ *---------------------------------------------------------------------------*/
+static bool writeLimit(uint8 reg_msb, uint8 reg_lsb, int16 limit)
+{
+    bool success;
+
+    /* The integer part is in the MSB and the fraction in the upper bits of
+     * the LSB, as in the temperature registers.
+     */
+    success  = I2CWriteRegister(STTS751_I2C_ADDRESS, reg_msb,
+                        (uint8)((limit >> TRES_BITS_SHIFT(12)) & 0xFF));
+    success &= I2CWriteRegister(STTS751_I2C_ADDRESS, reg_lsb,
+                        (uint8)((limit << TRES_BITS_SHIFT(12)) &
+                                 TRES_12_BITS_FRACTIONAL_MASK));
+
+    return success;
+}
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
 /*============================================================================*
  *  Public Function Implementations
  *============================================================================*/
@@ -61,12 +191,25 @@ extern bool STTS751_Init(void)
         }
         else
         {
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+            /* Configure the temperature sensor
+             * - Continuous conversion so that the limits are checked
+             * - Event disabled until the limits are set
+             * - 12 - bit resolution for 0.0625 degrees Centigrade accuracy.
+             */
+            success = I2CWriteRegister(STTS751_I2C_ADDRESS, REG_CONV_RATE,
+                                       STTS751_CONV_RATE);
+            success &= I2CWriteRegister(STTS751_I2C_ADDRESS, REG_CONFIG,
+                                        (CONTINUOUS_CONV|STTS751_DISABLE_EVENT|
+                                         TRES_12_BITS));
+#else
             /* Configure the temperature sensor
              * - Standby mode for one shot readings
              * - 12 - bit resolution for 0.0625 degrees Centigrade accuracy.
              */
             success = I2CWriteRegister(STTS751_I2C_ADDRESS, REG_CONFIG,
                                        (STANDBY_MODE|TRES_12_BITS));
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
         }
 
         /* Release the I2C bus */
@@ -125,7 +268,8 @@ extern bool STTS751_InitiateOneShotRead(void)
  *      STTS751_ReadTemperature
  *
  *  DESCRIPTION
- *      This function read the temperature from sensor STTS751.
+ *      This function read the temperature from sensor STTS751. The status
+ *      and temperature registers are read in one bus transaction.
  *
  *  RETURNS
  *      TRUE if read succeeds.
@@ -134,8 +278,7 @@ extern bool STTS751_InitiateOneShotRead(void)
 extern bool STTS751_ReadTemperature(int16 *temp)
 {
     bool  success = FALSE;
-    uint8 status  = 0x00;
-    uint8 integer, fraction;
+    uint8 read[READ_LEN];
 
     /* Set temperature to Invalid value */
     *temp = INVALID_TEMPERATURE;
@@ -145,33 +288,12 @@ extern bool STTS751_ReadTemperature(int16 *temp)
         /* Initialise I2C. */
         I2CcommsInit();
 
-        /* Check if conversion is in progress. */
-        success = I2CReadRegister(STTS751_I2C_ADDRESS, REG_STATUS, &status);
-
-        /* If read is successful and conversion is not in progress,
-         * Read the temperature from the device.
-         */
-        if ((success) && (!(status & STATUS_BUSY_BITMASK)))
+        /* Read the status and the temperature. */
+        success = I2CReadRegisterList(STTS751_I2C_ADDRESS, read_regs,
+                                      READ_LEN, read);
+        if (success)
         {
-            /* Read the temperature. */
-            success  = 
-                I2CReadRegister(STTS751_I2C_ADDRESS, REG_TEMP_MSB, &integer);
-            success &= 
-                I2CReadRegister(STTS751_I2C_ADDRESS, REG_TEMP_LSB, &fraction);
-
-            if (success)
-            {
-                /* Sign extend the temperature value. */
-                if (integer & 0x80) integer |= 0xFF00;
-
-                /* Fill the Integer part into temperature value. */
-                *temp = (int16)((uint16)integer << TRES_BITS_SHIFT(12));
-
-                /* Right Shift the Fractional part as per resolution. */
-                fraction = (fraction & 0xFF) >> TRES_BITS_SHIFT(12);
-
-                *temp |= fraction;
-            }
+            *temp = convertTemperature(read);
         }
 
         /* Release the I2C bus */
@@ -181,6 +303,29 @@ extern bool STTS751_ReadTemperature(int16 *temp)
     return success;
 }
 
+#ifdef ENABLE_I2C_QUEUE
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      STTS751_QueueReadTemperature
+ *
+ *  DESCRIPTION
+ *      This function queues a read of the temperature from sensor STTS751.
+ *      The handler is called with the temperature, or INVALID_TEMPERATURE,
+ *      once the read ends. Readings queued together share the last handler.
+ *
+ *  RETURNS
+ *      TRUE if the read is queued.
+ *
+ *----------------------------------------------------------------------------*/
+extern bool STTS751_QueueReadTemperature(STTS751_READ_HANDLER_T handler)
+{
+    read_handler = handler;
+
+    return I2CQueueReadRegisterList(STTS751_I2C_ADDRESS, read_regs, READ_LEN,
+                                    queued_read, queuedReadDone);
+}
+#endif /* ENABLE_I2C_QUEUE */
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      STTS751_ReadCallback
@@ -216,7 +361,10 @@ extern void STTS751_ShutDown(void)
  *      STTS751_InterruptHandler
  *
  *  DESCRIPTION
- *      This function handles the interrupt from temperature sensor STTS751
+ *      This function handles the interrupt from temperature sensor STTS751.
+ *      Reading the status register releases the EVENT pin. The sensor asserts
+ *      it again after the next conversion if the temperature is still outside
+ *      the limits.
  *
  *  RETURNS
  *      Nothing
@@ -224,7 +372,95 @@ extern void STTS751_ShutDown(void)
  *---------------------------------------------------------------------------*/
 extern void STTS751_InterruptHandler(void)
 {
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+    uint8 status;
+
+    if (I2CAcquire())
+    {
+        /* Initialise I2C. */
+        I2CcommsInit();
+
+        I2CReadRegister(STTS751_I2C_ADDRESS, REG_STATUS, &status);
+
+        /* Release the I2C bus */
+        I2CRelease();
+    }
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+}
+
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      STTS751_SetEventLimits
+ *
+ *  DESCRIPTION
+ *      This function sets the low and high limits in 1/16 degree Centigrade
+ *      units and enables the EVENT pin, which is asserted once a conversion
+ *      falls outside them. An event pending from the previous limits is
+ *      cleared.
+ *
+ *  RETURNS
+ *      TRUE if write succeeds.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool STTS751_SetEventLimits(int16 low, int16 high)
+{
+    bool  success = FALSE;
+    uint8 status;
+
+    if (I2CAcquire())
+    {
+        /* Initialise I2C. */
+        I2CcommsInit();
+
+        success  = writeLimit(REG_TEMP_HI_LIM_MSB, REG_TEMP_HI_LIM_LSB, high);
+        success &= writeLimit(REG_TEMP_LO_LIM_MSB, REG_TEMP_LO_LIM_LSB, low);
+        success &= I2CWriteRegister(STTS751_I2C_ADDRESS, REG_CONFIG,
+                                    (CONTINUOUS_CONV|STTS751_ENABLE_EVENT|
+                                     TRES_12_BITS));
+
+        /* Clear an event raised against the previous limits. */
+        success &= I2CReadRegister(STTS751_I2C_ADDRESS, REG_STATUS, &status);
+
+        /* Release the I2C bus */
+        I2CRelease();
+    }
+
+    return success;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      STTS751_DisableEvent
+ *
+ *  DESCRIPTION
+ *      This function stops the EVENT pin being asserted. The sensor keeps
+ *      converting so that the temperature can still be read.
+ *
+ *  RETURNS
+ *      TRUE if write succeeds.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool STTS751_DisableEvent(void)
+{
+    bool success = FALSE;
+
+    if (I2CAcquire())
+    {
+        /* Initialise I2C. */
+        I2CcommsInit();
+
+        success = I2CWriteRegister(STTS751_I2C_ADDRESS, REG_CONFIG,
+                                   (CONTINUOUS_CONV|STTS751_DISABLE_EVENT|
+                                    TRES_12_BITS));
+
+        /* Release the I2C bus */
+        I2CRelease();
+    }
+
+    return success;
 }
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
 
 #endif /* TEMPERATURE_SENSOR_STTS751 */
 
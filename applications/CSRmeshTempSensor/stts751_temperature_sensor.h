@@ -86,6 +86,18 @@
  */
 #define TRES_BITS_SHIFT(res)            (16 - (res))
 
+/* Conversion rates in conversions per second */
+#define CONV_RATE_0_0625                (0x00)
+#define CONV_RATE_0_125                 (0x01)
+#define CONV_RATE_0_25                  (0x02)
+#define CONV_RATE_0_5                   (0x03)
+#define CONV_RATE_1                     (0x04)
+
+/* Conversion rate used in continuous conversion mode. One conversion every
+ * 16 seconds is close to the rate at which the temperature was sampled.
+ */
+#define STTS751_CONV_RATE               (CONV_RATE_0_0625)
+
 /* Status bits  */
 #define STATUS_BUSY_BITMASK             (0x80)
 #define STATUS_TEMP_HI_BITMASK          (0x40)
@@ -103,6 +115,13 @@
 /* Invalid temperature. */
 #define INVALID_TEMPERATURE             ((int16)0xFFFF)
 
+#ifdef ENABLE_I2C_QUEUE
+/* Called with the temperature in 1/16 degree Centigrade units once a queued
+ * read ends.
+ */
+typedef void (*STTS751_READ_HANDLER_T)(int16 temp);
+#endif /* ENABLE_I2C_QUEUE */
+
 /*============================================================================*
  *  Public Function Prototypes
  *============================================================================*/
@@ -118,6 +137,11 @@ extern bool STTS751_InitiateOneShotRead(void);
 /* This function reads data from the temperature sensor STTS751 */
 extern bool STTS751_ReadTemperature(int16 *temp);
 
+#ifdef ENABLE_I2C_QUEUE
+/* This function queues a read of the temperature sensor STTS751 */
+extern bool STTS751_QueueReadTemperature(STTS751_READ_HANDLER_T handler);
+#endif /* ENABLE_I2C_QUEUE */
+
 /* This function implements the callback function for read operation.*/
 extern void STTS751_ReadCallback(void);
 
@@ -127,6 +151,14 @@ extern void STTS751_ShutDown(void);
 /* This function handles the interrupt from temperature sensor STTS751 */
 extern void STTS751_InterruptHandler(void);
 
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+/* This function sets the limits outside which the EVENT pin is asserted */
+extern bool STTS751_SetEventLimits(int16 low, int16 high);
+
+/* This function stops the EVENT pin being asserted */
+extern bool STTS751_DisableEvent(void);
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+
 #endif /* TEMPERATURE_SENSOR_STTS751 */
 #endif /* __STTS751_TEMPERATURE_SENSOR_H__ */
 
@@ -69,6 +69,13 @@
 /* STTS751 Temperature Sensor. */
 #define TEMPERATURE_SENSOR_STTS751
 
+/* Enable queueing I2C transactions, which are then run one at a time from a
+ * timer so that the application returns to the scheduler between them. Each
+ * transaction still waits in I2cRawComplete until it ends, so this splits up
+ * a sequence of transactions but does not make a single one asynchronous.
+ */
+/* #define ENABLE_I2C_QUEUE */
+
 /* Enable application debug logging on UART */
 #define DEBUG_ENABLE 
 
@@ -76,12 +83,40 @@
 /* Temperature Sensor Sampling Interval */
 #define TEMPERATURE_SAMPLING_INTERVAL  (15 * SECOND)
 
+/* Enable waking on the EVENT pin of the STTS751 instead of sampling. The
+ * sensor converts continuously and asserts EVENT once the temperature leaves
+ * the band of TEMPERATURE_CHANGE_TOLERANCE around the last broadcast value.
+ * The temperature is then sampled only every
+ * TEMPERATURE_FALLBACK_SAMPLING_INTERVAL in case an event is missed.
+ * The EVENT pin (open drain, active low) has to be wired to
+ * TEMP_SENSOR_EVENT_PIO in iot_hw.h, which is PIO 3 by default. The
+ * development board has not been confirmed to make this connection, so check
+ * the board or add the wire before enabling this. Without it no event
+ * arrives and the temperature is only read every fallback interval.
+ */
+/* #define ENABLE_TEMP_THRESHOLD_EVENT */
+
+/* Temperature Sensor Sampling Interval when the EVENT pin is used */
+#define TEMPERATURE_FALLBACK_SAMPLING_INTERVAL  (300 * SECOND)
+
 /* Temperature Controller. */
 #define ENABLE_TEMPERATURE_CONTROLLER
 
 /* Enable the Acknowledge mode */
 /* #define ENABLE_ACK_MODE */
 
+/* Enable recognising the aggregated acknowledgement which heaters send in
+ * ack mode. It is received on the data model, which has to be enabled and
+ * grouped onto the same groups as the sensor model.
+ */
+/* #define ENABLE_AGGREGATED_ACK */
+
+/* Enable keeping a history of the temperature samples which is uploaded over
+ * the data model on request or when it is nearly full. The data model has to
+ * be enabled.
+ */
+/* #define ENABLE_SENSOR_HISTORY */
+
 /* Default repeat interval in seconds. This enables the sensor periodically
  * sending the temperature every repeat interval. Value range 0-255. The
  * interval within 1-30 seconds is considered to be min of 30 due to the 
@@ -106,6 +141,13 @@
 /* Number of msgs to be retransmitted per temp change */
 #define NUM_OF_RETRANSMISSIONS         (60)
 
+/* Enable adapting the msg density and the number of retransmissions to the
+ * network. They are lowered while acks arrive early or little mesh traffic is
+ * heard and raised again when acks go missing. TRANSMIT_MSG_DENSITY and
+ * NUM_OF_RETRANSMISSIONS are the most that are sent.
+ */
+#define ENABLE_ADAPTIVE_RETRANSMIT
+
 /* Temperature change in 1/32 kelvin units. If temp changes more than this the
  * sensor would write the temp change onto the group.
  */
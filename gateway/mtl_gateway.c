@@ -0,0 +1,415 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      mtl_gateway.c
+ *
+ *  DESCRIPTION
+ *      This file implements the host side of the MTL over GATT protocol
+ *      served by the Bridge mesh control service:
+ *
+ *      - Messages longer than one ATT write are split into an
+ *        MTL_CONTINUATION_CP write and an MTL_COMPLETE_CP write, as
+ *        MtlFramingSegment does on the bridge.
+ *      - Responses notified on MTL_CONTINUATION_CP and MTL_COMPLETE_CP are
+ *        reassembled, and batches notified on MTL_BATCH_CP are split into
+ *        their |L|MTL msg| records.
+ *      - The client configuration descriptors are written on connection.
+ *        The bridge only passes mesh responses on once MTL_CP_CLIENT_CONFIG
+ *        enables notifications.
+ *      - MTL_RX_STATUS notifications are tracked so that no message is
+ *        written while the inbound queue of the bridge is full.
+ *
+ *      The file only uses the C library, so it builds on any host. The GATT
+ *      connection is reached through the transport passed to MtlGatewayInit.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "mtl_gateway.h"
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static mtl_gateway_result writeAttribute(MTL_GATEWAY_T *p_gw, uint16_t handle,
+                                         const uint8_t *p_value,
+                                         uint16_t length);
+static mtl_gateway_result writeClientConfig(MTL_GATEWAY_T *p_gw,
+                                            uint16_t handle, uint16_t value);
+static void resetReassembly(MTL_GATEWAY_T *p_gw);
+static bool handleBatch(MTL_GATEWAY_T *p_gw, const uint8_t *p_value,
+                        uint16_t length);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      writeAttribute
+ *
+ *  DESCRIPTION
+ *      This function writes a value to an attribute of the bridge through
+ *      the transport.
+ *
+ *  RETURNS
+ *      mtl_gateway_success if the transport accepted the write.
+ *
+ *---------------------------------------------------------------------------*/
+static mtl_gateway_result writeAttribute(MTL_GATEWAY_T *p_gw, uint16_t handle,
+                                         const uint8_t *p_value,
+                                         uint16_t length)
+{
+    p_gw->stats.writes++;
+
+    if(p_gw->transport.write(p_gw->transport.p_context, handle, p_value,
+                             length) != 0)
+    {
+        return mtl_gateway_transport_error;
+    }
+
+    return mtl_gateway_success;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      writeClientConfig
+ *
+ *  DESCRIPTION
+ *      This function writes a client characteristic configuration
+ *      descriptor (little endian). Descriptors the bridge does not have are
+ *      passed as handle 0 and skipped.
+ *
+ *  RETURNS
+ *      mtl_gateway_success if the descriptor was written or skipped.
+ *
+ *---------------------------------------------------------------------------*/
+static mtl_gateway_result writeClientConfig(MTL_GATEWAY_T *p_gw,
+                                            uint16_t handle, uint16_t value)
+{
+    uint8_t cccd[2];
+
+    if(handle == 0)
+    {
+        return mtl_gateway_success;
+    }
+
+    cccd[0] = value & 0xFF;
+    cccd[1] = value >> 8;
+
+    return writeAttribute(p_gw, handle, cccd, sizeof(cccd));
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      resetReassembly
+ *
+ *  DESCRIPTION
+ *      This function discards the message being reassembled.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+static void resetReassembly(MTL_GATEWAY_T *p_gw)
+{
+    p_gw->rx_length = 0;
+    p_gw->rx_continued = false;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      handleBatch
+ *
+ *  DESCRIPTION
+ *      This function splits an MTL_BATCH_CP notification into its messages,
+ *      each prefixed with a one octet length: |L|MTL msg|L|MTL msg|...
+ *      The whole batch is checked before any message is delivered.
+ *
+ *  RETURNS
+ *      true if the batch was well formed.
+ *
+ *---------------------------------------------------------------------------*/
+static bool handleBatch(MTL_GATEWAY_T *p_gw, const uint8_t *p_value,
+                        uint16_t length)
+{
+    uint16_t index = 0;
+
+    while(index < length)
+    {
+        if(p_value[index] == 0 ||
+           p_value[index] > MTL_GATEWAY_MAX_MSG_LEN ||
+           index + 1 + p_value[index] > length)
+        {
+            return false;
+        }
+        index += 1 + p_value[index];
+    }
+
+    for(index = 0; index < length; index += 1 + p_value[index])
+    {
+        p_gw->stats.msgs_received++;
+        p_gw->msg_cb(p_gw->p_msg_context, &p_value[index + 1],
+                     p_value[index]);
+    }
+
+    return (length != 0);
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MtlGatewayInit
+ *
+ *  DESCRIPTION
+ *      This function initialises the gateway state for a connection to a
+ *      bridge. Handles of optional attributes the bridge does not have are
+ *      passed as 0. The default MTU is used until MtlGatewayConnect.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+extern void MtlGatewayInit(MTL_GATEWAY_T *p_gw,
+                           const MTL_GATEWAY_TRANSPORT_T *p_transport,
+                           const MTL_GATEWAY_HANDLES_T *p_handles,
+                           MTL_GATEWAY_MSG_CB_T msg_cb, void *p_msg_context)
+{
+    memset(p_gw, 0, sizeof(*p_gw));
+
+    p_gw->transport = *p_transport;
+    p_gw->handles = *p_handles;
+    p_gw->msg_cb = msg_cb;
+    p_gw->p_msg_context = p_msg_context;
+    p_gw->data_len = MTL_GATEWAY_ATT_MTU - 3;
+
+    /* Assume there is room until the bridge says otherwise */
+    p_gw->rx_free_slots = 1;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MtlGatewayConnect
+ *
+ *  DESCRIPTION
+ *      This function sets the MTU the transport negotiated with the bridge
+ *      and writes the client configuration descriptors: notifications on
+ *      MTL_CONTINUATION_CP and MTL_COMPLETE_CP, which also tell the bridge
+ *      to pass mesh responses on, and on MTL_RX_STATUS. If batching is
+ *      asked for, notifications on MTL_BATCH_CP are enabled and batching is
+ *      switched on. The bridge only batches at an MTU above the default
+ *      one, so batching is not asked for at the default MTU. The current
+ *      MTL_RX_STATUS is then read, if the transport can.
+ *
+ *  RETURNS
+ *      mtl_gateway_success if all the writes were made.
+ *
+ *---------------------------------------------------------------------------*/
+extern mtl_gateway_result MtlGatewayConnect(MTL_GATEWAY_T *p_gw, uint16_t mtu,
+                                            bool batching)
+{
+    mtl_gateway_result result;
+    uint8_t value[MTL_GATEWAY_RX_STATUS_LEN];
+    uint16_t length;
+
+    if(mtu < MTL_GATEWAY_ATT_MTU)
+    {
+        mtu = MTL_GATEWAY_ATT_MTU;
+    }
+    else if(mtu > MTL_GATEWAY_ATT_MTU_MAX)
+    {
+        mtu = MTL_GATEWAY_ATT_MTU_MAX;
+    }
+    p_gw->data_len = mtu - 3;
+    resetReassembly(p_gw);
+
+    result = writeClientConfig(p_gw, p_gw->handles.cp_client_config,
+                               MTL_GATEWAY_CCCD_NOTIFICATION);
+    if(result == mtl_gateway_success)
+    {
+        result = writeClientConfig(p_gw, p_gw->handles.cp2_client_config,
+                                   MTL_GATEWAY_CCCD_NOTIFICATION);
+    }
+    if(result == mtl_gateway_success)
+    {
+        result = writeClientConfig(p_gw,
+                                   p_gw->handles.rx_status_client_config,
+                                   MTL_GATEWAY_CCCD_NOTIFICATION);
+    }
+    if(result == mtl_gateway_success && batching &&
+       p_gw->handles.batch_cp != 0 && mtu > MTL_GATEWAY_ATT_MTU)
+    {
+        value[0] = MTL_GATEWAY_BATCH_ON;
+        result = writeClientConfig(p_gw, p_gw->handles.batch_client_config,
+                                   MTL_GATEWAY_CCCD_NOTIFICATION);
+        if(result == mtl_gateway_success)
+        {
+            result = writeAttribute(p_gw, p_gw->handles.batch_cp, value, 1);
+        }
+    }
+
+    if(result == mtl_gateway_success && p_gw->transport.read != NULL &&
+       p_gw->handles.rx_status != 0 &&
+       p_gw->transport.read(p_gw->transport.p_context,
+                            p_gw->handles.rx_status, value, sizeof(value),
+                            &length) == 0 &&
+       length == MTL_GATEWAY_RX_STATUS_LEN)
+    {
+        p_gw->rx_free_slots = value[0];
+        p_gw->rx_dropped = value[1] | (value[2] << 8);
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MtlGatewaySend
+ *
+ *  DESCRIPTION
+ *      This function writes an MTL message to the bridge. A message that
+ *      fits in one ATT write goes to MTL_COMPLETE_CP. A longer one is split:
+ *      the first data_len octets go to MTL_CONTINUATION_CP and the rest to
+ *      MTL_COMPLETE_CP. The message is refused while the last MTL_RX_STATUS
+ *      of the bridge reported no free slot, the bridge would drop it.
+ *
+ *  RETURNS
+ *      mtl_gateway_success if the message was written.
+ *
+ *---------------------------------------------------------------------------*/
+extern mtl_gateway_result MtlGatewaySend(MTL_GATEWAY_T *p_gw,
+                                         const uint8_t *p_msg,
+                                         uint16_t length)
+{
+    mtl_gateway_result result = mtl_gateway_success;
+
+    if(length == 0 || length > MTL_GATEWAY_MAX_MSG_LEN ||
+       length > 2 * p_gw->data_len)
+    {
+        return mtl_gateway_invalid_length;
+    }
+
+    if(p_gw->rx_free_slots == 0)
+    {
+        p_gw->stats.busy++;
+        return mtl_gateway_busy;
+    }
+
+    if(length > p_gw->data_len)
+    {
+        result = writeAttribute(p_gw, p_gw->handles.continuation_cp, p_msg,
+                                p_gw->data_len);
+        p_msg += p_gw->data_len;
+        length -= p_gw->data_len;
+    }
+
+    if(result == mtl_gateway_success)
+    {
+        result = writeAttribute(p_gw, p_gw->handles.complete_cp, p_msg,
+                                length);
+    }
+
+    if(result == mtl_gateway_success)
+    {
+        p_gw->stats.msgs_sent++;
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MtlGatewayHandleNotification
+ *
+ *  DESCRIPTION
+ *      This function handles a notification from the bridge. Complete
+ *      messages are passed to the message callback. A message notified in
+ *      two parts is delivered when its MTL_COMPLETE_CP part arrives.
+ *      Notifications that cannot be parsed are counted and dropped.
+ *
+ *  RETURNS
+ *      true if the handle belongs to the MTL protocol.
+ *
+ *---------------------------------------------------------------------------*/
+extern bool MtlGatewayHandleNotification(MTL_GATEWAY_T *p_gw, uint16_t handle,
+                                         const uint8_t *p_value,
+                                         uint16_t length)
+{
+    if(handle == 0)
+    {
+        return false;
+    }
+
+    if(handle == p_gw->handles.continuation_cp)
+    {
+        p_gw->stats.notifications++;
+
+        /* The first part of a message */
+        resetReassembly(p_gw);
+        if(length == 0 || length > MTL_GATEWAY_MAX_MSG_LEN)
+        {
+            p_gw->stats.bad_notifications++;
+            return true;
+        }
+
+        memcpy(p_gw->rx_msg, p_value, length);
+        p_gw->rx_length = length;
+        p_gw->rx_continued = true;
+    }
+    else if(handle == p_gw->handles.complete_cp)
+    {
+        p_gw->stats.notifications++;
+
+        if(!p_gw->rx_continued)
+        {
+            p_gw->rx_length = 0;
+        }
+
+        if(length == 0 ||
+           p_gw->rx_length + length > MTL_GATEWAY_MAX_MSG_LEN)
+        {
+            p_gw->stats.bad_notifications++;
+            resetReassembly(p_gw);
+            return true;
+        }
+
+        memcpy(&p_gw->rx_msg[p_gw->rx_length], p_value, length);
+        p_gw->rx_length += length;
+
+        p_gw->stats.msgs_received++;
+        p_gw->msg_cb(p_gw->p_msg_context, p_gw->rx_msg, p_gw->rx_length);
+        resetReassembly(p_gw);
+    }
+    else if(handle == p_gw->handles.batch_cp)
+    {
+        p_gw->stats.notifications++;
+
+        if(!handleBatch(p_gw, p_value, length))
+        {
+            p_gw->stats.bad_notifications++;
+        }
+    }
+    else if(handle == p_gw->handles.rx_status)
+    {
+        p_gw->stats.notifications++;
+
+        if(length != MTL_GATEWAY_RX_STATUS_LEN)
+        {
+            p_gw->stats.bad_notifications++;
+            return true;
+        }
+
+        p_gw->rx_free_slots = p_value[0];
+        p_gw->rx_dropped = p_value[1] | (p_value[2] << 8);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,159 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      mtl_gateway.h
+ *
+ *  DESCRIPTION
+ *      Header definitions for the host side of the MTL over GATT protocol
+ *      served by the Bridge mesh control service. A gateway uses it to send
+ *      MTL messages to a bridge and to receive the responses the bridge
+ *      notifies. The GATT connection is provided by the gateway through the
+ *      MTL_GATEWAY_TRANSPORT_T functions.
+ *
+ *****************************************************************************/
+
+#ifndef __MTL_GATEWAY_H__
+#define __MTL_GATEWAY_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Longest MTL message carried by the bridge */
+#define MTL_GATEWAY_MAX_MSG_LEN                 (27)
+
+/* Default and largest ATT MTU used by the bridge */
+#define MTL_GATEWAY_ATT_MTU                     (23)
+#define MTL_GATEWAY_ATT_MTU_MAX                 (64)
+
+/* Client characteristic configuration values */
+#define MTL_GATEWAY_CCCD_NONE                   (0x0000)
+#define MTL_GATEWAY_CCCD_NOTIFICATION           (0x0001)
+
+/* MTL_BATCH_CP values */
+#define MTL_GATEWAY_BATCH_OFF                   (0x00)
+#define MTL_GATEWAY_BATCH_ON                    (0x01)
+
+/* Length of the MTL_RX_STATUS value */
+#define MTL_GATEWAY_RX_STATUS_LEN               (3)
+
+/*============================================================================*
+ *  Public Data Types
+ *============================================================================*/
+/* Result of the gateway functions */
+typedef enum
+{
+    mtl_gateway_success,
+    mtl_gateway_busy,               /* The bridge has no room for a message */
+    mtl_gateway_invalid_length,     /* The message does not fit the MTU */
+    mtl_gateway_transport_error     /* The transport failed a write */
+}mtl_gateway_result;
+
+/* Connection to the bridge. The functions return 0 on success. */
+typedef struct
+{
+    /* Context passed back to the functions */
+    void *p_context;
+
+    /* Writes a value to an attribute of the bridge */
+    int (*write)(void *p_context, uint16_t handle, const uint8_t *p_value,
+                 uint16_t length);
+
+    /* Reads the value of an attribute of the bridge. The length of the
+     * value read is returned in *p_length.
+     */
+    int (*read)(void *p_context, uint16_t handle, uint8_t *p_value,
+                uint16_t size, uint16_t *p_length);
+}MTL_GATEWAY_TRANSPORT_T;
+
+/* Handles of the mesh control service attributes found by the gateway's
+ * service discovery
+ */
+typedef struct
+{
+    uint16_t continuation_cp;
+    uint16_t cp_client_config;
+    uint16_t complete_cp;
+    uint16_t cp2_client_config;
+    uint16_t batch_cp;
+    uint16_t batch_client_config;
+    uint16_t rx_status;
+    uint16_t rx_status_client_config;
+}MTL_GATEWAY_HANDLES_T;
+
+/* Function called with each complete MTL message notified by the bridge */
+typedef void (*MTL_GATEWAY_MSG_CB_T)(void *p_context, const uint8_t *p_msg,
+                                     uint16_t length);
+
+/* Counters of the traffic on the connection */
+typedef struct
+{
+    uint32_t msgs_sent;             /* Messages written to the bridge */
+    uint32_t msgs_received;         /* Messages delivered to the callback */
+    uint32_t writes;                /* ATT writes made */
+    uint32_t notifications;         /* Notifications handled */
+    uint32_t busy;                  /* Sends refused while the bridge was
+                                     * full
+                                     */
+    uint32_t bad_notifications;     /* Notifications that could not be
+                                     * parsed
+                                     */
+}MTL_GATEWAY_STATS_T;
+
+/* State of the protocol on one connection */
+typedef struct
+{
+    MTL_GATEWAY_TRANSPORT_T transport;
+    MTL_GATEWAY_HANDLES_T   handles;
+
+    MTL_GATEWAY_MSG_CB_T    msg_cb;
+    void                    *p_msg_context;
+
+    /* Largest ATT write or notification payload on the connection */
+    uint16_t                data_len;
+
+    /* Message being reassembled from MTL_CONTINUATION_CP and
+     * MTL_COMPLETE_CP notifications
+     */
+    uint8_t                 rx_msg[MTL_GATEWAY_MAX_MSG_LEN];
+    uint16_t                rx_length;
+    bool                    rx_continued;
+
+    /* Last MTL_RX_STATUS of the bridge: free inbound slots and messages
+     * dropped
+     */
+    uint16_t                rx_free_slots;
+    uint16_t                rx_dropped;
+
+    MTL_GATEWAY_STATS_T     stats;
+}MTL_GATEWAY_T;
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Initialises the gateway state for a connection */
+extern void MtlGatewayInit(MTL_GATEWAY_T *p_gw,
+                           const MTL_GATEWAY_TRANSPORT_T *p_transport,
+                           const MTL_GATEWAY_HANDLES_T *p_handles,
+                           MTL_GATEWAY_MSG_CB_T msg_cb, void *p_msg_context);
+
+/* Enables the notifications of the bridge and, optionally, batching */
+extern mtl_gateway_result MtlGatewayConnect(MTL_GATEWAY_T *p_gw, uint16_t mtu,
+                                            bool batching);
+
+/* Sends an MTL message to the bridge */
+extern mtl_gateway_result MtlGatewaySend(MTL_GATEWAY_T *p_gw,
+                                         const uint8_t *p_msg,
+                                         uint16_t length);
+
+/* Handles a notification received from the bridge */
+extern bool MtlGatewayHandleNotification(MTL_GATEWAY_T *p_gw, uint16_t handle,
+                                         const uint8_t *p_value,
+                                         uint16_t length);
+
+#endif /* __MTL_GATEWAY_H__ */
@@ -0,0 +1,336 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      bench_adv_parse.c
+ *
+ *  DESCRIPTION
+ *      Host benchmark of the Bridge scan path parsing non-connectable
+ *      adverts. A fixed set of adverts standing in for a scan capture is
+ *      replayed through the parser HandleLEAdvMessage used before the AD
+ *      structures were walked, which unpacks the whole report and compares
+ *      the mesh header at every offset, and through the walk in
+ *      app_adv_parse.c as HandleLEAdvMessage uses it now.
+ *
+ *      The set has mesh adverts with and without a flags AD structure, user
+ *      adverts and user advert chunks from lights, beacons and phones, and
+ *      a malformed advert. Both parsers must find the same mesh payloads.
+ *      The benchmark reports the adverts parsed per second on the host, and
+ *      the octets unpacked and the headers compared per advert, which are
+ *      what the parsing costs on the device.
+ *
+ *****************************************************************************/
+
+/* For gettimeofday, the host SDK has its own time.h */
+#define _DEFAULT_SOURCE
+
+#include <string.h>
+#include <sys/time.h>
+
+#include <mem.h>
+
+#include "host_sdk.h"
+#include "app_adv_parse.h"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Largest advert data */
+#define MAX_ADV_DATA_LEN                (31)
+
+/* Times the set is replayed for the timing */
+#define REPLAY_COUNT                    (200000UL)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+/* What a parser found in an advert */
+typedef struct
+{
+    bool   mesh;                /* A mesh AD structure was found */
+    uint16 payload_offset;      /* Offset of the mesh payload */
+    uint16 payload_len;         /* Length of the mesh payload */
+    bool   chunk;               /* A user advert chunk was found */
+    uint32 unpacked;            /* Octets unpacked */
+    uint32 compared;            /* AD headers compared */
+}RESULT_T;
+
+typedef struct
+{
+    uint16 length;
+    uint8  data[MAX_ADV_DATA_LEN];
+}ADVERT_T;
+
+typedef void (*PARSER_T)(const uint16 *p_packed, uint16 length,
+                         RESULT_T *p_result);
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* AD headers as on the Bridge: mesh service data with MTL_ID_CODE, the user
+ * advert and the user advert chunk
+ */
+static const uint8 mesh_ad_data[3] = {0x16, 0xF1, 0xFE};
+static const uint8 user_ad_data[3] = {0x00, 0xAB, 0xAB};
+static const uint8 user_chunk_ad_data[3] = {0xFF, 0x0A, 0x00};
+
+static const ADVERT_T adverts[] =
+{
+    /* Mesh message, alone and after a flags AD structure */
+    { 24, {23, 0x16, 0xF1, 0xFE, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55,
+           0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0x01,
+           0x02, 0x03, 0x04, 0x32} },
+    { 17, {16, 0x16, 0xF1, 0xFE, 0x80, 0x01, 0x23, 0x45, 0x67, 0x89,
+           0xAB, 0xCD, 0xEF, 0x10, 0x20, 0x30, 0x32} },
+    { 27, {2, 0x01, 0x06, 23, 0x16, 0xF1, 0xFE, 0x01, 0x12, 0x23, 0x34,
+           0x45, 0x56, 0x67, 0x78, 0x89, 0x9A, 0xAB, 0xBC, 0xCD, 0xDE,
+           0xEF, 0xF0, 0x0F, 0x1E, 0x2D, 0x31} },
+    { 30, {29, 0x16, 0xF1, 0xFE, 0x02, 0x10, 0x20, 0x30, 0x40, 0x50,
+           0x60, 0x70, 0x80, 0x90, 0xA0, 0xB0, 0xC0, 0xD0, 0xE0, 0xF0,
+           0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x30} },
+
+    /* User advert and user advert chunk from a light */
+    { 12, {11, 0x00, 0xAB, 0xAB, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+           0x07, 0x08} },
+    { 30, {29, 0xFF, 0x0A, 0x00, 0x12, 0x01, 0x04, 0x00, 0x11, 0x22,
+           0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC,
+           0xDD, 0xEE, 0xFF, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70} },
+
+    /* iBeacon and Eddystone URL */
+    { 30, {2, 0x01, 0x06, 26, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xE2, 0xC5,
+           0x6D, 0xB5, 0xDF, 0xFB, 0x48, 0xD2, 0xB0, 0x60, 0xD0, 0xF5,
+           0xA7, 0x10, 0x96, 0xE0, 0x00, 0x01, 0x00, 0x02, 0xC5} },
+    { 27, {3, 0x03, 0xAA, 0xFE, 22, 0x16, 0xAA, 0xFE, 0x10, 0xEB, 0x03,
+           'e', 'x', 'a', 'm', 'p', 'l', 'e', '.', 'c', 'o', 'm', '/',
+           'm', 'e', 's', 'h'} },
+
+    /* Phones: manufacturer data and a short name */
+    { 30, {2, 0x01, 0x1A, 26, 0xFF, 0x06, 0x00, 0x01, 0x09, 0x20, 0x02,
+           0x5B, 0x1F, 0x7D, 0x21, 0x9C, 0x42, 0x0E, 0x35, 0x87, 0x5A,
+           0x60, 0x13, 0x2A, 0x3E, 0x4F, 0x1D, 0xB2, 0x90, 0x04} },
+    { 14, {2, 0x01, 0x06, 3, 0x02, 0x0F, 0x18, 6, 0x09, 'P', 'h', 'o',
+           'n', 'e'} },
+
+    /* Length octet running past the end of the report */
+    { 10, {2, 0x01, 0x06, 20, 0x16, 0xF1, 0xFE, 0x00, 0x11, 0x22} }
+};
+
+#define NUM_ADVERTS     (sizeof(adverts) / sizeof(adverts[0]))
+
+/* The last advert of the set is malformed */
+#define MALFORMED_ADVERT    (NUM_ADVERTS - 1)
+
+/* The adverts packed two octets to a word, as the firmware supplies them */
+static uint16 packed[NUM_ADVERTS][(MAX_ADV_DATA_LEN + 1) / 2];
+
+static uint8 unpackedData[MAX_ADV_DATA_LEN];
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/* Parser of the scan path before the AD structures were walked */
+static void parseByOffset(const uint16 *p_packed, uint16 length_data,
+                          RESULT_T *p_result)
+{
+    uint8 length;
+    uint8 index = 0;
+
+    MemCopyUnPack(unpackedData, p_packed, length_data);
+    p_result->unpacked += length_data;
+
+    do
+    {
+        if(index + 4 < length_data)
+        {
+            p_result->compared++;
+            if(!MemCmp(&unpackedData[index + 1], mesh_ad_data, 3))
+            {
+                length = unpackedData[index];
+
+                if(length > MAX_ADV_DATA_LEN || length == 0)
+                {
+                    break;
+                }
+
+                p_result->mesh = TRUE;
+                p_result->payload_offset = index + 4;
+                p_result->payload_len = length - 3;
+                break;
+            }
+
+            p_result->compared++;
+            if(!MemCmp(&unpackedData[index + 1], user_ad_data, 3))
+            {
+                /* Not a mesh data */
+            }
+            index += 1;
+        }
+        else
+        {
+            break;
+        }
+    }while(index < length_data);
+}
+
+/* Parser of the scan path walking the AD structures, as in
+ * HandleLEAdvMessage
+ */
+static void parseByAdWalk(const uint16 *p_packed, uint16 length_data,
+                          RESULT_T *p_result)
+{
+    uint16 index = 0;
+    uint8 length;
+
+    while(AppAdvNextAd(p_packed, length_data, &index, &length))
+    {
+        p_result->compared++;
+        if(AppAdvMatchAd(p_packed, index, mesh_ad_data))
+        {
+            MemCopyUnPack(unpackedData, p_packed, index + length + 1);
+            p_result->unpacked += index + length + 1;
+
+            p_result->mesh = TRUE;
+            p_result->payload_offset = index + AD_PAYLOAD_OFFSET;
+            p_result->payload_len = length - 3;
+            break;
+        }
+
+        p_result->compared++;
+        if(AppAdvMatchAd(p_packed, index, user_ad_data))
+        {
+            /* Not a mesh data */
+        }
+        else
+        {
+            p_result->compared++;
+            if(AppAdvMatchAd(p_packed, index, user_chunk_ad_data))
+            {
+                MemCopyUnPack(unpackedData, p_packed, index + length + 1);
+                p_result->unpacked += index + length + 1;
+                p_result->chunk = TRUE;
+                break;
+            }
+        }
+
+        index += length + 1;
+    }
+}
+
+/* Packs the adverts two octets to a word, low octet first */
+static void packAdverts(void)
+{
+    uint16 advert;
+    uint16 index;
+
+    memset(packed, 0, sizeof(packed));
+
+    for(advert = 0; advert < NUM_ADVERTS; advert++)
+    {
+        for(index = 0; index < adverts[advert].length; index++)
+        {
+            packed[advert][index >> 1] |= (index & 1) ?
+                                   (uint16)(adverts[advert].data[index] << 8) :
+                                   adverts[advert].data[index];
+        }
+    }
+}
+
+/* Replays the set through a parser and returns the adverts per second */
+static double timeParser(PARSER_T parser)
+{
+    RESULT_T result;
+    struct timeval start, end;
+    double elapsed;
+    uint32 count;
+    uint16 advert;
+
+    gettimeofday(&start, NULL);
+
+    for(count = 0; count < REPLAY_COUNT; count++)
+    {
+        for(advert = 0; advert < NUM_ADVERTS; advert++)
+        {
+            memset(&result, 0, sizeof(result));
+            parser(packed[advert], adverts[advert].length, &result);
+        }
+    }
+
+    gettimeofday(&end, NULL);
+    elapsed = (end.tv_sec - start.tv_sec) +
+              (end.tv_usec - start.tv_usec) / 1000000.0;
+
+    return elapsed > 0 ? (double)REPLAY_COUNT * NUM_ADVERTS / elapsed : 0;
+}
+
+/*============================================================================*
+ *  Benchmark
+ *============================================================================*/
+int main(void)
+{
+    RESULT_T by_offset[NUM_ADVERTS];
+    RESULT_T by_walk[NUM_ADVERTS];
+    uint32 offset_unpacked = 0, walk_unpacked = 0;
+    uint32 offset_compared = 0, walk_compared = 0;
+    uint16 mesh = 0, chunks = 0;
+    uint16 advert;
+
+    packAdverts();
+
+    memset(by_offset, 0, sizeof(by_offset));
+    memset(by_walk, 0, sizeof(by_walk));
+
+    for(advert = 0; advert < NUM_ADVERTS; advert++)
+    {
+        parseByOffset(packed[advert], adverts[advert].length,
+                      &by_offset[advert]);
+        parseByAdWalk(packed[advert], adverts[advert].length,
+                      &by_walk[advert]);
+
+        /* The walk unpacks no more than the whole report */
+        CHECK(by_walk[advert].unpacked <= by_offset[advert].unpacked);
+
+        offset_unpacked += by_offset[advert].unpacked;
+        offset_compared += by_offset[advert].compared;
+        walk_unpacked += by_walk[advert].unpacked;
+        walk_compared += by_walk[advert].compared;
+        mesh += by_walk[advert].mesh;
+        chunks += by_walk[advert].chunk;
+
+        if(advert == MALFORMED_ADVERT)
+        {
+            /* The old parser passes on a payload running past the report,
+             * the walk drops it
+             */
+            CHECK(by_offset[advert].mesh);
+            CHECK(!by_walk[advert].mesh);
+            continue;
+        }
+
+        /* Both find the same mesh payload in the well formed adverts */
+        CHECK_EQUAL(by_offset[advert].mesh, by_walk[advert].mesh);
+        CHECK_EQUAL(by_offset[advert].payload_offset,
+                    by_walk[advert].payload_offset);
+        CHECK_EQUAL(by_offset[advert].payload_len,
+                    by_walk[advert].payload_len);
+    }
+
+    /* The set has four good mesh adverts and one user advert chunk */
+    CHECK_EQUAL(4, mesh);
+    CHECK_EQUAL(1, chunks);
+
+    printf("%-10s %10s %9s %9s\n", "parser", "adverts/s", "unpacked",
+           "compared");
+    printf("%-10s %10s %9s %9s\n", "", "(host)", "/advert", "/advert");
+    printf("%-10s %10.0f %9.1f %9.1f\n", "by offset",
+           timeParser(parseByOffset),
+           offset_unpacked / (double)NUM_ADVERTS,
+           offset_compared / (double)NUM_ADVERTS);
+    printf("%-10s %10.0f %9.1f %9.1f\n", "AD walk",
+           timeParser(parseByAdWalk),
+           walk_unpacked / (double)NUM_ADVERTS,
+           walk_compared / (double)NUM_ADVERTS);
+
+    return HostTestResult("bench_adv_parse");
+}
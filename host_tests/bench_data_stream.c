@@ -0,0 +1,411 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      bench_data_stream.c
+ *
+ *  DESCRIPTION
+ *      Host benchmark of the Light 7-25 data stream. Reports from 16 octets
+ *      to 4 KB are streamed over a simulated mesh which loses, delays and
+ *      reorders messages. The module is both ends of the stream: the
+ *      messages sent by AppDataClientHandler's side are delivered to
+ *      AppDataServerHandler, whose acknowledgements travel back over the
+ *      same channel as DATA_STREAM_RECEIVED.
+ *
+ *      The transfer figures are read with AppDataStreamGetStats, the same
+ *      counters returned by CSR_STREAM_STATS_REQ on the device. The
+ *      benchmark also checks that the octets taken by the receiver are the
+ *      report, in order, and that the sender always goes back to idle.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "host_sdk.h"
+#include "app_data_stream.c"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Device the reports are streamed to */
+#define COLLECTOR_ID                    (0x8FFE)
+
+/* Device sending the reports */
+#define LIGHT_ID                        (0x8001)
+
+/* Largest report streamed */
+#define MAX_REPORT_LEN                  (4096)
+
+/* Streams sent for each report length and channel */
+#define TRIALS                          (20)
+
+/* Messages that can be in flight on the channel */
+#define MAX_IN_FLIGHT                   (16)
+
+/* Time one stream is given to end */
+#define STREAM_TIME_LIMIT               (30 * MINUTE)
+
+/* Step of the virtual clock while a stream is sent */
+#define RUN_STEP                        (100 * MILLISECOND)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+/* Simulated mesh between the sender and the receiver */
+typedef struct
+{
+    const char *name;
+    uint16 loss_percent;        /* Chance of a message being lost */
+    uint32 latency;             /* Shortest delivery time */
+    uint32 jitter;              /* Largest delay added to the latency */
+}CHANNEL_T;
+
+/* Message kinds */
+typedef enum
+{
+    msg_flush,
+    msg_data,
+    msg_received
+}MSG_KIND_T;
+
+typedef struct
+{
+    bool       used;
+    timer_id   tid;             /* Timer delivering the message */
+    MSG_KIND_T kind;
+    uint16     sn;              /* StreamSN, or StreamNESN of an ack */
+    uint16     len;
+    uint8      octets[MAX_DATA_STREAM_PACKET_SIZE];
+}MSG_T;
+
+/* Results of the streams of one report length over one channel */
+typedef struct
+{
+    uint16 completed;
+    uint16 aborted;
+    uint16 corrupt;
+    uint16 stuck;
+    uint32 duration;            /* Sum over the completed streams, ms */
+    uint32 packets;             /* Sum over all the streams */
+    uint32 retransmissions;     /* Sum over all the streams */
+}RESULT_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+static const CHANNEL_T channels[] =
+{
+    /* One hop, nothing lost */
+    { "clean",      0,  20 * MILLISECOND,   0 * MILLISECOND },
+    /* A few hops with some collisions */
+    { "lossy",     10,  40 * MILLISECOND,  60 * MILLISECOND },
+    /* A busy mesh. The jitter is close to the retry time, so
+     * retransmissions overtake the messages they repeat.
+     */
+    { "congested", 20, 100 * MILLISECOND, 400 * MILLISECOND }
+};
+
+static const uint16 report_lengths[] = { 16, 64, 256, 1024, 4096 };
+
+static const CHANNEL_T *p_channel;
+
+static MSG_T messages[MAX_IN_FLIGHT];
+
+/* Report sent and the copy taken by the receiver */
+static uint8 report[MAX_REPORT_LEN];
+static uint8 received[MAX_REPORT_LEN];
+
+static uint32 random_state = 1;
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+static uint32 nextRandom(uint32 range)
+{
+    random_state = random_state * 1103515245 + 12345;
+    return (random_state >> 8) % range;
+}
+
+static void deliverMessage(timer_id tid);
+
+/* Puts a message on the channel, unless the channel loses it */
+static void sendMessage(MSG_KIND_T kind, uint16 sn, const uint8 *p_octets,
+                        uint16 len)
+{
+    uint32 delay = p_channel->latency;
+    uint16 index;
+
+    if(nextRandom(100) < p_channel->loss_percent)
+    {
+        return;
+    }
+
+    if(p_channel->jitter != 0)
+    {
+        delay += nextRandom(p_channel->jitter);
+    }
+
+    for(index = 0; index < MAX_IN_FLIGHT; index++)
+    {
+        MSG_T *p_msg = &messages[index];
+
+        if(!p_msg->used)
+        {
+            p_msg->tid = TimerCreate(delay, TRUE, deliverMessage);
+            if(p_msg->tid == TIMER_INVALID)
+            {
+                break;
+            }
+            p_msg->used = TRUE;
+            p_msg->kind = kind;
+            p_msg->sn = sn;
+            p_msg->len = len;
+            if(len != 0)
+            {
+                memcpy(p_msg->octets, p_octets, len);
+            }
+            return;
+        }
+    }
+
+    /* The channel is full, which is the same as losing the message */
+}
+
+/* Passes a flush or data message to the receiving side of the module, and
+ * returns its acknowledgement as the firmware would
+ */
+static void receiveMessage(const MSG_T *p_msg)
+{
+    CSRMESH_DATA_STREAM_FLUSH_T flush;
+    CSRMESH_DATA_STREAM_SEND_T data;
+    CSRMESH_EVENT_DATA_T event;
+    void *p_ack = NULL;
+    uint16 nesn = app_stream_state.rx.nesn;
+
+    event.src_id = LIGHT_ID;
+    event.dst_id = COLLECTOR_ID;
+
+    if(p_msg->kind == msg_flush)
+    {
+        flush.streamsn = p_msg->sn;
+        event.data = &flush;
+        AppDataServerHandler(CSRMESH_DATA_STREAM_FLUSH, &event,
+                             sizeof(flush), &p_ack);
+    }
+    else
+    {
+        data.streamsn = p_msg->sn;
+        memcpy(data.streamoctets, p_msg->octets, p_msg->len);
+        data.streamoctets_len = p_msg->len;
+        event.data = &data;
+        AppDataServerHandler(CSRMESH_DATA_STREAM_SEND, &event,
+                             sizeof(data), &p_ack);
+
+        /* Keep the octets the receiver took */
+        if(app_stream_state.rx.nesn != nesn &&
+           nesn + p_msg->len <= MAX_REPORT_LEN)
+        {
+            memcpy(&received[nesn], p_msg->octets, p_msg->len);
+        }
+    }
+
+    if(p_ack != NULL)
+    {
+        sendMessage(msg_received, *(uint16 *)p_ack, NULL, 0);
+    }
+}
+
+static void deliverMessage(timer_id tid)
+{
+    uint16 index;
+
+    for(index = 0; index < MAX_IN_FLIGHT; index++)
+    {
+        MSG_T *p_msg = &messages[index];
+
+        if(p_msg->used && p_msg->tid == tid)
+        {
+            MSG_T msg = *p_msg;
+
+            p_msg->used = FALSE;
+
+            if(msg.kind == msg_received)
+            {
+                CSRMESH_DATA_STREAM_RECEIVED_T ack;
+                CSRMESH_EVENT_DATA_T event;
+
+                ack.streamnesn = msg.sn;
+                event.src_id = COLLECTOR_ID;
+                event.dst_id = LIGHT_ID;
+                event.data = &ack;
+                AppDataClientHandler(CSRMESH_DATA_STREAM_RECEIVED, &event,
+                                     sizeof(ack), NULL);
+            }
+            else
+            {
+                receiveMessage(&msg);
+            }
+            return;
+        }
+    }
+}
+
+/* Streams one report and adds its figures to the result */
+static void runStream(uint16 length, RESULT_T *p_result)
+{
+    const APP_DATA_STREAM_STATS_T *p_stats;
+    uint32 elapsed = 0;
+    uint16 index;
+
+    HostReset();
+    memset(messages, 0, sizeof(messages));
+    memset(received, 0, sizeof(received));
+
+    /* A location report, which the receiver takes without acting on it */
+    report[0] = USER_LOCATION_REPORT;
+    for(index = 1; index < length; index++)
+    {
+        report[index] = (uint8)nextRandom(256);
+    }
+
+    AppDataStreamInit(NULL, 0);
+    AppDataStreamResetStats();
+
+    CHECK(AppDataStreamSendReport(COLLECTOR_ID, report, length));
+
+    while(AppDataStreamIsSending() && elapsed < STREAM_TIME_LIMIT)
+    {
+        HostRunFor(RUN_STEP);
+        elapsed += RUN_STEP;
+    }
+
+    p_stats = AppDataStreamGetStats();
+
+    /* The sender must give up rather than wait for ever */
+    CHECK(!AppDataStreamIsSending());
+    CHECK_EQUAL(1, p_stats->streams_started);
+    CHECK_EQUAL(1, p_stats->streams_completed + p_stats->streams_aborted);
+
+    if(AppDataStreamIsSending())
+    {
+        p_result->stuck++;
+    }
+    else if(p_stats->streams_completed)
+    {
+        p_result->completed++;
+        p_result->duration += p_stats->duration;
+
+        CHECK_EQUAL(length, p_stats->bytes_acked);
+        CHECK(memcmp(report, received, length) == 0);
+        if(memcmp(report, received, length) != 0)
+        {
+            p_result->corrupt++;
+        }
+    }
+    else
+    {
+        p_result->aborted++;
+    }
+
+    p_result->packets += p_stats->packets_sent;
+    p_result->retransmissions += p_stats->retransmissions;
+}
+
+/*============================================================================*
+ *  Benchmark
+ *============================================================================*/
+int main(void)
+{
+    uint16 chan;
+    uint16 len;
+    uint16 trial;
+
+    printf("%-10s %6s %9s %9s %9s %9s %12s\n", "channel", "octets",
+           "completed", "time(ms)", "packets", "retx", "goodput(B/s)");
+
+    for(chan = 0; chan < sizeof(channels) / sizeof(channels[0]); chan++)
+    {
+        p_channel = &channels[chan];
+
+        for(len = 0; len < sizeof(report_lengths) / sizeof(report_lengths[0]);
+            len++)
+        {
+            uint16 length = report_lengths[len];
+            RESULT_T result;
+            uint32 mean_time = 0;
+
+            memset(&result, 0, sizeof(result));
+
+            for(trial = 0; trial < TRIALS; trial++)
+            {
+                runStream(length, &result);
+            }
+
+            if(result.completed)
+            {
+                mean_time = result.duration / result.completed;
+            }
+
+            printf("%-10s %6u %6u/%-2u %9lu %9lu %9lu %12lu\n",
+                   p_channel->name, length, result.completed, TRIALS,
+                   (unsigned long)mean_time,
+                   (unsigned long)(result.packets / TRIALS),
+                   (unsigned long)(result.retransmissions / TRIALS),
+                   (unsigned long)(mean_time ?
+                                   (uint32)length * 1000 / mean_time : 0));
+
+            CHECK_EQUAL(0, result.corrupt);
+            CHECK_EQUAL(0, result.stuck);
+
+            /* Nothing is lost on the clean channel */
+            if(p_channel->loss_percent == 0)
+            {
+                CHECK_EQUAL(TRIALS, result.completed);
+            }
+        }
+    }
+
+    return HostTestResult("bench_data_stream");
+}
+
+/*============================================================================*
+ *  Firmware functions called by the module
+ *============================================================================*/
+CSRmeshResult DataModelInit(CsrUint8 nw_id, CsrUint16 *group_id_list,
+                            CsrUint16 num_groups,
+                            CSRMESH_MODEL_CALLBACK_T app_callback)
+{
+    return CSR_MESH_RESULT_SUCCESS;
+}
+
+CSRmeshResult DataModelClientInit(CSRMESH_MODEL_CALLBACK_T app_callback)
+{
+    return CSR_MESH_RESULT_SUCCESS;
+}
+
+CSRmeshResult DataStreamFlush(CsrUint8 nw_id, CsrUint16 dest_id,
+                              CSRMESH_DATA_STREAM_FLUSH_T *p_params)
+{
+    sendMessage(msg_flush, p_params->streamsn, NULL, 0);
+    return CSR_MESH_RESULT_SUCCESS;
+}
+
+CSRmeshResult DataStreamSend(CsrUint8 nw_id, CsrUint16 dest_id,
+                             CSRMESH_DATA_STREAM_SEND_T *p_params)
+{
+    sendMessage(msg_data, p_params->streamsn, p_params->streamoctets,
+                p_params->streamoctets_len);
+    return CSR_MESH_RESULT_SUCCESS;
+}
+
+CSRmeshResult DataBlockSend(CsrUint8 nw_id, CsrUint16 dest_id,
+                            CSRMESH_DATA_BLOCK_SEND_T *p_params)
+{
+    return CSR_MESH_RESULT_SUCCESS;
+}
+
+void UserAdvertsUpdate(void)
+{
+}
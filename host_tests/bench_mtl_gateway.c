@@ -0,0 +1,199 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      bench_mtl_gateway.c
+ *
+ *  DESCRIPTION
+ *      Host benchmark of a gateway talking to the Bridge mesh control
+ *      service through the MTL gateway library and the loopback transport.
+ *      The gateway sends messages as fast as MTL_RX_STATUS lets it, and each
+ *      message is answered by one or several devices on the mesh. The
+ *      benchmark reports the response throughput, the latency from the send
+ *      to the first response, and the ATT traffic per message, at the
+ *      default and the largest MTU, with and without batching.
+ *
+ *      The GATT link takes no time in the loopback, so the figures are
+ *      those of the bridge queues and of the mesh.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "host_sdk.h"
+#include "mtl_loopback.h"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Messages sent in each run */
+#define NUM_MSGS                        (200)
+
+/* Time a run is given to end */
+#define RUN_TIME_LIMIT                  (5 * MINUTE)
+
+/* Step of the virtual clock while the gateway waits */
+#define RUN_STEP                        (MILLISECOND)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    const char *name;
+    uint16 mtu;
+    bool   batching;
+    uint16 responders;
+}CONFIG_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+static const CONFIG_T configs[] =
+{
+    { "mtu23",          MTL_GATEWAY_ATT_MTU,     FALSE, 1 },
+    { "mtu64",          MTL_GATEWAY_ATT_MTU_MAX, FALSE, 1 },
+    { "mtu64+batch",    MTL_GATEWAY_ATT_MTU_MAX, TRUE,  1 },
+    { "mtu23 group",    MTL_GATEWAY_ATT_MTU,     FALSE, 4 },
+    { "mtu64 group",    MTL_GATEWAY_ATT_MTU_MAX, FALSE, 4 },
+    { "mtu64+b group",  MTL_GATEWAY_ATT_MTU_MAX, TRUE,  4 }
+};
+
+static const uint16 msg_lengths[] = { 10, MTL_GATEWAY_MAX_MSG_LEN };
+
+/* The scheduler holds two messages and the mesh takes 30 ms for each */
+static const uint16 sched_queue_size = 2;
+static const uint32 mesh_tx_time = 30 * MILLISECOND;
+
+static MTL_GATEWAY_T gateway;
+
+/* Send time of each message and whether it has been answered */
+static uint32 send_time[NUM_MSGS];
+static bool answered[NUM_MSGS];
+
+static uint32 responses;
+static uint32 latency_sum;
+static uint32 latency_max;
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/* Records the latency of the first response to each message. The messages
+ * start with their sequence number.
+ */
+static void recordResponse(void *p_context, const uint8_t *p_msg,
+                           uint16_t length)
+{
+    uint16 seq = p_msg[0] | (p_msg[1] << 8);
+    uint32 latency;
+
+    responses++;
+
+    if(seq < NUM_MSGS && !answered[seq])
+    {
+        answered[seq] = TRUE;
+        latency = TimeGet32() - send_time[seq];
+        latency_sum += latency;
+        if(latency > latency_max)
+        {
+            latency_max = latency;
+        }
+    }
+}
+
+/* Sends NUM_MSGS messages and prints the figures of the run */
+static void runConfig(const CONFIG_T *p_config, uint16 length)
+{
+    LOOPBACK_MESH_T mesh;
+    uint8 msg[MTL_GATEWAY_MAX_MSG_LEN];
+    uint16 sent = 0;
+    uint32 expected = (uint32)NUM_MSGS * p_config->responders;
+    uint32 elapsed;
+    uint32 writes;
+
+    HostReset();
+    memset(answered, 0, sizeof(answered));
+    responses = 0;
+    latency_sum = 0;
+    latency_max = 0;
+
+    mesh.sched_queue_size = sched_queue_size;
+    mesh.mesh_tx_time = mesh_tx_time;
+    mesh.responders = p_config->responders;
+
+    MtlLoopbackInit(&gateway, &mesh, p_config->mtu);
+    MtlGatewayInit(&gateway, &loopback_transport, &loopback_handles,
+                   recordResponse, NULL);
+    CHECK_EQUAL(mtl_gateway_success,
+                MtlGatewayConnect(&gateway, p_config->mtu,
+                                  p_config->batching));
+    writes = gateway.stats.writes;
+
+    memset(msg, 0xA5, sizeof(msg));
+
+    while(responses < expected && TimeGet32() < RUN_TIME_LIMIT)
+    {
+        if(sent < NUM_MSGS)
+        {
+            msg[0] = sent & 0xFF;
+            msg[1] = sent >> 8;
+            send_time[sent] = TimeGet32();
+
+            if(MtlGatewaySend(&gateway, msg, length) == mtl_gateway_success)
+            {
+                sent++;
+                continue;
+            }
+        }
+
+        HostRunFor(RUN_STEP);
+    }
+    elapsed = TimeGet32();
+    writes = gateway.stats.writes - writes;
+
+    printf("%-14s %6u %9lu %10lu %8lu %8lu %7lu.%02lu %7lu.%02lu %6u\n",
+           p_config->name, length,
+           (unsigned long)responses,
+           (unsigned long)(elapsed ? (uint64_t)responses * SECOND /
+                                                            elapsed : 0),
+           (unsigned long)(latency_sum / NUM_MSGS / MILLISECOND),
+           (unsigned long)(latency_max / MILLISECOND),
+           (unsigned long)(writes / NUM_MSGS),
+           (unsigned long)(writes * 100 / NUM_MSGS % 100),
+           (unsigned long)(gateway.stats.notifications / expected),
+           (unsigned long)(gateway.stats.notifications * 100 / expected %
+                                                                        100),
+           gateway.rx_dropped);
+
+    /* Flow control keeps the bridge from dropping anything */
+    CHECK_EQUAL(NUM_MSGS, sent);
+    CHECK_EQUAL(expected, responses);
+    CHECK_EQUAL(0, gateway.rx_dropped);
+    CHECK_EQUAL(0, gateway.stats.bad_notifications);
+}
+
+/*============================================================================*
+ *  Benchmark
+ *============================================================================*/
+int main(void)
+{
+    uint16 config;
+    uint16 len;
+
+    printf("%-14s %6s %9s %10s %8s %8s %10s %10s %6s\n", "config", "octets",
+           "responses", "resp/s", "mean(ms)", "max(ms)", "writes/msg",
+           "notif/resp", "drops");
+
+    for(config = 0; config < sizeof(configs) / sizeof(configs[0]); config++)
+    {
+        for(len = 0; len < sizeof(msg_lengths) / sizeof(msg_lengths[0]);
+            len++)
+        {
+            runConfig(&configs[config], msg_lengths[len]);
+        }
+    }
+
+    return HostTestResult("bench_mtl_gateway");
+}
@@ -0,0 +1,468 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      bench_predictive_control.c
+ *
+ *  DESCRIPTION
+ *      Host simulation of the Heater controlling a room through a
+ *      temperature sensor it subscribes to, using the mesh event handler as
+ *      built for the device. Built as bench_predictive_control with the
+ *      configuration in user_config.h, and as bench_fixed_interval with
+ *      HOST_FIXED_INTERVAL, which leaves out ENABLE_PREDICTIVE_CONTROL so the
+ *      heater switches on the last value and keeps the sensors at
+ *      SUBSCRIPTION_REPEAT_INTERVAL.
+ *
+ *      The room loses heat to the outside, which swings over the day, and
+ *      the heater warms it through an element that takes a while to warm up
+ *      and cool down. The desired temperature is set back at night. The
+ *      sensor follows the TempSensor application: it samples every
+ *      SENSOR_SAMPLE_INTERVAL, writes its value when it has moved by the
+ *      tolerance and at the repeat interval, writes a changed repeat interval
+ *      to its NVM and writes its value on every subscription.
+ *
+ *      Each run lasts two days and the second day is reported: the updates
+ *      written by the sensor, the messages of the heater and the NVM writes
+ *      of the sensor per hour, and how far the room was from the desired
+ *      temperature. The shared run adds a second heater on the same sensor
+ *      which needs the shortest repeat interval, and checks that the heater
+ *      never asks for a longer one while it is kept to.
+ *
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_sdk.h"
+#include "host_heater.h"
+#include "user_config.h"
+
+#ifdef HOST_FIXED_INTERVAL
+#undef ENABLE_PREDICTIVE_CONTROL
+#endif /* HOST_FIXED_INTERVAL */
+
+/* The event handler is included to reach its state */
+#include "app_mesh_event_handler.c"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* The virtual clock wraps round after 71 minutes, the model keeps its own
+ * time in seconds
+ */
+#define HOUR                            (3600UL)
+
+/* Length of a run and the time from which it is reported, in seconds */
+#define RUN_TIME                        (48 * HOUR)
+#define REPORT_TIME                     (24 * HOUR)
+#define REPORT_HOURS                    ((RUN_TIME - REPORT_TIME) / HOUR)
+
+/* Sensor and heater device ids and the sensor group */
+#define SENSOR_ID                       (0x8001)
+#define PEER_HEATER_ID                  (0x8002)
+#define SENSOR_GROUP                    (0x0001)
+
+/* Sensor behaviour, as in the TempSensor user_config.h */
+#define SENSOR_SAMPLE_INTERVAL          (15)
+#define SENSOR_TOLERANCE                (32)
+#define SENSOR_MIN_REPEAT_INTERVAL      (30)
+
+/* Room: time constant of the heat loss, heater power in kelvin per hour,
+ * time constant of the heater element
+ */
+#define ROOM_TIME_CONSTANT              (2.0 * 3600)
+#define HEATER_POWER                    (12.0 / 3600)
+#define HEATER_TIME_CONSTANT            (15.0 * 60)
+
+#define PI                              (3.14159265358979)
+
+/* Outside temperature over the day, coldest at 03:00, in kelvin */
+#define OUTSIDE_MEAN                    (278.0)
+#define OUTSIDE_SWING                   (4.0)
+
+/* Desired temperature by day, 06:00 to 22:00, and by night, in kelvin */
+#define DESIRED_DAY                     (294)
+#define DESIRED_NIGHT                   (290)
+
+/* Interval the second heater needs in the shared run */
+#define PEER_INTERVAL                   (SUBSCRIPTION_MIN_REPEAT_INTERVAL)
+
+/* Time within which the sends of one subscription fall */
+#define SUBSCRIPTION_BURST_TIME         (10)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint8  repeat_interval;     /* Repeat interval last set */
+    uint32 next_repeat;         /* Model time of the next repeat */
+    uint32 next_sample;         /* Model time of the next sample */
+    uint16 last_bcast;          /* Temperature last written */
+    uint16 desired;             /* Desired temperature */
+    uint8  tid;
+}SENSOR_MODEL_T;
+
+typedef struct
+{
+    double room;                /* Room temperature in kelvin */
+    double element;             /* Heater output in kelvin per second */
+    uint32 time;                /* Model time in seconds */
+}ROOM_T;
+
+typedef struct
+{
+    uint32 updates;             /* Values written by the sensor */
+    uint32 heater_msgs;         /* Messages sent by the heater */
+    uint32 subscriptions;       /* Subscriptions of the heater */
+    uint32 nvm_writes;          /* Repeat intervals written by the sensor */
+    double error_sum;           /* Time integral of the error in K.s */
+    double error_max;           /* Largest error in kelvin */
+    uint32 cold_time;           /* Seconds more than 0.5 K below desired */
+    uint32 heat_time;           /* Seconds the heater was on */
+}FIGURES_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+static SENSOR_MODEL_T sensor;
+static ROOM_T room;
+static FIGURES_T figures;
+
+/* Shared run: the second heater and the model time it last subscribed */
+static bool peer_present;
+static uint32 peer_subscribe_time;
+
+/* Model time of the last subscription of the heater, 0 if none */
+static uint32 last_subscription;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static void sensorSetState(uint16 src_id, uint8 interval);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+static bool reporting(void)
+{
+    return room.time >= REPORT_TIME;
+}
+
+static uint16 desiredTemperature(uint32 now)
+{
+    uint32 hour = (now / HOUR) % 24;
+
+    return (hour >= 6 && hour < 22) ? DESIRED_DAY * 32 : DESIRED_NIGHT * 32;
+}
+
+static double outsideTemperature(uint32 now)
+{
+    double hour = (double)(now % (24 * HOUR)) / HOUR;
+
+    return OUTSIDE_MEAN - OUTSIDE_SWING * cos((hour - 3.0) * PI / 12.0);
+}
+
+/* Writes the sensor values to the group, which the heater receives */
+static void sensorWrite(void)
+{
+    CSRMESH_SENSOR_WRITE_VALUE_T write;
+    CSRMESH_EVENT_DATA_T data;
+    void *p_response = NULL;
+    uint8 *p_value;
+
+    sensor.last_bcast = (uint16)lround(room.room * 32);
+    sensor.tid = (sensor.tid + 1) & 0xFF;
+
+    memset(&write, 0, sizeof(write));
+    write.type = sensor_type_internal_air_temperature;
+    p_value = write.value;
+    BufWriteUint16(&p_value, sensor.last_bcast);
+    write.value_len = 2;
+    write.type2 = sensor_type_desired_air_temperature;
+    p_value = write.value2;
+    BufWriteUint16(&p_value, sensor.desired);
+    write.value2_len = 2;
+    write.tid = sensor.tid;
+
+    data.nw_id = 0;
+    data.seq_num = 0;
+    data.src_id = SENSOR_ID;
+    data.dst_id = SENSOR_GROUP;
+    data.data = &write;
+
+    AppSensorEventHandler(CSRMESH_SENSOR_WRITE_VALUE, &data, sizeof(write),
+                          &p_response);
+
+    if(reporting())
+    {
+        figures.updates++;
+
+        /* The library sends the response of the heater */
+        if(p_response != NULL)
+        {
+            figures.heater_msgs++;
+        }
+    }
+}
+
+/* Starts the repeats of the sensor from now */
+static void sensorRestartRepeat(void)
+{
+    uint8 interval = sensor.repeat_interval;
+
+    if(interval < SENSOR_MIN_REPEAT_INTERVAL)
+    {
+        interval = SENSOR_MIN_REPEAT_INTERVAL;
+    }
+    sensor.next_repeat = room.time + interval;
+}
+
+/* A subscription sent to the group reaches the sensor, and the heater when
+ * another heater sent it
+ */
+static void sensorSetState(uint16 src_id, uint8 interval)
+{
+    if(sensor.repeat_interval != interval)
+    {
+        sensor.repeat_interval = interval;
+        if(reporting())
+        {
+            figures.nvm_writes++;
+        }
+    }
+    sensorRestartRepeat();
+    sensorWrite();
+
+#if defined(ENABLE_PREDICTIVE_CONTROL) && defined(ENABLE_SENSOR_SUBSCRIPTION)
+    if(src_id == PEER_HEATER_ID)
+    {
+        CSRMESH_SENSOR_SET_STATE_T set_state;
+        CSRMESH_EVENT_DATA_T data;
+        void *p_response = NULL;
+
+        set_state.type = sensor_type_internal_air_temperature;
+        set_state.repeatinterval = interval;
+        set_state.tid = 0;
+
+        data.nw_id = 0;
+        data.seq_num = 0;
+        data.src_id = src_id;
+        data.dst_id = SENSOR_GROUP;
+        data.data = &set_state;
+
+        AppSensorEventHandler(CSRMESH_SENSOR_SET_STATE, &data,
+                              sizeof(set_state), &p_response);
+        CHECK(p_response == NULL);
+    }
+#endif /* ENABLE_PREDICTIVE_CONTROL && ENABLE_SENSOR_SUBSCRIPTION */
+}
+
+/* The second heater subscribes when it needs to and when it hears a longer
+ * interval than it needs
+ */
+static void peerSubscribe(void)
+{
+    peer_subscribe_time = room.time;
+    sensorSetState(PEER_HEATER_ID, PEER_INTERVAL);
+}
+
+/* Records the messages of the heater and passes its subscriptions on */
+static void recordMsg(host_heater_msg msg, uint16 dest_id,
+                      const void *p_params)
+{
+    if(reporting())
+    {
+        figures.heater_msgs++;
+    }
+
+    if(msg == host_heater_sensor_set_state)
+    {
+        const CSRMESH_SENSOR_SET_STATE_T *p_state = p_params;
+        uint32 now = room.time;
+
+        CHECK_EQUAL(SENSOR_GROUP, dest_id);
+
+        /* The sends of one subscription come close together, and
+         * subscriptions no closer than the rate limit
+         */
+        if(last_subscription == 0 ||
+           now - last_subscription > SUBSCRIPTION_BURST_TIME)
+        {
+#ifdef ENABLE_PREDICTIVE_CONTROL
+            if(last_subscription != 0)
+            {
+                CHECK(now - last_subscription >=
+                      SUBSCRIPTION_MIN_CHANGE_TIME);
+            }
+#endif /* ENABLE_PREDICTIVE_CONTROL */
+            if(reporting())
+            {
+                figures.subscriptions++;
+            }
+        }
+        last_subscription = now;
+
+        /* A longer interval than the second heater needs is only asked for
+         * once its subscription is no longer kept to
+         */
+        if(peer_present && p_state->repeatinterval > PEER_INTERVAL)
+        {
+#if defined(ENABLE_PREDICTIVE_CONTROL) && defined(ENABLE_SENSOR_SUBSCRIPTION)
+            CHECK(now - peer_subscribe_time >=
+                  SHARED_SUBSCRIPTION_TIME / SECOND);
+#endif /* ENABLE_PREDICTIVE_CONTROL && ENABLE_SENSOR_SUBSCRIPTION */
+            sensorSetState(0, p_state->repeatinterval & 0xFF);
+            peerSubscribe();
+        }
+        else
+        {
+            sensorSetState(0, p_state->repeatinterval & 0xFF);
+        }
+    }
+}
+
+/* Moves the room and the sensor on by one step */
+static void modelStep(void)
+{
+    uint32 now = room.time;
+    double target = HostHeaterStats()->heater_on ? HEATER_POWER : 0.0;
+    double desired = (double)desiredTemperature(now) / 32;
+    double error;
+
+    room.element += (target - room.element) / HEATER_TIME_CONSTANT;
+    room.room += (outsideTemperature(now) - room.room) / ROOM_TIME_CONSTANT +
+                 room.element;
+
+    if(reporting())
+    {
+        error = fabs(room.room - desired);
+        figures.error_sum += error;
+        if(error > figures.error_max)
+        {
+            figures.error_max = error;
+        }
+        if(room.room < desired - 0.5)
+        {
+            figures.cold_time++;
+        }
+        if(HostHeaterStats()->heater_on)
+        {
+            figures.heat_time++;
+        }
+    }
+
+    /* The desired temperature is set on the sensor */
+    if(desiredTemperature(now) != sensor.desired)
+    {
+        sensor.desired = desiredTemperature(now);
+        sensorWrite();
+    }
+
+    if(now >= sensor.next_sample)
+    {
+        sensor.next_sample += SENSOR_SAMPLE_INTERVAL;
+        if(labs((long)lround(room.room * 32) - (long)sensor.last_bcast) >=
+                                                            SENSOR_TOLERANCE)
+        {
+            sensorWrite();
+        }
+    }
+
+    if(sensor.repeat_interval != 0 && now >= sensor.next_repeat)
+    {
+        sensorRestartRepeat();
+        sensorWrite();
+    }
+}
+
+static void runSimulation(const char *name, bool shared)
+{
+    double report_time = (double)(RUN_TIME - REPORT_TIME);
+
+    HostReset();
+    HostHeaterReset(recordMsg);
+    memset(&figures, 0, sizeof(figures));
+    memset(&sensor, 0, sizeof(sensor));
+    peer_present = shared;
+    peer_subscribe_time = 0;
+    last_subscription = 0;
+
+    room.room = DESIRED_NIGHT;
+    room.element = 0;
+    room.time = 0;
+    sensor.desired = desiredTemperature(0);
+    sensor.last_bcast = (uint16)lround(room.room * 32);
+
+    /* Run the heater as on a device that has just been grouped */
+    sensor_model_groups[0] = SENSOR_GROUP;
+    current_air_temp = 0;
+    current_desired_air_temp = 0;
+    InitialiseSensorData();
+    InitialiseHeater();
+
+    if(shared)
+    {
+        peerSubscribe();
+    }
+
+    while(room.time < RUN_TIME)
+    {
+        HostRunFor(SECOND);
+        room.time++;
+        modelStep();
+    }
+
+    printf("%-10s %9.1f %9.1f %9.1f %9.1f %7.0f %7.0f %8.1f %7.1f\n", name,
+           figures.updates / (double)REPORT_HOURS,
+           figures.heater_msgs / (double)REPORT_HOURS,
+           figures.subscriptions / (double)REPORT_HOURS,
+           figures.nvm_writes / (double)REPORT_HOURS,
+           figures.error_sum * 1000 / report_time,
+           figures.error_max * 1000,
+           figures.cold_time * 100 / report_time,
+           figures.heat_time * 100 / report_time);
+
+    /* The room is kept within a third of a kelvin of the desired
+     * temperature on average, and the sensor keeps writing its value
+     */
+    CHECK(figures.error_sum / report_time < 1.0 / 3);
+    CHECK(figures.updates > 0);
+
+#if defined(ENABLE_PREDICTIVE_CONTROL) && defined(ENABLE_SENSOR_SUBSCRIPTION)
+    /* Alone on the sensor, the heater takes fewer updates and subscriptions
+     * than the sensor writes at SUBSCRIPTION_REPEAT_INTERVAL
+     */
+    if(!shared)
+    {
+        CHECK(figures.updates + figures.subscriptions <
+              REPORT_HOURS * HOUR / SUBSCRIPTION_REPEAT_INTERVAL);
+    }
+#endif /* ENABLE_PREDICTIVE_CONTROL && ENABLE_SENSOR_SUBSCRIPTION */
+}
+
+/*============================================================================*
+ *  Benchmark
+ *============================================================================*/
+int main(void)
+{
+    printf("%-10s %9s %9s %9s %9s %7s %7s %8s %7s\n", "run", "updates/h",
+           "heater/h", "subs/h", "nvm/h", "err(mK)", "max(mK)", "cold(%)",
+           "on(%)");
+
+#ifdef HOST_FIXED_INTERVAL
+    runSimulation("fixed", FALSE);
+#else
+    runSimulation("predictive", FALSE);
+    runSimulation("shared", TRUE);
+#endif /* HOST_FIXED_INTERVAL */
+
+#ifdef HOST_FIXED_INTERVAL
+    return HostTestResult("bench_fixed_interval");
+#else
+    return HostTestResult("bench_predictive_control");
+#endif /* HOST_FIXED_INTERVAL */
+}
@@ -0,0 +1,355 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      bench_sensor_ack.c
+ *
+ *  DESCRIPTION
+ *      Host simulation of the Heater acknowledging temperature updates in
+ *      ack mode with ENABLE_AGGREGATED_ACK, using the mesh event handler as
+ *      built for the device. 1, 5 and 20 sensors on one or two sensor
+ *      groups each write a new temperature to the heater, either all within
+ *      a second or one every ten seconds, and the heater runs until it has
+ *      sent all its acknowledgements.
+ *
+ *      For each run the simulation reports the acknowledgement messages the
+ *      heater sent and the airtime per temperature update. It compares them
+ *      with acknowledging each sensor with its own sensor value message,
+ *      which is one message for each entry acknowledged: the acknowledgement
+ *      table empties in the same way whichever way the entries are sent.
+ *
+ *      Airtime counts each message once on the three advertising channels
+ *      at 1 Mbps. The bearer repeats and the relays multiply every message
+ *      alike and are left out. The total per update is the sensor's write,
+ *      the response of the heater to it and the acknowledgements. The sensor
+ *      repeats its write until it is acknowledged either way, so those
+ *      repeats are the same for both and are left out as well.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "host_sdk.h"
+#include "host_heater.h"
+
+/* The event handler is included to reach its state */
+#include "app_mesh_event_handler.c"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Most sensors in a run */
+#define MAX_SENSORS                     (20)
+
+/* Time a run is given to end */
+#define RUN_TIME_LIMIT                  (10 * MINUTE)
+
+/* First sensor device id and the first sensor group */
+#define SENSOR_ID_BASE                  (0x8001)
+#define SENSOR_GROUP_BASE               (0x0001)
+
+/* Temperatures written by the sensors, in 1/32 kelvin */
+#define AIR_TEMP_BASE                   (293 * 32)
+#define DESIRED_TEMP                    (294 * 32)
+
+/* Octets of an advertising packet before and after its data: preamble,
+ * access address, header, advertiser address and CRC
+ */
+#define ADV_OVERHEAD_OCTETS             (16)
+
+/* Octets of a mesh message around the model message: AD length, type and
+ * UUID, sequence number, source, destination, MIC and TTL
+ */
+#define MESH_OVERHEAD_OCTETS            (16)
+
+/* Model message lengths: opcode followed by the parameters */
+#define SENSOR_WRITE_VALUE_OCTETS       (10)
+#define SENSOR_VALUE_OCTETS             (10)
+#define SENSOR_SET_STATE_OCTETS         (5)
+#define SENSOR_READ_VALUE_OCTETS        (6)
+
+/* Time on air of an octet at 1 Mbps and the channels each message is sent
+ * on
+ */
+#define OCTET_TIME                      (8)
+#define ADV_CHANNELS                    (3)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    const char *name;
+    uint32 interval;            /* Time between the writes of the sensors */
+}PATTERN_T;
+
+typedef struct
+{
+    uint32 acks;                /* Acknowledgement messages sent */
+    uint32 ack_airtime;
+    uint32 entries;             /* Sensor entries acknowledged */
+    uint32 other;               /* Other messages of the heater */
+    uint32 other_airtime;
+    uint16 acked[MAX_SENSORS];  /* Acknowledgements heard by each sensor */
+}RUN_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+static const PATTERN_T patterns[] =
+{
+    { "burst",      100 * MILLISECOND },
+    { "spread",     10 * SECOND }
+};
+
+static const uint16 sensor_counts[] = { 1, 5, 20 };
+static const uint16 group_counts[] = { 1, 2 };
+
+/* Transaction id of the last write of each sensor */
+static uint8 sensor_tid[MAX_SENSORS];
+static uint16 num_sensors;
+
+static RUN_T run;
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/* Time on air of a mesh message carrying a model message */
+static uint32 airtime(uint16 model_octets)
+{
+    return (uint32)(ADV_OVERHEAD_OCTETS + MESH_OVERHEAD_OCTETS +
+                    model_octets) * OCTET_TIME * ADV_CHANNELS;
+}
+
+static uint16 sensorValueOctets(const CSRMESH_SENSOR_VALUE_T *p_value)
+{
+    return 1 + 2 + p_value->value_len + 2 + p_value->value2_len + 1;
+}
+
+/* Index of a sensor, or MAX_SENSORS if it is not one */
+static uint16 sensorIndex(uint16 dev_id)
+{
+    uint16 index = dev_id - SENSOR_ID_BASE;
+
+    return (dev_id >= SENSOR_ID_BASE && index < num_sensors) ? index :
+                                                               MAX_SENSORS;
+}
+
+/* Records an acknowledgement of a sensor, which must carry its last tid */
+static void recordAck(uint16 dev_id, uint8 tid)
+{
+    uint16 index = sensorIndex(dev_id);
+
+    CHECK(index < MAX_SENSORS);
+    if(index < MAX_SENSORS)
+    {
+        CHECK_EQUAL(sensor_tid[index], tid);
+        run.acked[index]++;
+    }
+}
+
+/* Records the messages sent by the heater */
+static void recordMsg(host_heater_msg msg, uint16 dest_id,
+                      const void *p_params)
+{
+    switch(msg)
+    {
+        case host_heater_sensor_value:
+        {
+            const CSRMESH_SENSOR_VALUE_T *p_value = p_params;
+
+            run.acks++;
+            run.entries++;
+            run.ack_airtime += airtime(sensorValueOctets(p_value));
+            recordAck(dest_id, p_value->tid);
+        }
+        break;
+
+        case host_heater_data_block:
+        {
+            const CSRMESH_DATA_BLOCK_SEND_T *p_block = p_params;
+            uint16 offset;
+
+            CHECK_EQUAL(USER_SENSOR_ACK_LIST, p_block->datagramoctets[0]);
+            CHECK_EQUAL(0, (p_block->datagramoctets_len - 1) %
+                                                    AGGREGATED_ACK_ENTRY_LEN);
+
+            run.acks++;
+            run.ack_airtime += airtime(1 + p_block->datagramoctets_len);
+
+            /* The same block goes to every group, a sensor hears it on its
+             * own group
+             */
+            if(dest_id != SENSOR_GROUP_BASE)
+            {
+                break;
+            }
+
+            for(offset = 1; offset < p_block->datagramoctets_len;
+                offset += AGGREGATED_ACK_ENTRY_LEN)
+            {
+                const uint8 *p_entry = &p_block->datagramoctets[offset];
+
+                run.entries++;
+                recordAck(p_entry[0] | (p_entry[1] << 8), p_entry[2]);
+            }
+        }
+        break;
+
+        case host_heater_sensor_set_state:
+            run.other++;
+            run.other_airtime += airtime(SENSOR_SET_STATE_OCTETS);
+        break;
+
+        case host_heater_sensor_read_value:
+            run.other++;
+            run.other_airtime += airtime(SENSOR_READ_VALUE_OCTETS);
+        break;
+    }
+}
+
+/* Writes a new temperature from a sensor to the heater as the CSRmesh
+ * library passes it, and returns the airtime of the write and the response
+ */
+static uint32 writeTemperature(uint16 sensor)
+{
+    CSRMESH_SENSOR_WRITE_VALUE_T write;
+    CSRMESH_EVENT_DATA_T data;
+    void *p_response = NULL;
+    uint8 *p_value;
+    uint32 air = airtime(SENSOR_WRITE_VALUE_OCTETS);
+
+    sensor_tid[sensor] = (sensor_tid[sensor] + 1) & 0xFF;
+
+    memset(&write, 0, sizeof(write));
+    write.type = sensor_type_internal_air_temperature;
+    p_value = write.value;
+    BufWriteUint16(&p_value, AIR_TEMP_BASE + sensor + 1);
+    write.value_len = 2;
+    write.type2 = sensor_type_desired_air_temperature;
+    p_value = write.value2;
+    BufWriteUint16(&p_value, DESIRED_TEMP);
+    write.value2_len = 2;
+    write.tid = sensor_tid[sensor];
+
+    data.nw_id = 0;
+    data.seq_num = 0;
+    data.src_id = SENSOR_ID_BASE + sensor;
+    data.dst_id = SENSOR_GROUP_BASE;
+    data.data = &write;
+
+    AppSensorEventHandler(CSRMESH_SENSOR_WRITE_VALUE, &data, sizeof(write),
+                          &p_response);
+
+    /* The library sends the response the handler returns */
+    CHECK(p_response != NULL);
+    if(p_response != NULL)
+    {
+        air += airtime(sensorValueOctets(p_response));
+    }
+
+    return air;
+}
+
+/* Runs one temperature update from each sensor and prints the figures */
+static void runSimulation(const PATTERN_T *p_pattern, uint16 sensors,
+                          uint16 groups)
+{
+    uint32 write_airtime = 0;
+    uint32 per_device_airtime;
+    uint32 total;
+    uint16 index;
+
+    HostReset();
+    HostHeaterReset(recordMsg);
+    memset(&run, 0, sizeof(run));
+    memset(sensor_tid, 0, sizeof(sensor_tid));
+    num_sensors = sensors;
+
+    for(index = 0; index < groups; index++)
+    {
+        sensor_model_groups[index] = SENSOR_GROUP_BASE + index;
+    }
+
+    current_air_temp = 0;
+    current_desired_air_temp = 0;
+    InitialiseSensorData();
+
+    for(index = 0; index < sensors; index++)
+    {
+        write_airtime += writeTemperature(index);
+        HostRunFor(p_pattern->interval);
+    }
+
+    while(retransmit_tid != TIMER_INVALID && TimeGet32() < RUN_TIME_LIMIT)
+    {
+        HostRunFor(SECOND);
+    }
+    CHECK(retransmit_tid == TIMER_INVALID);
+
+    /* Each entry would otherwise take a sensor value message */
+    per_device_airtime = run.entries * airtime(SENSOR_VALUE_OCTETS);
+    total = write_airtime + run.ack_airtime + run.other_airtime;
+
+    printf("%-8s %7u %6u %8lu %9lu %9lu %10lu %10lu\n",
+           p_pattern->name, sensors, groups,
+           (unsigned long)run.entries,
+           (unsigned long)run.acks,
+           (unsigned long)(per_device_airtime / sensors),
+           (unsigned long)(run.ack_airtime / sensors),
+           (unsigned long)(total / sensors));
+
+    /* Every sensor hears its acknowledgement, and never in more messages
+     * than acknowledging each entry takes
+     */
+    for(index = 0; index < sensors; index++)
+    {
+        CHECK(run.acked[index] > 0);
+    }
+    CHECK(run.acks <= run.entries);
+    CHECK(run.ack_airtime <= per_device_airtime);
+
+    /* Several sensors heard together on one group share the messages */
+    if(p_pattern->interval < RETRANSMIT_INTERVAL && sensors > 1 &&
+       groups == 1)
+    {
+        CHECK(run.acks < run.entries);
+    }
+}
+
+/*============================================================================*
+ *  Benchmark
+ *============================================================================*/
+int main(void)
+{
+    uint16 pattern;
+    uint16 sensors;
+    uint16 groups;
+
+    printf("%-8s %7s %6s %8s %9s %9s %10s %10s\n", "pattern", "sensors",
+           "groups", "entries", "ack msgs", "unicast", "aggregated",
+           "total");
+    printf("%-8s %7s %6s %8s %9s %9s %10s %10s\n", "", "", "", "", "",
+           "us/update", "us/update", "us/update");
+
+    for(pattern = 0; pattern < sizeof(patterns) / sizeof(patterns[0]);
+        pattern++)
+    {
+        for(sensors = 0;
+            sensors < sizeof(sensor_counts) / sizeof(sensor_counts[0]);
+            sensors++)
+        {
+            for(groups = 0;
+                groups < sizeof(group_counts) / sizeof(group_counts[0]);
+                groups++)
+            {
+                runSimulation(&patterns[pattern], sensor_counts[sensors],
+                              group_counts[groups]);
+            }
+        }
+    }
+
+    return HostTestResult("bench_sensor_ack");
+}
@@ -0,0 +1,38 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_gatt_db.h
+ *
+ *  DESCRIPTION
+ *      Host build of the Bridge GATT database handles. On the device this
+ *      header is generated from app_gatt_db.db, the handles here follow the
+ *      order of the attributes in mesh_control_service_db.db.
+ *
+ *****************************************************************************/
+
+#ifndef __APP_GATT_DB_H__
+#define __APP_GATT_DB_H__
+
+#define HANDLE_MESH_CONTROL_SERVICE             (0x0016)
+#define HANDLE_MESH_CONTROL_SERVICE_END         (0xffff)
+#define HANDLE_NETWORK_KEY                      (0x0018)
+#define HANDLE_DEVICE_UUID                      (0x001a)
+#define HANDLE_DEVICE_ID                        (0x001c)
+#define HANDLE_MTL_CONTINUATION_CP              (0x001e)
+#define HANDLE_MTL_CP_CLIENT_CONFIG             (0x001f)
+#define HANDLE_MTL_COMPLETE_CP                  (0x0021)
+#define HANDLE_MTL_CP2_CLIENT_CONFIG            (0x0022)
+#define HANDLE_MTL_TTL                          (0x0024)
+#define HANDLE_MESH_APPEARANCE                  (0x0026)
+#define HANDLE_MTL_BATCH_CP                     (0x0028)
+#define HANDLE_MTL_BATCH_CLIENT_CONFIG          (0x0029)
+#define HANDLE_MTL_RX_STATUS                    (0x002b)
+#define HANDLE_MTL_RX_STATUS_CLIENT_CONFIG      (0x002c)
+#define HANDLE_NEIGHBOUR_TABLE                  (0x002e)
+#define HANDLE_USER_ADV_REPORT                  (0x0030)
+#define HANDLE_USER_ADV_REPORT_CLIENT_CONFIG    (0x0031)
+
+#endif /* __APP_GATT_DB_H__ */
@@ -0,0 +1,19 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      app_gatt_db.h
+ *
+ *  DESCRIPTION
+ *      Host build of the Heater GATT database handles. On the device this
+ *      header is generated from app_gatt_db.db. The mesh event handler uses
+ *      none of the handles, so none are defined.
+ *
+ *****************************************************************************/
+
+#ifndef __APP_GATT_DB_H__
+#define __APP_GATT_DB_H__
+
+#endif /* __APP_GATT_DB_H__ */
@@ -0,0 +1,186 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      host_heater.c
+ *
+ *  DESCRIPTION
+ *      This file implements the application and CSRmesh functions the
+ *      Heater mesh event handler, app_mesh_event_handler.c as built for the
+ *      device, calls on the host. The messages the heater sends on the mesh
+ *      are passed to the callback of the test, the LED colour is taken as
+ *      the heating state, and the NVM and the bearer do nothing.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include <mem.h>
+
+#include "host_heater.h"
+#include "csr_mesh_heater.h"
+#include "csr_mesh_heater_util.h"
+#include "battery_hw.h"
+#include "iot_hw.h"
+#include "nvm_access.h"
+#include "sensor_client.h"
+#include "data_client.h"
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+static HOST_HEATER_MSG_CB_T host_msg_cb;
+static HOST_HEATER_STATS_T stats;
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+static CSRmeshResult sendMsg(host_heater_msg msg, uint16 dest_id,
+                             const void *p_params)
+{
+    stats.msgs++;
+
+    if(host_msg_cb != NULL)
+    {
+        host_msg_cb(msg, dest_id, p_params);
+    }
+
+    return CSR_MESH_RESULT_SUCCESS;
+}
+
+/*============================================================================*
+ *  Application Data and Function Implementations
+ *============================================================================*/
+CSRMESH_HEATER_APP_DATA_T g_heater_app_data;
+uint16 sensor_model_groups[NUM_SENSOR_MODEL_GROUPS];
+uint16 attention_model_groups[NUM_ATT_MODEL_GROUPS];
+uint16 data_model_groups[NUM_DATA_MODEL_GROUPS];
+CSR_MESH_DEVICE_APPEARANCE_T appearance;
+
+void AppUpdateBearerState(CSR_MESH_TRANSMIT_STATE_T *p_bearer_state)
+{
+}
+
+void GattTriggerConnectableAdverts(void)
+{
+}
+
+void InitiateAssociation(void)
+{
+}
+
+bool HandleGroupSetMsg(CSR_MESH_GROUP_ID_RELATED_DATA_T msg)
+{
+    return FALSE;
+}
+
+void SetScanDutyCycle(uint8 scan_duty_cycle)
+{
+}
+
+uint8 ReadBatteryLevel(void)
+{
+    return 100;
+}
+
+uint8 GetBatteryState(void)
+{
+    return 0;
+}
+
+void IOTLightControlDeviceSetColor(uint8 red, uint8 green, uint8 blue)
+{
+    stats.heater_on = (red != 0);
+}
+
+void IOTLightControlDevicePower(bool power_on)
+{
+    stats.heater_on = power_on;
+}
+
+void IOTLightControlDeviceBlink(uint8 red, uint8 green, uint8 blue,
+                                uint8 on_time, uint8 off_time)
+{
+}
+
+bool Nvm_Read(uint16* buffer, uint16 length, uint16 offset)
+{
+    MemSet(buffer, 0, length);
+    return TRUE;
+}
+
+bool Nvm_Write(uint16* buffer, uint16 length, uint16 offset)
+{
+    stats.nvm_writes++;
+    return TRUE;
+}
+
+/*============================================================================*
+ *  CSRmesh Library Function Implementations
+ *============================================================================*/
+CSRmeshResult SensorValue(CsrUint8 nw_id, CsrUint16 dest_id,
+                          CSRMESH_SENSOR_VALUE_T *p_params)
+{
+    return sendMsg(host_heater_sensor_value, dest_id, p_params);
+}
+
+CSRmeshResult SensorSetState(CsrUint8 nw_id, CsrUint16 dest_id,
+                             CSRMESH_SENSOR_SET_STATE_T *p_params)
+{
+    return sendMsg(host_heater_sensor_set_state, dest_id, p_params);
+}
+
+CSRmeshResult SensorReadValue(CsrUint8 nw_id, CsrUint16 dest_id,
+                              CSRMESH_SENSOR_READ_VALUE_T *p_params)
+{
+    return sendMsg(host_heater_sensor_read_value, dest_id, p_params);
+}
+
+CSRmeshResult DataBlockSend(CsrUint8 nw_id, CsrUint16 dest_id,
+                            CSRMESH_DATA_BLOCK_SEND_T *p_params)
+{
+    return sendMsg(host_heater_data_block, dest_id, p_params);
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      HostHeaterReset
+ *
+ *  DESCRIPTION
+ *      This function removes the heater from all the groups, clears the
+ *      counters and sets the callback for the messages it sends.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+void HostHeaterReset(HOST_HEATER_MSG_CB_T msg_cb)
+{
+    host_msg_cb = msg_cb;
+    memset(&stats, 0, sizeof(stats));
+    memset(&g_heater_app_data, 0, sizeof(g_heater_app_data));
+    memset(sensor_model_groups, 0, sizeof(sensor_model_groups));
+    memset(attention_model_groups, 0, sizeof(attention_model_groups));
+    memset(data_model_groups, 0, sizeof(data_model_groups));
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      HostHeaterStats
+ *
+ *  DESCRIPTION
+ *      This function returns the heater activity since the last reset.
+ *
+ *  RETURNS
+ *      Pointer to the counters.
+ *
+ *---------------------------------------------------------------------------*/
+const HOST_HEATER_STATS_T *HostHeaterStats(void)
+{
+    return &stats;
+}
@@ -0,0 +1,52 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      host_heater.h
+ *
+ *  DESCRIPTION
+ *      Host implementation of the application and CSRmesh functions the
+ *      Heater mesh event handler calls. See host_heater.c.
+ *
+ *****************************************************************************/
+
+#ifndef __HOST_HEATER_H__
+#define __HOST_HEATER_H__
+
+#include <types.h>
+
+/*============================================================================*
+ *  Public Data Types
+ *============================================================================*/
+/* Messages the heater sends on the mesh */
+typedef enum
+{
+    host_heater_sensor_value,       /* CSRMESH_SENSOR_VALUE_T */
+    host_heater_data_block,         /* CSRMESH_DATA_BLOCK_SEND_T */
+    host_heater_sensor_set_state,   /* CSRMESH_SENSOR_SET_STATE_T */
+    host_heater_sensor_read_value   /* CSRMESH_SENSOR_READ_VALUE_T */
+}host_heater_msg;
+
+/* Called for each message the heater sends, with its parameters */
+typedef void (*HOST_HEATER_MSG_CB_T)(host_heater_msg msg, uint16 dest_id,
+                                     const void *p_params);
+
+typedef struct
+{
+    uint32 msgs;                /* Messages sent on the mesh */
+    uint32 nvm_writes;          /* Nvm_Write calls */
+    bool   heater_on;           /* Last power state set */
+}HOST_HEATER_STATS_T;
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Clears the groups and the counters and sets the message callback */
+extern void HostHeaterReset(HOST_HEATER_MSG_CB_T msg_cb);
+
+/* Returns the heater activity since the last reset */
+extern const HOST_HEATER_STATS_T *HostHeaterStats(void);
+
+#endif /* __HOST_HEATER_H__ */
@@ -0,0 +1,262 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      host_i2c.c
+ *
+ *  DESCRIPTION
+ *      This file implements the SDK raw I2C functions on the host against a
+ *      scripted target. The target is a register file at one address: the
+ *      first byte written after its WRITE address sets the register pointer,
+ *      further bytes are written to the registers and bytes read after its
+ *      READ address come from them, the pointer advancing each time. The
+ *      test can make any raw operation fail to check the error handling.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include <i2c.h>
+#include <pio.h>
+
+#include "host_i2c.h"
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef enum
+{
+    i2c_target_idle,            /* Not addressed */
+    i2c_target_write,           /* Addressed with its WRITE address */
+    i2c_target_read             /* Addressed with its READ address */
+}i2c_target_state;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+static uint8 target_regs[HOST_I2C_NUM_REGS];
+static uint8 target_address;
+static bool target_attached;
+static i2c_target_state target_state;
+
+/* Register the next byte is read from or written to */
+static uint8 target_pointer;
+
+/* Set until the register pointer has been written after the WRITE address */
+static bool pointer_pending;
+
+/* Bus state */
+static bool bus_started;
+static bool address_pending;
+static bool last_acked;
+
+/* Raw operations run since the script was set and the one which fails */
+static uint16 operations;
+static uint16 fail_operation;
+
+static HOST_I2C_STATS_T i2c_stats;
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/* Counts a raw operation and checks whether the script makes it fail */
+static bool failOperation(void)
+{
+    operations++;
+
+    return (fail_operation != 0 && operations == fail_operation);
+}
+
+/*============================================================================*
+ *  SDK Function Implementations
+ *============================================================================*/
+void I2cInit(uint8 sda_pio, uint8 scl_pio, uint8 power_pio,
+             pio_i2c_pull_mode pull_mode)
+{
+}
+
+void I2cConfigClock(uint16 high_period, uint16 low_period)
+{
+}
+
+void I2cEnable(bool enable)
+{
+    i2c_stats.enabled = enable;
+}
+
+void PioSetI2CPullMode(pio_i2c_pull_mode pull_mode)
+{
+}
+
+sys_status I2cRawStart(bool wait)
+{
+    if(failOperation() || !i2c_stats.enabled)
+    {
+        return sys_status_failed;
+    }
+
+    bus_started = TRUE;
+    address_pending = TRUE;
+    target_state = i2c_target_idle;
+
+    return sys_status_success;
+}
+
+sys_status I2cRawRestart(bool wait)
+{
+    if(failOperation() || !bus_started)
+    {
+        return sys_status_failed;
+    }
+
+    address_pending = TRUE;
+    target_state = i2c_target_idle;
+
+    return sys_status_success;
+}
+
+sys_status I2cRawStop(bool wait)
+{
+    if(failOperation() || !bus_started)
+    {
+        return sys_status_failed;
+    }
+
+    bus_started = FALSE;
+    target_state = i2c_target_idle;
+
+    return sys_status_success;
+}
+
+sys_status I2cRawWriteByte(uint8 data)
+{
+    if(failOperation() || !bus_started)
+    {
+        return sys_status_failed;
+    }
+
+    last_acked = FALSE;
+
+    if(address_pending)
+    {
+        address_pending = FALSE;
+
+        if(target_attached && (data & 0xFE) == target_address)
+        {
+            target_state = (data & 0x01) ? i2c_target_read : i2c_target_write;
+            pointer_pending = (target_state == i2c_target_write);
+            last_acked = TRUE;
+        }
+    }
+    else if(target_state == i2c_target_write)
+    {
+        if(pointer_pending)
+        {
+            target_pointer = data;
+            pointer_pending = FALSE;
+        }
+        else
+        {
+            target_regs[target_pointer++] = data;
+            i2c_stats.writes++;
+        }
+        last_acked = TRUE;
+    }
+
+    return sys_status_success;
+}
+
+sys_status I2cRawWaitAck(bool wait)
+{
+    if(failOperation() || !last_acked)
+    {
+        return sys_status_failed;
+    }
+
+    return sys_status_success;
+}
+
+sys_status I2cRawReadByte(uint8 *p_data)
+{
+    if(failOperation() || target_state != i2c_target_read)
+    {
+        return sys_status_failed;
+    }
+
+    *p_data = target_regs[target_pointer++];
+    i2c_stats.reads++;
+
+    return sys_status_success;
+}
+
+sys_status I2cRawSendAck(bool wait)
+{
+    return (failOperation() || !bus_started) ? sys_status_failed :
+                                               sys_status_success;
+}
+
+sys_status I2cRawSendNack(bool wait)
+{
+    return (failOperation() || !bus_started) ? sys_status_failed :
+                                               sys_status_success;
+}
+
+sys_status I2cRawComplete(uint32 timeout)
+{
+    i2c_stats.transactions++;
+    i2c_stats.wait_time += timeout;
+
+    return sys_status_success;
+}
+
+void I2cRawTerminate(void)
+{
+    bus_started = FALSE;
+    address_pending = FALSE;
+    target_state = i2c_target_idle;
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+void HostI2cReset(void)
+{
+    memset(target_regs, 0, sizeof(target_regs));
+    memset(&i2c_stats, 0, sizeof(i2c_stats));
+    target_attached = FALSE;
+    target_state = i2c_target_idle;
+    target_pointer = 0;
+    bus_started = FALSE;
+    address_pending = FALSE;
+    operations = 0;
+    fail_operation = 0;
+}
+
+void HostI2cAttach(uint8 base_address)
+{
+    target_address = base_address & 0xFE;
+    target_attached = TRUE;
+}
+
+void HostI2cSetRegister(uint8 reg, uint8 value)
+{
+    target_regs[reg] = value;
+}
+
+uint8 HostI2cGetRegister(uint8 reg)
+{
+    return target_regs[reg];
+}
+
+void HostI2cFailOperation(uint16 operation)
+{
+    operations = 0;
+    fail_operation = operation;
+}
+
+const HOST_I2C_STATS_T *HostI2cStats(void)
+{
+    return &i2c_stats;
+}
@@ -0,0 +1,59 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      host_i2c.h
+ *
+ *  DESCRIPTION
+ *      Control of the scripted I2C target used by the host tests
+ *
+ *****************************************************************************/
+
+#ifndef __HOST_I2C_H__
+#define __HOST_I2C_H__
+
+#include <types.h>
+
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Registers of the target */
+#define HOST_I2C_NUM_REGS               (256)
+
+/*============================================================================*
+ *  Public Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint16 transactions;    /* I2cRawComplete calls, one per transaction */
+    uint16 reads;           /* Register values read from the target */
+    uint16 writes;          /* Register values written to the target */
+    uint32 wait_time;       /* Time waited in I2cRawComplete, taken as the
+                             * timeout of each call as the device blocks
+                             * for up to that long
+                             */
+    bool   enabled;         /* I2C controller enabled */
+}HOST_I2C_STATS_T;
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Removes the target from the bus and clears its registers and the script */
+extern void HostI2cReset(void);
+
+/* Puts a target at the WRITE address given on the bus */
+extern void HostI2cAttach(uint8 base_address);
+
+/* Sets and gets a register of the target */
+extern void HostI2cSetRegister(uint8 reg, uint8 value);
+extern uint8 HostI2cGetRegister(uint8 reg);
+
+/* Makes the raw operation at the given position, counted from now, fail */
+extern void HostI2cFailOperation(uint16 operation);
+
+/* Returns the bus activity since the last reset */
+extern const HOST_I2C_STATS_T *HostI2cStats(void);
+
+#endif /* __HOST_I2C_H__ */
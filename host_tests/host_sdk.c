@@ -0,0 +1,323 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      host_sdk.c
+ *
+ *  DESCRIPTION
+ *      This file implements the SDK functions used by the application
+ *      modules under test on the host. Time is a virtual clock that only
+ *      moves when the test calls HostRunFor, so timer driven behaviour is
+ *      repeatable and runs as fast as the host allows.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "host_sdk.h"
+#include <buf_utils.h>
+#include <mem.h>
+#include <time.h>
+#include <timer.h>
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Timers that can run at the same time */
+#define HOST_MAX_TIMERS                 (32)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    bool                used;
+    uint32              expiry;     /* Virtual time the timer expires at */
+    uint32              created;    /* Order of creation, for equal expiry */
+    timer_callback_arg  handler;
+}HOST_TIMER_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Virtual clock in microseconds */
+static uint32 host_time;
+
+static HOST_TIMER_T host_timers[HOST_MAX_TIMERS];
+
+/* Creation counter, so timers expiring together fire in creation order */
+static uint32 host_timer_serial;
+
+/* Checks made and failed by the test */
+static unsigned long host_checks;
+static unsigned long host_failures;
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      nextTimer
+ *
+ *  DESCRIPTION
+ *      Finds the running timer that expires first, at or before the end
+ *      time.
+ *
+ *  RETURNS
+ *      Index of the timer, or HOST_MAX_TIMERS if none expires by then.
+ *
+ *---------------------------------------------------------------------------*/
+static uint16 nextTimer(uint32 end)
+{
+    uint16 index;
+    uint16 next = HOST_MAX_TIMERS;
+
+    for(index = 0; index < HOST_MAX_TIMERS; index++)
+    {
+        HOST_TIMER_T *p_timer = &host_timers[index];
+
+        if(!p_timer->used || TimeSub(end, p_timer->expiry) < 0)
+        {
+            continue;
+        }
+
+        if(next == HOST_MAX_TIMERS ||
+           TimeSub(p_timer->expiry, host_timers[next].expiry) < 0 ||
+           (p_timer->expiry == host_timers[next].expiry &&
+            p_timer->created < host_timers[next].created))
+        {
+            next = index;
+        }
+    }
+
+    return next;
+}
+
+/*============================================================================*
+ *  SDK Function Implementations
+ *============================================================================*/
+void MemSet(void *p_dst, uint16 value, uint16 length)
+{
+    memset(p_dst, value, length);
+}
+
+void MemCopy(void *p_dst, const void *p_src, uint16 length)
+{
+    memmove(p_dst, p_src, length);
+}
+
+int16 MemCmp(const void *p_a, const void *p_b, uint16 length)
+{
+    return (int16)memcmp(p_a, p_b, length);
+}
+
+void MemCopyUnPack(void *p_dst, const uint16 *p_src, uint16 length)
+{
+    uint8 *p_octet = p_dst;
+    uint16 index;
+
+    for(index = 0; index < length; index++)
+    {
+        p_octet[index] = (index & 1) ? (uint8)(p_src[index >> 1] >> 8) :
+                                       (uint8)(p_src[index >> 1] & 0xFF);
+    }
+}
+
+uint8 BufReadUint8(uint8 **p_buf)
+{
+    return *(*p_buf)++;
+}
+
+uint16 BufReadUint16(uint8 **p_buf)
+{
+    uint16 value = (*p_buf)[0] | ((*p_buf)[1] << 8);
+
+    *p_buf += 2;
+    return value;
+}
+
+void BufWriteUint8(uint8 **p_buf, uint8 value)
+{
+    *(*p_buf)++ = value;
+}
+
+void BufWriteUint16(uint8 **p_buf, uint16 value)
+{
+    *(*p_buf)++ = value & 0xFF;
+    *(*p_buf)++ = value >> 8;
+}
+
+void DebugWriteChar(char value)
+{
+}
+
+void DebugWriteString(const char *string)
+{
+}
+
+uint32 TimeGet32(void)
+{
+    return host_time;
+}
+
+int32 TimeSub(uint32 t1, uint32 t2)
+{
+    return (int32)(t1 - t2);
+}
+
+timer_id TimerCreate(uint32 timeout, bool is_one_shot,
+                     timer_callback_arg handler)
+{
+    uint16 index;
+
+    (void)is_one_shot;
+
+    for(index = 0; index < HOST_MAX_TIMERS; index++)
+    {
+        if(!host_timers[index].used)
+        {
+            host_timers[index].used = TRUE;
+            host_timers[index].expiry = host_time + timeout;
+            host_timers[index].created = host_timer_serial++;
+            host_timers[index].handler = handler;
+            return index;
+        }
+    }
+
+    /* Out of timers, as the firmware would be */
+    return TIMER_INVALID;
+}
+
+bool TimerDelete(timer_id tid)
+{
+    if(tid < HOST_MAX_TIMERS && host_timers[tid].used)
+    {
+        host_timers[tid].used = FALSE;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      HostReset
+ *
+ *  DESCRIPTION
+ *      This function deletes all the timers and sets the clock back to zero.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+void HostReset(void)
+{
+    memset(host_timers, 0, sizeof(host_timers));
+    host_time = 0;
+    host_timer_serial = 0;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      HostRunFor
+ *
+ *  DESCRIPTION
+ *      This function advances the virtual clock by the duration given. Each
+ *      timer expiring in that time is called in turn with the clock set to
+ *      its expiry time, and may create further timers.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+void HostRunFor(uint32 duration)
+{
+    uint32 end = host_time + duration;
+    uint16 next;
+
+    while((next = nextTimer(end)) != HOST_MAX_TIMERS)
+    {
+        timer_callback_arg handler = host_timers[next].handler;
+
+        host_time = host_timers[next].expiry;
+        host_timers[next].used = FALSE;
+        handler(next);
+    }
+
+    host_time = end;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      HostTimersRunning
+ *
+ *  DESCRIPTION
+ *      This function counts the timers running.
+ *
+ *  RETURNS
+ *      Number of timers running.
+ *
+ *---------------------------------------------------------------------------*/
+uint16 HostTimersRunning(void)
+{
+    uint16 index;
+    uint16 running = 0;
+
+    for(index = 0; index < HOST_MAX_TIMERS; index++)
+    {
+        if(host_timers[index].used)
+        {
+            running++;
+        }
+    }
+
+    return running;
+}
+
+void HostCheck(bool ok, const char *file, int line, const char *text)
+{
+    host_checks++;
+
+    if(!ok)
+    {
+        host_failures++;
+        printf("%s:%d: CHECK(%s) failed\n", file, line, text);
+    }
+}
+
+void HostCheckEqual(long expected, long actual, const char *file, int line,
+                    const char *text)
+{
+    host_checks++;
+
+    if(expected != actual)
+    {
+        host_failures++;
+        printf("%s:%d: %s is %ld, expected %ld\n", file, line, text, actual,
+               expected);
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      HostTestResult
+ *
+ *  DESCRIPTION
+ *      This function prints the number of checks made and failed.
+ *
+ *  RETURNS
+ *      0 if all the checks passed, 1 otherwise.
+ *
+ *---------------------------------------------------------------------------*/
+int HostTestResult(const char *name)
+{
+    printf("%s: %lu checks, %lu failed\n", name, host_checks, host_failures);
+
+    return host_failures ? 1 : 0;
+}
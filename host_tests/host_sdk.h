@@ -0,0 +1,54 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      host_sdk.h
+ *
+ *  DESCRIPTION
+ *      Control of the host build of the SDK and the checks used by the host
+ *      tests
+ *
+ *****************************************************************************/
+
+#ifndef __HOST_SDK_H__
+#define __HOST_SDK_H__
+
+#include <stdio.h>
+
+#include <types.h>
+#include <timer.h>
+
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Records a failure if the condition does not hold */
+#define CHECK(cond) \
+    HostCheck((cond) ? TRUE : FALSE, __FILE__, __LINE__, #cond)
+
+/* Records a failure if the two integer values differ */
+#define CHECK_EQUAL(expected, actual) \
+    HostCheckEqual((long)(expected), (long)(actual), __FILE__, __LINE__, \
+                   #actual)
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Deletes all the timers and sets the virtual clock back to zero */
+extern void HostReset(void);
+
+/* Advances the virtual clock, calling the timers that expire on the way */
+extern void HostRunFor(uint32 duration);
+
+/* Number of timers running */
+extern uint16 HostTimersRunning(void);
+
+extern void HostCheck(bool ok, const char *file, int line, const char *text);
+extern void HostCheckEqual(long expected, long actual, const char *file,
+                           int line, const char *text);
+
+/* Prints the result of the test and returns the process exit code */
+extern int HostTestResult(const char *name);
+
+#endif /* __HOST_SDK_H__ */
@@ -0,0 +1,328 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      mtl_loopback.c
+ *
+ *  DESCRIPTION
+ *      In-process transport between the host MTL gateway library and the
+ *      Bridge mesh control service, mesh_control_service.c as built for the
+ *      device. The gateway's ATT writes and reads are passed to the service
+ *      as GATT_ACCESS_INDs, and the service's notifications are passed back
+ *      to the gateway.
+ *
+ *      The firmware and CSRmesh library functions the service calls are
+ *      implemented here. The scheduler is a queue drained at the rate the
+ *      mesh sends messages. Each message sent on the mesh is answered by the
+ *      given number of devices with a copy of the message, through the
+ *      notify callback the service registers on the CCCD write. The GATT
+ *      link itself takes no time.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include <gatt.h>
+#include <gatt_prim.h>
+#include <mem.h>
+#include <timer.h>
+
+#include "mtl_loopback.h"
+#include "app_gatt.h"
+#include "app_gatt_db.h"
+#include "app_neighbour.h"
+#include "csr_sched.h"
+#include "mesh_control_service.h"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Largest scheduler queue */
+#define MAX_SCHED_QUEUE                 (8)
+
+/* Largest attribute value passed over the link */
+#define MAX_VALUE_LEN                   (64)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint8  data[MESH_LONGEST_MSG_LEN];
+    uint16 length;
+}SCHED_MSG_T;
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+static int loopbackWrite(void *p_context, uint16_t handle,
+                         const uint8_t *p_value, uint16_t length);
+static int loopbackRead(void *p_context, uint16_t handle, uint8_t *p_value,
+                        uint16_t size, uint16_t *p_length);
+static void meshTxTimerHandler(timer_id tid);
+
+/*============================================================================*
+ *  Public Data
+ *============================================================================*/
+const MTL_GATEWAY_TRANSPORT_T loopback_transport =
+{
+    NULL, loopbackWrite, loopbackRead
+};
+
+const MTL_GATEWAY_HANDLES_T loopback_handles =
+{
+    HANDLE_MTL_CONTINUATION_CP,
+    HANDLE_MTL_CP_CLIENT_CONFIG,
+    HANDLE_MTL_COMPLETE_CP,
+    HANDLE_MTL_CP2_CLIENT_CONFIG,
+    HANDLE_MTL_BATCH_CP,
+    HANDLE_MTL_BATCH_CLIENT_CONFIG,
+    HANDLE_MTL_RX_STATUS,
+    HANDLE_MTL_RX_STATUS_CLIENT_CONFIG
+};
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+static MTL_GATEWAY_T *p_gateway;
+static LOOPBACK_MESH_T mesh;
+static LOOPBACK_STATS_T stats;
+
+/* Scheduler transmit queue */
+static SCHED_MSG_T sched_queue[MAX_SCHED_QUEUE];
+static uint16 sched_head;
+static uint16 sched_count;
+static timer_id mesh_tx_tid = TIMER_INVALID;
+
+/* Callback registered by the service for mesh responses */
+static CSR_SCHED_NOTIFY_GATT_CB_T notify_cb;
+static uint16 notify_ucid;
+
+/* Last GATT_ACCESS_RSP of the service */
+static sys_status rsp_status;
+static uint8 rsp_value[MAX_VALUE_LEN];
+static uint16 rsp_length;
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/* Passes an ATT write of the gateway to the service */
+static int loopbackWrite(void *p_context, uint16_t handle,
+                         const uint8_t *p_value, uint16_t length)
+{
+    uint8 value[MAX_VALUE_LEN];
+    GATT_ACCESS_IND_T ind;
+
+    if(length > MAX_VALUE_LEN)
+    {
+        return -1;
+    }
+
+    MemCopy(value, p_value, length);
+    ind.cid = LOOPBACK_CID;
+    ind.handle = handle;
+    ind.flags = 0;
+    ind.offset = 0;
+    ind.size_value = length;
+    ind.value = value;
+
+    rsp_status = sys_status_failed;
+    MeshControlHandleAccessWrite(&ind);
+
+    return (rsp_status == sys_status_success) ? 0 : -1;
+}
+
+/* Passes an ATT read of the gateway to the service */
+static int loopbackRead(void *p_context, uint16_t handle, uint8_t *p_value,
+                        uint16_t size, uint16_t *p_length)
+{
+    GATT_ACCESS_IND_T ind;
+
+    ind.cid = LOOPBACK_CID;
+    ind.handle = handle;
+    ind.flags = 0;
+    ind.offset = 0;
+    ind.size_value = 0;
+    ind.value = NULL;
+
+    rsp_status = sys_status_failed;
+    MeshControlHandleAccessRead(&ind);
+
+    if(rsp_status != sys_status_success || rsp_length > size)
+    {
+        return -1;
+    }
+
+    MemCopy(p_value, rsp_value, rsp_length);
+    *p_length = rsp_length;
+
+    return 0;
+}
+
+/* Sends the oldest queued message on the mesh and passes the responses of
+ * the devices to the service
+ */
+static void meshTxTimerHandler(timer_id tid)
+{
+    SCHED_MSG_T *p_msg = &sched_queue[sched_head];
+    uint16 responder;
+
+    if(tid != mesh_tx_tid)
+    {
+        return;
+    }
+    mesh_tx_tid = TIMER_INVALID;
+
+    sched_head = (sched_head + 1) % MAX_SCHED_QUEUE;
+    sched_count--;
+    stats.mesh_msgs++;
+
+    for(responder = 0; responder < mesh.responders; responder++)
+    {
+        if(notify_cb != NULL)
+        {
+            notify_cb(notify_ucid, p_msg->data, p_msg->length);
+        }
+    }
+
+    if(sched_count)
+    {
+        mesh_tx_tid = TimerCreate(mesh.mesh_tx_time, TRUE,
+                                  meshTxTimerHandler);
+    }
+}
+
+/*============================================================================*
+ *  Firmware and CSRmesh Library Function Implementations
+ *============================================================================*/
+sys_status GattCharValueNotification(uint16 ucid, uint16 handle, uint16 size,
+                                     const uint8 *value)
+{
+    stats.notifications++;
+
+    if(ucid == LOOPBACK_CID && p_gateway != NULL)
+    {
+        MtlGatewayHandleNotification(p_gateway, handle, value, size);
+    }
+
+    return sys_status_success;
+}
+
+void GattAccessRsp(uint16 cid, uint16 handle, sys_status rc,
+                   uint16 size_value, const uint8 *value)
+{
+    rsp_status = rc;
+    rsp_length = 0;
+
+    if(rc == sys_status_success && size_value <= MAX_VALUE_LEN)
+    {
+        MemCopy(rsp_value, value, size_value);
+        rsp_length = size_value;
+    }
+}
+
+CSRmeshResult CSRSchedHandleIncomingData(
+                                CSR_SCHED_INCOMING_DATA_EVENT_T data_event,
+                                CsrUint8* data,
+                                CsrUint8 length,
+                                CsrInt8 rssi)
+{
+    SCHED_MSG_T *p_msg;
+
+    if(sched_count >= mesh.sched_queue_size ||
+       length > MESH_LONGEST_MSG_LEN)
+    {
+        stats.sched_refused++;
+        return CSR_MESH_RESULT_FAILURE;
+    }
+
+    p_msg = &sched_queue[(sched_head + sched_count) % MAX_SCHED_QUEUE];
+    MemCopy(p_msg->data, data, length);
+    p_msg->length = length;
+    sched_count++;
+
+    if(mesh_tx_tid == TIMER_INVALID)
+    {
+        mesh_tx_tid = TimerCreate(mesh.mesh_tx_time, TRUE,
+                                  meshTxTimerHandler);
+    }
+
+    return CSR_MESH_RESULT_SUCCESS;
+}
+
+void CSRSchedNotifyGattEvent(CSR_SCHED_GATT_EVENT_T gatt_event_type,
+                             CSR_SCHED_GATT_EVENT_DATA_T *gatt_event_data,
+                             CSR_SCHED_NOTIFY_GATT_CB_T call_back)
+{
+    if(gatt_event_type == CSR_SCHED_GATT_CCCD_STATE_CHANGE_EVENT)
+    {
+        notify_cb = call_back;
+        notify_ucid = gatt_event_data->cid;
+    }
+}
+
+uint16 AppNeighbourReadRecord(uint8 *p_value)
+{
+    return 0;
+}
+
+bool AppNeighbourSetCursor(uint16 slot)
+{
+    return FALSE;
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MtlLoopbackInit
+ *
+ *  DESCRIPTION
+ *      This function initialises the mesh control service as on a new
+ *      connection at the given MTU, empties the mesh and connects the
+ *      gateway to it. The gateway still has to enable the notifications.
+ *
+ *  RETURNS
+ *      Nothing.
+ *
+ *---------------------------------------------------------------------------*/
+void MtlLoopbackInit(MTL_GATEWAY_T *p_gw, const LOOPBACK_MESH_T *p_mesh,
+                     uint16 mtu)
+{
+    p_gateway = p_gw;
+    mesh = *p_mesh;
+    if(mesh.sched_queue_size > MAX_SCHED_QUEUE)
+    {
+        mesh.sched_queue_size = MAX_SCHED_QUEUE;
+    }
+    memset(&stats, 0, sizeof(stats));
+
+    TimerDelete(mesh_tx_tid);
+    mesh_tx_tid = TIMER_INVALID;
+    sched_head = 0;
+    sched_count = 0;
+    notify_cb = NULL;
+    notify_ucid = GATT_INVALID_UCID;
+
+    MeshControlServiceDataInit();
+    MeshControlSetAttMtu(mtu);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      MtlLoopbackGetStats
+ *
+ *  DESCRIPTION
+ *      This function returns the counters of the bridge side.
+ *
+ *  RETURNS
+ *      Pointer to the counters.
+ *
+ *---------------------------------------------------------------------------*/
+const LOOPBACK_STATS_T *MtlLoopbackGetStats(void)
+{
+    return &stats;
+}
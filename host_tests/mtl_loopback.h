@@ -0,0 +1,71 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      mtl_loopback.h
+ *
+ *  DESCRIPTION
+ *      In-process transport between the host MTL gateway library and the
+ *      Bridge mesh control service. See mtl_loopback.c.
+ *
+ *****************************************************************************/
+
+#ifndef __MTL_LOOPBACK_H__
+#define __MTL_LOOPBACK_H__
+
+#include <types.h>
+
+#include "mtl_gateway.h"
+
+/*============================================================================*
+ *  Public Definitions
+ *============================================================================*/
+/* Connection the gateway uses */
+#define LOOPBACK_CID                    (0x0040)
+
+/*============================================================================*
+ *  Public Data Types
+ *============================================================================*/
+/* Mesh behind the bridge */
+typedef struct
+{
+    /* Messages the scheduler holds before it refuses more */
+    uint16 sched_queue_size;
+
+    /* Time to send one message on the mesh. Its responses come back when it
+     * has been sent.
+     */
+    uint32 mesh_tx_time;
+
+    /* Devices answering each message */
+    uint16 responders;
+}LOOPBACK_MESH_T;
+
+/* Counters of the bridge side */
+typedef struct
+{
+    uint32 mesh_msgs;           /* Messages the scheduler sent on the mesh */
+    uint32 sched_refused;       /* Messages the scheduler refused */
+    uint32 notifications;       /* Notifications sent to the gateway */
+}LOOPBACK_STATS_T;
+
+/*============================================================================*
+ *  Public Data
+ *============================================================================*/
+/* Transport and handles to pass to MtlGatewayInit */
+extern const MTL_GATEWAY_TRANSPORT_T loopback_transport;
+extern const MTL_GATEWAY_HANDLES_T loopback_handles;
+
+/*============================================================================*
+ *  Public Function Prototypes
+ *============================================================================*/
+/* Connects the gateway to a freshly initialised mesh control service */
+extern void MtlLoopbackInit(MTL_GATEWAY_T *p_gw, const LOOPBACK_MESH_T *p_mesh,
+                            uint16 mtu);
+
+/* Counters of the bridge side */
+extern const LOOPBACK_STATS_T *MtlLoopbackGetStats(void);
+
+#endif /* __MTL_LOOPBACK_H__ */
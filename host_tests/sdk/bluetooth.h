@@ -0,0 +1,32 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      bluetooth.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK Bluetooth address types
+ *
+ *****************************************************************************/
+
+#ifndef __BLUETOOTH_H__
+#define __BLUETOOTH_H__
+
+#include <types.h>
+
+typedef struct
+{
+    uint32 lap;
+    uint8  uap;
+    uint16 nap;
+}BD_ADDR_T;
+
+typedef struct
+{
+    uint16    type;
+    BD_ADDR_T addr;
+}TYPED_BD_ADDR_T;
+
+#endif /* __BLUETOOTH_H__ */
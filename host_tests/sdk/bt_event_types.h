@@ -0,0 +1,32 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      bt_event_types.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK Bluetooth event types used by the application
+ *      modules under test
+ *
+ *****************************************************************************/
+
+#ifndef __BT_EVENT_TYPES_H__
+#define __BT_EVENT_TYPES_H__
+
+#include <types.h>
+#include <bluetooth.h>
+
+/* GATT_ACCESS_IND from the firmware */
+typedef struct
+{
+    uint16 cid;
+    uint16 handle;
+    uint16 flags;
+    uint16 offset;
+    uint16 size_value;
+    uint8  *value;
+}GATT_ACCESS_IND_T;
+
+#endif /* __BT_EVENT_TYPES_H__ */
@@ -0,0 +1,24 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      buf_utils.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK buffer access functions
+ *
+ *****************************************************************************/
+
+#ifndef __BUF_UTILS_H__
+#define __BUF_UTILS_H__
+
+#include <types.h>
+
+extern uint8 BufReadUint8(uint8 **p_buf);
+extern uint16 BufReadUint16(uint8 **p_buf);
+extern void BufWriteUint8(uint8 **p_buf, uint8 value);
+extern void BufWriteUint16(uint8 **p_buf, uint16 value);
+
+#endif /* __BUF_UTILS_H__ */
@@ -0,0 +1,18 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      config_store.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK configuration store interface. The
+ *      modules under test do not read the configuration store.
+ *
+ *****************************************************************************/
+
+#ifndef __CONFIG_STORE_H__
+#define __CONFIG_STORE_H__
+
+#endif /* __CONFIG_STORE_H__ */
@@ -0,0 +1,18 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      csr_ota.h
+ *
+ *  DESCRIPTION
+ *      Host build of the OTA update library interface. The modules under
+ *      test use none of it.
+ *
+ *****************************************************************************/
+
+#ifndef __CSR_OTA_H__
+#define __CSR_OTA_H__
+
+#endif /* __CSR_OTA_H__ */
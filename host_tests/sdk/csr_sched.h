@@ -0,0 +1,88 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      csr_sched.h
+ *
+ *  DESCRIPTION
+ *      Host build of the CSRmesh scheduler interface used by the application
+ *      modules under test. The scheduler types in include/csr_sched.h are
+ *      only defined for CSR101x, the ones the application headers need are
+ *      repeated here with the same names. The functions used by the Bridge
+ *      are implemented by the loopback transport, see mtl_loopback.c.
+ *
+ *****************************************************************************/
+
+#ifndef __CSR_SCHED_H__
+#define __CSR_SCHED_H__
+
+#include <types.h>
+#include <ls_types.h>
+
+#include "csr_types.h"
+#include "csr_mesh_result.h"
+
+/* CSR Mesh Scheduling Mesh-LE Parameter Type */
+typedef struct
+{
+    CsrUint8 tx_queue_size;
+    CsrUint8 relay_repeat_count;
+    CsrUint8 device_repeat_count;
+} CSR_SCHED_MESH_TX_PARAM_T;
+
+typedef struct
+{
+    CsrBool is_le_bearer_ready;
+    CSR_SCHED_MESH_TX_PARAM_T tx_param;
+} CSR_SCHED_MESH_LE_PARAM_T;
+
+/* CSR Mesh Scheduling LE Parameter Type. The generic LE parameters are not
+ * used on the host.
+ */
+typedef struct
+{
+    CSR_SCHED_MESH_LE_PARAM_T mesh_le_param;
+} CSR_SCHED_LE_PARAMS_T;
+
+/* CSR Mesh Scheduling LE Event Type */
+typedef enum
+{
+    CSR_SCHED_GATT_CONNECTION_EVENT,
+    CSR_SCHED_GATT_STATE_CHANGE_EVENT,
+    CSR_SCHED_GATT_CCCD_STATE_CHANGE_EVENT
+}CSR_SCHED_GATT_EVENT_T;
+
+/* CSR Mesh Scheduling LE Incoming data event Type */
+typedef enum
+{
+    CSR_SCHED_INCOMING_LE_MESH_DATA_EVENT   = 1,
+    CSR_SCHED_INCOMING_GATT_MESH_DATA_EVENT = 2,
+    CSR_SCHED_SET_LE_ADV_PKT_EVENT          = 3
+}CSR_SCHED_INCOMING_DATA_EVENT_T;
+
+/* CSR Mesh Scheduling GATT Event Type */
+typedef struct
+{
+    CsrUint16 cid;
+    CsrBool is_gatt_bearer_ready;
+    CsrUint16 conn_interval;
+    CsrBool  is_notification_enabled;
+} CSR_SCHED_GATT_EVENT_DATA_T;
+
+/* CSR Mesh Scheduler GATT notify handler function */
+typedef void (*CSR_SCHED_NOTIFY_GATT_CB_T) (CsrUint16 ucid, CsrUint8 *mtl_msg,
+                                            CsrUint8 length);
+
+extern CSRmeshResult CSRSchedHandleIncomingData(
+                                CSR_SCHED_INCOMING_DATA_EVENT_T data_event,
+                                CsrUint8* data,
+                                CsrUint8 length,
+                                CsrInt8 rssi);
+
+extern void CSRSchedNotifyGattEvent(CSR_SCHED_GATT_EVENT_T gatt_event_type,
+                                    CSR_SCHED_GATT_EVENT_DATA_T *gatt_event_data,
+                                    CSR_SCHED_NOTIFY_GATT_CB_T call_back);
+
+#endif /* __CSR_SCHED_H__ */
@@ -0,0 +1,21 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      debug.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK debug output functions. The output is
+ *      discarded, see host_sdk.c.
+ *
+ *****************************************************************************/
+
+#ifndef __DEBUG_H__
+#define __DEBUG_H__
+
+extern void DebugWriteChar(char value);
+extern void DebugWriteString(const char *string);
+
+#endif /* __DEBUG_H__ */
@@ -0,0 +1,26 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      gatt.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK GATT server functions. They are implemented by
+ *      the test that links a module calling them, see mtl_loopback.c.
+ *
+ *****************************************************************************/
+
+#ifndef __GATT_H__
+#define __GATT_H__
+
+#include <types.h>
+#include <status.h>
+
+extern sys_status GattCharValueNotification(uint16 ucid, uint16 handle,
+                                            uint16 size, const uint8 *value);
+extern void GattAccessRsp(uint16 cid, uint16 handle, sys_status rc,
+                          uint16 size_value, const uint8 *value);
+
+#endif /* __GATT_H__ */
@@ -0,0 +1,22 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      gatt_prim.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK GATT status codes
+ *
+ *****************************************************************************/
+
+#ifndef __GATT_PRIM_H__
+#define __GATT_PRIM_H__
+
+#include <status.h>
+
+#define gatt_status_read_not_permitted   (STATUS_GROUP_GATT + 0x02)
+#define gatt_status_write_not_permitted  (STATUS_GROUP_GATT + 0x03)
+
+#endif /* __GATT_PRIM_H__ */
@@ -0,0 +1,18 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      gatt_uuid.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK GATT UUID definitions. The modules under
+ *      test use none of them.
+ *
+ *****************************************************************************/
+
+#ifndef __GATT_UUID_H__
+#define __GATT_UUID_H__
+
+#endif /* __GATT_UUID_H__ */
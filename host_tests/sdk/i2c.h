@@ -0,0 +1,44 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      i2c.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK raw I2C functions. They drive the scripted I2C
+ *      target of host_i2c.c.
+ *
+ *****************************************************************************/
+
+#ifndef __I2C_H__
+#define __I2C_H__
+
+#include <types.h>
+#include <status.h>
+#include <pio.h>
+
+#define I2C_RESERVED_PIO                (0xFF)
+#define I2C_POWER_PIO_UNDEFINED         (0xFF)
+
+#define I2C_SCL_100KBPS_HIGH_PERIOD     (80)
+#define I2C_SCL_100KBPS_LOW_PERIOD      (80)
+
+extern void I2cInit(uint8 sda_pio, uint8 scl_pio, uint8 power_pio,
+                    pio_i2c_pull_mode pull_mode);
+extern void I2cConfigClock(uint16 high_period, uint16 low_period);
+extern void I2cEnable(bool enable);
+
+extern sys_status I2cRawStart(bool wait);
+extern sys_status I2cRawRestart(bool wait);
+extern sys_status I2cRawStop(bool wait);
+extern sys_status I2cRawWriteByte(uint8 data);
+extern sys_status I2cRawWaitAck(bool wait);
+extern sys_status I2cRawReadByte(uint8 *p_data);
+extern sys_status I2cRawSendAck(bool wait);
+extern sys_status I2cRawSendNack(bool wait);
+extern sys_status I2cRawComplete(uint32 timeout);
+extern void I2cRawTerminate(void);
+
+#endif /* __I2C_H__ */
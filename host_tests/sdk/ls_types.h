@@ -0,0 +1,24 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      ls_types.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK link supervisor types used by the application
+ *      headers
+ *
+ *****************************************************************************/
+
+#ifndef __LS_TYPES_H__
+#define __LS_TYPES_H__
+
+typedef enum
+{
+    ls_addr_type_public = 0,
+    ls_addr_type_random = 1
+}ls_addr_type;
+
+#endif /* __LS_TYPES_H__ */
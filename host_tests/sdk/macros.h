@@ -0,0 +1,20 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      macros.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK byte access macros
+ *
+ *****************************************************************************/
+
+#ifndef __MACROS_H__
+#define __MACROS_H__
+
+#define WORD_MSB(x)                 (((x) >> 8) & 0xFF)
+#define WORD_LSB(x)                 ((x) & 0xFF)
+
+#endif /* __MACROS_H__ */
@@ -0,0 +1,26 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      mem.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK memory functions
+ *
+ *****************************************************************************/
+
+#ifndef __MEM_H__
+#define __MEM_H__
+
+#include <types.h>
+
+extern void MemSet(void *p_dst, uint16 value, uint16 length);
+extern void MemCopy(void *p_dst, const void *p_src, uint16 length);
+extern int16 MemCmp(const void *p_a, const void *p_b, uint16 length);
+
+/* Unpacks length octets held two to a word, low octet first */
+extern void MemCopyUnPack(void *p_dst, const uint16 *p_src, uint16 length);
+
+#endif /* __MEM_H__ */
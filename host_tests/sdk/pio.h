@@ -0,0 +1,30 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      pio.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK PIO functions used with I2C
+ *
+ *****************************************************************************/
+
+#ifndef __PIO_H__
+#define __PIO_H__
+
+#include <types.h>
+
+typedef enum
+{
+    pio_i2c_pull_mode_no_pulls,
+    pio_i2c_pull_mode_strong_pull_up,
+    pio_i2c_pull_mode_strong_pull_down,
+    pio_i2c_pull_mode_weak_pull_up,
+    pio_i2c_pull_mode_weak_pull_down
+}pio_i2c_pull_mode;
+
+extern void PioSetI2CPullMode(pio_i2c_pull_mode pull_mode);
+
+#endif /* __PIO_H__ */
@@ -0,0 +1,26 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      status.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK status codes
+ *
+ *****************************************************************************/
+
+#ifndef __STATUS_H__
+#define __STATUS_H__
+
+/* Base of the GATT status codes */
+#define STATUS_GROUP_GATT   (0x0100)
+
+typedef enum
+{
+    sys_status_success = 0x0000,
+    sys_status_failed  = 0x0001
+}sys_status;
+
+#endif /* __STATUS_H__ */
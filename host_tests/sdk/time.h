@@ -0,0 +1,27 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      time.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK time functions. Time is the virtual clock of
+ *      host_sdk.c, in microseconds.
+ *
+ *****************************************************************************/
+
+#ifndef __TIME_H__
+#define __TIME_H__
+
+#include <types.h>
+
+#define MILLISECOND                 ((uint32)1000)
+#define SECOND                      (1000 * MILLISECOND)
+#define MINUTE                      (60 * SECOND)
+
+extern uint32 TimeGet32(void);
+extern int32 TimeSub(uint32 t1, uint32 t2);
+
+#endif /* __TIME_H__ */
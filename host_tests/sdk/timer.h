@@ -0,0 +1,31 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      timer.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK timer functions. Timers expire when the test
+ *      advances the virtual clock with HostRunFor.
+ *
+ *****************************************************************************/
+
+#ifndef __TIMER_H__
+#define __TIMER_H__
+
+#include <types.h>
+#include <time.h>
+
+typedef uint16 timer_id;
+
+#define TIMER_INVALID               ((timer_id)0xFFFF)
+
+typedef void (*timer_callback_arg)(timer_id tid);
+
+extern timer_id TimerCreate(uint32 timeout, bool is_one_shot,
+                            timer_callback_arg handler);
+extern bool TimerDelete(timer_id tid);
+
+#endif /* __TIMER_H__ */
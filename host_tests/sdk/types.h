@@ -0,0 +1,37 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      types.h
+ *
+ *  DESCRIPTION
+ *      Host build of the SDK basic types used by the application modules
+ *      under test. On the device uint8 is 16 bits wide, the modules mask the
+ *      values they store in it so the narrower host type does not change
+ *      their behaviour.
+ *
+ *****************************************************************************/
+
+#ifndef __TYPES_H__
+#define __TYPES_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <macros.h>
+
+typedef uint8_t     uint8;
+typedef uint16_t    uint16;
+typedef uint32_t    uint32;
+typedef int8_t      int8;
+typedef int16_t     int16;
+typedef int32_t     int32;
+
+typedef uint16      bool;
+
+#define TRUE        (1)
+#define FALSE       (0)
+
+#endif /* __TYPES_H__ */
@@ -0,0 +1,320 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      test_ack_table.c
+ *
+ *  DESCRIPTION
+ *      Host tests of the Heater acknowledgement table with 50 sensors: least
+ *      recently added eviction, refresh of a sensor already in the table and
+ *      sensors sharing a hash bucket. The module is included so that the
+ *      tests can use its hash to pick colliding device ids.
+ *
+ *****************************************************************************/
+
+#include "host_sdk.h"
+#include "app_ack_table.c"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Sensors sending values to the heater */
+#define NUM_SENSORS                     (50)
+
+/* First sensor device id */
+#define SENSOR_ID_BASE                  (0x8001)
+
+/* Acknowledgements recorded in one AppAckTableSend */
+#define MAX_SENT                        (ACK_TABLE_SIZE + 1)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint16 dev_id;
+    uint16 tid;
+    uint16 retransmit_count;
+}MODEL_ENTRY_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Acknowledgements sent by the last AppAckTableSend */
+static uint16 sent_dev[MAX_SENT];
+static uint16 sent_tid[MAX_SENT];
+static uint16 sent_count;
+
+/* Reference table, most recently added first */
+static MODEL_ENTRY_T model[ACK_TABLE_SIZE];
+static uint16 model_count;
+
+static uint32 random_state = 1;
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+static void recordAck(uint16 dev_id, uint16 tid)
+{
+    CHECK(sent_count < MAX_SENT);
+    if(sent_count < MAX_SENT)
+    {
+        sent_dev[sent_count] = dev_id;
+        sent_tid[sent_count] = tid;
+    }
+    sent_count++;
+}
+
+static uint16 sendAcks(void)
+{
+    sent_count = 0;
+    return AppAckTableSend(recordAck);
+}
+
+static uint16 nextRandom(uint16 range)
+{
+    random_state = random_state * 1103515245 + 12345;
+    return (uint16)((random_state >> 16) % range);
+}
+
+/* Adds a device to the reference table in the same way as AppAckTableAdd */
+static void modelAdd(uint16 dev_id, uint16 tid, uint16 retransmit_count)
+{
+    uint16 index;
+
+    for(index = 0; index < model_count; index++)
+    {
+        if(model[index].dev_id == dev_id)
+        {
+            break;
+        }
+    }
+
+    if(index == model_count)
+    {
+        if(model_count < ACK_TABLE_SIZE)
+        {
+            model_count++;
+        }
+        index = model_count - 1;
+    }
+
+    for(; index > 0; index--)
+    {
+        model[index] = model[index - 1];
+    }
+
+    model[0].dev_id = dev_id;
+    model[0].tid = tid;
+    model[0].retransmit_count = retransmit_count;
+}
+
+/* Sends from the reference table and checks the table sent the same */
+static void modelSendAndCompare(void)
+{
+    uint16 pending;
+    uint16 index;
+    uint16 kept = 0;
+
+    CHECK_EQUAL(model_count, AppAckTableCount());
+
+    pending = sendAcks();
+    CHECK_EQUAL(model_count, sent_count);
+
+    for(index = 0; index < model_count && index < sent_count; index++)
+    {
+        CHECK_EQUAL(model[index].dev_id, sent_dev[index]);
+        CHECK_EQUAL(model[index].tid, sent_tid[index]);
+
+        if(model[index].retransmit_count > 1)
+        {
+            model[index].retransmit_count--;
+            model[kept++] = model[index];
+        }
+    }
+
+    model_count = kept;
+    CHECK_EQUAL(model_count, pending);
+    CHECK_EQUAL(model_count, AppAckTableCount());
+}
+
+/*----------------------------------------------------------------------------*
+ *  Adding 50 sensors keeps the last ACK_TABLE_SIZE, most recent first
+ *---------------------------------------------------------------------------*/
+static void testEvictsLeastRecentlyAdded(void)
+{
+    uint16 sensor;
+
+    AppAckTableInit();
+
+    for(sensor = 0; sensor < NUM_SENSORS; sensor++)
+    {
+        AppAckTableAdd(SENSOR_ID_BASE + sensor, sensor, 1);
+    }
+
+    CHECK_EQUAL(0, sendAcks());
+    CHECK_EQUAL(ACK_TABLE_SIZE, sent_count);
+
+    for(sensor = 0; sensor < ACK_TABLE_SIZE; sensor++)
+    {
+        CHECK_EQUAL(SENSOR_ID_BASE + NUM_SENSORS - 1 - sensor,
+                    sent_dev[sensor]);
+        CHECK_EQUAL(NUM_SENSORS - 1 - sensor, sent_tid[sensor]);
+    }
+
+    /* All the acknowledgements were sent, so the table is now empty */
+    CHECK_EQUAL(0, sendAcks());
+    CHECK_EQUAL(0, sent_count);
+}
+
+/*----------------------------------------------------------------------------*
+ *  Adding a sensor already in the table updates it and protects it from
+ *  eviction, without using a second entry
+ *---------------------------------------------------------------------------*/
+static void testRefreshOnAdd(void)
+{
+    uint16 sensor;
+
+    AppAckTableInit();
+
+    for(sensor = 0; sensor < ACK_TABLE_SIZE; sensor++)
+    {
+        AppAckTableAdd(SENSOR_ID_BASE + sensor, sensor, 1);
+    }
+
+    /* Refresh the oldest sensor, then add one more */
+    AppAckTableAdd(SENSOR_ID_BASE, 0x40, 3);
+    AppAckTableAdd(SENSOR_ID_BASE + NUM_SENSORS - 1, 0x41, 1);
+
+    CHECK_EQUAL(1, sendAcks());
+    CHECK_EQUAL(ACK_TABLE_SIZE, sent_count);
+    CHECK_EQUAL(SENSOR_ID_BASE + NUM_SENSORS - 1, sent_dev[0]);
+    CHECK_EQUAL(SENSOR_ID_BASE, sent_dev[1]);
+    CHECK_EQUAL(0x40, sent_tid[1]);
+
+    /* The second oldest sensor was evicted instead */
+    for(sensor = 0; sensor < sent_count; sensor++)
+    {
+        CHECK(sent_dev[sensor] != SENSOR_ID_BASE + 1);
+    }
+
+    /* Only the refreshed sensor has acknowledgements left */
+    CHECK_EQUAL(1, sendAcks());
+    CHECK_EQUAL(1, sent_count);
+    CHECK_EQUAL(SENSOR_ID_BASE, sent_dev[0]);
+    CHECK_EQUAL(0, sendAcks());
+    CHECK_EQUAL(SENSOR_ID_BASE, sent_dev[0]);
+    CHECK_EQUAL(0, sendAcks());
+    CHECK_EQUAL(0, sent_count);
+}
+
+/*----------------------------------------------------------------------------*
+ *  Sensors in the same hash bucket are found, refreshed and removed from the
+ *  middle of the bucket chain
+ *---------------------------------------------------------------------------*/
+static void testBucketCollisions(void)
+{
+    uint16 colliding[ACK_TABLE_SIZE + 1];
+    uint16 found = 0;
+    uint16 dev_id;
+    uint16 index;
+
+    /* Pick sensor ids that share the bucket of the first one */
+    for(dev_id = SENSOR_ID_BASE; found < ACK_TABLE_SIZE + 1; dev_id++)
+    {
+        if(hashDevice(dev_id) == hashDevice(SENSOR_ID_BASE))
+        {
+            colliding[found++] = dev_id;
+        }
+    }
+
+    AppAckTableInit();
+
+    /* Alternate sensors need one or two acknowledgements */
+    for(index = 0; index < ACK_TABLE_SIZE; index++)
+    {
+        AppAckTableAdd(colliding[index], index, 1 + (index & 1));
+    }
+
+    /* Refresh a sensor in the middle of the chain */
+    AppAckTableAdd(colliding[3], 0x33, 2);
+    CHECK_EQUAL(ACK_TABLE_SIZE / 2, sendAcks());
+    CHECK_EQUAL(ACK_TABLE_SIZE, sent_count);
+    CHECK_EQUAL(colliding[3], sent_dev[0]);
+    CHECK_EQUAL(0x33, sent_tid[0]);
+
+    /* Sensors freed from the chain can be added again, and the rest are
+     * still found rather than added twice
+     */
+    for(index = 0; index < ACK_TABLE_SIZE; index++)
+    {
+        AppAckTableAdd(colliding[index], 0x50 + index, 1);
+    }
+    CHECK_EQUAL(0, sendAcks());
+    CHECK_EQUAL(ACK_TABLE_SIZE, sent_count);
+    for(index = 0; index < ACK_TABLE_SIZE; index++)
+    {
+        CHECK_EQUAL(colliding[ACK_TABLE_SIZE - 1 - index], sent_dev[index]);
+        CHECK_EQUAL(0x50 + ACK_TABLE_SIZE - 1 - index, sent_tid[index]);
+    }
+
+    /* A ninth sensor in the bucket evicts the oldest from the chain */
+    for(index = 0; index <= ACK_TABLE_SIZE; index++)
+    {
+        AppAckTableAdd(colliding[index], index, 1);
+    }
+    sendAcks();
+    CHECK_EQUAL(ACK_TABLE_SIZE, sent_count);
+    CHECK_EQUAL(colliding[ACK_TABLE_SIZE], sent_dev[0]);
+    CHECK_EQUAL(colliding[1], sent_dev[ACK_TABLE_SIZE - 1]);
+}
+
+/*----------------------------------------------------------------------------*
+ *  Random adds from 50 sensors interleaved with sends match a simple
+ *  reference table
+ *---------------------------------------------------------------------------*/
+static void testRandomTraffic(void)
+{
+    uint16 step;
+
+    AppAckTableInit();
+    model_count = 0;
+
+    for(step = 0; step < 5000; step++)
+    {
+        if(nextRandom(4) == 0)
+        {
+            modelSendAndCompare();
+        }
+        else
+        {
+            uint16 dev_id = SENSOR_ID_BASE + nextRandom(NUM_SENSORS);
+            uint16 tid = nextRandom(256);
+            uint16 count = 1 + nextRandom(4);
+
+            AppAckTableAdd(dev_id, tid, count);
+            modelAdd(dev_id, tid, count);
+        }
+    }
+
+    while(model_count)
+    {
+        modelSendAndCompare();
+    }
+    modelSendAndCompare();
+}
+
+/*============================================================================*
+ *  Test Entry
+ *============================================================================*/
+int main(void)
+{
+    testEvictsLeastRecentlyAdded();
+    testRefreshOnAdd();
+    testBucketCollisions();
+    testRandomTraffic();
+
+    return HostTestResult("test_ack_table");
+}
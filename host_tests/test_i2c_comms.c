@@ -0,0 +1,302 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      test_i2c_comms.c
+ *
+ *  DESCRIPTION
+ *      Host tests of the TempSensor I2C transaction queue against the
+ *      scripted I2C target: transactions run from the timer in order, a
+ *      failed transfer is reported, and a transaction waiting for a held bus
+ *      is retried and then given up after I2C_QUEUE_MAX_ATTEMPTS.
+ *
+ *****************************************************************************/
+
+#include <mem.h>
+
+#include "host_sdk.h"
+#include "host_i2c.h"
+#include "i2c_comms.c"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* WRITE address of the target and of an address nothing answers on */
+#define TARGET_ADDRESS                  (0x72)
+#define ABSENT_ADDRESS                  (0x76)
+
+/* Handler calls recorded */
+#define MAX_LOG                         (16)
+
+/* Handler ids in the log, failures are logged with LOG_FAILED added */
+#define LOG_A                           (1)
+#define LOG_B                           (2)
+#define LOG_C                           (3)
+#define LOG_FAILED                      (0x10)
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+static uint16 handler_log[MAX_LOG];
+static uint16 handler_count;
+
+static const uint8 read_regs[3] = {0x01, 0x00, 0x02};
+static uint8 read_buffer[3];
+static uint8 chained_buffer[3];
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+static void logHandler(uint16 id, bool success)
+{
+    if(handler_count < MAX_LOG)
+    {
+        handler_log[handler_count] = id + (success ? 0 : LOG_FAILED);
+    }
+    handler_count++;
+}
+
+static void handlerA(bool success)
+{
+    logHandler(LOG_A, success);
+}
+
+static void handlerB(bool success)
+{
+    logHandler(LOG_B, success);
+}
+
+static void handlerC(bool success)
+{
+    logHandler(LOG_C, success);
+}
+
+/* Queues another read from within the handler of the previous one */
+static void chainingHandler(bool success)
+{
+    logHandler(LOG_A, success);
+    CHECK(I2CQueueReadRegisterList(TARGET_ADDRESS, read_regs, 3,
+                                   chained_buffer, handlerB));
+}
+
+static void setUp(void)
+{
+    HostReset();
+    HostI2cReset();
+    HostI2cAttach(TARGET_ADDRESS);
+    HostI2cSetRegister(0x00, 0x19);
+    HostI2cSetRegister(0x01, 0x00);
+    HostI2cSetRegister(0x02, 0x80);
+
+    I2CQueueInit();
+    bus_I2C_status = i2c_bus_released;
+
+    handler_count = 0;
+    MemSet(read_buffer, 0, sizeof(read_buffer));
+    MemSet(chained_buffer, 0, sizeof(chained_buffer));
+}
+
+/*----------------------------------------------------------------------------*
+ *  A queued read runs from the timer, not from the call queueing it
+ *---------------------------------------------------------------------------*/
+static void testQueuedReadRunsFromTimer(void)
+{
+    setUp();
+
+    CHECK(I2CQueueReadRegisterList(TARGET_ADDRESS, read_regs, 3, read_buffer,
+                                   handlerA));
+    CHECK_EQUAL(0, handler_count);
+    CHECK_EQUAL(0, HostI2cStats()->transactions);
+
+    HostRunFor(I2C_QUEUE_DELAY);
+
+    CHECK_EQUAL(1, handler_count);
+    CHECK_EQUAL(LOG_A, handler_log[0]);
+    CHECK_EQUAL(0x00, read_buffer[0]);
+    CHECK_EQUAL(0x19, read_buffer[1]);
+    CHECK_EQUAL(0x80, read_buffer[2]);
+
+    /* One transaction for the whole list, then the bus is released */
+    CHECK_EQUAL(1, HostI2cStats()->transactions);
+    CHECK_EQUAL(3, HostI2cStats()->reads);
+    CHECK(!HostI2cStats()->enabled);
+    CHECK_EQUAL(0, HostTimersRunning());
+    CHECK(I2CAcquire());
+    I2CRelease();
+}
+
+/*----------------------------------------------------------------------------*
+ *  Transactions run in order, one per timer expiry, and the queue refuses
+ *  transactions once full
+ *---------------------------------------------------------------------------*/
+static void testQueueOrderAndFull(void)
+{
+    uint16 index;
+
+    setUp();
+
+    CHECK(I2CQueueWriteRegister(TARGET_ADDRESS, 0x00, 0x1A, handlerA));
+    CHECK(I2CQueueReadRegisterList(TARGET_ADDRESS, read_regs, 3, read_buffer,
+                                   handlerB));
+    for(index = 2; index < I2C_QUEUE_SIZE; index++)
+    {
+        CHECK(I2CQueueWriteRegister(TARGET_ADDRESS, 0x10 + index, index,
+                                    handlerC));
+    }
+    CHECK(!I2CQueueWriteRegister(TARGET_ADDRESS, 0x20, 0x00, handlerC));
+
+    HostRunFor(I2C_QUEUE_DELAY);
+    CHECK_EQUAL(1, handler_count);
+    CHECK_EQUAL(0x1A, HostI2cGetRegister(0x00));
+
+    HostRunFor(I2C_QUEUE_SIZE * I2C_QUEUE_DELAY);
+    CHECK_EQUAL(I2C_QUEUE_SIZE, handler_count);
+    CHECK_EQUAL(LOG_A, handler_log[0]);
+    CHECK_EQUAL(LOG_B, handler_log[1]);
+    CHECK_EQUAL(LOG_C, handler_log[2]);
+
+    /* The read saw the value written before it */
+    CHECK_EQUAL(0x1A, read_buffer[1]);
+    CHECK_EQUAL(3, HostI2cGetRegister(0x13));
+    CHECK_EQUAL(0, HostTimersRunning());
+}
+
+/*----------------------------------------------------------------------------*
+ *  A transfer that fails is reported and the next transaction still runs
+ *---------------------------------------------------------------------------*/
+static void testFailedTransfer(void)
+{
+    uint16 operation;
+
+    /* Fail each of the 31 raw operations of the read in turn */
+    for(operation = 1; operation <= 31; operation++)
+    {
+        setUp();
+        CHECK(I2CQueueReadRegisterList(TARGET_ADDRESS, read_regs, 3,
+                                       read_buffer, handlerA));
+        CHECK(I2CQueueWriteRegister(TARGET_ADDRESS, 0x00, 0x1B, handlerB));
+
+        HostI2cFailOperation(operation);
+        HostRunFor(I2C_QUEUE_DELAY);
+        HostI2cFailOperation(0);
+        HostRunFor(I2C_QUEUE_DELAY);
+
+        CHECK_EQUAL(2, handler_count);
+        CHECK_EQUAL(LOG_A + LOG_FAILED, handler_log[0]);
+        CHECK_EQUAL(LOG_B, handler_log[1]);
+        CHECK_EQUAL(0x1B, HostI2cGetRegister(0x00));
+        CHECK(I2CAcquire());
+        I2CRelease();
+    }
+
+    /* Nothing answers at the address */
+    setUp();
+    CHECK(I2CQueueWriteRegister(ABSENT_ADDRESS, 0x00, 0x1C, handlerA));
+    HostRunFor(I2C_QUEUE_DELAY);
+    CHECK_EQUAL(1, handler_count);
+    CHECK_EQUAL(LOG_A + LOG_FAILED, handler_log[0]);
+    CHECK_EQUAL(0x19, HostI2cGetRegister(0x00));
+}
+
+/*----------------------------------------------------------------------------*
+ *  A transaction waits for a held bus and runs once it is released
+ *---------------------------------------------------------------------------*/
+static void testBusHeldThenReleased(void)
+{
+    setUp();
+
+    CHECK(I2CAcquire());
+    CHECK(I2CQueueReadRegisterList(TARGET_ADDRESS, read_regs, 3, read_buffer,
+                                   handlerA));
+
+    HostRunFor((I2C_QUEUE_MAX_ATTEMPTS - 1) * I2C_QUEUE_DELAY);
+    CHECK_EQUAL(0, handler_count);
+    CHECK_EQUAL(0, HostI2cStats()->transactions);
+
+    I2CRelease();
+    HostRunFor(I2C_QUEUE_DELAY);
+    CHECK_EQUAL(1, handler_count);
+    CHECK_EQUAL(LOG_A, handler_log[0]);
+    CHECK_EQUAL(0x19, read_buffer[1]);
+}
+
+/*----------------------------------------------------------------------------*
+ *  A transaction that never gets the bus is ended as failed after
+ *  I2C_QUEUE_MAX_ATTEMPTS, and the next one gets its own attempts
+ *---------------------------------------------------------------------------*/
+static void testBusHeldGivesUp(void)
+{
+    setUp();
+
+    CHECK(I2CAcquire());
+    CHECK(I2CQueueReadRegisterList(TARGET_ADDRESS, read_regs, 3, read_buffer,
+                                   handlerA));
+    CHECK(I2CQueueWriteRegister(TARGET_ADDRESS, 0x00, 0x1D, handlerB));
+
+    HostRunFor(I2C_QUEUE_MAX_ATTEMPTS * I2C_QUEUE_DELAY);
+    CHECK_EQUAL(1, handler_count);
+    CHECK_EQUAL(LOG_A + LOG_FAILED, handler_log[0]);
+    CHECK_EQUAL(0, HostI2cStats()->transactions);
+
+    HostRunFor(I2C_QUEUE_MAX_ATTEMPTS * I2C_QUEUE_DELAY);
+    CHECK_EQUAL(2, handler_count);
+    CHECK_EQUAL(LOG_B + LOG_FAILED, handler_log[1]);
+
+    /* The queue is empty, so nothing keeps polling the bus */
+    CHECK_EQUAL(0, HostTimersRunning());
+    CHECK_EQUAL(0x19, HostI2cGetRegister(0x00));
+    I2CRelease();
+}
+
+/*----------------------------------------------------------------------------*
+ *  A handler may queue the next transaction
+ *---------------------------------------------------------------------------*/
+static void testHandlerQueuesNext(void)
+{
+    setUp();
+
+    CHECK(I2CQueueReadRegisterList(TARGET_ADDRESS, read_regs, 3, read_buffer,
+                                   chainingHandler));
+    HostRunFor(I2C_QUEUE_DELAY);
+    CHECK_EQUAL(1, handler_count);
+
+    HostRunFor(I2C_QUEUE_DELAY);
+    CHECK_EQUAL(2, handler_count);
+    CHECK_EQUAL(LOG_B, handler_log[1]);
+    CHECK_EQUAL(0x80, chained_buffer[2]);
+    CHECK_EQUAL(0, HostTimersRunning());
+}
+
+/*----------------------------------------------------------------------------*
+ *  I2CQueueInit drops the queued transactions without calling them
+ *---------------------------------------------------------------------------*/
+static void testQueueInit(void)
+{
+    setUp();
+
+    CHECK(I2CQueueWriteRegister(TARGET_ADDRESS, 0x00, 0x1E, handlerA));
+    I2CQueueInit();
+    HostRunFor(10 * I2C_QUEUE_DELAY);
+
+    CHECK_EQUAL(0, handler_count);
+    CHECK_EQUAL(0, HostTimersRunning());
+    CHECK_EQUAL(0x19, HostI2cGetRegister(0x00));
+}
+
+/*============================================================================*
+ *  Test Entry
+ *============================================================================*/
+int main(void)
+{
+    testQueuedReadRunsFromTimer();
+    testQueueOrderAndFull();
+    testFailedTransfer();
+    testBusHeldThenReleased();
+    testBusHeldGivesUp();
+    testHandlerQueuesNext();
+    testQueueInit();
+
+    return HostTestResult("test_i2c_comms");
+}
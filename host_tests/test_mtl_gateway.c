@@ -0,0 +1,338 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      test_mtl_gateway.c
+ *
+ *  DESCRIPTION
+ *      Host tests of the MTL gateway library against the Bridge mesh control
+ *      service over the loopback transport: CCCD handling, messages split
+ *      at the default MTU, batched responses, flow control on MTL_RX_STATUS
+ *      and notifications that cannot be parsed.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "host_sdk.h"
+#include "mtl_loopback.h"
+#include "app_gatt_db.h"
+#include "mesh_control_service.h"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Messages recorded by the message callback */
+#define MAX_RECEIVED                    (64)
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+typedef struct
+{
+    uint8  data[MTL_GATEWAY_MAX_MSG_LEN];
+    uint16 length;
+}RECEIVED_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+static MTL_GATEWAY_T gateway;
+
+static RECEIVED_T received[MAX_RECEIVED];
+static uint16 received_count;
+
+/* One message on a lightly loaded mesh answered by one device */
+static const LOOPBACK_MESH_T quiet_mesh = { 2, 30 * MILLISECOND, 1 };
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+static void recordMessage(void *p_context, const uint8_t *p_msg,
+                          uint16_t length)
+{
+    if(received_count < MAX_RECEIVED)
+    {
+        memcpy(received[received_count].data, p_msg, length);
+        received[received_count].length = length;
+    }
+    received_count++;
+}
+
+/* Fills a message with a pattern that identifies it */
+static void fillMessage(uint8 *p_msg, uint16 length, uint16 seed)
+{
+    uint16 index;
+
+    for(index = 0; index < length; index++)
+    {
+        p_msg[index] = (seed * 31 + index) & 0xFF;
+    }
+}
+
+static bool receivedEquals(uint16 index, const uint8 *p_msg, uint16 length)
+{
+    return (index < MAX_RECEIVED &&
+            received[index].length == length &&
+            memcmp(received[index].data, p_msg, length) == 0);
+}
+
+static void startConnection(const LOOPBACK_MESH_T *p_mesh, uint16 mtu)
+{
+    HostReset();
+    received_count = 0;
+
+    MtlLoopbackInit(&gateway, p_mesh, mtu);
+    MtlGatewayInit(&gateway, &loopback_transport, &loopback_handles,
+                   recordMessage, NULL);
+}
+
+/*============================================================================*
+ *  Tests
+ *============================================================================*/
+/* Without the CCCD written the bridge passes messages on but the scheduler
+ * has no callback for the responses
+ */
+static void testNoResponsesBeforeConnect(void)
+{
+    uint8 msg[10];
+
+    startConnection(&quiet_mesh, MTL_GATEWAY_ATT_MTU);
+
+    fillMessage(msg, sizeof(msg), 1);
+    CHECK_EQUAL(mtl_gateway_success, MtlGatewaySend(&gateway, msg,
+                                                    sizeof(msg)));
+    HostRunFor(SECOND);
+
+    CHECK_EQUAL(1, MtlLoopbackGetStats()->mesh_msgs);
+    CHECK_EQUAL(0, received_count);
+}
+
+/* Connect writes the CCCDs the service reads back */
+static void testConnectWritesClientConfig(void)
+{
+    uint8 value[2];
+    uint16 length = 0;
+
+    startConnection(&quiet_mesh, MTL_GATEWAY_ATT_MTU);
+
+    CHECK_EQUAL(mtl_gateway_success,
+                MtlGatewayConnect(&gateway, MTL_GATEWAY_ATT_MTU, FALSE));
+
+    CHECK_EQUAL(0, loopback_transport.read(NULL, HANDLE_MTL_CP_CLIENT_CONFIG,
+                                           value, sizeof(value), &length));
+    CHECK_EQUAL(2, length);
+    CHECK_EQUAL(MTL_GATEWAY_CCCD_NOTIFICATION, value[0] | (value[1] << 8));
+
+    CHECK_EQUAL(0, loopback_transport.read(NULL,
+                                        HANDLE_MTL_RX_STATUS_CLIENT_CONFIG,
+                                        value, sizeof(value), &length));
+    CHECK_EQUAL(MTL_GATEWAY_CCCD_NOTIFICATION, value[0] | (value[1] << 8));
+
+    /* Batching was not asked for */
+    CHECK_EQUAL(0, loopback_transport.read(NULL, HANDLE_MTL_BATCH_CP,
+                                           value, sizeof(value), &length));
+    CHECK_EQUAL(1, length);
+    CHECK_EQUAL(MTL_GATEWAY_BATCH_OFF, value[0]);
+
+    /* No batch fits in a notification at the default MTU, so the bridge
+     * does not accept batching
+     */
+    value[0] = MTL_GATEWAY_BATCH_ON;
+    CHECK(loopback_transport.write(NULL, HANDLE_MTL_BATCH_CP, value, 1) != 0);
+    CHECK_EQUAL(0, loopback_transport.read(NULL, HANDLE_MTL_BATCH_CP,
+                                           value, sizeof(value), &length));
+    CHECK_EQUAL(MTL_GATEWAY_BATCH_OFF, value[0]);
+
+    /* The queue of the bridge is empty */
+    CHECK_EQUAL(MTL_RX_QUEUE_SIZE, gateway.rx_free_slots);
+}
+
+/* Every message length round trips at the default MTU. Messages longer than
+ * 20 octets are split both ways.
+ */
+static void testRoundTripDefaultMtu(void)
+{
+    uint8 msg[MTL_GATEWAY_MAX_MSG_LEN];
+    uint16 length;
+    uint32 writes;
+    uint32 notifications;
+
+    startConnection(&quiet_mesh, MTL_GATEWAY_ATT_MTU);
+    MtlGatewayConnect(&gateway, MTL_GATEWAY_ATT_MTU, TRUE);
+
+    for(length = 1; length <= MTL_GATEWAY_MAX_MSG_LEN; length++)
+    {
+        fillMessage(msg, length, length);
+        writes = gateway.stats.writes;
+        notifications = gateway.stats.notifications;
+
+        CHECK_EQUAL(mtl_gateway_success,
+                    MtlGatewaySend(&gateway, msg, length));
+        HostRunFor(SECOND);
+
+        CHECK(receivedEquals(length - 1, msg, length));
+        CHECK_EQUAL((length > MTL_GATEWAY_ATT_MTU - 3) ? 2 : 1,
+                    gateway.stats.writes - writes);
+        CHECK_EQUAL((length > MTL_GATEWAY_ATT_MTU - 3) ? 2 : 1,
+                    gateway.stats.notifications - notifications);
+    }
+
+    CHECK_EQUAL(MTL_GATEWAY_MAX_MSG_LEN, received_count);
+    CHECK_EQUAL(0, gateway.stats.bad_notifications);
+}
+
+/* Responses from several devices at the larger MTU arrive in one batch */
+static void testBatchedResponses(void)
+{
+    static const LOOPBACK_MESH_T group_mesh = { 2, 30 * MILLISECOND, 4 };
+    uint8 msg[12];
+    uint16 index;
+
+    startConnection(&group_mesh, MTL_GATEWAY_ATT_MTU_MAX);
+    MtlGatewayConnect(&gateway, MTL_GATEWAY_ATT_MTU_MAX, TRUE);
+
+    fillMessage(msg, sizeof(msg), 7);
+    CHECK_EQUAL(mtl_gateway_success, MtlGatewaySend(&gateway, msg,
+                                                    sizeof(msg)));
+    HostRunFor(SECOND);
+
+    CHECK_EQUAL(4, received_count);
+    for(index = 0; index < 4; index++)
+    {
+        CHECK(receivedEquals(index, msg, sizeof(msg)));
+    }
+
+    /* 4 x (1 + 12) octets fit in one 61 octet notification */
+    CHECK_EQUAL(1, gateway.stats.notifications);
+    CHECK_EQUAL(0, gateway.stats.bad_notifications);
+
+    /* The same responses without batching take a notification each */
+    startConnection(&group_mesh, MTL_GATEWAY_ATT_MTU_MAX);
+    MtlGatewayConnect(&gateway, MTL_GATEWAY_ATT_MTU_MAX, FALSE);
+    MtlGatewaySend(&gateway, msg, sizeof(msg));
+    HostRunFor(SECOND);
+
+    CHECK_EQUAL(4, received_count);
+    CHECK_EQUAL(4, gateway.stats.notifications);
+}
+
+/* A gateway sending faster than the mesh is held off by MTL_RX_STATUS and
+ * nothing is dropped
+ */
+static void testFlowControl(void)
+{
+    /* The scheduler takes one message at a time and the mesh needs longer
+     * than the drain interval to send it
+     */
+    static const LOOPBACK_MESH_T slow_mesh = { 1, 60 * MILLISECOND, 1 };
+    uint8 msg[MAX_RECEIVED][8];
+    uint16 sent = 0;
+    uint16 index;
+
+    startConnection(&slow_mesh, MTL_GATEWAY_ATT_MTU);
+    MtlGatewayConnect(&gateway, MTL_GATEWAY_ATT_MTU, FALSE);
+
+    for(index = 0; index < 20; index++)
+    {
+        fillMessage(msg[index], sizeof(msg[index]), index);
+    }
+
+    while(sent < 20)
+    {
+        if(MtlGatewaySend(&gateway, msg[sent], sizeof(msg[sent])) ==
+                                                        mtl_gateway_success)
+        {
+            sent++;
+        }
+        else
+        {
+            HostRunFor(MILLISECOND);
+        }
+    }
+    HostRunFor(5 * SECOND);
+
+    /* The gateway had to wait for room */
+    CHECK(gateway.stats.busy > 0);
+    CHECK_EQUAL(0, gateway.rx_dropped);
+    CHECK_EQUAL(20, MtlLoopbackGetStats()->mesh_msgs);
+
+    CHECK_EQUAL(20, received_count);
+    for(index = 0; index < 20; index++)
+    {
+        CHECK(receivedEquals(index, msg[index], sizeof(msg[index])));
+    }
+}
+
+/* Messages that do not fit are refused before anything is written */
+static void testInvalidLength(void)
+{
+    uint8 msg[MTL_GATEWAY_MAX_MSG_LEN + 1];
+
+    startConnection(&quiet_mesh, MTL_GATEWAY_ATT_MTU);
+    MtlGatewayConnect(&gateway, MTL_GATEWAY_ATT_MTU, FALSE);
+
+    fillMessage(msg, sizeof(msg), 3);
+    CHECK_EQUAL(mtl_gateway_invalid_length, MtlGatewaySend(&gateway, msg, 0));
+    CHECK_EQUAL(mtl_gateway_invalid_length,
+                MtlGatewaySend(&gateway, msg, sizeof(msg)));
+    CHECK_EQUAL(0, gateway.stats.msgs_sent);
+}
+
+/* Broken notifications are counted and nothing is delivered from them */
+static void testBadNotifications(void)
+{
+    static const uint8 batch_overrun[] = { 3, 0xAA, 0xBB, 0xCC, 5, 0xDD };
+    static const uint8 batch_empty_record[] = { 0 };
+    static const uint8 short_status[] = { 1, 0 };
+    uint8 long_part[MTL_GATEWAY_MAX_MSG_LEN];
+
+    startConnection(&quiet_mesh, MTL_GATEWAY_ATT_MTU_MAX);
+    MtlGatewayConnect(&gateway, MTL_GATEWAY_ATT_MTU_MAX, TRUE);
+    fillMessage(long_part, sizeof(long_part), 9);
+
+    CHECK(MtlGatewayHandleNotification(&gateway, HANDLE_MTL_BATCH_CP,
+                                       batch_overrun,
+                                       sizeof(batch_overrun)));
+    CHECK(MtlGatewayHandleNotification(&gateway, HANDLE_MTL_BATCH_CP,
+                                       batch_empty_record,
+                                       sizeof(batch_empty_record)));
+    CHECK(MtlGatewayHandleNotification(&gateway, HANDLE_MTL_RX_STATUS,
+                                       short_status, sizeof(short_status)));
+
+    /* A continuation followed by a part that makes the message too long */
+    CHECK(MtlGatewayHandleNotification(&gateway, HANDLE_MTL_CONTINUATION_CP,
+                                       long_part, 20));
+    CHECK(MtlGatewayHandleNotification(&gateway, HANDLE_MTL_COMPLETE_CP,
+                                       long_part, 20));
+
+    CHECK_EQUAL(4, gateway.stats.bad_notifications);
+    CHECK_EQUAL(0, received_count);
+
+    /* Reassembly starts afresh after the error */
+    CHECK(MtlGatewayHandleNotification(&gateway, HANDLE_MTL_COMPLETE_CP,
+                                       long_part, 5));
+    CHECK(receivedEquals(0, long_part, 5));
+
+    /* Other handles are left to the caller */
+    CHECK(!MtlGatewayHandleNotification(&gateway, HANDLE_NEIGHBOUR_TABLE,
+                                        long_part, 1));
+}
+
+/*============================================================================*
+ *  Test Entry
+ *============================================================================*/
+int main(void)
+{
+    testNoResponsesBeforeConnect();
+    testConnectWritesClientConfig();
+    testRoundTripDefaultMtu();
+    testBatchedResponses();
+    testFlowControl();
+    testInvalidLength();
+    testBadNotifications();
+
+    return HostTestResult("test_mtl_gateway");
+}
@@ -0,0 +1,206 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      test_stts751.c
+ *
+ *  DESCRIPTION
+ *      Host tests of the TempSensor STTS751 driver against the scripted I2C
+ *      target. STTS751_ReadTemperature is checked for the temperature it
+ *      returns and for the bus transactions and completion wait time it
+ *      takes per reading, against the read of one register per transaction
+ *      it replaced.
+ *
+ *****************************************************************************/
+
+#include "host_sdk.h"
+#include "host_i2c.h"
+#include "stts751_temperature_sensor.h"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Completion wait of one transaction, as given to I2cRawComplete */
+#define TRANSACTION_WAIT                (1 * MILLISECOND)
+
+/* Registers of a reading of 25.5 degrees Centigrade */
+#define TEMP_MSB                        (0x19)
+#define TEMP_LSB                        (0x80)
+#define TEMP_VALUE                      ((int16)(25 * 16 + 8))
+
+/* Raw operations in a reading: a start, nine per register with a restart
+ * between registers, and a stop
+ */
+#define READ_OPERATIONS                 (1 + 3 * 9 + 2 + 1)
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+/* The temperature read as it was before I2CReadRegisterList: the status, MSB
+ * and LSB registers each in a transaction of their own.
+ */
+static bool readTemperatureByRegister(int16 *temp)
+{
+    bool  success = FALSE;
+    uint8 status  = 0x00;
+    uint8 integer, fraction;
+
+    *temp = INVALID_TEMPERATURE;
+
+    if (I2CAcquire())
+    {
+        I2CcommsInit();
+
+        success = I2CReadRegister(STTS751_I2C_ADDRESS, REG_STATUS, &status);
+
+        if ((success) && (!(status & STATUS_BUSY_BITMASK)))
+        {
+            success  =
+                I2CReadRegister(STTS751_I2C_ADDRESS, REG_TEMP_MSB, &integer);
+            success &=
+                I2CReadRegister(STTS751_I2C_ADDRESS, REG_TEMP_LSB, &fraction);
+
+            if (success)
+            {
+                uint16 value = integer;
+
+                if (value & 0x80) value |= 0xFF00;
+
+                *temp = (int16)((value << TRES_BITS_SHIFT(12)) |
+                                (fraction >> TRES_BITS_SHIFT(12)));
+            }
+        }
+
+        I2CRelease();
+    }
+
+    return success;
+}
+
+static void setUp(uint8 status, uint8 msb, uint8 lsb)
+{
+    HostReset();
+    HostI2cReset();
+    HostI2cAttach(STTS751_I2C_ADDRESS);
+    HostI2cSetRegister(REG_STATUS, status);
+    HostI2cSetRegister(REG_TEMP_MSB, msb);
+    HostI2cSetRegister(REG_TEMP_LSB, lsb);
+}
+
+/*============================================================================*
+ *  Tests
+ *============================================================================*/
+/*----------------------------------------------------------------------------*
+ *  A reading takes one transaction and one completion wait, where reading
+ *  the registers one at a time took three of each
+ *---------------------------------------------------------------------------*/
+static void testTransactionsPerReading(void)
+{
+    int16 temp;
+
+    setUp(0x00, TEMP_MSB, TEMP_LSB);
+    CHECK(readTemperatureByRegister(&temp));
+    CHECK_EQUAL(TEMP_VALUE, temp);
+    CHECK_EQUAL(3, HostI2cStats()->transactions);
+    CHECK_EQUAL(3, HostI2cStats()->reads);
+    CHECK_EQUAL(3 * TRANSACTION_WAIT, HostI2cStats()->wait_time);
+
+    setUp(0x00, TEMP_MSB, TEMP_LSB);
+    CHECK(STTS751_ReadTemperature(&temp));
+    CHECK_EQUAL(TEMP_VALUE, temp);
+    CHECK_EQUAL(1, HostI2cStats()->transactions);
+    CHECK_EQUAL(3, HostI2cStats()->reads);
+    CHECK_EQUAL(TRANSACTION_WAIT, HostI2cStats()->wait_time);
+
+    /* The bus is released after the reading */
+    CHECK(!HostI2cStats()->enabled);
+    CHECK(I2CAcquire());
+    I2CRelease();
+}
+
+/*----------------------------------------------------------------------------*
+ *  Readings below zero are sign extended
+ *---------------------------------------------------------------------------*/
+static void testNegativeTemperature(void)
+{
+    int16 temp;
+
+    /* -10.25 degrees Centigrade */
+    setUp(0x00, 0xF5, 0xC0);
+    CHECK(STTS751_ReadTemperature(&temp));
+    CHECK_EQUAL((int16)(-10 * 16 - 4), temp);
+
+    setUp(0x00, 0xF5, 0xC0);
+    CHECK(readTemperatureByRegister(&temp));
+    CHECK_EQUAL((int16)(-10 * 16 - 4), temp);
+}
+
+/*----------------------------------------------------------------------------*
+ *  A conversion in progress gives INVALID_TEMPERATURE in one transaction,
+ *  as the temperature registers are read with the status
+ *---------------------------------------------------------------------------*/
+static void testConversionInProgress(void)
+{
+    int16 temp;
+
+    setUp(STATUS_BUSY_BITMASK, TEMP_MSB, TEMP_LSB);
+    CHECK(STTS751_ReadTemperature(&temp));
+#ifdef ENABLE_TEMP_THRESHOLD_EVENT
+    /* In continuous conversion the registers hold the last conversion */
+    CHECK_EQUAL(TEMP_VALUE, temp);
+#else
+    CHECK_EQUAL(INVALID_TEMPERATURE, temp);
+#endif /* ENABLE_TEMP_THRESHOLD_EVENT */
+    CHECK_EQUAL(1, HostI2cStats()->transactions);
+    CHECK_EQUAL(TRANSACTION_WAIT, HostI2cStats()->wait_time);
+}
+
+/*----------------------------------------------------------------------------*
+ *  A failed bus operation anywhere in the reading gives INVALID_TEMPERATURE,
+ *  still in one transaction, and releases the bus
+ *---------------------------------------------------------------------------*/
+static void testBusFailure(void)
+{
+    int16 temp;
+    uint16 operation;
+
+    for(operation = 1; operation <= READ_OPERATIONS; operation++)
+    {
+        setUp(0x00, TEMP_MSB, TEMP_LSB);
+        HostI2cFailOperation(operation);
+
+        CHECK(!STTS751_ReadTemperature(&temp));
+        CHECK_EQUAL(INVALID_TEMPERATURE, temp);
+        CHECK_EQUAL(1, HostI2cStats()->transactions);
+        CHECK(I2CAcquire());
+        I2CRelease();
+    }
+
+    /* The reading ends with the last operation */
+    setUp(0x00, TEMP_MSB, TEMP_LSB);
+    HostI2cFailOperation(READ_OPERATIONS + 1);
+    CHECK(STTS751_ReadTemperature(&temp));
+    CHECK_EQUAL(TEMP_VALUE, temp);
+
+    /* No target on the bus */
+    setUp(0x00, TEMP_MSB, TEMP_LSB);
+    HostI2cReset();
+    CHECK(!STTS751_ReadTemperature(&temp));
+    CHECK_EQUAL(INVALID_TEMPERATURE, temp);
+    CHECK_EQUAL(1, HostI2cStats()->transactions);
+}
+
+/*============================================================================*
+ *  Test Runner
+ *============================================================================*/
+int main(void)
+{
+    testTransactionsPerReading();
+    testNegativeTemperature();
+    testConversionInProgress();
+    testBusFailure();
+
+    return HostTestResult("test_stts751");
+}
@@ -0,0 +1,269 @@
+/******************************************************************************
+ *  Copyright 2015 Qualcomm Technologies International, Ltd.
+ *  Bluetooth Low Energy CSRmesh 2.0
+ *  Application version 2.0
+ *
+ *  FILE
+ *      test_user_adv.c
+ *
+ *  DESCRIPTION
+ *      Host tests of the Bridge reassembly of the reports lights send in
+ *      user advert chunks: a grid of lights sending at once with more
+ *      lights than slots, a report in the middle of reassembly keeping its
+ *      slot, and a report notified again only when its content changes.
+ *      The module is included so that the tests can use its table sizes.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "host_sdk.h"
+#include "app_user_adv.c"
+
+/*============================================================================*
+ *  Private Definitions
+ *============================================================================*/
+/* Lights in the grid, more than the reassembly slots */
+#define NUM_LIGHTS                      (12)
+
+/* Chunks in the report of each light */
+#define REPORT_CHUNKS                   (3)
+#define REPORT_LEN                      (2 * USER_ADV_CHUNK_LEN + 5)
+
+/* Lights send the chunks of a report 200ms apart and repeat the report
+ * every second
+ */
+#define CHUNK_INTERVAL                  (200 * MILLISECOND)
+#define REPORT_INTERVAL                 (SECOND)
+
+/* Time the grid is run for */
+#define GRID_RUN_TIME                   (60 * SECOND)
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+/* Reports notified for each light and the content of the last one */
+static uint16 notified[NUM_LIGHTS];
+static uint8 notified_data[NUM_LIGHTS][REPORT_LEN];
+static uint16 notified_len[NUM_LIGHTS];
+
+/* Content of the report of each light */
+static uint8 report_version[NUM_LIGHTS];
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+static void lightAddr(uint16 light, BD_ADDR_T *p_addr)
+{
+    p_addr->lap = 0x100000UL + light;
+    p_addr->uap = 0x5B;
+    p_addr->nap = 0x0002;
+}
+
+static uint8 reportOctet(uint16 light, uint16 offset)
+{
+    return (uint8)(light * 31 + report_version[light] * 7 + offset);
+}
+
+/* Sends one chunk of the report of a light to the module */
+static void sendChunk(uint16 light, uint16 chunk)
+{
+    uint8 data[1 + USER_ADV_CHUNK_LEN];
+    uint16 length = (chunk + 1 < REPORT_CHUNKS) ? USER_ADV_CHUNK_LEN :
+                            REPORT_LEN - chunk * USER_ADV_CHUNK_LEN;
+    BD_ADDR_T addr;
+    uint16 index;
+
+    data[0] = (REPORT_CHUNKS << 4) | chunk;
+    for(index = 0; index < length; index++)
+    {
+        data[1 + index] = reportOctet(light,
+                                      chunk * USER_ADV_CHUNK_LEN + index);
+    }
+
+    lightAddr(light, &addr);
+    AppUserAdvHandleChunk(&addr, data, 1 + length);
+}
+
+/* Checks the last report notified for a light against its content */
+static bool notifiedEquals(uint16 light)
+{
+    uint16 index;
+
+    if(notified_len[light] != REPORT_LEN)
+    {
+        return FALSE;
+    }
+
+    for(index = 0; index < REPORT_LEN; index++)
+    {
+        if(notified_data[light][index] != reportOctet(light, index))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static void resetTest(void)
+{
+    HostReset();
+    AppUserAdvInit();
+    memset(notified, 0, sizeof(notified));
+    memset(notified_len, 0, sizeof(notified_len));
+    memset(report_version, 0, sizeof(report_version));
+}
+
+/* Runs the grid, every light sending its report in turn. The lights start
+ * 50ms apart so that their chunks interleave.
+ */
+static void runGrid(uint32 duration)
+{
+    uint32 step = 50 * MILLISECOND;
+    uint32 time;
+    uint16 light;
+    uint32 phase;
+
+    for(time = 0; time < duration; time += step)
+    {
+        for(light = 0; light < NUM_LIGHTS; light++)
+        {
+            phase = (time + REPORT_INTERVAL - light * step) % REPORT_INTERVAL;
+
+            if(phase % CHUNK_INTERVAL == 0 &&
+               phase / CHUNK_INTERVAL < REPORT_CHUNKS)
+            {
+                sendChunk(light, phase / CHUNK_INTERVAL);
+            }
+        }
+
+        HostRunFor(step);
+    }
+}
+
+/*============================================================================*
+ *  Mesh Control Service
+ *============================================================================*/
+bool MeshControlNotifyUserAdvReport(const BD_ADDR_T *p_addr,
+                                    const uint8 *p_data, uint16 length)
+{
+    uint16 light = p_addr->lap - 0x100000UL;
+
+    CHECK(light < NUM_LIGHTS);
+    CHECK(length <= REPORT_LEN);
+    if(light < NUM_LIGHTS && length <= REPORT_LEN)
+    {
+        notified[light]++;
+        notified_len[light] = length;
+        memcpy(notified_data[light], p_data, length);
+    }
+
+    return TRUE;
+}
+
+/*============================================================================*
+ *  Tests
+ *============================================================================*/
+/* A grid of lights sending at once, with three times as many lights as
+ * slots, gets every report through once
+ */
+static void testGrid(void)
+{
+    uint16 light;
+
+    CHECK(NUM_LIGHTS > 2 * USER_ADV_SOURCES);
+    CHECK(NUM_LIGHTS <= USER_ADV_FORWARDED);
+
+    resetTest();
+    runGrid(GRID_RUN_TIME);
+
+    for(light = 0; light < NUM_LIGHTS; light++)
+    {
+        CHECK_EQUAL(1, notified[light]);
+        CHECK(notifiedEquals(light));
+    }
+}
+
+/* A changed report is notified again, an unchanged one is not */
+static void testChangedReport(void)
+{
+    uint16 light;
+
+    resetTest();
+    runGrid(GRID_RUN_TIME);
+
+    report_version[3]++;
+    runGrid(GRID_RUN_TIME);
+
+    for(light = 0; light < NUM_LIGHTS; light++)
+    {
+        CHECK_EQUAL(light == 3 ? 2 : 1, notified[light]);
+        CHECK(notifiedEquals(light));
+    }
+}
+
+/* A report in the middle of reassembly keeps its slot. The chunks of other
+ * lights are dropped until it completes or its chunks stop.
+ */
+static void testSlotKeptWhileReassembling(void)
+{
+    uint16 light;
+    uint16 chunk;
+
+    resetTest();
+
+    for(light = 0; light < USER_ADV_SOURCES; light++)
+    {
+        sendChunk(light, 0);
+    }
+
+    /* No slot is free for another light */
+    for(chunk = 0; chunk < REPORT_CHUNKS; chunk++)
+    {
+        sendChunk(USER_ADV_SOURCES, chunk);
+    }
+    CHECK_EQUAL(0, notified[USER_ADV_SOURCES]);
+
+    /* The reports being reassembled complete */
+    for(light = 0; light < USER_ADV_SOURCES; light++)
+    {
+        for(chunk = 1; chunk < REPORT_CHUNKS; chunk++)
+        {
+            sendChunk(light, chunk);
+        }
+        CHECK_EQUAL(1, notified[light]);
+    }
+
+    /* A complete report gives its slot up */
+    for(chunk = 0; chunk < REPORT_CHUNKS; chunk++)
+    {
+        sendChunk(USER_ADV_SOURCES, chunk);
+    }
+    CHECK_EQUAL(1, notified[USER_ADV_SOURCES]);
+
+    /* So does a report whose chunks stopped */
+    resetTest();
+    for(light = 0; light < USER_ADV_SOURCES; light++)
+    {
+        sendChunk(light, 0);
+    }
+    HostRunFor(USER_ADV_REASSEMBLY_TIMEOUT + SECOND);
+    for(chunk = 0; chunk < REPORT_CHUNKS; chunk++)
+    {
+        sendChunk(USER_ADV_SOURCES, chunk);
+    }
+    CHECK_EQUAL(1, notified[USER_ADV_SOURCES]);
+}
+
+/*============================================================================*
+ *  Test Runner
+ *============================================================================*/
+int main(void)
+{
+    testGrid();
+    testChangedReport();
+    testSlotKeptWhileReassembling();
+
+    return HostTestResult("test_user_adv");
+}